@@ -75,6 +75,29 @@ size_t isNdarrayContiguous(const pybind11::ndarray<Args...>& array)
     return true;
 }
 
+/**
+ * Get the number of elements stored in an array, where each element consists of `componentCount` values.
+ * The array must either be 1D and hold a multiple of `componentCount` values, or be 2D with `componentCount` columns.
+ * @param[in] array The array.
+ * @param[in] componentCount Number of values per element.
+ * @param[in] name Name of the array, used in error messages.
+ * @return The number of elements.
+ */
+template<typename... Args>
+size_t getNdarrayElementCount(const pybind11::ndarray<Args...>& array, size_t componentCount, const char* name)
+{
+    FALCOR_CHECK(
+        array.ndim() == 1 || (array.ndim() == 2 && array.shape(1) == componentCount),
+        "'{}' must be an array of shape (N, {}) or (N * {})",
+        name,
+        componentCount,
+        componentCount
+    );
+    size_t size = getNdarraySize(array);
+    FALCOR_CHECK(size % componentCount == 0, "'{}' must hold a multiple of {} values, got {}", name, componentCount, size);
+    return size / componentCount;
+}
+
 pybind11::dlpack::dtype dataTypeToDtype(DataType type);
 std::optional<pybind11::dlpack::dtype> resourceFormatToDtype(ResourceFormat format);
 
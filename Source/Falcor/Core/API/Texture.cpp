@@ -37,19 +37,18 @@
 #include "Utils/Logger.h"
 #include "Utils/Threading.h"
 #include "Utils/Math/Common.h"
-#include "Utils/Image/ImageIO.h"
+#include "Utils/Image/DecodedTexture.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Scripting/ndarray.h"
 #include "Core/Pass/FullScreenPass.h"
 
 #include <mutex>
+#include <cstring>
 
 namespace Falcor
 {
 namespace
 {
-static constexpr bool kTopDown = true; // Memory layout when loading from file
-
 gfx::IResource::Type getGfxResourceType(Texture::Type type)
 {
     switch (type)
@@ -265,99 +264,17 @@ ref<Texture> Texture::createMippedFromFiles(
     fstd::span<const std::filesystem::path> paths,
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
-    Bitmap::ImportFlags importFlags
+    Bitmap::ImportFlags importFlags,
+    Bitmap::UniqueConstPtr* pMip0Bitmap
 )
 {
-    std::vector<Bitmap::UniqueConstPtr> mips;
-    mips.reserve(paths.size());
-    size_t combinedSize = 0;
-    std::filesystem::path fullPathMip0;
-
-    for (const auto& path : paths)
-    {
-        Bitmap::UniqueConstPtr pBitmap;
-        if (hasExtension(path, "dds"))
-        {
-            pBitmap = ImageIO::loadBitmapFromDDS(path);
-        }
-        else
-        {
-            pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
-        }
-        if (!pBitmap)
-        {
-            logWarning("Error loading mip {}. Loading failed for image file '{}'.", mips.size(), path);
-            break;
-        }
-
-        if (!mips.empty())
-        {
-            if (mips.back()->getFormat() != pBitmap->getFormat())
-            {
-                logWarning("Error loading mip {} from file {}. Texture format of all mip levels must match.", mips.size(), path);
-                break;
-            }
-            if (std::max(mips.back()->getWidth() / 2, 1u) != pBitmap->getWidth() ||
-                std::max(mips.back()->getHeight() / 2, 1u) != pBitmap->getHeight())
-            {
-                logWarning(
-                    "Error loading mip {} from file {}. Image resolution must decrease by half. ({}, {}) != ({}, {})/2",
-                    mips.size(),
-                    path,
-                    pBitmap->getWidth(),
-                    pBitmap->getHeight(),
-                    mips.back()->getWidth(),
-                    mips.back()->getHeight()
-                );
-                break;
-            }
-        }
-        else
-        {
-            fullPathMip0 = path;
-        }
-        combinedSize += pBitmap->getSize();
-        mips.emplace_back(std::move(pBitmap));
-    }
-
-    ref<Texture> pTex;
-    if (!mips.empty())
-    {
-        // Combine all the mip data into a single buffer
-        size_t copyDst = 0;
-        std::unique_ptr<uint8_t[]> combinedData(new uint8_t[combinedSize]);
-        for (auto& mip : mips)
-        {
-            std::memcpy(&combinedData[copyDst], mip->getData(), mip->getSize());
-            copyDst += mip->getSize();
-        }
-
-        ResourceFormat texFormat = mips[0]->getFormat();
-        if (loadAsSrgb)
-            texFormat = linearToSrgbFormat(texFormat);
-
-        // Create mip mapped texture.
-        pTex =
-            pDevice->createTexture2D(mips[0]->getWidth(), mips[0]->getHeight(), texFormat, 1, mips.size(), combinedData.get(), bindFlags);
-    }
-
-    if (pTex != nullptr)
-    {
-        pTex->setSourcePath(fullPathMip0);
-        pTex->mImportFlags = importFlags;
-
-        // Log debug info.
-        std::string str = fmt::format(
-            "Loaded texture: size={}x{} mips={} format={} path={}",
-            pTex->getWidth(),
-            pTex->getHeight(),
-            pTex->getMipCount(),
-            to_string(pTex->getFormat()),
-            fullPathMip0
-        );
-        logDebug(str);
-    }
+    auto decoded = DecodedTexture::decodeMippedFromFiles(paths, loadAsSrgb, importFlags);
+    if (!decoded)
+        return nullptr;
 
+    ref<Texture> pTex = createFromDecoded(pDevice, *decoded, bindFlags);
+    if (pTex && pMip0Bitmap)
+        *pMip0Bitmap = std::move(decoded->pBitmap);
     return pTex;
 }
 
@@ -367,54 +284,71 @@ ref<Texture> Texture::createFromFile(
     bool generateMipLevels,
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
-    Bitmap::ImportFlags importFlags
+    Bitmap::ImportFlags importFlags,
+    Bitmap::UniqueConstPtr* pBitmap
 )
 {
-    if (!std::filesystem::exists(path))
-    {
-        logWarning("Error when loading image file. File '{}' does not exist.", path);
+    auto decoded = DecodedTexture::decodeFromFile(path, generateMipLevels, loadAsSrgb, importFlags);
+    if (!decoded)
         return nullptr;
-    }
 
     ref<Texture> pTex;
-    if (hasExtension(path, "dds"))
+    try
     {
-        try
-        {
-            pTex = ImageIO::loadTextureFromDDS(pDevice, path, loadAsSrgb);
-        }
-        catch (const std::exception& e)
-        {
-            logWarning("Error loading '{}': {}", path, e.what());
-        }
+        pTex = createFromDecoded(pDevice, *decoded, bindFlags);
     }
-    else
+    catch (const std::exception& e)
     {
-        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
-        if (pBitmap)
-        {
-            ResourceFormat texFormat = pBitmap->getFormat();
-            if (loadAsSrgb)
-            {
-                texFormat = linearToSrgbFormat(texFormat);
-            }
+        logWarning("Error creating texture from '{}': {}", path, e.what());
+    }
+    if (pTex && pBitmap)
+        *pBitmap = std::move(decoded->pBitmap);
+    return pTex;
+}
 
-            pTex = pDevice->createTexture2D(
-                pBitmap->getWidth(),
-                pBitmap->getHeight(),
-                texFormat,
-                1,
-                generateMipLevels ? Texture::kMaxPossible : 1,
-                pBitmap->getData(),
-                bindFlags
-            );
-        }
+ref<Texture> Texture::createFromDecoded(ref<Device> pDevice, const DecodedTexture& decoded, ResourceBindFlags bindFlags)
+{
+    const uint32_t mipLevels = decoded.generateMipLevels ? Texture::kMaxPossible : decoded.mipLevels;
+    const void* pData = decoded.getData();
+
+    // Replicate the texel of a constant texture over mip0.
+    std::vector<uint8_t> constantData;
+    if (decoded.isConstant)
+    {
+        FALCOR_ASSERT(decoded.type == Resource::Type::Texture2D && decoded.mipLevels == 1 && decoded.arraySize == 1);
+        const size_t texelSize = decoded.getDataSize();
+        constantData.resize(size_t(decoded.width) * decoded.height * texelSize);
+        for (size_t offset = 0; offset < constantData.size(); offset += texelSize)
+            std::memcpy(constantData.data() + offset, pData, texelSize);
+        pData = constantData.data();
+    }
+
+    ref<Texture> pTex;
+    switch (decoded.type)
+    {
+    case Resource::Type::Texture1D:
+        pTex = pDevice->createTexture1D(decoded.width, decoded.format, decoded.arraySize, mipLevels, pData, bindFlags);
+        break;
+    case Resource::Type::Texture2D:
+        pTex = pDevice->createTexture2D(decoded.width, decoded.height, decoded.format, decoded.arraySize, mipLevels, pData, bindFlags);
+        break;
+    case Resource::Type::TextureCube:
+        pTex = pDevice->createTextureCube(
+            decoded.width, decoded.height, decoded.format, decoded.arraySize / 6, mipLevels, pData, bindFlags
+        );
+        break;
+    case Resource::Type::Texture3D:
+        pTex = pDevice->createTexture3D(decoded.width, decoded.height, decoded.depth, decoded.format, mipLevels, pData, bindFlags);
+        break;
+    default:
+        logWarning("Failed to create texture from '{}': Unrecognized texture type.", decoded.sourcePath);
+        return nullptr;
     }
 
     if (pTex != nullptr)
     {
-        pTex->setSourcePath(path);
-        pTex->mImportFlags = importFlags;
+        pTex->setSourcePath(decoded.sourcePath);
+        pTex->mImportFlags = decoded.importFlags;
 
         // Log debug info.
         std::string str = fmt::format(
@@ -423,7 +357,7 @@ ref<Texture> Texture::createFromFile(
             pTex->getHeight(),
             pTex->getMipCount(),
             to_string(pTex->getFormat()),
-            path
+            decoded.sourcePath
         );
         logDebug(str);
     }
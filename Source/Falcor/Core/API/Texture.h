@@ -40,6 +40,7 @@ namespace Falcor
 {
 class Sampler;
 class RenderContext;
+struct DecodedTexture;
 
 /**
  * Abstracts the API texture objects
@@ -167,6 +168,7 @@ public:
      * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
      * @param[in] bindFlags The bind flags to create the texture with.
      * @param[in] importFlags Optional flags for the file import.
+     * @param[out] pMip0Bitmap Optional pointer receiving the decoded bitmap of mip0.
      * @return A new texture, or nullptr if the texture failed to load.
      */
     static ref<Texture> createMippedFromFiles(
@@ -174,7 +176,8 @@ public:
         fstd::span<const std::filesystem::path> paths,
         bool loadAsSrgb,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
-        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
+        Bitmap::UniqueConstPtr* pMip0Bitmap = nullptr
     );
 
     /**
@@ -184,6 +187,7 @@ public:
      * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
      * @param[in] bindFlags The bind flags to create the texture with.
      * @param[in] importFlags Optional flags for the file import.
+     * @param[out] pBitmap Optional pointer receiving the decoded bitmap. DDS files are not decoded to a bitmap.
      * @return A new texture, or nullptr if the texture failed to load.
      */
     static ref<Texture> createFromFile(
@@ -192,7 +196,20 @@ public:
         bool generateMipLevels,
         bool loadAsSrgb,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
-        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
+        Bitmap::UniqueConstPtr* pBitmap = nullptr
+    );
+
+    /**
+     * Create a new texture object from texel data decoded on the CPU.
+     * @param[in] decoded Decoded texture (see DecodedTexture::decodeFromFile()).
+     * @param[in] bindFlags The bind flags to create the texture with.
+     * @return A new texture, or nullptr if the texture failed to be created.
+     */
+    static ref<Texture> createFromDecoded(
+        ref<Device> pDevice,
+        const DecodedTexture& decoded,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
     );
 
     gfx::ITextureResource* getGfxTextureResource() const { return mGfxTextureResource; }
@@ -33,6 +33,7 @@
 #include "Core/ObjectPython.h"
 #include "Core/API/Device.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
+#include "Utils/Logger.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
@@ -139,7 +140,7 @@ uint32_t RenderGraph::addPass(const ref<RenderPass>& pPass, const std::string& p
     uint32_t passIndex = mpGraph->addNode();
     mNameToIndex[passName] = passIndex;
 
-    pPass->mPassChangedCB = [this]() { mRecompile = true; };
+    pPass->mPassChangedCB = [this, passIndex]() { mDirtyPasses.insert(passIndex); };
     pPass->mName = passName;
 
     if (mpScene)
@@ -187,7 +188,7 @@ void RenderGraph::updatePass(const std::string& passName, const Properties& prop
     std::string passTypeName = pOldPass->getType();
     auto pPass = RenderPass::create(passTypeName, mpDevice, props);
     pPassIt->second.pPass = pPass;
-    pPass->mPassChangedCB = [this]() { mRecompile = true; };
+    pPass->mPassChangedCB = [this, index]() { mDirtyPasses.insert(index); };
     pPass->mName = pOldPass->getName();
 
     if (mpScene)
@@ -423,18 +424,43 @@ std::vector<std::string> RenderGraph::getUnmarkedOutputs() const
 
 bool RenderGraph::compile(RenderContext* pRenderContext, std::string& log)
 {
-    if (!mRecompile)
+    if (!mRecompile && mDirtyPasses.empty())
         return true;
-    mpExe = nullptr;
 
     try
     {
-        mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps);
+        // Only recompile the passes affected by changes of individual passes if the graph itself didn't change
+        bool compiled = false;
+        if (!mRecompile && mpExe)
+        {
+            compiled = RenderGraphCompiler::recompile(*this, pRenderContext, mCompilerDeps, mDirtyPasses, *mpExe, &mCompileStats);
+        }
+
+        if (!compiled)
+        {
+            mpExe = nullptr;
+            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps, &mCompileStats);
+        }
+
         mRecompile = false;
+        mDirtyPasses.clear();
+
+        logDebug(
+            "Compiled render graph '{}' ({}): {} of {} passes compiled, {} of {} resources allocated in {:.2f} ms.",
+            mName,
+            mCompileStats.incremental ? "incremental" : "full",
+            mCompileStats.compiledPassCount,
+            mCompileStats.passCount,
+            mCompileStats.allocatedResourceCount,
+            mCompileStats.resourceCount,
+            mCompileStats.compileTime
+        );
         return true;
     }
     catch (const std::exception& e)
     {
+        mpExe = nullptr;
+        mRecompile = true;
         log = e.what();
         return false;
     }
@@ -610,7 +636,7 @@ bool RenderGraph::isGraphOutput(const std::string& name) const
 
 ref<Resource> RenderGraph::getOutput(const std::string& name)
 {
-    if (mRecompile)
+    if (mRecompile || !mDirtyPasses.empty())
         FALCOR_THROW("Can't fetch the output '{}'. The graph wasn't successfuly compiled yet.", name);
 
     str_pair strPair;
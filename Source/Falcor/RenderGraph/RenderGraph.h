@@ -311,6 +311,13 @@ public:
         return compile(pRenderContext, s);
     }
 
+    /**
+     * Get the statistics of the last compilation.
+     * Changes to the graph or the frame size trigger a full compilation. If only passes requested a recompilation, just the passes
+     * affected by the change are compiled again and unchanged resources are kept.
+     */
+    const RenderGraphCompiler::Stats& getCompileStats() const { return mCompileStats; }
+
 private:
     struct EdgeData
     {
@@ -378,6 +385,8 @@ private:
     std::unique_ptr<RenderGraphExe> mpExe;           ///< Helper for allocating resources and executing the graph.
     RenderGraphCompiler::Dependencies mCompilerDeps; ///< Data needed by the graph compiler.
     bool mRecompile = false; ///< Set to true to trigger a recompilation after any graph changes (topology/scene/size/passes/etc.)
+    std::unordered_set<uint32_t> mDirtyPasses;       ///< Node IDs of passes that requested a recompilation.
+    RenderGraphCompiler::Stats mCompileStats;        ///< Statistics of the last compilation.
 
     friend class RenderGraphUI;
     friend class RenderGraphExporter;
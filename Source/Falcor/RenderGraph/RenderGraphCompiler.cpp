@@ -31,6 +31,8 @@
 #include "Core/Error.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -49,9 +51,11 @@ RenderGraphCompiler::RenderGraphCompiler(RenderGraph& graph, const Dependencies&
 std::unique_ptr<RenderGraphExe> RenderGraphCompiler::compile(
     RenderGraph& graph,
     RenderContext* pRenderContext,
-    const Dependencies& dependencies
+    const Dependencies& dependencies,
+    Stats* pStats
 )
 {
+    auto startTime = CpuTimer::getCurrentTimePoint();
     RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies);
 
     // Register the external resources
@@ -60,11 +64,12 @@ std::unique_ptr<RenderGraphExe> RenderGraphCompiler::compile(
         pResourcesCache->registerExternalResource(name, pRes);
 
     c.resolveExecutionOrder();
-    c.compilePasses(pRenderContext);
+    std::vector<bool> passMask(c.mExecutionList.size(), true);
+    uint32_t compiledPassCount = c.compilePasses(pRenderContext, passMask);
     if (c.insertAutoPasses())
         c.resolveExecutionOrder();
     c.validateGraph();
-    c.allocateResources(pRenderContext->getDevice(), pResourcesCache.get());
+    uint32_t allocatedResourceCount = c.allocateResources(pRenderContext->getDevice(), pResourcesCache.get());
 
     auto pExe = std::make_unique<RenderGraphExe>();
     pExe->mExecutionList.reserve(c.mExecutionList.size());
@@ -72,12 +77,101 @@ std::unique_ptr<RenderGraphExe> RenderGraphCompiler::compile(
     for (auto e : c.mExecutionList)
     {
         pExe->insertPass(e.name, e.pPass);
+        pExe->mNodeIndices.push_back(e.index);
+        pExe->mReflections.push_back(e.reflector);
     }
+    pExe->mHasGeneratedPasses = !c.mCompilationChanges.generatedPasses.empty();
     c.restoreCompilationChanges();
     pExe->mpResourceCache = std::move(pResourcesCache);
+
+    if (pStats)
+    {
+        *pStats = {};
+        pStats->passCount = (uint32_t)c.mExecutionList.size();
+        pStats->compiledPassCount = compiledPassCount;
+        pStats->resourceCount = pExe->mpResourceCache->getResourceCount();
+        pStats->allocatedResourceCount = allocatedResourceCount;
+        pStats->compileTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
     return pExe;
 }
 
+bool RenderGraphCompiler::recompile(
+    RenderGraph& graph,
+    RenderContext* pRenderContext,
+    const Dependencies& dependencies,
+    const std::unordered_set<uint32_t>& dirtyPasses,
+    RenderGraphExe& exe,
+    Stats* pStats
+)
+{
+    // Passes inserted by the compiler are not part of the graph, so their connections can't be tracked.
+    if (exe.mHasGeneratedPasses || !exe.mpResourceCache)
+        return false;
+
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies);
+
+    // Restore the execution list of the previous compilation. The topology is unchanged, so the execution order still holds.
+    for (size_t i = 0; i < exe.mExecutionList.size(); i++)
+    {
+        uint32_t index = exe.mNodeIndices[i];
+        auto it = graph.mNodeData.find(index);
+        if (it == graph.mNodeData.end() || it->second.pPass != exe.mExecutionList[i].pPass)
+            return false;
+        c.mExecutionList.push_back({index, exe.mExecutionList[i].pPass, exe.mExecutionList[i].name, exe.mReflections[i]});
+    }
+
+    RenderPass::CompileData compileData;
+    compileData.defaultTexDims = dependencies.defaultResourceProps.dims;
+    compileData.defaultTexFormat = dependencies.defaultResourceProps.format;
+
+    // Reflect the dirty passes again. Passes connected to a pass whose reflection changed need to be compiled as well.
+    std::vector<bool> passMask(c.mExecutionList.size(), false);
+    for (size_t i = 0; i < c.mExecutionList.size(); i++)
+    {
+        auto& p = c.mExecutionList[i];
+        if (dirtyPasses.count(p.index) == 0)
+            continue;
+
+        passMask[i] = true;
+        auto newR = p.pPass->reflect(compileData);
+        if (newR != p.reflector)
+        {
+            p.reflector = newR;
+            c.markConnectedPasses(i, passMask);
+        }
+    }
+
+    uint32_t compiledPassCount = c.compilePasses(pRenderContext, passMask);
+    if (c.requiresAutoPasses())
+        return false;
+    c.validateGraph();
+
+    // Rebuild the resource cache, taking over resources whose properties are unchanged.
+    auto pResourcesCache = std::make_unique<ResourceCache>();
+    for (const auto& [name, pRes] : dependencies.externalResources)
+        pResourcesCache->registerExternalResource(name, pRes);
+    uint32_t allocatedResourceCount =
+        c.allocateResources(pRenderContext->getDevice(), pResourcesCache.get(), exe.mpResourceCache.get());
+
+    for (size_t i = 0; i < c.mExecutionList.size(); i++)
+        exe.mReflections[i] = c.mExecutionList[i].reflector;
+    exe.mpResourceCache = std::move(pResourcesCache);
+
+    if (pStats)
+    {
+        *pStats = {};
+        pStats->incremental = true;
+        pStats->passCount = (uint32_t)c.mExecutionList.size();
+        pStats->compiledPassCount = compiledPassCount;
+        pStats->resourceCount = exe.mpResourceCache->getResourceCount();
+        pStats->allocatedResourceCount = allocatedResourceCount;
+        pStats->compileTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+    return true;
+}
+
 void RenderGraphCompiler::validateGraph() const
 {
     std::string err;
@@ -261,7 +355,34 @@ bool RenderGraphCompiler::insertAutoPasses()
     return addedPasses;
 }
 
-void RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache* pResourceCache)
+bool RenderGraphCompiler::requiresAutoPasses() const
+{
+    for (const auto& p : mExecutionList)
+    {
+        const DirectedGraph::Node* pNode = mGraph.mpGraph->getNode(p.index);
+        for (uint32_t e = 0; e < pNode->getOutgoingEdgeCount(); e++)
+        {
+            uint32_t edgeIndex = pNode->getOutgoingEdge(e);
+            const auto& edgeData = mGraph.mEdgeData.at(edgeIndex);
+            if (edgeData.srcField.empty())
+                continue;
+
+            uint32_t dstIndex = mGraph.mpGraph->getEdge(edgeIndex)->getDestNode();
+            for (const auto& other : mExecutionList)
+            {
+                if (other.index != dstIndex)
+                    continue;
+                const auto* pSrcField = p.reflector.getField(edgeData.srcField);
+                const auto* pDstField = other.reflector.getField(edgeData.dstField);
+                if (pSrcField && pDstField && canAutoResolve(*pSrcField, *pDstField))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache* pResourceCache, const ResourceCache* pPrevious)
 {
     // Build list to look up execution order index from the pass
     std::unordered_map<RenderPass*, uint32_t> passToIndex;
@@ -342,7 +463,7 @@ void RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache*
         }
     }
 
-    pResourceCache->allocateResources(pDevice, mDependencies.defaultResourceProps);
+    return pResourceCache->allocateResources(pDevice, mDependencies.defaultResourceProps, pPrevious);
 }
 
 void RenderGraphCompiler::restoreCompilationChanges()
@@ -440,14 +561,20 @@ RenderPass::CompileData RenderGraphCompiler::prepPassCompilationData(const PassD
     return compileData;
 }
 
-void RenderGraphCompiler::compilePasses(RenderContext* pRenderContext)
+uint32_t RenderGraphCompiler::compilePasses(RenderContext* pRenderContext, std::vector<bool>& passMask)
 {
+    FALCOR_ASSERT(passMask.size() == mExecutionList.size());
+
     while (1)
     {
         std::string log;
         bool success = true;
-        for (auto& p : mExecutionList)
+        for (size_t i = 0; i < mExecutionList.size(); i++)
         {
+            if (!passMask[i])
+                continue;
+
+            auto& p = mExecutionList[i];
             try
             {
                 p.pPass->compile(pRenderContext, prepPassCompilationData(p));
@@ -460,16 +587,21 @@ void RenderGraphCompiler::compilePasses(RenderContext* pRenderContext)
         }
 
         if (success)
-            return;
+            return (uint32_t)std::count(passMask.begin(), passMask.end(), true);
 
         // Retry
         bool changed = false;
-        for (auto& p : mExecutionList)
+        for (size_t i = 0; i < mExecutionList.size(); i++)
         {
+            if (!passMask[i])
+                continue;
+
+            auto& p = mExecutionList[i];
             auto newR = p.pPass->reflect(prepPassCompilationData(p));
             if (newR != p.reflector)
             {
                 p.reflector = newR;
+                markConnectedPasses(i, passMask);
                 changed = true;
             }
         }
@@ -477,4 +609,31 @@ void RenderGraphCompiler::compilePasses(RenderContext* pRenderContext)
         FALCOR_CHECK(changed, "Graph compilation failed:\n{}", log);
     }
 }
+
+void RenderGraphCompiler::markConnectedPasses(size_t passIndex, std::vector<bool>& passMask) const
+{
+    // The compile data of a pass includes the fields of the passes it is connected to through data edges
+    auto markPass = [&](uint32_t edgeIndex, uint32_t nodeIndex)
+    {
+        if (mGraph.mEdgeData.at(edgeIndex).srcField.empty())
+            return; // Execution edge
+        for (size_t i = 0; i < mExecutionList.size(); i++)
+        {
+            if (mExecutionList[i].index == nodeIndex)
+                passMask[i] = true;
+        }
+    };
+
+    const DirectedGraph::Node* pNode = mGraph.mpGraph->getNode(mExecutionList[passIndex].index);
+    for (uint32_t e = 0; e < pNode->getIncomingEdgeCount(); e++)
+    {
+        uint32_t edgeIndex = pNode->getIncomingEdge(e);
+        markPass(edgeIndex, mGraph.mpGraph->getEdge(edgeIndex)->getSourceNode());
+    }
+    for (uint32_t e = 0; e < pNode->getOutgoingEdgeCount(); e++)
+    {
+        uint32_t edgeIndex = pNode->getOutgoingEdge(e);
+        markPass(edgeIndex, mGraph.mpGraph->getEdge(edgeIndex)->getDestNode());
+    }
+}
 } // namespace Falcor
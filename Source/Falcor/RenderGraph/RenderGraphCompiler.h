@@ -32,6 +32,7 @@
 #include "RenderGraphExe.h"
 #include "Core/Macros.h"
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -47,7 +48,43 @@ public:
         ResourceCache::DefaultProperties defaultResourceProps;
         ResourceCache::ResourcesMap externalResources;
     };
-    static std::unique_ptr<RenderGraphExe> compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
+
+    /// Statistics of a compilation.
+    struct Stats
+    {
+        bool incremental = false;            ///< True if only the changed part of the graph was recompiled.
+        uint32_t passCount = 0;              ///< Number of passes in the execution list.
+        uint32_t compiledPassCount = 0;      ///< Number of passes that were compiled.
+        uint32_t resourceCount = 0;          ///< Number of resources owned by the graph.
+        uint32_t allocatedResourceCount = 0; ///< Number of resources that were allocated.
+        double compileTime = 0.0;            ///< Compilation time in ms.
+    };
+
+    static std::unique_ptr<RenderGraphExe> compile(
+        RenderGraph& graph,
+        RenderContext* pRenderContext,
+        const Dependencies& dependencies,
+        Stats* pStats = nullptr
+    );
+
+    /**
+     * Recompile a graph after some of its passes requested a recompilation, without changes to the graph topology.
+     * The dirty passes are reflected and compiled again. Passes connected to fields whose reflection changed are compiled again
+     * as well, repeatedly until the reflections are stable. Resources of the previous compilation are kept if their properties
+     * are unchanged.
+     * @param[in] dirtyPasses Node IDs of the passes that requested a recompilation.
+     * @param[in,out] exe Executable of the previous compilation. It is updated in place on success.
+     * @param[out] pStats Optional compilation statistics.
+     * @return True if the graph was recompiled, false if a full compilation is required.
+     */
+    static bool recompile(
+        RenderGraph& graph,
+        RenderContext* pRenderContext,
+        const Dependencies& dependencies,
+        const std::unordered_set<uint32_t>& dirtyPasses,
+        RenderGraphExe& exe,
+        Stats* pStats = nullptr
+    );
 
 private:
     RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies);
@@ -73,9 +110,11 @@ private:
     } mCompilationChanges;
 
     void resolveExecutionOrder();
-    void compilePasses(RenderContext* pRenderContext);
+    uint32_t compilePasses(RenderContext* pRenderContext, std::vector<bool>& passMask);
+    void markConnectedPasses(size_t passIndex, std::vector<bool>& passMask) const;
     bool insertAutoPasses();
-    void allocateResources(ref<Device> pDevice, ResourceCache* pResourceCache);
+    bool requiresAutoPasses() const;
+    uint32_t allocateResources(ref<Device> pDevice, ResourceCache* pResourceCache, const ResourceCache* pPrevious = nullptr);
     void validateGraph() const;
     void restoreCompilationChanges();
     RenderPass::CompileData prepPassCompilationData(const PassData& passData);
@@ -116,5 +116,10 @@ private:
 
     std::vector<Pass> mExecutionList;
     std::unique_ptr<ResourceCache> mpResourceCache;
+
+    // Compilation results kept for incremental recompilation
+    std::vector<uint32_t> mNodeIndices;             ///< Graph node ID of each pass in the execution list.
+    std::vector<RenderPassReflection> mReflections; ///< Reflection of each pass in the execution list.
+    bool mHasGeneratedPasses = false;               ///< True if the compiler inserted passes which are not part of the graph.
 };
 } // namespace Falcor
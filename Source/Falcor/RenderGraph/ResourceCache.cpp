@@ -191,14 +191,37 @@ inline ref<Resource> createResourceForPass(
     return pResource;
 }
 
-void ResourceCache::allocateResources(ref<Device> pDevice, const DefaultProperties& params)
+uint32_t ResourceCache::allocateResources(ref<Device> pDevice, const DefaultProperties& params, const ResourceCache* pPrevious)
 {
+    // Resources of a previous cache can only be reused if unspecified properties resolve to the same values
+    if (pPrevious && (any(pPrevious->mDefaultProperties.dims != params.dims) || pPrevious->mDefaultProperties.format != params.format))
+        pPrevious = nullptr;
+
+    uint32_t allocatedCount = 0;
     for (auto& data : mResourceData)
     {
         if ((data.pResource == nullptr) && (data.field.isValid()))
         {
-            data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
+            if (pPrevious)
+            {
+                auto it = pPrevious->mNameToIndex.find(data.name);
+                if (it != pPrevious->mNameToIndex.end())
+                {
+                    const auto& prevData = pPrevious->mResourceData[it->second];
+                    if (prevData.name == data.name && prevData.field == data.field && prevData.resolveBindFlags == data.resolveBindFlags)
+                        data.pResource = prevData.pResource;
+                }
+            }
+
+            if (data.pResource == nullptr)
+            {
+                data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
+                allocatedCount++;
+            }
         }
     }
+
+    mDefaultProperties = params;
+    return allocatedCount;
 }
 } // namespace Falcor
@@ -86,8 +86,16 @@ public:
     /**
      * Allocate all resources that need to be created/updated.
      * This includes new resources, resources whose properties have been updated since last allocation call.
+     * @param[in] pPrevious Optional cache from a previous compilation. Resources with the same name and properties are taken over
+     * from it instead of being allocated.
+     * @return Number of resources that were allocated.
      */
-    void allocateResources(ref<Device> pDevice, const DefaultProperties& params);
+    uint32_t allocateResources(ref<Device> pDevice, const DefaultProperties& params, const ResourceCache* pPrevious = nullptr);
+
+    /**
+     * Get the number of resources owned by the cache. Aliased fields share a resource.
+     */
+    uint32_t getResourceCount() const { return (uint32_t)mResourceData.size(); }
 
     /**
      * Clears all registered field/resource properties and allocated resources.
@@ -110,6 +118,9 @@ private:
 
     // References to output resources not to be allocated by the render graph
     ResourcesMap mExternalResources;
+
+    // Default properties used for the last allocation
+    DefaultProperties mDefaultProperties{};
 };
 
 } // namespace Falcor
@@ -0,0 +1,207 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasBuildCache.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Fixed overhead per BLAS used by the estimator, for both result and scratch data.
+        */
+        const uint64_t kEstimatedBlasOverhead = 4096;
+
+        /** Default bytes per triangle. These are conservative compared to sizes observed on current GPUs.
+        */
+        const double kDefaultTriangleResultBytes = 128.0;
+        const double kDefaultTriangleScratchBytes = 64.0;
+        const double kDefaultTriangleCompactedBytes = 64.0;
+
+        /** Default bytes per AABB.
+        */
+        const double kDefaultAABBResultBytes = 96.0;
+        const double kDefaultAABBScratchBytes = 64.0;
+        const double kDefaultAABBCompactedBytes = 48.0;
+
+        bool isCompacted(const BlasBuildRecord& record)
+        {
+            return is_set(record.buildFlags, RtAccelerationStructureBuildFlags::AllowCompaction);
+        }
+
+        bool hasOnlyType(const BlasBuildRecord& record, RtGeometryType type)
+        {
+            return !record.geometries.empty() && std::all_of(record.geometries.begin(), record.geometries.end(), [type](const BlasGeometryRecord& g) { return g.type == type; });
+        }
+
+        uint64_t estimateBytes(double rate, uint64_t primitiveCount)
+        {
+            return align_to(kAccelerationStructureByteAlignment, kEstimatedBlasOverhead + (uint64_t)(rate * (double)primitiveCount));
+        }
+    }
+
+    uint64_t BlasGeometryRecord::getPrimitiveCount() const
+    {
+        if (type == RtGeometryType::ProcedurePrimitives) return aabbCount;
+        return (indexCount > 0 ? indexCount : vertexCount) / 3;
+    }
+
+    bool BlasGeometryRecord::operator==(const BlasGeometryRecord& other) const
+    {
+        return type == other.type && flags == other.flags && vertexCount == other.vertexCount && indexCount == other.indexCount &&
+            indexFormat == other.indexFormat && aabbCount == other.aabbCount && hasTransform == other.hasTransform;
+    }
+
+    bool BlasBuildRecord::hasSameInputs(const BlasBuildRecord& other) const
+    {
+        return buildFlags == other.buildFlags && geometries == other.geometries;
+    }
+
+    uint64_t BlasBuildRecord::getPrimitiveCount() const
+    {
+        uint64_t count = 0;
+        for (const auto& geometry : geometries) count += geometry.getPrimitiveCount();
+        return count;
+    }
+
+    bool BlasBuildRecord::operator==(const BlasBuildRecord& other) const
+    {
+        return hasSameInputs(other) &&
+            prebuildInfo.resultDataMaxSize == other.prebuildInfo.resultDataMaxSize &&
+            prebuildInfo.scratchDataSize == other.prebuildInfo.scratchDataSize &&
+            prebuildInfo.updateScratchDataSize == other.prebuildInfo.updateScratchDataSize &&
+            finalByteSize == other.finalByteSize;
+    }
+
+    BlasBuildSize getBlasBuildSize(const BlasBuildRecord& record)
+    {
+        // Same padding as in Scene::preparePrebuildInfo().
+        BlasBuildSize size;
+        size.resultByteSize = align_to(kAccelerationStructureByteAlignment, record.prebuildInfo.resultDataMaxSize);
+        size.scratchByteSize = align_to(kAccelerationStructureByteAlignment, std::max(record.prebuildInfo.scratchDataSize, record.prebuildInfo.updateScratchDataSize));
+        return size;
+    }
+
+    BlasSizeEstimator::BlasSizeEstimator()
+        : mTriangleRates{ kDefaultTriangleResultBytes, kDefaultTriangleScratchBytes, kDefaultTriangleCompactedBytes }
+        , mAABBRates{ kDefaultAABBResultBytes, kDefaultAABBScratchBytes, kDefaultAABBCompactedBytes }
+    {}
+
+    void BlasSizeEstimator::calibrate(const std::vector<BlasBuildRecord>& records)
+    {
+        auto calibrateType = [&](RtGeometryType type, Rates& rates)
+        {
+            uint64_t primitiveCount = 0, resultBytes = 0, scratchBytes = 0;
+            uint64_t compactedPrimitiveCount = 0, compactedBytes = 0;
+
+            for (const auto& record : records)
+            {
+                if (!record.hasSizes() || !hasOnlyType(record, type)) continue;
+
+                const BlasBuildSize size = getBlasBuildSize(record);
+                const uint64_t count = record.getPrimitiveCount();
+                primitiveCount += count;
+                resultBytes += size.resultByteSize - std::min(size.resultByteSize, kEstimatedBlasOverhead);
+                scratchBytes += size.scratchByteSize - std::min(size.scratchByteSize, kEstimatedBlasOverhead);
+
+                if (isCompacted(record))
+                {
+                    compactedPrimitiveCount += count;
+                    compactedBytes += record.finalByteSize - std::min(record.finalByteSize, kEstimatedBlasOverhead);
+                }
+            }
+
+            if (primitiveCount > 0)
+            {
+                rates.resultBytes = (double)resultBytes / (double)primitiveCount;
+                rates.scratchBytes = (double)scratchBytes / (double)primitiveCount;
+            }
+            if (compactedPrimitiveCount > 0)
+            {
+                rates.compactedBytes = (double)compactedBytes / (double)compactedPrimitiveCount;
+            }
+        };
+
+        calibrateType(RtGeometryType::Triangles, mTriangleRates);
+        calibrateType(RtGeometryType::ProcedurePrimitives, mAABBRates);
+    }
+
+    BlasBuildSize BlasSizeEstimator::estimateBuildSize(const BlasBuildRecord& record) const
+    {
+        const Rates& rates = getRates(record);
+        const uint64_t primitiveCount = record.getPrimitiveCount();
+        return { estimateBytes(rates.resultBytes, primitiveCount), estimateBytes(rates.scratchBytes, primitiveCount) };
+    }
+
+    uint64_t BlasSizeEstimator::estimateFinalSize(const BlasBuildRecord& record) const
+    {
+        if (!isCompacted(record)) return estimateBuildSize(record).resultByteSize;
+        return estimateBytes(getRates(record).compactedBytes, record.getPrimitiveCount());
+    }
+
+    const BlasSizeEstimator::Rates& BlasSizeEstimator::getRates(const BlasBuildRecord& record) const
+    {
+        // BLASes mixing triangles and AABBs (displaced meshes) are estimated with the triangle rates.
+        return hasOnlyType(record, RtGeometryType::ProcedurePrimitives) ? mAABBRates : mTriangleRates;
+    }
+
+    BlasMemoryReport computeBlasMemoryReport(const BlasBuildCache& cache, uint64_t maxGroupByteSize)
+    {
+        BlasSizeEstimator estimator;
+        estimator.calibrate(cache.blases);
+
+        BlasMemoryReport report;
+        report.blasCount = cache.blases.size();
+
+        std::vector<BlasBuildSize> sizes(cache.blases.size());
+        for (size_t i = 0; i < cache.blases.size(); i++)
+        {
+            const auto& record = cache.blases[i];
+            report.primitiveCount += record.getPrimitiveCount();
+
+            if (record.hasSizes())
+            {
+                sizes[i] = getBlasBuildSize(record);
+                report.finalByteSize += record.finalByteSize;
+            }
+            else
+            {
+                sizes[i] = estimator.estimateBuildSize(record);
+                report.finalByteSize += estimator.estimateFinalSize(record);
+                report.estimatedBlasCount++;
+            }
+        }
+
+        auto groups = computeBlasGroupPacking(sizes, maxGroupByteSize, BlasGroupPacking::FirstFitDecreasing);
+        auto stats = computeBlasGroupPackingStats(sizes, groups);
+        report.groupCount = stats.groupCount;
+        report.buildByteSize = stats.getPeakByteSize();
+
+        return report;
+    }
+}
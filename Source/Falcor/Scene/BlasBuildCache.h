@@ -0,0 +1,165 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "BlasGroupPacking.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/API/RtAccelerationStructure.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Default memory budget for building a group of BLASes.
+    */
+    const uint64_t kDefaultBlasBuildMemoryBudget = 1ull << 29;
+
+    /** Build input of one BLAS geometry, without device addresses.
+    */
+    struct BlasGeometryRecord
+    {
+        RtGeometryType type = RtGeometryType::Triangles;
+        RtGeometryFlags flags = RtGeometryFlags::None;
+        uint32_t vertexCount = 0;                               ///< Number of vertices (triangles only).
+        uint32_t indexCount = 0;                                ///< Number of indices, zero for non-indexed triangles.
+        ResourceFormat indexFormat = ResourceFormat::Unknown;   ///< Index format (triangles only).
+        uint64_t aabbCount = 0;                                 ///< Number of AABBs (procedural primitives only).
+        bool hasTransform = false;                              ///< True if the vertices are transformed during the build.
+
+        /** Get the number of triangles or AABBs.
+        */
+        uint64_t getPrimitiveCount() const;
+
+        bool operator==(const BlasGeometryRecord& other) const;
+        bool operator!=(const BlasGeometryRecord& other) const { return !(*this == other); }
+    };
+
+    /** Build inputs of one BLAS and the sizes last observed when building it on a device.
+    */
+    struct BlasBuildRecord
+    {
+        std::vector<BlasGeometryRecord> geometries;
+        RtAccelerationStructureBuildFlags buildFlags = RtAccelerationStructureBuildFlags::None;
+
+        RtAccelerationStructurePrebuildInfo prebuildInfo = {};  ///< Prebuild info. All zero if unknown.
+        uint64_t finalByteSize = 0;                             ///< Size of the final BLAS (compacted if compaction is enabled), including padding. Zero if unknown.
+
+        /** Check if the record has observed sizes.
+        */
+        bool hasSizes() const { return prebuildInfo.resultDataMaxSize > 0 && finalByteSize > 0; }
+
+        /** Check if two records describe the same build inputs, ignoring the sizes.
+        */
+        bool hasSameInputs(const BlasBuildRecord& other) const;
+
+        /** Get the total number of triangles and AABBs.
+        */
+        uint64_t getPrimitiveCount() const;
+
+        bool operator==(const BlasBuildRecord& other) const;
+        bool operator!=(const BlasBuildRecord& other) const { return !(*this == other); }
+    };
+
+    /** BLAS build records of a scene, stored in the scene cache.
+        The sizes depend on the GPU and driver, so they are tagged with the device they were observed on.
+    */
+    struct BlasBuildCache
+    {
+        std::string deviceName;                 ///< Name of the device the sizes were observed on.
+        std::vector<BlasBuildRecord> blases;    ///< One record per BLAS, in the order of the scene's BLAS data.
+
+        bool operator==(const BlasBuildCache& other) const { return deviceName == other.deviceName && blases == other.blases; }
+        bool operator!=(const BlasBuildCache& other) const { return !(*this == other); }
+    };
+
+    /** Get the memory requirements for building a BLAS from its recorded prebuild info, padded as for the actual build.
+        \param[in] record BLAS build record with sizes.
+        \return Memory requirements.
+    */
+    FALCOR_API BlasBuildSize getBlasBuildSize(const BlasBuildRecord& record);
+
+    /** CPU-side estimator for BLAS sizes.
+        Sizes are estimated as a number of bytes per triangle or AABB plus a fixed overhead per BLAS.
+        The default rates are conservative. Calibrating with records observed on a device makes the
+        estimate match that device more closely.
+    */
+    class FALCOR_API BlasSizeEstimator
+    {
+    public:
+        BlasSizeEstimator();
+
+        /** Derive the per-primitive rates from records with observed sizes.
+            Only records with a single geometry type contribute to the rates of that type.
+            \param[in] records BLAS build records. Records without sizes are ignored.
+        */
+        void calibrate(const std::vector<BlasBuildRecord>& records);
+
+        /** Estimate the memory requirements for building a BLAS, including padding.
+        */
+        BlasBuildSize estimateBuildSize(const BlasBuildRecord& record) const;
+
+        /** Estimate the size of the final BLAS, including padding.
+        */
+        uint64_t estimateFinalSize(const BlasBuildRecord& record) const;
+
+    private:
+        struct Rates
+        {
+            double resultBytes;     ///< Uncompacted result bytes per primitive.
+            double scratchBytes;    ///< Scratch bytes per primitive.
+            double compactedBytes;  ///< Compacted result bytes per primitive.
+        };
+
+        const Rates& getRates(const BlasBuildRecord& record) const;
+
+        Rates mTriangleRates;
+        Rates mAABBRates;
+    };
+
+    /** Expected acceleration structure memory of a scene.
+    */
+    struct BlasMemoryReport
+    {
+        uint64_t blasCount = 0;             ///< Number of BLASes.
+        uint64_t estimatedBlasCount = 0;    ///< Number of BLASes without observed sizes, whose sizes were estimated.
+        uint64_t primitiveCount = 0;        ///< Total number of triangles and AABBs.
+        uint64_t groupCount = 0;            ///< Number of BLAS build groups.
+        uint64_t buildByteSize = 0;         ///< Peak memory of the result and scratch buffers during the build.
+        uint64_t finalByteSize = 0;         ///< Memory of the final BLASes.
+    };
+
+    /** Compute the expected BLAS memory of a scene from cached build data, without a device.
+        Observed sizes are used where available, the sizes of the other BLASes are estimated with
+        an estimator calibrated on the observed ones. The BLASes are grouped as in Scene::buildBlas().
+        \param[in] cache BLAS build cache.
+        \param[in] maxGroupByteSize Target memory budget per build group.
+        \return Memory report.
+    */
+    FALCOR_API BlasMemoryReport computeBlasMemoryReport(const BlasBuildCache& cache, uint64_t maxGroupByteSize = kDefaultBlasBuildMemoryBudget);
+}
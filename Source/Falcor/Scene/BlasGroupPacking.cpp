@@ -0,0 +1,222 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasGroupPacking.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::vector<std::vector<uint32_t>> packSequential(const std::vector<BlasBuildSize>& sizes, uint64_t maxGroupByteSize)
+        {
+            std::vector<std::vector<uint32_t>> groups;
+            uint64_t groupSize = 0;
+
+            for (uint32_t blasId = 0; blasId < (uint32_t)sizes.size(); blasId++)
+            {
+                uint64_t blasSize = sizes[blasId].resultByteSize + sizes[blasId].scratchByteSize;
+
+                // Start new BLAS group on first iteration or if group size would exceed the target.
+                if (groupSize == 0 || groupSize + blasSize > maxGroupByteSize)
+                {
+                    groups.push_back({});
+                    groupSize = 0;
+                }
+
+                groups.back().push_back(blasId);
+                groupSize += blasSize;
+            }
+
+            return groups;
+        }
+
+        struct PackedGroup
+        {
+            std::vector<uint32_t> blasIndices;
+            uint64_t resultByteSize = 0;
+            uint64_t scratchByteSize = 0;
+        };
+
+        /** Pack BLASes in the given order into the first group where both the result and scratch data fit the capacities.
+        */
+        std::vector<PackedGroup> packFirstFit(const std::vector<BlasBuildSize>& sizes, const std::vector<uint32_t>& order, uint64_t resultCapacity, uint64_t scratchCapacity)
+        {
+            std::vector<PackedGroup> groups;
+            for (uint32_t blasId : order)
+            {
+                const auto& size = sizes[blasId];
+                auto it = std::find_if(groups.begin(), groups.end(), [&](const PackedGroup& group)
+                {
+                    return group.resultByteSize + size.resultByteSize <= resultCapacity && group.scratchByteSize + size.scratchByteSize <= scratchCapacity;
+                });
+                if (it == groups.end()) it = groups.insert(groups.end(), PackedGroup{});
+
+                it->blasIndices.push_back(blasId);
+                it->resultByteSize += size.resultByteSize;
+                it->scratchByteSize += size.scratchByteSize;
+            }
+            return groups;
+        }
+
+        std::vector<std::vector<uint32_t>> packFirstFitDecreasing(const std::vector<BlasBuildSize>& sizes, uint64_t maxGroupByteSize)
+        {
+            uint64_t totalResult = 0, totalScratch = 0;
+            uint64_t maxResult = 0, maxScratch = 0;
+            for (const auto& size : sizes)
+            {
+                totalResult += size.resultByteSize;
+                totalScratch += size.scratchByteSize;
+                maxResult = std::max(maxResult, size.resultByteSize);
+                maxScratch = std::max(maxScratch, size.scratchByteSize);
+            }
+
+            // Everything fits in a single group.
+            if (totalResult + totalScratch <= maxGroupByteSize)
+            {
+                std::vector<uint32_t> group(sizes.size());
+                std::iota(group.begin(), group.end(), 0);
+                return { std::move(group) };
+            }
+
+            // Sort by decreasing total size. Ties are broken by index to keep the result deterministic.
+            std::vector<uint32_t> sorted(sizes.size());
+            std::iota(sorted.begin(), sorted.end(), 0);
+            std::stable_sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b)
+            {
+                return sizes[a].resultByteSize + sizes[a].scratchByteSize > sizes[b].resultByteSize + sizes[b].scratchByteSize;
+            });
+
+            // Groups fill up in either result or scratch data first, leaving the other unused. To avoid this, the BLASes
+            // with more and less scratch data than average are interleaved so that the running scratch-to-result ratio
+            // stays close to the total ratio, while keeping the order roughly decreasing.
+            std::vector<uint32_t> order;
+            order.reserve(sizes.size());
+            {
+                std::vector<uint32_t> scratchHeavy, resultHeavy;
+                for (uint32_t blasId : sorted)
+                {
+                    bool isScratchHeavy = (double)sizes[blasId].scratchByteSize * totalResult >= (double)sizes[blasId].resultByteSize * totalScratch;
+                    (isScratchHeavy ? scratchHeavy : resultHeavy).push_back(blasId);
+                }
+
+                size_t i = 0, j = 0;
+                double runningResult = 0.0, runningScratch = 0.0;
+                while (i < scratchHeavy.size() || j < resultHeavy.size())
+                {
+                    bool takeScratchHeavy = j == resultHeavy.size() || (i < scratchHeavy.size() && runningScratch * totalResult <= runningResult * totalScratch);
+                    uint32_t blasId = takeScratchHeavy ? scratchHeavy[i++] : resultHeavy[j++];
+                    order.push_back(blasId);
+                    runningResult += sizes[blasId].resultByteSize;
+                    runningScratch += sizes[blasId].scratchByteSize;
+                }
+            }
+
+            // The result and scratch buffers are sized for the largest group in each, so the budget is split into separate
+            // result and scratch capacities, by default in proportion to the total sizes. We try a few splits around that
+            // and keep the one giving the fewest groups and then the lowest peak memory.
+            // The capacities are enlarged if needed so that every BLAS fits on its own.
+            const double proportionalFraction = (double)totalScratch / (double)(totalResult + totalScratch);
+            const double kSplitOffsets[] = { 0.0, -0.025, 0.025, -0.05, 0.05 };
+
+            std::vector<PackedGroup> bestGroups;
+            uint64_t bestPeak = 0;
+            for (double offset : kSplitOffsets)
+            {
+                double scratchFraction = std::clamp(proportionalFraction + offset, 0.0, 1.0);
+                uint64_t scratchCapacity = std::max(maxScratch, (uint64_t)(maxGroupByteSize * scratchFraction));
+                uint64_t resultCapacity = std::max(maxResult, maxGroupByteSize > scratchCapacity ? maxGroupByteSize - scratchCapacity : 0);
+
+                auto groups = packFirstFit(sizes, order, resultCapacity, scratchCapacity);
+                uint64_t maxGroupResult = 0, maxGroupScratch = 0;
+                for (const auto& group : groups)
+                {
+                    maxGroupResult = std::max(maxGroupResult, group.resultByteSize);
+                    maxGroupScratch = std::max(maxGroupScratch, group.scratchByteSize);
+                }
+                uint64_t peak = maxGroupResult + maxGroupScratch;
+
+                if (bestGroups.empty() || groups.size() < bestGroups.size() || (groups.size() == bestGroups.size() && peak < bestPeak))
+                {
+                    bestGroups = std::move(groups);
+                    bestPeak = peak;
+                }
+            }
+
+            // Order the BLASes within each group by index, and the groups by their first BLAS.
+            std::vector<std::vector<uint32_t>> result;
+            result.reserve(bestGroups.size());
+            for (auto& group : bestGroups)
+            {
+                std::sort(group.blasIndices.begin(), group.blasIndices.end());
+                result.push_back(std::move(group.blasIndices));
+            }
+            std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.front() < b.front(); });
+
+            return result;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> computeBlasGroupPacking(const std::vector<BlasBuildSize>& sizes, uint64_t maxGroupByteSize, BlasGroupPacking packing)
+    {
+        if (sizes.empty()) return {};
+
+        switch (packing)
+        {
+        case BlasGroupPacking::Sequential:
+            return packSequential(sizes, maxGroupByteSize);
+        case BlasGroupPacking::FirstFitDecreasing:
+            return packFirstFitDecreasing(sizes, maxGroupByteSize);
+        default:
+            FALCOR_THROW("Unknown BLAS group packing strategy");
+        }
+    }
+
+    BlasGroupPackingStats computeBlasGroupPackingStats(const std::vector<BlasBuildSize>& sizes, const std::vector<std::vector<uint32_t>>& groups)
+    {
+        BlasGroupPackingStats stats;
+        stats.groupCount = groups.size();
+
+        for (const auto& group : groups)
+        {
+            uint64_t resultByteSize = 0;
+            uint64_t scratchByteSize = 0;
+            for (uint32_t blasId : group)
+            {
+                FALCOR_CHECK(blasId < sizes.size(), "BLAS index {} is out of range", blasId);
+                resultByteSize += sizes[blasId].resultByteSize;
+                scratchByteSize += sizes[blasId].scratchByteSize;
+            }
+            stats.maxResultByteSize = std::max(stats.maxResultByteSize, resultByteSize);
+            stats.maxScratchByteSize = std::max(stats.maxScratchByteSize, scratchByteSize);
+        }
+
+        return stats;
+    }
+}
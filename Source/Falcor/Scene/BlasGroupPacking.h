@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Memory requirements for building a BLAS.
+    */
+    struct BlasBuildSize
+    {
+        uint64_t resultByteSize = 0;    ///< Size of the uncompacted result data, including padding.
+        uint64_t scratchByteSize = 0;   ///< Size of the scratch data, including padding.
+    };
+
+    /** Strategy for organizing BLASes into build groups.
+    */
+    enum class BlasGroupPacking
+    {
+        Sequential,         ///< Add BLASes in order, starting a new group when the memory budget is exceeded.
+        FirstFitDecreasing, ///< Add BLASes in order of decreasing size to the first group with enough room left.
+    };
+
+    /** Organize BLASes into groups that are built together.
+
+        The BLASes of a group are built into shared result and scratch buffers, which are sized for the
+        largest group. The peak memory usage is therefore the sum of the largest result size and the
+        largest scratch size over all groups.
+
+        With FirstFitDecreasing, the memory budget is split into separate result and scratch budgets in
+        proportion to the total sizes, so that the peak memory usage stays within the budget. BLASes with
+        more and less scratch data than average are interleaved so that groups fill up evenly in both.
+        The result is deterministic and the BLAS indices within each group are in increasing order.
+
+        \param[in] sizes Memory requirements of each BLAS.
+        \param[in] maxGroupByteSize Target memory budget per group. BLASes exceeding the budget are placed in their own group.
+        \param[in] packing Packing strategy.
+        \return List of groups, each a list of BLAS indices.
+    */
+    FALCOR_API std::vector<std::vector<uint32_t>> computeBlasGroupPacking(const std::vector<BlasBuildSize>& sizes, uint64_t maxGroupByteSize, BlasGroupPacking packing);
+
+    /** Peak memory usage for building BLASes with a given grouping.
+    */
+    struct BlasGroupPackingStats
+    {
+        uint64_t groupCount = 0;            ///< Number of groups.
+        uint64_t maxResultByteSize = 0;     ///< Largest result size over all groups.
+        uint64_t maxScratchByteSize = 0;    ///< Largest scratch size over all groups.
+
+        uint64_t getPeakByteSize() const { return maxResultByteSize + maxScratchByteSize; }
+    };
+
+    /** Compute the peak memory usage for building BLASes with a given grouping.
+        \param[in] sizes Memory requirements of each BLAS.
+        \param[in] groups List of groups, each a list of BLAS indices.
+        \return Statistics.
+    */
+    FALCOR_API BlasGroupPackingStats computeBlasGroupPackingStats(const std::vector<BlasBuildSize>& sizes, const std::vector<std::vector<uint32_t>>& groups);
+}
@@ -32,7 +32,11 @@
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/Matrix.h"
 #include "Utils/Math/Quaternion.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
 #include <cmath>
+#include <execution>
+#include <limits>
 
 namespace Falcor
 {
@@ -181,7 +185,7 @@ namespace Falcor
                 prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 1]);
                 fwd = normalize(strandArrays.controlPoints[j + 1] - strandArrays.controlPoints[j - 1]);
             }
-            else if (j < strandArrays.controlPoints.size() - 2)
+            else if (j < strandArrays.controlPoints.size() - 1)
             {
                 prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 2]);
                 fwd = normalize(strandArrays.controlPoints[j + 1] - strandArrays.controlPoints[j - 1]);
@@ -203,7 +207,7 @@ namespace Falcor
             FALCOR_ASSERT_LT(std::abs(length(t) - 1.f), 1e-3f);
         }
 
-        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, uint32_t j)
+        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t j)
         {
             // Mesh vertices, normals, tangents, and texCrds (if any).
             for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
@@ -212,33 +216,132 @@ namespace Falcor
                 float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
 
                 float curveRadius = 0.5f * optimizedStrandArrays.widths[j];
-                result.vertices.push_back(optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal);
-                result.normals.push_back(vNormal);
-                result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                result.radii.push_back(curveRadius);
+                uint32_t v = meshVertexOffset + j * pointCountPerCrossSection + k;
+                result.vertices[v] = optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal;
+                result.normals[v] = vNormal;
+                result.tangents[v] = float4(fwd.x, fwd.y, fwd.z, 1);
+                result.radii[v] = curveRadius;
 
                 if (curveArrays.UVs)
                 {
-                    result.texCrds.push_back(optimizedStrandArrays.UVs[j]);
+                    result.texCrds[v] = optimizedStrandArrays.UVs[j];
                 }
             }
         }
 
-        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
+        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t faceOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
         {
+            uint32_t f = faceOffset + 2 * j * quadCountLimit;
             for (uint32_t k = 0; k < quadCountLimit; k++)
             {
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k);
+                result.faceVertexCounts[f] = 3;
+                result.faceVertexIndices[3 * f + 0] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                result.faceVertexIndices[3 * f + 1] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                result.faceVertexIndices[3 * f + 2] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                f++;
+
+                result.faceVertexCounts[f] = 3;
+                result.faceVertexIndices[3 * f + 0] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                result.faceVertexIndices[3 * f + 1] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                result.faceVertexIndices[3 * f + 2] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k;
+                f++;
             }
         }
+
+        // Number of strands tessellated sequentially by one task. Scratch buffers are reused within a task.
+        const uint32_t kStrandsPerTask = 64;
+
+        /** Output layout of the kept strands, computed before tessellation so that strands can be processed in parallel.
+        */
+        struct StrandLayout
+        {
+            uint32_t strandCount = 0;               ///< Number of kept strands.
+            uint32_t maxVertexCountPerStrand = 0;   ///< Maximum number of control points of a kept strand.
+            std::vector<uint32_t> inputOffsets;     ///< Offset of the first control point of each kept strand in the input arrays.
+            std::vector<uint32_t> pointOffsets;     ///< Offset of the first tessellated point of each kept strand, with the total point count at the end.
+        };
+
+        /** Compute the number of points a strand is tessellated into.
+            This matches the output of optimizeStrandGeometry(), which removes duplicate control points before subdividing.
+        */
+        uint32_t getTessellatedPointCount(const float3* controlPoints, uint32_t inputOffset, uint32_t vertexCount, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            uint32_t uniqueCount = 1;
+            for (uint32_t j = 0; j + 1 < vertexCount; j++)
+            {
+                if (any(controlPoints[inputOffset + j] != controlPoints[inputOffset + j + 1])) uniqueCount++;
+            }
+            return div_round_up(subdivPerSegment * (uniqueCount - 1), keepOneEveryXVerticesPerStrand) + 1;
+        }
+
+        StrandLayout computeStrandLayout(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            StrandLayout layout;
+            layout.strandCount = div_round_up(strandCount, keepOneEveryXStrands);
+            layout.inputOffsets.resize(layout.strandCount);
+            layout.pointOffsets.resize(layout.strandCount + 1);
+
+            uint32_t inputOffset = 0;
+            for (uint32_t i = 0; i < strandCount; i++)
+            {
+                if (i % keepOneEveryXStrands == 0)
+                {
+                    layout.inputOffsets[i / keepOneEveryXStrands] = inputOffset;
+                    layout.maxVertexCountPerStrand = std::max(layout.maxVertexCountPerStrand, vertexCountsPerStrand[i]);
+                }
+                inputOffset += vertexCountsPerStrand[i];
+            }
+
+            // Count the output points of each strand in parallel, then compute the offsets with a prefix sum.
+            auto range = NumericRange<uint32_t>(0, layout.strandCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t strand)
+            {
+                uint32_t i = strand * keepOneEveryXStrands;
+                layout.pointOffsets[strand] = getTessellatedPointCount(controlPoints, layout.inputOffsets[strand], vertexCountsPerStrand[i], subdivPerSegment, keepOneEveryXVerticesPerStrand);
+            });
+
+            uint64_t pointCount = 0;
+            for (uint32_t strand = 0; strand < layout.strandCount; strand++)
+            {
+                uint32_t count = layout.pointOffsets[strand];
+                layout.pointOffsets[strand] = (uint32_t)pointCount;
+                pointCount += count;
+                if (pointCount > std::numeric_limits<uint32_t>::max()) FALCOR_THROW("Tessellated curve point count exceeds the maximum");
+            }
+            layout.pointOffsets[layout.strandCount] = (uint32_t)pointCount;
+
+            return layout;
+        }
+
+        /** Run a function over all kept strands in parallel, in tasks of consecutive strands.
+            The function is called with the kept strand index and the per-task scratch buffers.
+        */
+        template<typename Func>
+        void forEachStrandParallel(const StrandLayout& layout, Func func)
+        {
+            auto range = NumericRange<uint32_t>(0, div_round_up(layout.strandCount, kStrandsPerTask));
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t task)
+            {
+                StrandArrays strandArrays;
+                strandArrays.controlPoints.reserve(layout.maxVertexCountPerStrand);
+                strandArrays.widths.reserve(layout.maxVertexCountPerStrand);
+                strandArrays.UVs.reserve(layout.maxVertexCountPerStrand);
+
+                StrandArrays optimizedStrandArrays;
+                CubicSplineCache splineCache;
+
+                uint32_t end = std::min(layout.strandCount, (task + 1) * kStrandsPerTask);
+                for (uint32_t strand = task * kStrandsPerTask; strand < end; strand++)
+                {
+                    optimizedStrandArrays.controlPoints.clear();
+                    optimizedStrandArrays.UVs.clear();
+                    optimizedStrandArrays.widths.clear();
+                    optimizedStrandArrays.vertexCount = 0;
+
+                    func(strand, strandArrays, optimizedStrandArrays, splineCache);
+                }
+            });
+        }
     }
 
     CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const float4x4& xform)
@@ -250,45 +353,32 @@ namespace Falcor
         FALCOR_ASSERT(degree == 1);
         result.degree = degree;
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
+        // First pass: compute the output offsets of each strand.
+        StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t pointCount = layout.pointOffsets[layout.strandCount];
 
-        uint32_t pointOffset = 0;
+        // Each strand has one segment less than points.
+        result.indices.resize(pointCount - layout.strandCount);
+        result.points.resize(pointCount);
+        result.radius.resize(pointCount);
+        if (UVs) result.texCrds.resize(pointCount);
 
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
+        // Second pass: tessellate the strands in parallel directly into the output arrays.
         CurveArrays curveArrays(controlPoints, widths, UVs);
 
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        forEachStrandParallel(layout, [&](uint32_t strand, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, CubicSplineCache& splineCache)
         {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
+            const uint32_t pointOffset = layout.pointOffsets[strand];
+            const uint32_t segmentOffset = pointOffset - strand;
+            strandArrays.vertexCount = vertexCountsPerStrand[strand * keepOneEveryXStrands];
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, layout.inputOffsets[strand], subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
 
             const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
             const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
 
             uint32_t tmpCount = 0;
+            uint32_t p = pointOffset;
             for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
             {
                 for (uint32_t k = 0; k < subdivPerSegment; k++)
@@ -296,13 +386,14 @@ namespace Falcor
                     if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                     {
                         float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
+                        result.indices[segmentOffset + (p - pointOffset)] = p;
 
                         // Pre-transform curve points.
                         float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), sanitizeWidth(splineWidths.interpolate(j, t) * 0.5f * widthScale)));
 
-                        result.points.push_back(sph.xyz());
-                        result.radius.push_back(sph.w);
+                        result.points[p] = sph.xyz();
+                        result.radius[p] = sph.w;
+                        p++;
                     }
                     tmpCount++;
                 }
@@ -310,14 +401,17 @@ namespace Falcor
 
             // Always keep the last vertex.
             float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f), sanitizeWidth(splineWidths.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f) * 0.5f * widthScale)));
-            result.points.push_back(sph.xyz());
-            result.radius.push_back(sph.w);
+            result.points[p] = sph.xyz();
+            result.radius[p] = sph.w;
+            p++;
+            FALCOR_ASSERT(p == layout.pointOffsets[strand + 1]);
 
             // Texture coordinates.
             if (UVs)
             {
                 const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), optimizedStrandArrays.vertexCount);
                 tmpCount = 0;
+                p = pointOffset;
                 for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
                 {
                     for (uint32_t k = 0; k < subdivPerSegment; k++)
@@ -325,18 +419,16 @@ namespace Falcor
                         if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                         {
                             float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
+                            result.texCrds[p++] = splineUVs.interpolate(j, t);
                         }
                         tmpCount++;
                     }
                 }
 
                 // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
+                result.texCrds[p++] = splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f);
             }
-
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
-        }
+        });
 
         return result;
     }
@@ -344,47 +436,36 @@ namespace Falcor
     CurveTessellation::MeshResult CurveTessellation::convertToPolytube(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
     {
         MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+
+        // First pass: compute the output offsets of each strand.
+        // Each tessellated point becomes a cross-section of vertices, and each pair of consecutive cross-sections is connected by two triangles per vertex.
+        StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint64_t vertexCount = (uint64_t)pointCountPerCrossSection * layout.pointOffsets[layout.strandCount];
+        const uint64_t faceCount = 2ull * pointCountPerCrossSection * (layout.pointOffsets[layout.strandCount] - layout.strandCount);
+        if (vertexCount > std::numeric_limits<uint32_t>::max() || 3 * faceCount > std::numeric_limits<uint32_t>::max())
         {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
+            FALCOR_THROW("Tessellated curve mesh size exceeds the maximum");
         }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
-
-        uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
-        CurveArrays curveArrays(controlPoints, widths, UVs);
 
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
+        result.vertices.resize(vertexCount);
+        result.normals.resize(vertexCount);
+        result.tangents.resize(vertexCount);
+        result.radii.resize(vertexCount);
+        if (UVs) result.texCrds.resize(vertexCount);
+        result.faceVertexCounts.resize(faceCount);
+        result.faceVertexIndices.resize(faceCount * 3);
 
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
+        // Second pass: tessellate the strands in parallel directly into the output arrays.
+        CurveArrays curveArrays(controlPoints, widths, UVs);
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+        forEachStrandParallel(layout, [&](uint32_t strand, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, CubicSplineCache& splineCache)
+        {
+            const uint32_t meshVertexOffset = pointCountPerCrossSection * layout.pointOffsets[strand];
+            const uint32_t faceOffset = 2 * pointCountPerCrossSection * (layout.pointOffsets[strand] - strand);
+            strandArrays.vertexCount = vertexCountsPerStrand[strand * keepOneEveryXStrands];
 
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, layout.inputOffsets[strand], subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+            FALCOR_ASSERT(optimizedStrandArrays.controlPoints.size() == layout.pointOffsets[strand + 1] - layout.pointOffsets[strand]);
 
             // Build the initial frame.
             float3 fwd, s, t;
@@ -399,21 +480,17 @@ namespace Falcor
                 updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
 
                 // Mesh vertices, normals, tangents, and texCrds (if any).
-                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, j);
+                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, meshVertexOffset, pointCountPerCrossSection, j);
 
                 // Mesh faces.
                 if (j < optimizedStrandArrays.controlPoints.size() - 1)
                 {
                     uint32_t quadCountLimit = pointCountPerCrossSection;
-                    connectFaceVertices(result, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
+                    connectFaceVertices(result, meshVertexOffset, faceOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
                 }
             }
-
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)optimizedStrandArrays.controlPoints.size();
-        }
+        });
 
         return result;
     }
-
-
 }
@@ -0,0 +1,146 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "DirtyInstanceTracker.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    void DirtyInstanceTracker::resize(uint32_t instanceCount)
+    {
+        mIsDirty.assign(instanceCount, 0);
+        mDirtyInstances.clear();
+        mSorted = true;
+
+        mMatrixInstanceOffsets.clear();
+        mMatrixInstances.clear();
+        mReferencedMatrices.clear();
+    }
+
+    void DirtyInstanceTracker::setInstanceMatrices(uint32_t matrixCount, const std::vector<uint32_t>& instanceMatrixIDs)
+    {
+        resize((uint32_t)instanceMatrixIDs.size());
+
+        // Build the matrix to instance mapping with a counting sort.
+        mMatrixInstanceOffsets.assign(matrixCount + 1, 0);
+        for (uint32_t matrixID : instanceMatrixIDs)
+        {
+            FALCOR_CHECK(matrixID < matrixCount, "Matrix ID {} is out of range (matrix count is {})", matrixID, matrixCount);
+            mMatrixInstanceOffsets[matrixID + 1]++;
+        }
+
+        for (uint32_t matrixID = 0; matrixID < matrixCount; matrixID++)
+        {
+            if (mMatrixInstanceOffsets[matrixID + 1] > 0) mReferencedMatrices.push_back(matrixID);
+            mMatrixInstanceOffsets[matrixID + 1] += mMatrixInstanceOffsets[matrixID];
+        }
+
+        mMatrixInstances.resize(instanceMatrixIDs.size());
+        std::vector<uint32_t> writeOffsets(mMatrixInstanceOffsets.begin(), mMatrixInstanceOffsets.end() - 1);
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)instanceMatrixIDs.size(); instanceID++)
+        {
+            mMatrixInstances[writeOffsets[instanceMatrixIDs[instanceID]]++] = instanceID;
+        }
+    }
+
+    bool DirtyInstanceTracker::markDirty(uint32_t instanceID)
+    {
+        FALCOR_ASSERT(instanceID < mIsDirty.size());
+        if (mIsDirty[instanceID]) return false;
+
+        mIsDirty[instanceID] = 1;
+        if (!mDirtyInstances.empty() && mDirtyInstances.back() > instanceID) mSorted = false;
+        mDirtyInstances.push_back(instanceID);
+        return true;
+    }
+
+    void DirtyInstanceTracker::markAllDirty()
+    {
+        std::fill(mIsDirty.begin(), mIsDirty.end(), 1);
+        mDirtyInstances.resize(mIsDirty.size());
+        std::iota(mDirtyInstances.begin(), mDirtyInstances.end(), 0);
+        mSorted = true;
+    }
+
+    void DirtyInstanceTracker::clear()
+    {
+        for (uint32_t instanceID : mDirtyInstances) mIsDirty[instanceID] = 0;
+        mDirtyInstances.clear();
+        mSorted = true;
+    }
+
+    const std::vector<uint32_t>& DirtyInstanceTracker::getDirtyInstances()
+    {
+        if (!mSorted)
+        {
+            // When many instances are dirty, scanning the flags is cheaper than sorting the list.
+            if (mDirtyInstances.size() * 16 > mIsDirty.size())
+            {
+                mDirtyInstances.clear();
+                for (uint32_t instanceID = 0; instanceID < (uint32_t)mIsDirty.size(); instanceID++)
+                {
+                    if (mIsDirty[instanceID]) mDirtyInstances.push_back(instanceID);
+                }
+            }
+            else
+            {
+                std::sort(mDirtyInstances.begin(), mDirtyInstances.end());
+            }
+            mSorted = true;
+        }
+        return mDirtyInstances;
+    }
+
+    std::vector<DirtyInstanceTracker::Range> DirtyInstanceTracker::getDirtyRanges(uint32_t maxGap)
+    {
+        return coalesce(getDirtyInstances(), maxGap);
+    }
+
+    std::vector<DirtyInstanceTracker::Range> DirtyInstanceTracker::coalesce(const std::vector<uint32_t>& sortedIndices, uint32_t maxGap)
+    {
+        std::vector<Range> ranges;
+        for (uint32_t index : sortedIndices)
+        {
+            if (!ranges.empty())
+            {
+                Range& last = ranges.back();
+                uint32_t end = last.offset + last.count;
+                FALCOR_ASSERT(index + 1 >= end, "Indices must be sorted");
+                if (index < end) continue;
+                if (index - end <= maxGap)
+                {
+                    last.count = index + 1 - last.offset;
+                    continue;
+                }
+            }
+            ranges.push_back({ index, 1 });
+        }
+        return ranges;
+    }
+}
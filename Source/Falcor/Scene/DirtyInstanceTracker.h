@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Tracks which instances need to be updated after the transforms they reference have changed.
+
+        Each instance references a transform matrix by ID. The tracker stores the reverse mapping from
+        matrices to instances, so that the instances affected by a set of changed matrices are found
+        without visiting all instances. Dirty instances are kept in a compact list, which can be
+        coalesced into contiguous ranges to minimize the number of buffer uploads.
+    */
+    class FALCOR_API DirtyInstanceTracker
+    {
+    public:
+        /** Contiguous range of instances.
+        */
+        struct Range
+        {
+            uint32_t offset = 0;
+            uint32_t count = 0;
+
+            bool operator==(const Range& other) const { return offset == other.offset && count == other.count; }
+        };
+
+        /** Set the number of tracked instances, without a matrix mapping. All instances are marked clean.
+            \param[in] instanceCount Number of instances.
+        */
+        void resize(uint32_t instanceCount);
+
+        /** Set the matrix referenced by each instance. All instances are marked clean.
+            \param[in] matrixCount Number of matrices.
+            \param[in] instanceMatrixIDs Matrix ID for each instance.
+        */
+        void setInstanceMatrices(uint32_t matrixCount, const std::vector<uint32_t>& instanceMatrixIDs);
+
+        /** Mark all instances that reference a changed matrix as dirty.
+            Only matrices referenced by at least one instance are queried.
+            \param[in] isMatrixChanged Predicate returning true if the matrix with the given ID has changed.
+            \return Number of instances that were newly marked dirty.
+        */
+        template<typename Predicate>
+        uint32_t markChangedMatrices(Predicate isMatrixChanged)
+        {
+            uint32_t count = 0;
+            for (uint32_t matrixID : mReferencedMatrices)
+            {
+                if (!isMatrixChanged(matrixID)) continue;
+                for (uint32_t i = mMatrixInstanceOffsets[matrixID]; i < mMatrixInstanceOffsets[matrixID + 1]; i++)
+                {
+                    if (markDirty(mMatrixInstances[i])) count++;
+                }
+            }
+            return count;
+        }
+
+        /** Mark an instance as dirty.
+            \param[in] instanceID Instance ID.
+            \return True if the instance was not dirty before.
+        */
+        bool markDirty(uint32_t instanceID);
+
+        /** Mark all instances as dirty.
+        */
+        void markAllDirty();
+
+        /** Mark all instances as clean.
+        */
+        void clear();
+
+        bool isDirty(uint32_t instanceID) const { return mIsDirty[instanceID] != 0; }
+        bool empty() const { return mDirtyInstances.empty(); }
+        uint32_t getDirtyCount() const { return (uint32_t)mDirtyInstances.size(); }
+        uint32_t getInstanceCount() const { return (uint32_t)mIsDirty.size(); }
+
+        /** Get the dirty instances.
+            \return List of dirty instance IDs in increasing order.
+        */
+        const std::vector<uint32_t>& getDirtyInstances();
+
+        /** Get the dirty instances coalesced into contiguous ranges.
+            \param[in] maxGap Ranges separated by at most this many clean instances are merged, trading redundant data for fewer ranges.
+            \return List of ranges in increasing order.
+        */
+        std::vector<Range> getDirtyRanges(uint32_t maxGap = 0);
+
+        /** Coalesce a list of indices into contiguous ranges.
+            \param[in] sortedIndices Indices in non-decreasing order. Duplicates are allowed.
+            \param[in] maxGap Ranges separated by at most this many missing indices are merged.
+            \return List of ranges in increasing order.
+        */
+        static std::vector<Range> coalesce(const std::vector<uint32_t>& sortedIndices, uint32_t maxGap = 0);
+
+    private:
+        std::vector<uint8_t> mIsDirty;                  ///< Dirty flag per instance.
+        std::vector<uint32_t> mDirtyInstances;          ///< List of dirty instance IDs.
+        bool mSorted = true;                            ///< True if mDirtyInstances is sorted.
+
+        std::vector<uint32_t> mMatrixInstanceOffsets;   ///< Offset into mMatrixInstances for each matrix, with one extra element at the end.
+        std::vector<uint32_t> mMatrixInstances;         ///< Instance IDs grouped by matrix.
+        std::vector<uint32_t> mReferencedMatrices;      ///< IDs of the matrices referenced by at least one instance.
+    };
+}
@@ -321,7 +321,25 @@ namespace Falcor
 
     void BasicMaterial::optimizeTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, TextureOptimizationStats& stats)
     {
-        FALCOR_ASSERT(getTexture(slot) != nullptr);
+        auto pTexture = getTexture(slot);
+        FALCOR_ASSERT(pTexture != nullptr);
+        optimizeTexture(slot, texInfo, pTexture->getFormat(), stats);
+    }
+
+    bool BasicMaterial::optimizeConstantTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, ResourceFormat format, TextureOptimizationStats& stats)
+    {
+        FALCOR_ASSERT(texInfo.isConstant(TextureChannelFlags::RGBA));
+
+        // Normal and displacement maps can't be replaced. They are created and analyzed again by optimizeTexture().
+        if (slot == TextureSlot::Normal || slot == TextureSlot::Displacement) return false;
+
+        size_t texturesRemoved = stats.texturesRemoved[(size_t)slot];
+        optimizeTexture(slot, texInfo, format, stats);
+        return stats.texturesRemoved[(size_t)slot] > texturesRemoved;
+    }
+
+    void BasicMaterial::optimizeTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, ResourceFormat format, TextureOptimizationStats& stats)
+    {
         TextureChannelFlags channelMask = getTextureSlotInfo(slot).mask;
 
         switch (slot)
@@ -330,8 +348,7 @@ namespace Falcor
         {
             bool previouslyOpaque = isOpaque();
 
-            auto pBaseColor = getBaseColorTexture();
-            bool hasAlpha = isAlphaSupported() && pBaseColor && doesFormatHaveAlpha(pBaseColor->getFormat());
+            bool hasAlpha = isAlphaSupported() && doesFormatHaveAlpha(format);
             bool isColorConstant = texInfo.isConstant(TextureChannelFlags::RGB);
             bool isAlphaConstant = texInfo.isConstant(TextureChannelFlags::Alpha);
 
@@ -611,6 +628,33 @@ namespace Falcor
         return true;
     }
 
+    uint64_t BasicMaterial::hash() const
+    {
+        // This function hashes the same data that is compared in operator==().
+        Hasher hasher;
+        hashBase(hasher);
+
+        hasher.insert(mData.flags);
+        hasher.insert(mData.displacementScale);
+        hasher.insert(mData.displacementOffset);
+        hasher.insert(mData.baseColor);
+        hasher.insert(mData.specular);
+        hasher.insert(mData.emissive);
+        hasher.insert(mData.emissiveFactor);
+        hasher.insert(mData.diffuseTransmission);
+        hasher.insert(mData.specularTransmission);
+        hasher.insert(mData.transmission);
+        hasher.insert(mData.volumeAbsorption);
+        hasher.insert(mData.volumeAnisotropy);
+        hasher.insert(mData.volumeScattering);
+
+        hasher.insert(mpDefaultSampler->getDesc());
+        hasher.insert(mpDisplacementMinSampler->getDesc());
+        hasher.insert(mpDisplacementMaxSampler->getDesc());
+
+        return hasher.get();
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
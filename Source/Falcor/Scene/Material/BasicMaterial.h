@@ -66,6 +66,10 @@ namespace Falcor
         */
         bool isEqual(const ref<Material>& pOther) const override;
 
+        /** Computes a hash of the material that is consistent with isEqual().
+        */
+        uint64_t hash() const override;
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
@@ -90,6 +94,16 @@ namespace Falcor
         */
         void optimizeTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, TextureOptimizationStats& stats) override;
 
+        /** Optimize the material for a texture of constant value before the texture is created.
+            Textures in the base color, specular, emissive and transmission slots are replaced by uniform material parameters.
+            \param[in] slot The texture slot.
+            \param[in] texInfo Information about the texture. All channels are constant.
+            \param[in] format Format of the texture.
+            \param[out] stats Optimization stats passed back to the caller.
+            \return True if the texture was replaced by uniform material parameters, false otherwise.
+        */
+        bool optimizeConstantTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, ResourceFormat format, TextureOptimizationStats& stats) override;
+
         /** Set the default texture sampler for the material.
         */
         void setDefaultTextureSampler(const ref<Sampler>& pSampler) override;
@@ -252,6 +266,7 @@ namespace Falcor
         BasicMaterial(ref<Device> pDevice, const std::string& name, MaterialType type);
 
         bool isAlphaSupported() const;
+        void optimizeTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, ResourceFormat format, TextureOptimizationStats& stats);
         void prepareDisplacementMapForRendering();
         void adjustDoubleSidedFlag();
         void updateAlphaMode();
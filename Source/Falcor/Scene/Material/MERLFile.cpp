@@ -27,11 +27,17 @@
  **************************************************************************/
 #include "MERLFile.h"
 #include "Utils/Logger.h"
-#include "Utils/Image/ImageIO.h"
 #include "Scene/Material/MERLMaterial.h"
 #include "Scene/Material/DiffuseSpecularUtils.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
-#include <fstream>
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/NumericRange.h"
+#include "Utils/SharedCache.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <execution>
 
 namespace Falcor
 {
@@ -48,6 +54,17 @@ namespace Falcor
         const double kBlueScale = 1.66 / 1500.0;
 
         const uint32_t kAlbedoLUTSize = MERLMaterialData::kAlbedoLUTSize;
+
+        // Number of samples converted per parallel task.
+        const size_t kConversionChunkSize = 1 << 14;
+
+        using SharedDataCache = SharedCache<MERLFile::SharedData, MeasuredBRDFCache::Key>;
+
+        SharedDataCache& getSharedDataCache()
+        {
+            static SharedDataCache cache;
+            return cache;
+        }
     }
 
     MERLFile::MERLFile(const std::filesystem::path& path)
@@ -56,22 +73,23 @@ namespace Falcor
             FALCOR_THROW("Failed to load MERL BRDF from '{}'", path);
     }
 
-    bool MERLFile::loadBRDF(const std::filesystem::path& path)
+    bool MERLFile::loadBRDF(const std::filesystem::path& path, bool loadData)
     {
         mDesc = {};
-        mData.clear();
-        mAlbedoLUT.clear();
+        mKey = {};
+        mpData.reset();
 
-        std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
-        if (!ifs.good())
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
         {
             logWarning("MERLFile: Failed to open file '{}'.", path);
             return false;
         }
 
-        // Load header.
+        // Validate header.
         int dims[3] = {};
-        ifs.read(reinterpret_cast<char*>(dims), sizeof(int) * 3);
+        if (file.getSize() >= sizeof(dims))
+            std::memcpy(dims, file.getData(), sizeof(dims));
 
         size_t n = (size_t)dims[0] * dims[1] * dims[2];
         if (n != kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2)
@@ -80,10 +98,7 @@ namespace Falcor
             return false;
         }
 
-        // Load BRDF data.
-        std::vector<double> data(3 * n);
-        ifs.read(reinterpret_cast<char*>(data.data()), sizeof(double) * 3 * n);
-        if (!ifs.good())
+        if (file.getSize() < sizeof(dims) + sizeof(double) * 3 * n)
         {
             logWarning("MERLFile: Failed to load BRDF data from file '{}'.", path);
             return false;
@@ -92,7 +107,10 @@ namespace Falcor
         mDesc.path = path;
         mDesc.name = path.stem().string();
 
-        prepareData(dims, data);
+        // The key is memoized, so the file content is only read if the key or the data isn't cached yet.
+        mKey = MeasuredBRDFCache::getKey(path, file.getData(), file.getSize());
+        if (loadData)
+            acquireData(static_cast<const uint8_t*>(file.getData()) + sizeof(dims), n);
 
         // Load JSON sidecar file if it exists.
         const auto jsonPath = std::filesystem::path(path).replace_extension("json");
@@ -103,87 +121,131 @@ namespace Falcor
         return true;
     }
 
-    void MERLFile::prepareData(const int dims[3], const std::vector<double>& data)
+    void MERLFile::loadData()
+    {
+        FALCOR_CHECK(!mDesc.path.empty(), "No BRDF loaded");
+        if (mpData)
+            return;
+
+        MemoryMappedFile file(mDesc.path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        const size_t n = kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2;
+        const size_t headerSize = 3 * sizeof(int);
+        if (!file.isOpen() || file.getSize() < headerSize + sizeof(double) * 3 * n)
+            FALCOR_THROW("Failed to load MERL BRDF data from '{}'", mDesc.path);
+
+        acquireData(static_cast<const uint8_t*>(file.getData()) + headerSize, n);
+    }
+
+    void MERLFile::acquireData(const void* pData, size_t sampleCount)
+    {
+        // Look up the BRDF data in the shared cache. The samples are only converted on a cache miss.
+        mpData = getSharedDataCache().acquire(mKey, [&]()
+        {
+            auto pSharedData = std::make_shared<SharedData>();
+            pSharedData->key = mKey;
+            prepareData(pData, sampleCount, pSharedData->samples);
+            return pSharedData;
+        });
+    }
+
+    const std::vector<float3>& MERLFile::getData() const
+    {
+        static const std::vector<float3> kEmpty;
+        return mpData ? mpData->samples : kEmpty;
+    }
+
+    void MERLFile::prepareData(const void* pData, size_t sampleCount, std::vector<float3>& samples) const
     {
         // Convert BRDF samples to fp32 precision and interleave RGB channels.
-        const size_t n = (size_t)dims[0] * dims[1] * dims[2];
+        // The samples are stored as three planes of doubles, which are not necessarily aligned in the mapped file.
+        const size_t n = sampleCount;
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        auto load = [pBytes](size_t index)
+        {
+            double value;
+            std::memcpy(&value, pBytes + index * sizeof(double), sizeof(double));
+            return value;
+        };
 
-        FALCOR_ASSERT(data.size() == 3 * n);
-        mData.resize(n);
+        samples.resize(n);
 
-        size_t negCount = 0;
-        size_t infCount = 0;
-        size_t nanCount = 0;
+        std::atomic<size_t> negCount = 0;
+        std::atomic<size_t> infCount = 0;
+        std::atomic<size_t> nanCount = 0;
 
-        for (size_t i = 0; i < n; i++)
+        auto range = NumericRange<size_t>(0, div_round_up(n, kConversionChunkSize));
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
         {
-            float3& v = mData[i];
+            size_t chunkNegCount = 0;
+            size_t chunkInfCount = 0;
+            size_t chunkNaNCount = 0;
 
-            // Extract RGB and apply scaling.
-            v.x = static_cast<float>(data[i] * kRedScale);
-            v.y = static_cast<float>(data[i + n] * kGreenScale);
-            v.z = static_cast<float>(data[i + 2 * n] * kBlueScale);
+            const size_t end = std::min(n, (chunk + 1) * kConversionChunkSize);
+            for (size_t i = chunk * kConversionChunkSize; i < end; i++)
+            {
+                float3& v = samples[i];
 
-            // Validate data point and set to zero if invalid.
-            bool isNeg = v.x < 0.f || v.y < 0.f || v.z < 0.f;
-            bool isInf = std::isinf(v.x) || std::isinf(v.y) || std::isinf(v.z);
-            bool isNaN = std::isnan(v.x) || std::isnan(v.y) || std::isnan(v.z);
+                // Extract RGB and apply scaling.
+                v.x = static_cast<float>(load(i) * kRedScale);
+                v.y = static_cast<float>(load(i + n) * kGreenScale);
+                v.z = static_cast<float>(load(i + 2 * n) * kBlueScale);
 
-            if (isNeg) negCount++;
-            if (isInf) infCount++;
-            if (isNaN) nanCount++;
+                // Validate data point and set to zero if invalid.
+                bool isNeg = v.x < 0.f || v.y < 0.f || v.z < 0.f;
+                bool isInf = std::isinf(v.x) || std::isinf(v.y) || std::isinf(v.z);
+                bool isNaN = std::isnan(v.x) || std::isnan(v.y) || std::isnan(v.z);
 
-            if (isInf || isNaN) v = float3(0.f);
-            else if (isNeg) v = max(v, float3(0.f));
-        }
+                if (isNeg) chunkNegCount++;
+                if (isInf) chunkInfCount++;
+                if (isNaN) chunkNaNCount++;
+
+                if (isInf || isNaN) v = float3(0.f);
+                else if (isNeg) v = max(v, float3(0.f));
+            }
 
-        if (negCount > 0) logWarning("MERL BRDF {} has {} samples with negative values. Clamped to zero.", mDesc.name, negCount);
-        if (infCount > 0) logWarning("MERL BRDF {} has {} samples with inf values. Sample set to zero.", mDesc.name, infCount);
-        if (nanCount > 0) logWarning("MERL BRDF {} has {} samples with NaN values. Sample set to zero.", mDesc.name, nanCount);
+            negCount += chunkNegCount;
+            infCount += chunkInfCount;
+            nanCount += chunkNaNCount;
+        });
+
+        if (negCount > 0) logWarning("MERL BRDF {} has {} samples with negative values. Clamped to zero.", mDesc.name, negCount.load());
+        if (infCount > 0) logWarning("MERL BRDF {} has {} samples with inf values. Sample set to zero.", mDesc.name, infCount.load());
+        if (nanCount > 0) logWarning("MERL BRDF {} has {} samples with NaN values. Sample set to zero.", mDesc.name, nanCount.load());
     }
 
     const std::vector<float4>& MERLFile::prepareAlbedoLUT(ref<Device> pDevice)
     {
-        if (!mAlbedoLUT.empty())
-            return mAlbedoLUT;
+        FALCOR_CHECK(mpData, "No BRDF loaded");
 
-        FALCOR_CHECK(!mDesc.path.empty(), "No BRDF loaded");
-        const auto texPath = mDesc.path.replace_extension("dds");
+        // The table is shared with all instances loaded from identical files. Only the first one prepares it.
+        std::lock_guard<std::mutex> lock(mpData->albedoLUTMutex);
+        if (!mpData->albedoLUT.empty())
+            return mpData->albedoLUT;
 
-        // Try loading cached albedo lookup table.
-        if (std::filesystem::is_regular_file(texPath))
+        // Try loading cached albedo lookup table, either from the shared cache directory or next to the BRDF file.
+        const auto cachePath = MeasuredBRDFCache::getAlbedoLUTPath(mpData->key);
+        const auto sidecarPath = std::filesystem::path(mDesc.path).replace_extension("dds");
+        for (const auto& texPath : {cachePath, sidecarPath})
         {
-            const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
-
-            if (albedoLut->getFormat() == kAlbedoLUTFormat &&
-                albedoLut->getWidth() == kAlbedoLUTSize && albedoLut->getHeight() == 1)
+            if (MeasuredBRDFCache::loadAlbedoLUT(texPath, kAlbedoLUTSize, mpData->albedoLUT))
             {
-                const float4* data = reinterpret_cast<const float4*>(albedoLut->getData());
-                mAlbedoLUT.resize(kAlbedoLUTSize);
-                std::copy(data, data + kAlbedoLUTSize, mAlbedoLUT.begin());
-
-                logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                return mAlbedoLUT;
+                logInfo("Loaded albedo LUT from '{}'.", texPath);
+                return mpData->albedoLUT;
             }
         }
 
         // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pDevice, kAlbedoLUTSize);
-        FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
+        auto albedoLUT = computeAlbedoLUT(pDevice, kAlbedoLUTSize);
+        FALCOR_ASSERT(albedoLUT.size() == kAlbedoLUTSize);
 
         // Cache lookup table as texture on disk.
-        {
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
-            const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
-
-            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
-            logInfo("Saved albedo LUT to '{}'.", texPath);
-        }
+        MeasuredBRDFCache::saveAlbedoLUT(cachePath, albedoLUT);
 
-        return mAlbedoLUT;
+        mpData->albedoLUT = std::move(albedoLUT);
+        return mpData->albedoLUT;
     }
 
-    void MERLFile::computeAlbedoLUT(ref<Device> pDevice, const size_t binCount)
+    std::vector<float4> MERLFile::computeAlbedoLUT(ref<Device> pDevice, const size_t binCount) const
     {
         logInfo("MERLFile: Computing albedo LUT for MERL BRDF '{}'...", mDesc.name);
 
@@ -208,8 +270,9 @@ namespace Falcor
         auto albedos = integrator.integrateIsotropic(pDevice->getRenderContext(), materialID, cosThetas);
 
         // Copy result into RGBA format needed for texture creation.
-        mAlbedoLUT.resize(binCount);
+        std::vector<float4> albedoLUT(binCount);
         for (uint32_t i = 0; i < binCount; i++)
-            mAlbedoLUT[i] = float4(albedos[i], 1.f);
+            albedoLUT[i] = float4(albedos[i], 1.f);
+        return albedoLUT;
     }
 }
@@ -30,8 +30,11 @@
 #include "Core/API/Formats.h"
 #include "Utils/Math/Vector.h"
 #include "Scene/Material/DiffuseSpecularData.slang"
+#include "Scene/Material/MeasuredBRDFCache.h"
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace Falcor
 {
@@ -39,6 +42,13 @@ namespace Falcor
 
     /** Class for loading a measured material from the MERL BRDF database.
         Additional metadata is loaded along with the BRDF if available.
+
+        BRDF files are memory-mapped and converted to fp32 in parallel. The converted data
+        and albedo lookup table are shared process-wide between all instances loaded from
+        files with identical content, as long as any instance is alive. Materials only keep
+        the GPU copies, so the CPU data is released once the last instance is destroyed.
+        The GPU copies are shared by all materials on a device using identical files, and the
+        data is not loaded again while one of them is alive (see loadBRDF() and loadData()).
     */
     class FALCOR_API MERLFile
     {
@@ -50,6 +60,16 @@ namespace Falcor
             DiffuseSpecularData extraData = {}; ///< Parameters for a best fit BRDF approximation.
         };
 
+        /** BRDF data shared between all instances loaded from files with identical content.
+        */
+        struct SharedData
+        {
+            MeasuredBRDFCache::Key key;     ///< Content key of the BRDF file.
+            std::vector<float3> samples;    ///< BRDF data in RGB float format.
+            std::vector<float4> albedoLUT;  ///< Precomputed albedo lookup table. Empty until prepared.
+            std::mutex albedoLUTMutex;      ///< Serializes preparing the albedo lookup table.
+        };
+
         static constexpr ResourceFormat kAlbedoLUTFormat = ResourceFormat::RGBA32Float;
 
         MERLFile() = default;
@@ -61,9 +81,14 @@ namespace Falcor
 
         /** Loads a MERL BRDF.
             \param[in] path Path to the binary MERL file.
+            \param[in] loadData If false, only the description and content key are loaded. Use loadData() to load the BRDF data later.
             \return True if the BRDF was successfully loaded.
         */
-        bool loadBRDF(const std::filesystem::path& path);
+        bool loadBRDF(const std::filesystem::path& path, bool loadData = true);
+
+        /** Load the BRDF data if it was deferred in loadBRDF(). Throws on error.
+        */
+        void loadData();
 
         /** Prepare an albedo lookup table.
             The table is loaded from disk or recomputed if needed.
@@ -73,14 +98,25 @@ namespace Falcor
         const std::vector<float4>& prepareAlbedoLUT(ref<Device> pDevice);
 
         const Desc& getDesc() const { return mDesc; }
-        const std::vector<float3>& getData() const { return mData; }
+
+        /** Get the content key of the loaded file. Files with identical content have the same key.
+        */
+        const MeasuredBRDFCache::Key& getKey() const { return mKey; }
+
+        const std::vector<float3>& getData() const;
+
+        /** Get the data shared with other instances loaded from identical files.
+            Holding on to it keeps the data in the process-wide cache.
+        */
+        std::shared_ptr<const SharedData> getSharedData() const { return mpData; }
 
     private:
-        void prepareData(const int dims[3], const std::vector<double>& data);
-        void computeAlbedoLUT(ref<Device> pDevice, const size_t binCount);
+        void acquireData(const void* pData, size_t sampleCount);
+        void prepareData(const void* pData, size_t sampleCount, std::vector<float3>& samples) const;
+        std::vector<float4> computeAlbedoLUT(ref<Device> pDevice, const size_t binCount) const;
 
-        Desc mDesc;                     ///< BRDF description and sampling parameters.
-        std::vector<float3> mData;      ///< BRDF data in RGB float format.
-        std::vector<float4> mAlbedoLUT; ///< Precomputed albedo lookup table.
+        Desc mDesc;                         ///< BRDF description and sampling parameters.
+        MeasuredBRDFCache::Key mKey = {};   ///< Content key of the loaded file.
+        std::shared_ptr<SharedData> mpData; ///< BRDF data and albedo lookup table.
     };
 }
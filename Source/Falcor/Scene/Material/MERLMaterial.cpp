@@ -33,14 +33,32 @@
 #include "Scene/Material/MERLFile.h"
 #include "Scene/Material/MaterialSystem.h"
 #include "Scene/Material/DiffuseSpecularUtils.h"
+#include "Utils/SharedCache.h"
+#include <mutex>
 
 namespace Falcor
 {
+    struct MERLMaterial::SharedGPUData
+    {
+        ref<Buffer> pBRDFData;      ///< GPU buffer holding all BRDF data as float3 array.
+        ref<Texture> pAlbedoLUT;    ///< Precomputed albedo lookup table. Created on first use.
+        std::mutex albedoLUTMutex;  ///< Serializes creating the albedo lookup table.
+    };
+
     namespace
     {
         static_assert((sizeof(MaterialHeader) + sizeof(MERLMaterialData)) <= sizeof(MaterialDataBlob), "MERLMaterialData is too large");
 
         const char kShaderFile[] = "Rendering/Materials/MERLMaterial.slang";
+
+        // The cache only holds weak references, the GPU data is released with the last material using it.
+        using SharedGPUDataCache = SharedCache<MERLMaterial::SharedGPUData, std::pair<Device*, MeasuredBRDFCache::Key>>;
+
+        SharedGPUDataCache& getSharedGPUDataCache()
+        {
+            static SharedGPUDataCache cache;
+            return cache;
+        }
     }
 
     MERLMaterial::MERLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
@@ -48,32 +66,50 @@ namespace Falcor
     {
         FALCOR_CHECK(!path.empty(), "Missing path.");
 
-        MERLFile merlFile(path);
+        // The BRDF data is only loaded if no other material on the device uses an identical file.
+        MERLFile merlFile;
+        if (!merlFile.loadBRDF(path, false))
+            FALCOR_THROW("Failed to load MERL BRDF from '{}'", path);
         init(merlFile);
 
-        // Create albedo LUT texture.
-        auto lut = merlFile.prepareAlbedoLUT(mpDevice);
-        FALCOR_CHECK(!lut.empty() && sizeof(lut[0]) == sizeof(float4), "Expected albedo LUT in float4 format.");
-        static_assert(MERLFile::kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
-        mpAlbedoLUT = mpDevice->createTexture2D((uint32_t)lut.size(), 1, MERLFile::kAlbedoLUTFormat, 1, 1, lut.data(), ResourceBindFlags::ShaderResource);
+        // Create albedo LUT texture. Computing the table creates a material from the same file, so the cache must not be locked here.
+        std::lock_guard<std::mutex> lock(mpSharedGPUData->albedoLUTMutex);
+        if (!mpSharedGPUData->pAlbedoLUT)
+        {
+            merlFile.loadData();
+            auto lut = merlFile.prepareAlbedoLUT(mpDevice);
+            FALCOR_CHECK(!lut.empty() && sizeof(lut[0]) == sizeof(float4), "Expected albedo LUT in float4 format.");
+            static_assert(MERLFile::kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
+            mpSharedGPUData->pAlbedoLUT =
+                mpDevice->createTexture2D((uint32_t)lut.size(), 1, MERLFile::kAlbedoLUTFormat, 1, 1, lut.data(), ResourceBindFlags::ShaderResource);
+        }
+        mpAlbedoLUT = mpSharedGPUData->pAlbedoLUT;
     }
 
     MERLMaterial::MERLMaterial(ref<Device> pDevice, const MERLFile& merlFile)
         : Material(pDevice, "", MaterialType::MERL)
     {
-        init(merlFile);
+        MERLFile file = merlFile;
+        init(file);
     }
 
-    void MERLMaterial::init(const MERLFile& merlFile)
+    void MERLMaterial::init(MERLFile& merlFile)
     {
         mPath = merlFile.getDesc().path;
         mBRDFName = merlFile.getDesc().name;
         mData.extraData = merlFile.getDesc().extraData;
 
-        // Create GPU buffer.
-        const auto& brdf = merlFile.getData();
-        FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
-        mpBRDFData = mpDevice->createBuffer(brdf.size() * sizeof(brdf[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf.data());
+        // Get the GPU buffer, or create it if no other material on the device uses an identical file.
+        mpSharedGPUData = getSharedGPUDataCache().acquire({mpDevice.get(), merlFile.getKey()}, [&]()
+        {
+            merlFile.loadData();
+            const auto& brdf = merlFile.getData();
+            FALCOR_CHECK(!brdf.empty() && sizeof(brdf[0]) == sizeof(float3), "Expected BRDF data in float3 format.");
+            auto pSharedGPUData = std::make_shared<SharedGPUData>();
+            pSharedGPUData->pBRDFData = mpDevice->createBuffer(brdf.size() * sizeof(brdf[0]), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, brdf.data());
+            return pSharedGPUData;
+        });
+        mpBRDFData = mpSharedGPUData->pBRDFData;
 
         // Create sampler for albedo LUT.
         Sampler::Desc desc;
@@ -141,6 +177,14 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMaterial::hash() const
+    {
+        Hasher hasher;
+        hashBase(hasher);
+        hasher.insert(mPath);
+        return hasher.get();
+    }
+
     ProgramDesc::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -28,6 +28,7 @@
 #pragma once
 #include "Material.h"
 #include "MERLMaterialData.slang"
+#include <memory>
 
 namespace Falcor
 {
@@ -52,19 +53,29 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        uint64_t hash() const override;
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
 
         size_t getMaxBufferCount() const override { return 1; }
 
+        /** Get the GPU buffer holding the BRDF data. It is shared with other materials using identical BRDF files.
+        */
+        const ref<Buffer>& getBRDFData() const { return mpBRDFData; }
+
+        /** GPU data shared by all materials on a device that use identical BRDF files. Defined in MERLMaterial.cpp.
+        */
+        struct SharedGPUData;
+
     protected:
-        void init(const MERLFile& merlFile);
+        void init(MERLFile& merlFile);
 
         std::filesystem::path mPath;        ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
 
         MERLMaterialData mData;             ///< Material parameters.
+        std::shared_ptr<SharedGPUData> mpSharedGPUData; ///< GPU data shared with other materials using identical BRDF files.
         ref<Buffer> mpBRDFData;             ///< GPU buffer holding all BRDF data as float3 array.
         ref<Texture> mpAlbedoLUT;           ///< Precomputed albedo lookup table.
         ref<Sampler> mpLUTSampler;          ///< Sampler for accessing the LUT texture.
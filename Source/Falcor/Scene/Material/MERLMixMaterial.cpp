@@ -235,6 +235,22 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMixMaterial::hash() const
+    {
+        Hasher hasher;
+        hashBase(hasher);
+
+        hasher.insert(mBRDFs.size());
+        for (const auto& brdf : mBRDFs)
+        {
+            hasher.insert(brdf.name);
+            hasher.insert(brdf.path);
+        }
+        hasher.insert(mpDefaultSampler->getDesc());
+
+        return hasher.get();
+    }
+
     ProgramDesc::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
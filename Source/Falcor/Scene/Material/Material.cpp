@@ -328,6 +328,52 @@ namespace Falcor
         return true;
     }
 
+    void Material::hashBase(Hasher& hasher) const
+    {
+        // This function hashes the same data that is compared in isBaseEqual().
+
+        hasher.insert(mHeader.packedData);
+        hasher.insert(mTextureTransform);
+
+        FALCOR_ASSERT(mTextureSlotInfo.size() == mTextureSlotData.size());
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            hasher.insert(hasTextureSlot(slot));
+            if (hasTextureSlot(slot))
+            {
+                hasher.insert(mTextureSlotInfo[i].name);
+                hasher.insert(mTextureSlotInfo[i].mask);
+                hasher.insert(mTextureSlotInfo[i].srgb);
+                hasher.insert(mTextureSlotData[i].pTexture.get());
+            }
+        }
+    }
+
+    void Material::Hasher::insert(const Transform& transform)
+    {
+        insert(transform.getTranslation());
+        insert(transform.getScaling());
+        insert(transform.getRotation());
+    }
+
+    void Material::Hasher::insert(const Sampler::Desc& desc)
+    {
+        insert(desc.magFilter);
+        insert(desc.minFilter);
+        insert(desc.mipFilter);
+        insert(desc.maxAnisotropy);
+        insert(desc.maxLod);
+        insert(desc.minLod);
+        insert(desc.lodBias);
+        insert(desc.comparisonFunc);
+        insert(desc.reductionMode);
+        insert(desc.addressModeU);
+        insert(desc.addressModeV);
+        insert(desc.addressModeW);
+        insert(desc.borderColor);
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
@@ -38,6 +38,7 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
 #include "MaterialTypeRegistry.h"
@@ -163,6 +164,12 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Computes a hash of the material.
+            The hash is consistent with isEqual(), i.e., materials that compare equal have the same hash.
+            \return Hash of all material properties *except* the name.
+        */
+        virtual uint64_t hash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -265,6 +272,16 @@ namespace Falcor
         */
         virtual void optimizeTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, TextureOptimizationStats& stats) {}
 
+        /** Optimize the material for a texture of constant value before the texture is created.
+            This is called for textures whose creation was deferred on load (see TextureManager::loadTexture()).
+            \param[in] slot The texture slot.
+            \param[in] texInfo Information about the texture. All channels are constant.
+            \param[in] format Format of the texture.
+            \param[out] stats Optimization stats passed back to the caller.
+            \return True if the texture was replaced by uniform material parameters, false if it should be created and bound to the slot.
+        */
+        virtual bool optimizeConstantTexture(const TextureSlot slot, const TextureAnalyzer::Result& texInfo, ResourceFormat format, TextureOptimizationStats& stats) { return false; }
+
         /** Return the maximum dimensions of the bound textures.
         */
         virtual uint2 getMaxTextureDimensions() const;
@@ -350,6 +367,31 @@ namespace Falcor
         virtual void setRoughnessMollification( float factor ) {};
 
     protected:
+        /** Helper for hashing material properties in the same way they are compared in isEqual().
+            Floating-point zeros are hashed as +0 since -0 compares equal to +0.
+        */
+        class Hasher
+        {
+        public:
+            template<typename T>
+            std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>> insert(T value) { mHash.insert(value); }
+            void insert(float value) { mHash.insert(value == 0.f ? 0.f : value); }
+            void insert(float16_t value) { insert(float(value)); }
+            template<typename T, int N>
+            void insert(const math::vector<T, N>& v) { for (int i = 0; i < N; i++) insert(v[i]); }
+            void insert(const quatf& q) { insert(float4(q.x, q.y, q.z, q.w)); }
+            void insert(const std::string& str) { insert(str.size()); mHash.insert(str.data(), str.size()); }
+            void insert(const std::filesystem::path& path) { for (const auto& element : path) insert(element.string()); }
+            void insert(const void* ptr) { mHash.insert(ptr); }
+            void insert(const Transform& transform);
+            void insert(const Sampler::Desc& desc);
+
+            uint64_t get() const { return mHash.get(); }
+
+        private:
+            FNVHash64 mHash;
+        };
+
         Material(ref<Device> pDevice, const std::string& name, MaterialType type);
 
         using UpdateCallback = std::function<void(Material::UpdateFlags)>;
@@ -360,6 +402,7 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
+        void hashBase(Hasher& hasher) const;
 
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
@@ -29,10 +29,14 @@
 #include "StandardMaterial.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/StringUtils.h"
 #include "MaterialTypeRegistry.h"
 #include "Scene/Lights/LightProfile.h"
+#include <algorithm>
+#include <execution>
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -350,20 +354,33 @@ namespace Falcor
         std::vector<ref<Material>> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Hash all materials in parallel. Equal materials have equal hashes,
+        // so each material only needs to be compared against the unique materials in its bucket.
+        std::vector<uint64_t> hashes(mMaterials.size());
+        NumericRange<size_t> range(0, mMaterials.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { hashes[i] = mMaterials[i]->hash(); });
+
         // Find unique set of materials.
+        // The buckets list unique materials in the order they were added, so the first equal
+        // material found is the same as with a linear search over all unique materials.
+        std::unordered_map<uint64_t, std::vector<MaterialID>> buckets;
+        buckets.reserve(mMaterials.size());
+
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = buckets[hashes[id.get()]];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](MaterialID uniqueID) { return uniqueMaterials[uniqueID.get()]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back(idMap[id.get()]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[it->get()]->getName());
+                idMap[id.get()] = *it;
             }
         }
 
@@ -401,26 +418,54 @@ namespace Falcor
 
         if (textures.empty()) return;
 
-        // Analyze the textures.
-        logInfo("Analyzing {} material textures.", textures.size());
+        // Use the results of the CPU analysis done while loading the textures where available.
+        // The remaining textures are analyzed on the GPU.
+        std::vector<TextureAnalyzer::Result> results(textures.size());
+        std::vector<size_t> gpuIndices;
+        std::vector<ref<Texture>> gpuTextures;
+
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (auto analysis = mpTextureManager->getTextureAnalysis(textures[i].get()))
+            {
+                results[i] = *analysis;
+            }
+            else
+            {
+                gpuIndices.push_back(i);
+                gpuTextures.push_back(textures[i]);
+            }
+        }
+
+        logInfo("Analyzing {} material textures ({} analyzed on load).", textures.size(), textures.size() - gpuTextures.size());
 
-        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        if (!gpuTextures.empty())
+        {
+            RenderContext* pRenderContext = mpDevice->getRenderContext();
 
-        TextureAnalyzer analyzer(mpDevice);
-        auto pResults = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        analyzer.analyze(pRenderContext, textures, pResults);
+            TextureAnalyzer analyzer(mpDevice);
+            auto pResults = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            analyzer.analyze(pRenderContext, gpuTextures, pResults);
 
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
-        pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
-        pRenderContext->submit(false);
-        pRenderContext->signal(mpFence.get());
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
+            pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
+            pRenderContext->submit(false);
+            pRenderContext->signal(mpFence.get());
 
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->wait();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
+            // Wait for results to become available.
+            mpFence->wait();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
+            for (size_t i = 0; i < gpuIndices.size(); i++)
+            {
+                results[gpuIndices[i]] = gpuResults[i];
+            }
+            pResultsStaging->unmap();
+        }
+
+        // Optimize the materials.
         Material::TextureOptimizationStats stats = {};
 
         for (size_t i = 0; i < textures.size(); i++)
@@ -428,8 +473,6 @@ namespace Falcor
             materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
         }
 
-        pResultsStaging->unmap();
-
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
         {
@@ -0,0 +1,166 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MaterialTextureBaker.h"
+#include "Core/Platform/OS.h"
+#include "Scene/Scene.h"
+#include "Utils/Image/BakedTexture.h"
+#include "Utils/StringFormatters.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <map>
+
+namespace Falcor
+{
+    ImageIO::CompressionMode MaterialTextureBaker::selectCompressionMode(Material::TextureSlot slot, ResourceFormat format)
+    {
+        // Displacement maps are sampled as heights and lose too much precision with block compression, whatever their format.
+        // Index maps store integer material indices that must not be filtered or approximated.
+        if (slot == Material::TextureSlot::Displacement || slot == Material::TextureSlot::Index) return ImageIO::CompressionMode::None;
+
+        const uint32_t channelCount = getFormatChannelCount(format);
+        if (getFormatType(format) == FormatType::Float) return ImageIO::CompressionMode::BC6;
+        if (channelCount == 1) return ImageIO::CompressionMode::BC4;
+        if (channelCount == 2) return ImageIO::CompressionMode::BC5;
+
+        switch (slot)
+        {
+        case Material::TextureSlot::Normal:
+            return ImageIO::CompressionMode::BC5;
+        case Material::TextureSlot::BaseColor:
+        case Material::TextureSlot::Specular:
+        case Material::TextureSlot::Emissive:
+        case Material::TextureSlot::Transmission:
+            return ImageIO::CompressionMode::BC7;
+        default:
+            return ImageIO::CompressionMode::None;
+        }
+    }
+
+    std::vector<MaterialTextureBaker::Job> MaterialTextureBaker::collectJobs(const Scene& scene)
+    {
+        std::map<std::filesystem::path, Job> jobs;
+
+        for (const auto& pMaterial : scene.getMaterials())
+        {
+            for (uint32_t i = 0; i < (uint32_t)Material::TextureSlot::Count; ++i)
+            {
+                const auto slot = (Material::TextureSlot)i;
+                if (slot == Material::TextureSlot::Index || !pMaterial->hasTextureSlot(slot)) continue;
+
+                ref<Texture> pTexture = pMaterial->getTexture(slot);
+                if (!pTexture || pTexture->getSourcePath().empty()) continue;
+
+                const std::filesystem::path& sourcePath = pTexture->getSourcePath();
+                if (jobs.count(sourcePath) != 0) continue;
+
+                Job job;
+                job.sourcePath = sourcePath;
+                job.bakedPath = BakedTexture::getBakedPath(sourcePath);
+                job.slot = slot;
+                job.srgb = pMaterial->getTextureSlotInfo(slot).srgb;
+                jobs.emplace(sourcePath, std::move(job));
+            }
+        }
+
+        std::vector<Job> result;
+        result.reserve(jobs.size());
+        for (auto& [path, job] : jobs) result.push_back(std::move(job));
+        return result;
+    }
+
+    void MaterialTextureBaker::runJob(Job& job, bool force, bool dryRun)
+    {
+        try
+        {
+            if (hasExtension(job.sourcePath, "dds"))
+            {
+                job.status = Status::Skipped;
+                job.message = "Source is already a DDS file.";
+                return;
+            }
+
+            if (!force && BakedTexture::find(job.sourcePath))
+            {
+                job.status = Status::UpToDate;
+                return;
+            }
+
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(job.sourcePath, true);
+            if (!pBitmap)
+            {
+                job.status = Status::Failed;
+                job.message = "Failed to load source texture.";
+                return;
+            }
+
+            job.width = pBitmap->getWidth();
+            job.height = pBitmap->getHeight();
+            job.mode = selectCompressionMode(job.slot, pBitmap->getFormat());
+
+            if (!BakedTexture::canBake(*pBitmap, job.mode))
+            {
+                job.status = Status::Skipped;
+                job.message = fmt::format("Cannot compress {}x{} texture with {} without resizing.", job.width, job.height, to_string(job.mode));
+                return;
+            }
+
+            if (!dryRun) BakedTexture::bake(*pBitmap, job.bakedPath, job.mode, job.srgb);
+            job.status = Status::Baked;
+        }
+        catch (const std::exception& e)
+        {
+            job.status = Status::Failed;
+            job.message = e.what();
+        }
+    }
+
+    void MaterialTextureBaker::writeManifest(const std::filesystem::path& path, const std::filesystem::path& scenePath, const std::vector<Job>& jobs)
+    {
+        nlohmann::json textures = nlohmann::json::array();
+        for (const auto& job : jobs)
+        {
+            textures.push_back({
+                {"source", job.sourcePath.string()},
+                {"baked", job.bakedPath.string()},
+                {"slot", to_string(job.slot)},
+                {"srgb", job.srgb},
+                {"mode", to_string(job.mode)},
+                {"width", job.width},
+                {"height", job.height},
+                {"status", to_string(job.status)},
+                {"message", job.message},
+            });
+        }
+
+        nlohmann::json manifest = {{"scene", scenePath.string()}, {"textures", textures}};
+
+        std::ofstream ofs(path);
+        if (!ofs.good()) FALCOR_THROW("Failed to write manifest '{}'.", path);
+        ofs << manifest.dump(4) << std::endl;
+    }
+}
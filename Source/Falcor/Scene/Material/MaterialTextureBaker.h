@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Scene/Material/Material.h"
+#include "Utils/Image/ImageIO.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    class Scene;
+
+    /** Helpers to bake the textures of a scene's materials offline (see BakedTexture).
+
+        The compression mode of each texture is selected from the material slot it is used in
+        and the format of the source image. This is used by the TextureBaker tool.
+    */
+    class FALCOR_API MaterialTextureBaker
+    {
+    public:
+        enum class Status
+        {
+            Baked,
+            UpToDate,
+            Skipped,
+            Failed,
+        };
+
+        /** Bake job for a single source texture.
+        */
+        struct Job
+        {
+            std::filesystem::path sourcePath;
+            std::filesystem::path bakedPath;
+            Material::TextureSlot slot = Material::TextureSlot::Count;
+            bool srgb = false;
+
+            // Results.
+            ImageIO::CompressionMode mode = ImageIO::CompressionMode::None;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            Status status = Status::Skipped;
+            std::string message;
+        };
+
+        /** Select the block compression mode for a texture.
+            Slots that must stay uncompressed are handled first. Otherwise the bitmap format overrides
+            the slot's mode where that mode cannot represent the data.
+            \param[in] slot Material slot the texture is used in.
+            \param[in] format Format of the source bitmap.
+            \return Compression mode.
+        */
+        static ImageIO::CompressionMode selectCompressionMode(Material::TextureSlot slot, ResourceFormat format);
+
+        /** Collect the unique source textures of all materials in a scene.
+            \param[in] scene Scene, loaded with baked textures disabled.
+            \return List of jobs sorted by source path.
+        */
+        static std::vector<Job> collectJobs(const Scene& scene);
+
+        /** Run a bake job. Errors are reported in the job status and never thrown.
+            \param[in,out] job Job to run.
+            \param[in] force Bake the texture even if the baked texture is up to date.
+            \param[in] dryRun Only determine the outcome, do not write the baked texture.
+        */
+        static void runJob(Job& job, bool force, bool dryRun);
+
+        /** Write a JSON manifest listing the mode and outcome of each job.
+            \param[in] path Manifest file path.
+            \param[in] scenePath Path of the baked scene.
+            \param[in] jobs Completed jobs.
+        */
+        static void writeManifest(const std::filesystem::path& path, const std::filesystem::path& scenePath, const std::vector<Job>& jobs);
+    };
+
+    inline std::string to_string(MaterialTextureBaker::Status status)
+    {
+        switch (status)
+        {
+        case MaterialTextureBaker::Status::Baked: return "baked";
+        case MaterialTextureBaker::Status::UpToDate: return "up-to-date";
+        case MaterialTextureBaker::Status::Skipped: return "skipped";
+        case MaterialTextureBaker::Status::Failed: return "failed";
+        default:
+            FALCOR_THROW("Invalid bake status");
+        }
+    }
+
+    inline std::string to_string(ImageIO::CompressionMode mode)
+    {
+        switch (mode)
+        {
+        case ImageIO::CompressionMode::BC1: return "BC1";
+        case ImageIO::CompressionMode::BC2: return "BC2";
+        case ImageIO::CompressionMode::BC3: return "BC3";
+        case ImageIO::CompressionMode::BC4: return "BC4";
+        case ImageIO::CompressionMode::BC5: return "BC5";
+        case ImageIO::CompressionMode::BC6: return "BC6";
+        case ImageIO::CompressionMode::BC7: return "BC7";
+        case ImageIO::CompressionMode::None: return "None";
+        default:
+            FALCOR_THROW("Invalid compression mode");
+        }
+    }
+}
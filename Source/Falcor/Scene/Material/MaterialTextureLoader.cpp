@@ -27,11 +27,13 @@
  **************************************************************************/
 #include "MaterialTextureLoader.h"
 #include "Utils/Logger.h"
+#include <numeric>
 
 namespace Falcor
 {
-    MaterialTextureLoader::MaterialTextureLoader(TextureManager& textureManager, bool useSrgb)
+    MaterialTextureLoader::MaterialTextureLoader(TextureManager& textureManager, bool useSrgb, bool optimizeConstantTextures)
         : mUseSrgb(useSrgb)
+        , mOptimizeConstantTextures(optimizeConstantTextures)
         , mTextureManager(textureManager)
     {
     }
@@ -62,7 +64,8 @@ namespace Falcor
             Bitmap::ImportFlags::None,
             nullptr /*search dirs*/,
             nullptr /*load count*/,
-            pMaterial.get()
+            pMaterial.get(),
+            mOptimizeConstantTextures /*defer constant*/
         );
 
         // Store assignment to material for later.
@@ -74,11 +77,29 @@ namespace Falcor
         mTextureManager.waitForAllTexturesLoading();
 
         // Assign textures to materials.
+        // Constant textures that were not created on load are first offered to the material, which may replace them by
+        // uniform parameters. Otherwise getTexture() creates them.
+        Material::TextureOptimizationStats stats = {};
         for (const auto& assignment : mTextureAssignments)
         {
+            if (mOptimizeConstantTextures && assignment.handle && !assignment.handle.isUdim())
+            {
+                auto desc = mTextureManager.getTextureDesc(assignment.handle);
+                if (desc.pDeferred && desc.analysis &&
+                    assignment.pMaterial->optimizeConstantTexture(assignment.textureSlot, *desc.analysis, desc.pDeferred->decoded.format, stats))
+                {
+                    continue;
+                }
+            }
+
             auto pTexture = mTextureManager.getTexture(assignment.handle);
             assignment.pMaterial->setTexture(assignment.textureSlot, pTexture);
         }
         mTextureAssignments.clear();
+
+        if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
+        {
+            logInfo("Replaced {} constant material textures by material parameters without creating them.", totalRemoved);
+        }
     }
 }
@@ -41,11 +41,20 @@ namespace Falcor
         material assignment is stored. When the client destroys the instance of the
         `MaterialTextureLoader`, it blocks until all textures are loaded and assigns
         them to the materials.
+
+        If constant textures are optimized, textures found to have a constant value on load
+        are not created. Materials replace them by uniform parameters where possible,
+        see Material::optimizeConstantTexture(), and they are only created otherwise.
     */
     class FALCOR_API MaterialTextureLoader
     {
     public:
-        MaterialTextureLoader(TextureManager& textureManager, bool useSrgb);
+        /** Constructor.
+            \param[in] textureManager Texture manager to load textures with.
+            \param[in] useSrgb Load textures in slots marked as sRGB using sRGB formats.
+            \param[in] optimizeConstantTextures Replace textures of constant value by material parameters instead of creating them.
+        */
+        MaterialTextureLoader(TextureManager& textureManager, bool useSrgb, bool optimizeConstantTextures = false);
         ~MaterialTextureLoader();
 
         /** Request loading a material texture.
@@ -70,6 +79,7 @@ namespace Falcor
         };
 
         bool mUseSrgb;
+        bool mOptimizeConstantTextures;
         std::vector<TextureAssignment> mTextureAssignments;
         TextureManager& mTextureManager;
     };
@@ -0,0 +1,162 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeasuredBRDFCache.h"
+#include "Core/Error.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <execution>
+#include <map>
+#include <mutex>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kDirectory = "NVIDIA/Falcor/MeasuredBRDFCache";
+
+        // Files are hashed in chunks of this size in parallel.
+        const size_t kHashChunkSize = 1 << 20;
+
+        const ResourceFormat kAlbedoLUTFormat = ResourceFormat::RGBA32Float;
+
+        struct FileIdentity
+        {
+            uintmax_t size = 0;
+            std::filesystem::file_time_type writeTime;
+            MeasuredBRDFCache::Key key;
+        };
+
+        struct KeyMemo
+        {
+            std::mutex mutex;
+            std::map<std::filesystem::path, FileIdentity> files;
+        };
+
+        KeyMemo& getKeyMemo()
+        {
+            static KeyMemo memo;
+            return memo;
+        }
+    }
+
+    MeasuredBRDFCache::Key MeasuredBRDFCache::getKey(const std::filesystem::path& path, const void* pData, size_t size)
+    {
+        std::error_code ec;
+        const auto writeTime = std::filesystem::last_write_time(path, ec);
+        if (ec) return computeKey(pData, size);
+
+        const auto absolutePath = std::filesystem::absolute(path, ec);
+        if (ec) return computeKey(pData, size);
+
+        KeyMemo& memo = getKeyMemo();
+        {
+            std::lock_guard<std::mutex> lock(memo.mutex);
+            auto it = memo.files.find(absolutePath);
+            if (it != memo.files.end() && it->second.size == size && it->second.writeTime == writeTime)
+                return it->second.key;
+        }
+
+        // Hash outside of the lock so that different files can be hashed concurrently.
+        FileIdentity identity;
+        identity.size = size;
+        identity.writeTime = writeTime;
+        identity.key = computeKey(pData, size);
+
+        std::lock_guard<std::mutex> lock(memo.mutex);
+        memo.files[absolutePath] = identity;
+        return identity.key;
+    }
+
+    MeasuredBRDFCache::Key MeasuredBRDFCache::computeKey(const void* pData, size_t size)
+    {
+        // Hash fixed-size chunks in parallel and combine the chunk digests.
+        // The result only depends on the content, not on the number of threads.
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        std::vector<SHA1::MD> digests(div_round_up(size, kHashChunkSize));
+
+        auto range = NumericRange<size_t>(0, digests.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t chunk)
+        {
+            const size_t offset = chunk * kHashChunkSize;
+            digests[chunk] = SHA1::compute(pBytes + offset, std::min(kHashChunkSize, size - offset));
+        });
+
+        SHA1 sha1;
+        sha1.update(uint64_t(size));
+        sha1.update(digests.data(), digests.size() * sizeof(SHA1::MD));
+        return sha1.finalize();
+    }
+
+    std::filesystem::path MeasuredBRDFCache::getAlbedoLUTPath(const Key& key)
+    {
+        return getAppDataDirectory() / kDirectory / (SHA1::toString(key) + "_albedo.dds");
+    }
+
+    bool MeasuredBRDFCache::loadAlbedoLUT(const std::filesystem::path& path, uint32_t size, std::vector<float4>& lut)
+    {
+        if (!std::filesystem::is_regular_file(path)) return false;
+
+        Bitmap::UniqueConstPtr pBitmap;
+        try
+        {
+            pBitmap = ImageIO::loadBitmapFromDDS(path);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to load albedo LUT from '{}': {}", path, e.what());
+            return false;
+        }
+
+        if (!pBitmap || pBitmap->getFormat() != kAlbedoLUTFormat || pBitmap->getWidth() != size || pBitmap->getHeight() != 1)
+            return false;
+
+        const float4* pLUT = reinterpret_cast<const float4*>(pBitmap->getData());
+        lut.assign(pLUT, pLUT + size);
+        return true;
+    }
+
+    void MeasuredBRDFCache::saveAlbedoLUT(const std::filesystem::path& path, const std::vector<float4>& lut)
+    {
+        try
+        {
+            std::filesystem::create_directories(path.parent_path());
+            const auto pBitmap = Bitmap::create((uint32_t)lut.size(), 1, kAlbedoLUTFormat, reinterpret_cast<const uint8_t*>(lut.data()));
+            ImageIO::saveToDDS(path, *pBitmap, ImageIO::CompressionMode::None, false);
+            logInfo("Saved albedo LUT to '{}'.", path);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to save albedo LUT to '{}': {}", path, e.what());
+        }
+    }
+}
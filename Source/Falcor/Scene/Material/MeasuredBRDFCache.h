@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+    /** Helpers for caching measured BRDF data (MERL, RGL) across materials and runs.
+
+        Measured BRDF files are identified by a key computed from their content, so that
+        materials referencing the same file, or identical copies of it, can share the decoded
+        data. The key of a file is memoized by path, size and modification time, which allows
+        repeated loads of a memory-mapped file to skip reading its content altogether.
+
+        Precomputed albedo lookup tables are persisted in the application data directory next
+        to the scene cache, so they survive across runs and don't require write access to the
+        directory containing the BRDF.
+    */
+    class FALCOR_API MeasuredBRDFCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        /** Get the content key of a file.
+            The key is computed on first use and memoized for the same path, size and modification time.
+            \param[in] path Path of the file.
+            \param[in] pData File content.
+            \param[in] size File size in bytes.
+            \return Returns the content key.
+        */
+        static Key getKey(const std::filesystem::path& path, const void* pData, size_t size);
+
+        /** Compute the content key of a block of memory.
+            The data is hashed in parallel in fixed-size chunks.
+            \param[in] pData Data to hash.
+            \param[in] size Size in bytes.
+            \return Returns the content key.
+        */
+        static Key computeKey(const void* pData, size_t size);
+
+        /** Get the path of the persisted albedo lookup table for a given key.
+        */
+        static std::filesystem::path getAlbedoLUTPath(const Key& key);
+
+        /** Load an albedo lookup table from a DDS file.
+            \param[in] path Path of the DDS file.
+            \param[in] size Expected number of entries.
+            \param[out] lut Loaded lookup table.
+            \return True if the file exists and matches the expected size and format.
+        */
+        static bool loadAlbedoLUT(const std::filesystem::path& path, uint32_t size, std::vector<float4>& lut);
+
+        /** Save an albedo lookup table as an uncompressed DDS file in RGBA32Float format.
+            Failures are logged but not fatal, as the table can be recomputed.
+            \param[in] path Path of the DDS file. Missing directories are created.
+            \param[in] lut Lookup table.
+        */
+        static void saveAlbedoLUT(const std::filesystem::path& path, const std::vector<float4>& lut);
+    };
+}
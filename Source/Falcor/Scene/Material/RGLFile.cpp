@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "RGLFile.h"
 #include "Core/Error.h"
+#include <cstring>
 
 namespace Falcor
 {
@@ -133,14 +134,18 @@ namespace Falcor
         mMeasurement = MeasurementData{thetaI, phiI, sigma, ndf, vndf, rgb, luminance, isotropic, std::move(descString)};
     }
 
-    RGLFile::RGLFile(std::ifstream& in)
+    RGLFile::RGLFile(const void* pData, size_t size)
     {
-        auto readBytes = [&](void* dst, size_t size)
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        size_t pos = 0;
+        auto readBytes = [&](void* dst, size_t count)
         {
-            in.read(reinterpret_cast<char*>(dst), size);
+            if (count > size - pos) FALCOR_THROW("Error parsing RGL file: File truncated");
+            std::memcpy(dst, pBytes + pos, count);
+            pos += count;
         };
 
-        uint8_t header[12];
+        char header[12];
         readBytes(header, 12);
 
         uint8_t version[2];
@@ -149,7 +154,7 @@ namespace Falcor
         uint32_t fieldCount;
         readBytes(&fieldCount, 4);
 
-        if (strcmp(reinterpret_cast<const char*>(header), "tensor_file"))
+        if (std::memcmp(header, "tensor_file", 12))
         {
             FALCOR_THROW("Invalid file header");
         }
@@ -164,7 +169,7 @@ namespace Falcor
             readBytes(&nameLength, 2);
 
             std::string fieldName(nameLength, '\0');
-            readBytes(&fieldName[0], nameLength);
+            readBytes(fieldName.data(), nameLength);
 
             uint16_t fieldDim;
             readBytes(&fieldDim, 2);
@@ -182,8 +187,6 @@ namespace Falcor
             field.shape.reset(new uint64_t[fieldDim]);
             readBytes(field.shape.get(), 8 * fieldDim);
 
-            if (!in.good()) FALCOR_THROW("Error parsing RGL field: File truncated");
-
             size_t elemSize = fieldSize(FieldType(fieldType));
             if (elemSize == 0)
             {
@@ -198,12 +201,10 @@ namespace Falcor
             }
             field.numElems = N;
 
+            // Field data is copied directly out of the file contents.
+            if (offset > size || N > (size - offset) / elemSize) FALCOR_THROW("Error parsing RGL field: File truncated");
             field.data.reset(new uint8_t[N * elemSize]);
-
-            uint64_t pos = in.tellg();
-            in.seekg(offset);
-            readBytes(field.data.get(), N * elemSize);
-            in.seekg(pos);
+            std::memcpy(field.data.get(), pBytes + offset, N * elemSize);
 
             mFieldMap.insert(std::make_pair(std::string(fieldName), int(mFields.size())));
             mFields.emplace_back(std::move(field));
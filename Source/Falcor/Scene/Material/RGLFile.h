@@ -75,9 +75,11 @@ namespace Falcor
 
         RGLFile() = default;
 
-        /** Loads RGL measured BRDF file and validates contents. Throws Falcor::Exception on failure.
+        /** Parses RGL measured BRDF file contents and validates them. Throws Falcor::Exception on failure.
+            \param[in] pData File contents, typically a memory-mapped file. Field data is copied.
+            \param[in] size Size of the file contents in bytes.
         */
-        RGLFile(std::ifstream& in);
+        RGLFile(const void* pData, size_t size);
 
         void saveFile(std::ofstream& out) const;
 
@@ -28,13 +28,15 @@
 #include "RGLMaterial.h"
 #include "RGLFile.h"
 #include "RGLCommon.h"
+#include "MeasuredBRDFCache.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
-#include "Utils/Image/ImageIO.h"
+#include "Utils/SharedCache.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
-#include <fstream>
+#include <mutex>
 
 namespace Falcor
 {
@@ -50,15 +52,58 @@ namespace Falcor
         const std::string kLoadFile = "load";
     }
 
-    RGLMaterial::RGLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
-        : Material(pDevice, name, MaterialType::RGL)
+    struct RGLMaterial::SharedData
     {
-        FALCOR_CHECK(!path.empty(), "Missing path.");
+        MeasuredBRDFCache::Key key;                             ///< Content key of the BRDF file.
+        RGLFile file;                                           ///< Parsed BRDF file.
+        std::unique_ptr<SamplableDistribution4D> pVNDFDist;     ///< Sampling distribution built from the VNDF.
+        std::unique_ptr<SamplableDistribution4D> pLumiDist;     ///< Sampling distribution built from the luminance.
+        std::vector<float4> albedoLUT;                          ///< Precomputed albedo lookup table. Empty until prepared.
+        std::mutex albedoLUTMutex;                              ///< Serializes preparing the albedo lookup table.
+
+        /** Parses the file contents and builds the sampling distributions. Throws on error.
+        */
+        SharedData(const MeasuredBRDFCache::Key& key_, const void* pData, size_t size)
+            : key(key_)
+            , file(pData, size)
+        {
+            auto theta = file.data().thetaI;
+            auto phi   = file.data().phiI;
+            auto sigma = file.data().sigma;
+            auto ndf   = file.data().ndf;
+            auto vndf  = file.data().vndf;
+            auto lumi  = file.data().luminance;
+
+            const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
+            if (phi->shape[0] > kMaxResolution || theta->shape[0] > kMaxResolution || std::max(sigma->shape[0], sigma->shape[1]) > kMaxResolution
+                || std::max(ndf->shape[0], ndf->shape[1]) > kMaxResolution || std::max(vndf->shape[2], vndf->shape[3]) > kMaxResolution
+                || std::max(lumi->shape[2], lumi->shape[3]) > kMaxResolution)
+            {
+                FALCOR_THROW("Measurement resolution too large");
+            }
 
-        if (!loadBRDF(path))
+            uint4 vndfSize = uint4(phi->shape[0], theta->shape[0], vndf->shape[3], vndf->shape[2]);
+            uint4 lumiSize = uint4(phi->shape[0], theta->shape[0], lumi->shape[3], lumi->shape[2]);
+            pVNDFDist = std::make_unique<SamplableDistribution4D>(reinterpret_cast<const float*>(vndf->data.get()), vndfSize);
+            pLumiDist = std::make_unique<SamplableDistribution4D>(reinterpret_cast<const float*>(lumi->data.get()), lumiSize);
+        }
+    };
+
+    namespace
+    {
+        using SharedDataCache = SharedCache<RGLMaterial::SharedData, MeasuredBRDFCache::Key>;
+
+        SharedDataCache& getSharedDataCache()
         {
-            FALCOR_THROW("RGLMaterial() - Failed to load BRDF from '{}'.", path);
+            static SharedDataCache cache;
+            return cache;
         }
+    }
+
+    RGLMaterial::RGLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
+        : Material(pDevice, name, MaterialType::RGL)
+    {
+        FALCOR_CHECK(!path.empty(), "Missing path.");
 
         // Create resources for albedo lookup table.
         Sampler::Desc desc;
@@ -67,7 +112,10 @@ namespace Falcor
         desc.setMaxAnisotropy(1);
         mpSampler = mpDevice->createSampler(desc);
 
-        prepareAlbedoLUT(mpDevice->getRenderContext());
+        if (!loadBRDF(path))
+        {
+            FALCOR_THROW("RGLMaterial() - Failed to load BRDF from '{}'.", path);
+        }
     }
 
     bool RGLMaterial::renderUI(Gui::Widgets& widget)
@@ -135,6 +183,14 @@ namespace Falcor
         return true;
     }
 
+    uint64_t RGLMaterial::hash() const
+    {
+        Hasher hasher;
+        hashBase(hasher);
+        hasher.insert(mPath);
+        return hasher.get();
+    }
+
     ProgramDesc::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { ProgramDesc::ShaderModule::fromFile(kShaderFile) };
@@ -147,17 +203,19 @@ namespace Falcor
 
     bool RGLMaterial::loadBRDF(const std::filesystem::path& path)
     {
-        std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
-        if (!ifs.good())
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
         {
             logWarning("RGLMaterial::loadBRDF() - Failed to open file '{}'.", path);
             return false;
         }
 
-        std::unique_ptr<RGLFile> file;
+        // Look up the decoded BRDF in the shared cache. The file content is only read on a cache miss.
+        std::shared_ptr<SharedData> pSharedData;
         try
         {
-            file.reset(new RGLFile(ifs));
+            const auto key = MeasuredBRDFCache::getKey(path, file.getData(), file.getSize());
+            pSharedData = getSharedDataCache().acquire(key, [&]() { return std::make_shared<SharedData>(key, file.getData(), file.getSize()); });
         }
         catch(const RuntimeError& e)
         {
@@ -165,32 +223,18 @@ namespace Falcor
             return false;
         }
 
-        if (!ifs.good())
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to load BRDF data from file '{}': Read error.", path);
-            return false;
-        }
-
-        auto theta = file->data().thetaI;
-        auto phi   = file->data().phiI;
-        auto sigma = file->data().sigma;
-        auto ndf   = file->data().ndf;
-        auto vndf  = file->data().vndf;
-        auto lumi  = file->data().luminance;
-        auto rgb   = file->data().rgb;
-
-        const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
-        if (phi->shape[0] > kMaxResolution || theta->shape[0] > kMaxResolution || std::max(sigma->shape[0], sigma->shape[1]) > kMaxResolution
-            || std::max(ndf->shape[0], ndf->shape[1]) > kMaxResolution || std::max(vndf->shape[2], vndf->shape[3]) > kMaxResolution
-            || std::max(lumi->shape[2], lumi->shape[3]) > kMaxResolution)
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to process BRDF data: Measurement resolution too large.", path);
-            return false;
-        }
+        const RGLFile& rglFile = pSharedData->file;
+        auto theta = rglFile.data().thetaI;
+        auto phi   = rglFile.data().phiI;
+        auto sigma = rglFile.data().sigma;
+        auto ndf   = rglFile.data().ndf;
+        auto vndf  = rglFile.data().vndf;
+        auto lumi  = rglFile.data().luminance;
+        auto rgb   = rglFile.data().rgb;
 
         mPath = path;
         mBRDFName = std::filesystem::path(path).stem().string();
-        mBRDFDescription = file->data().description;
+        mBRDFDescription = rglFile.data().description;
 
         mData.phiSize = uint(phi->shape[0]);
         mData.thetaSize = uint(theta->shape[0]);
@@ -204,8 +248,8 @@ namespace Falcor
         auto prod3 = [&](uint4 v) { return v.x * v.y * v.z; };
         auto prod4 = [&](uint4 v) { return v.x * v.y * v.z * v.w; };
 
-        SamplableDistribution4D vndfDist(reinterpret_cast<float*>(vndf->data.get()), vndfSize);
-        SamplableDistribution4D lumiDist(reinterpret_cast<float*>(lumi->data.get()), lumiSize);
+        SamplableDistribution4D& vndfDist = *pSharedData->pVNDFDist;
+        SamplableDistribution4D& lumiDist = *pSharedData->pLumiDist;
 
         mpVNDFMarginalBuf    = mpDevice->createBuffer(prod3(vndfSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, vndfDist.getMarginal());
         mpLumiMarginalBuf    = mpDevice->createBuffer(prod3(lumiSize) * 4, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, lumiDist.getMarginal());
@@ -222,48 +266,50 @@ namespace Falcor
 
         markUpdates(Material::UpdateFlags::ResourcesChanged);
 
+        // The decoded data is only needed to create the GPU buffers and the lookup table, so it is released on return.
+        prepareAlbedoLUT(mpDevice->getRenderContext(), *pSharedData);
+
         logInfo("Loaded RGL BRDF '{}': {}.", mBRDFName, mBRDFDescription);
 
         return true;
     }
 
-    void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext) // TODO
+    void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext, SharedData& sharedData) // TODO
     {
-        const auto texPath = mPath.replace_extension("dds");
+        // The table is shared with all materials loaded from identical files. Only the first one prepares it.
+        std::lock_guard<std::mutex> lock(sharedData.albedoLUTMutex);
+        auto& albedoLUT = sharedData.albedoLUT;
 
-        // Try loading albedo lookup table.
-        if (std::filesystem::is_regular_file(texPath))
+        if (albedoLUT.empty())
         {
-            // Load 1D texture in non-SRGB format, no mips.
-            // If successful, verify dimensions/format/etc. match the expectations.
-            mpAlbedoLUT = Texture::createFromFile(mpDevice, texPath.string(), false, false, ResourceBindFlags::ShaderResource);
-
-            if (mpAlbedoLUT)
+            // Try loading cached albedo lookup table, either from the shared cache directory or next to the BRDF file.
+            const auto cachePath = MeasuredBRDFCache::getAlbedoLUTPath(sharedData.key);
+            const auto sidecarPath = std::filesystem::path(mPath).replace_extension("dds");
+            for (const auto& texPath : {cachePath, sidecarPath})
             {
-                if (mpAlbedoLUT->getFormat() == kAlbedoLUTFormat &&
-                    mpAlbedoLUT->getWidth() == kAlbedoLUTSize &&
-                    mpAlbedoLUT->getHeight() == 1 && mpAlbedoLUT->getDepth() == 1 &&
-                    mpAlbedoLUT->getMipCount() == 1 && mpAlbedoLUT->getArraySize() == 1)
+                if (MeasuredBRDFCache::loadAlbedoLUT(texPath, kAlbedoLUTSize, albedoLUT))
                 {
-                    logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                    return;
+                    logInfo("Loaded albedo LUT from '{}'.", texPath);
+                    break;
                 }
             }
-        }
-
-        // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pRenderContext);
 
-        // Cache lookup table in texture on disk.
-        // TODO: Capture texture to DDS is not yet supported. Calling ImageIO directly for now.
-        //mpAlbedoLUT->captureToFile(0, 0, texPath.string(), Bitmap::FileFormat::DdsFile, Bitmap::ExportFlags::Uncompressed);
-        FALCOR_ASSERT(mpAlbedoLUT);
-        ImageIO::saveToDDS(pRenderContext, texPath.string(), mpAlbedoLUT, ImageIO::CompressionMode::None, false);
+            if (albedoLUT.empty())
+            {
+                // Failed to load a valid lookup table. We'll recompute it and cache it on disk.
+                auto computedLUT = computeAlbedoLUT(pRenderContext);
+                MeasuredBRDFCache::saveAlbedoLUT(cachePath, computedLUT);
+                albedoLUT = std::move(computedLUT);
+            }
+        }
 
-        logInfo("Saved albedo LUT to '{}'.", texPath.string());
+        // Create albedo LUT texture.
+        static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
+        FALCOR_ASSERT(albedoLUT.size() == kAlbedoLUTSize);
+        mpAlbedoLUT = mpDevice->createTexture2D(kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, albedoLUT.data(), ResourceBindFlags::ShaderResource);
     }
 
-    void RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
+    std::vector<float4> RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
     {
         logInfo("Computing albedo LUT for RGL BRDF '{}'...", mBRDFName);
 
@@ -291,12 +337,9 @@ namespace Falcor
         auto albedos = integrator.integrateIsotropic(pRenderContext, materialID, cosThetas);
 
         // Copy result into format needed for texture creation.
-        static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
-        std::vector<float4> initData(kAlbedoLUTSize, float4(0.f));
-        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) initData[i] = float4(albedos[i], 1.f);
-
-        // Create albedo LUT texture.
-        mpAlbedoLUT = mpDevice->createTexture2D(kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, initData.data(), ResourceBindFlags::ShaderResource);
+        std::vector<float4> albedoLUT(kAlbedoLUTSize, float4(0.f));
+        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) albedoLUT[i] = float4(albedos[i], 1.f);
+        return albedoLUT;
     }
 
     FALCOR_SCRIPT_BINDING(RGLMaterial)
@@ -29,6 +29,7 @@
 #include "Material.h"
 #include "RGLMaterialData.slang"
 #include <filesystem>
+#include <vector>
 
 namespace Falcor
 {
@@ -43,6 +44,9 @@ namespace Falcor
     {
         FALCOR_OBJECT(RGLMaterial)
     public:
+        /// Decoded BRDF data shared between all materials loaded from files with identical content.
+        struct SharedData;
+
         static ref<RGLMaterial> create(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path) { return make_ref<RGLMaterial>(pDevice, name, path); }
 
         RGLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path);
@@ -50,6 +54,7 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        uint64_t hash() const override;
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         ProgramDesc::ShaderModuleList getShaderModules() const override;
         TypeConformanceList getTypeConformances() const override;
@@ -58,10 +63,14 @@ namespace Falcor
 
         bool loadBRDF(const std::filesystem::path& path);
 
+        /** Get the texture holding the precomputed albedo lookup table.
+        */
+        const ref<Texture>& getAlbedoLUT() const { return mpAlbedoLUT; }
+
     protected:
         void prepareData(const int dims[3], const std::vector<double>& data);
-        void prepareAlbedoLUT(RenderContext* pRenderContext);
-        void computeAlbedoLUT(RenderContext* pRenderContext);
+        void prepareAlbedoLUT(RenderContext* pRenderContext, SharedData& sharedData);
+        std::vector<float4> computeAlbedoLUT(RenderContext* pRenderContext);
 
         std::filesystem::path mPath;        ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
@@ -178,6 +178,23 @@ namespace Falcor
         }
     }
 
+    void NDSDFGrid::hashContent(FNVHash64& hash) const
+    {
+        hash.insert(mNarrowBandThickness);
+        hash.insert(mValues.size());
+        for (const auto& lodValues : mValues)
+        {
+            hash.insert(lodValues.size());
+            if (!lodValues.empty()) hash.insert(lodValues.data(), lodValues.size() * sizeof(int8_t));
+        }
+    }
+
+    bool NDSDFGrid::isContentEqualInternal(const SDFGrid& other) const
+    {
+        const NDSDFGrid& otherGrid = static_cast<const NDSDFGrid&>(other);
+        return mNarrowBandThickness == otherGrid.mNarrowBandThickness && mValues == otherGrid.mValues;
+    }
+
     float NDSDFGrid::calculateNormalizationFactor(uint32_t gridWidth) const
     {
         return 0.5f * float(M_SQRT3) * mNarrowBandThickness / gridWidth;
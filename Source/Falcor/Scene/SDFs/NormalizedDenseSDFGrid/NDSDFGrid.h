@@ -59,6 +59,8 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void hashContent(FNVHash64& hash) const override;
+        virtual bool isContentEqualInternal(const SDFGrid& other) const override;
 
         float calculateNormalizationFactor(uint32_t gridWidth) const;
 
@@ -44,6 +44,7 @@
 #include <nlohmann/json.hpp>
 #include <random>
 #include <fstream>
+#include <cstring>
 
 using json = nlohmann::json;
 
@@ -62,6 +63,9 @@ namespace Falcor
 
         const char kPrimitiveTranslationJSONKey[] = "translation";
         const char kPrimitiveInvRotationScaleJSONKey[] = "inv_rot_scale";
+
+        // Primitives are hashed and compared bitwise, which requires them to be free of padding.
+        static_assert(sizeof(SDF3DPrimitive) == 19 * sizeof(float), "SDF3DPrimitive must not contain padding");
     }
 
     NLOHMANN_JSON_SERIALIZE_ENUM(SDF3DShapeType, {
@@ -437,6 +441,36 @@ namespace Falcor
         mBakePrimitives = true;
     }
 
+    uint64_t SDFGrid::getContentHash() const
+    {
+        FNVHash64 hash;
+        hash.insert(getType());
+        hash.insert(mGridWidth);
+        hash.insert(mBakedPrimitiveCount);
+        hash.insert(mInitializedWithPrimitives);
+        hash.insert(mPrimitives.size());
+        if (!mPrimitives.empty()) hash.insert(mPrimitives.data(), mPrimitives.size() * sizeof(SDF3DPrimitive));
+        hashContent(hash);
+        return hash.get();
+    }
+
+    bool SDFGrid::isContentEqual(const SDFGrid& other) const
+    {
+        if (this == &other) return true;
+        if (!hasCPUValues() || !other.hasCPUValues()) return false;
+
+        if (getType() != other.getType()) return false;
+        if (mGridWidth != other.mGridWidth) return false;
+        if (mBakedPrimitiveCount != other.mBakedPrimitiveCount) return false;
+        if (mInitializedWithPrimitives != other.mInitializedWithPrimitives) return false;
+
+        // Primitives are compared bitwise, which is conservative for floats (-0 and +0 are considered different).
+        if (mPrimitives.size() != other.mPrimitives.size()) return false;
+        if (!mPrimitives.empty() && std::memcmp(mPrimitives.data(), other.mPrimitives.data(), mPrimitives.size() * sizeof(SDF3DPrimitive)) != 0) return false;
+
+        return isContentEqualInternal(other);
+    }
+
     std::string SDFGrid::getTypeName(Type type)
     {
         switch (type)
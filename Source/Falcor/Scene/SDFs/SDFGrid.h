@@ -32,6 +32,7 @@
 #include "Core/API/Texture.h"
 #include "Core/Pass/ComputePass.h"
 #include "Scene/SDFs/SDF3DPrimitiveCommon.slang"
+#include "Utils/Math/FNVHash.h"
 #include <memory>
 #include <vector>
 #include <utility>
@@ -231,11 +232,36 @@ namespace Falcor
         */
         uint32_t getBakedPrimitiveCount() const { return mBakedPrimitiveCount; };
 
+        /** Computes a hash of the content of the SDF grid, i.e., its type, grid width, creation parameters, values and primitives.
+            Grids for which isContentEqual() returns true are guaranteed to have the same hash.
+            \return The content hash.
+        */
+        uint64_t getContentHash() const;
+
+        /** Check if this SDF grid has the same content as another SDF grid, meaning that one can be rendered in place of the other.
+            Grids whose values have already been uploaded to the GPU and released on the CPU are only equal to themselves.
+            \param[in] other The SDF grid to compare against.
+            \return True if the content is equal, otherwise false.
+        */
+        bool isContentEqual(const SDFGrid& other) const;
+
         static std::string getTypeName(Type type);
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Returns true if the values of the grid are available on the CPU, false if they only exist on the GPU.
+        */
+        virtual bool hasCPUValues() const { return true; }
+
+        /** Inserts the type specific content (creation parameters and values) of the grid into a hash.
+        */
+        virtual void hashContent(FNVHash64& hash) const = 0;
+
+        /** Compares the type specific content (creation parameters and values) of the grid against a grid of the same type.
+        */
+        virtual bool isContentEqualInternal(const SDFGrid& other) const = 0;
+
         void createEvaluatePrimitivesPass(bool writeToTexture3D, bool mergeWithSDField);
 
         void updatePrimitivesBuffer();
@@ -988,6 +988,22 @@ namespace Falcor
         }
     }
 
+    void SDFSBS::hashContent(FNVHash64& hash) const
+    {
+        hash.insert(mBrickWidth);
+        hash.insert(mCompressed);
+        hash.insert(mDefaultGridWidth);
+        hash.insert(mSDField.size());
+        if (!mSDField.empty()) hash.insert(mSDField.data(), mSDField.size() * sizeof(int8_t));
+    }
+
+    bool SDFSBS::isContentEqualInternal(const SDFGrid& other) const
+    {
+        const SDFSBS& otherGrid = static_cast<const SDFSBS&>(other);
+        return mBrickWidth == otherGrid.mBrickWidth && mCompressed == otherGrid.mCompressed && mDefaultGridWidth == otherGrid.mDefaultGridWidth &&
+            mSDField == otherGrid.mSDField;
+    }
+
     void SDFSBS::createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int8_t>& sdField)
     {
         FALCOR_CHECK(!sdField.empty(), "Cannot create SDF grid texture from empty values vector");
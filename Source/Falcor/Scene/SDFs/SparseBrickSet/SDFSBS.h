@@ -79,6 +79,9 @@ namespace Falcor
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual bool hasCPUValues() const override { return !mHasGridRepresentation || !mSDField.empty(); }
+        virtual void hashContent(FNVHash64& hash) const override;
+        virtual bool isContentEqualInternal(const SDFGrid& other) const override;
 
         void createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int8_t>& sdField);
 
@@ -422,4 +422,16 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    void SDFSVO::hashContent(FNVHash64& hash) const
+    {
+        hash.insert(mValues.size());
+        if (!mValues.empty()) hash.insert(mValues.data(), mValues.size() * sizeof(int8_t));
+    }
+
+    bool SDFSVO::isContentEqualInternal(const SDFGrid& other) const
+    {
+        const SDFSVO& otherGrid = static_cast<const SDFSVO&>(other);
+        return mValues == otherGrid.mValues;
+    }
 }
@@ -62,6 +62,8 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void hashContent(FNVHash64& hash) const override;
+        virtual bool isContentEqualInternal(const SDFGrid& other) const override;
 
     private:
         // CPU data.
@@ -174,4 +174,16 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    void SDFSVS::hashContent(FNVHash64& hash) const
+    {
+        hash.insert(mValues.size());
+        if (!mValues.empty()) hash.insert(mValues.data(), mValues.size() * sizeof(int8_t));
+    }
+
+    bool SDFSVS::isContentEqualInternal(const SDFGrid& other) const
+    {
+        const SDFSVS& otherGrid = static_cast<const SDFSVS&>(other);
+        return mValues == otherGrid.mValues;
+    }
 }
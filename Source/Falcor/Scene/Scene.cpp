@@ -27,7 +27,9 @@
  **************************************************************************/
 #include "Scene.h"
 #include "SceneDefines.slangh"
+#include "BlasGroupPacking.h"
 #include "SceneBuilder.h"
+#include "SceneCache.h"
 #include "Importer.h"
 #include "Scene/Material/SerializedMaterialParams.h"
 #include "Curves/CurveConfig.h"
@@ -63,9 +65,12 @@ namespace Falcor
 
     namespace
     {
-        // Large scenes are split into multiple BLAS groups in order to reduce build memory usage.
-        // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
-        const size_t kMaxBLASBuildMemory = 1ull << 29;
+        // Matrix ID used for TLAS instance descs that have an identity transform.
+        const uint32_t kIdentityMatrixID = std::numeric_limits<uint32_t>::max();
+
+        // Dirty ranges separated by at most this many clean elements are uploaded together.
+        // Re-uploading a few unchanged elements is cheaper than issuing a separate copy.
+        const uint32_t kMaxUploadRangeGap = 8;
 
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
@@ -178,6 +183,8 @@ namespace Falcor
         mpEnvMap = sceneData.pEnvMap;
         mSceneGraph = std::move(sceneData.sceneGraph);
         mMetadata = std::move(sceneData.metadata);
+        mSceneCacheKey = sceneData.sceneCacheKey;
+        mBlasBuildCache = std::move(sceneData.blasBuildCache);
 
         // Merge all geometry instance lists into one.
         mGeometryInstanceData.reserve(sceneData.meshInstanceData.size() + sceneData.curveInstanceData.size() + sceneData.sdfGridInstances.size());
@@ -185,6 +192,13 @@ namespace Falcor
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.curveInstanceData), std::end(sceneData.curveInstanceData));
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.sdfGridInstances), std::end(sceneData.sdfGridInstances));
 
+        // Setup tracking of instances affected by transform changes.
+        {
+            std::vector<uint32_t> instanceMatrixIDs(mGeometryInstanceData.size());
+            for (size_t i = 0; i < mGeometryInstanceData.size(); i++) instanceMatrixIDs[i] = mGeometryInstanceData[i].globalMatrixID;
+            mDirtyInstances.setInstanceMatrices((uint32_t)mSceneGraph.size(), instanceMatrixIDs);
+        }
+
         mMeshDesc = std::move(sceneData.meshDesc);
         mMeshNames = std::move(sceneData.meshNames);
         mMeshBBs = std::move(sceneData.meshBBs);
@@ -902,43 +916,67 @@ namespace Falcor
         }
     }
 
-    void Scene::updateGeometryInstances(bool forceUpdate)
+    bool Scene::updateGeometryInstanceFlags(GeometryInstanceData& inst) const
     {
-        if (mGeometryInstanceData.empty()) return;
+        if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh) return false;
 
-        bool dataChanged = false;
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        uint32_t prevFlags = inst.flags;
 
-        for (auto& inst : mGeometryInstanceData)
-        {
-            if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
-            {
-                uint32_t prevFlags = inst.flags;
+        FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
+        const float4x4& transform = globalMatrices[inst.globalMatrixID];
+        bool isTransformFlipped = doesTransformFlip(transform);
+        bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
+        bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+
+        if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
 
-                FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
-                const float4x4& transform = globalMatrices[inst.globalMatrixID];
-                bool isTransformFlipped = doesTransformFlip(transform);
-                bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
-                bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+        if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
 
-                if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+        if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
 
-                if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        return inst.flags != prevFlags;
+    }
+
+    void Scene::updateGeometryInstances(bool forceUpdate)
+    {
+        if (mGeometryInstanceData.empty()) return;
 
-                if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        if (forceUpdate) mDirtyInstances.markAllDirty();
 
-                dataChanged |= (inst.flags != prevFlags);
-            }
+        // Only instances whose transforms changed need to be visited. The instance flags depend on the transform only,
+        // and the TLAS instance desc of a dirty instance needs a new transform.
+        std::vector<uint32_t> changedInstances;
+        for (uint32_t instanceID : mDirtyInstances.getDirtyInstances())
+        {
+            auto& inst = mGeometryInstanceData[instanceID];
+            if (updateGeometryInstanceFlags(inst)) changedInstances.push_back(instanceID);
+            if (mInstanceDescsValid) mDirtyInstanceDescs.markDirty(inst.instanceIndex);
         }
 
-        if (forceUpdate || dataChanged)
+        mSceneStats.dirtyInstanceCount = mDirtyInstances.getDirtyCount();
+        mSceneStats.instanceUploadRangeCount = 0;
+
+        if (forceUpdate)
         {
             uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
             mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+            mSceneStats.instanceUploadRangeCount = 1;
+        }
+        else
+        {
+            // Upload the changed instances in coalesced ranges.
+            for (const auto& range : DirtyInstanceTracker::coalesce(changedInstances, kMaxUploadRangeGap))
+            {
+                mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data() + range.offset, range.offset * sizeof(GeometryInstanceData), range.count * sizeof(GeometryInstanceData));
+                mSceneStats.instanceUploadRangeCount++;
+            }
         }
+
+        mDirtyInstances.clear();
     }
 
     IScene::UpdateFlags Scene::updateRaytracingAABBData(bool forceUpdate)
@@ -1481,6 +1519,7 @@ namespace Falcor
             }
         }
         if (mpTlasScratch) s.tlasScratchMemoryInBytes += mpTlasScratch->getSize();
+        if (mpInstanceDescsBuffer) s.tlasScratchMemoryInBytes += mpInstanceDescsBuffer->getSize();
     }
 
     void Scene::updateLightStats()
@@ -1869,13 +1908,9 @@ namespace Falcor
             mUpdates |= IScene::UpdateFlags::SceneGraphChanged;
             if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= IScene::UpdateFlags::MeshesChanged;
 
-            for (const auto& inst : mGeometryInstanceData)
-            {
-                if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
-                {
-                    mUpdates |= IScene::UpdateFlags::GeometryMoved;
-                }
-            }
+            // Find the instances whose transforms changed. Only the referenced matrices are checked.
+            mDirtyInstances.markChangedMatrices([&](uint32_t matrixID) { return mpAnimationController->isMatrixChanged(NodeID{ matrixID }); });
+            if (!mDirtyInstances.empty()) mUpdates |= IScene::UpdateFlags::GeometryMoved;
 
             // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
             if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= IScene::UpdateFlags::CurvesMoved;
@@ -2199,6 +2234,14 @@ namespace Falcor
                 << "  TLAS memory (scratch): " << formatByteSize(s.tlasScratchMemoryInBytes) << std::endl
                 << std::endl;
 
+            // Per-frame update stats.
+            oss << "Update stats (last update):" << std::endl
+                << "  Dirty instances: " << s.dirtyInstanceCount << std::endl
+                << "  Instance upload ranges: " << s.instanceUploadRangeCount << std::endl
+                << "  TLAS instance descs updated: " << s.instanceDescUpdateCount << std::endl
+                << "  TLAS instance desc upload ranges: " << s.instanceDescUploadRangeCount << std::endl
+                << std::endl;
+
             // Material stats.
             oss << "Materials stats:" << std::endl
                 << "  Material types: " << s.materials.materialTypeCount << std::endl
@@ -3106,33 +3149,32 @@ namespace Falcor
     void Scene::computeBlasGroups()
     {
         mBlasGroups.clear();
-        uint64_t groupSize = 0;
 
-        for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        // Pack the BLASes into as few groups as possible while keeping the peak build memory within the target.
+        // Large scenes are split into multiple BLAS groups in order to reduce build memory usage.
+        // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
+        std::vector<BlasBuildSize> sizes(mBlasData.size());
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            sizes[blasId] = { mBlasData[blasId].resultByteSize, mBlasData[blasId].scratchByteSize };
+        }
+
+        for (auto& blasIndices : computeBlasGroupPacking(sizes, kDefaultBlasBuildMemoryBudget, BlasGroupPacking::FirstFitDecreasing))
         {
-            auto& blas = mBlasData[blasId];
-            size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
+            auto& group = mBlasGroups.emplace_back();
+            group.blasIndices = std::move(blasIndices);
 
-            // Start new BLAS group on first iteration or if group size would exceed the target.
-            if (groupSize == 0 || groupSize + blasSize > kMaxBLASBuildMemory)
+            for (uint32_t blasId : group.blasIndices)
             {
-                mBlasGroups.push_back({});
-                groupSize = 0;
+                auto& blas = mBlasData[blasId];
+                blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
+
+                // Update data offsets and sizes.
+                blas.resultByteOffset = group.resultByteSize;
+                blas.scratchByteOffset = group.scratchByteSize;
+                group.resultByteSize += blas.resultByteSize;
+                group.scratchByteSize += blas.scratchByteSize;
             }
-
-            // Add BLAS to current group.
-            FALCOR_ASSERT(mBlasGroups.size() > 0);
-            auto& group = mBlasGroups.back();
-            group.blasIndices.push_back(blasId);
-            blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
-
-            // Update data offsets and sizes.
-            blas.resultByteOffset = group.resultByteSize;
-            blas.scratchByteOffset = group.scratchByteSize;
-            group.resultByteSize += blas.resultByteSize;
-            group.scratchByteSize += blas.scratchByteSize;
-
-            groupSize += blasSize;
         }
 
         // Validation that all offsets and sizes are correct.
@@ -3240,7 +3282,9 @@ namespace Falcor
         if (mRebuildBlas)
         {
             // Invalidate any previous TLASes as they won't be valid anymore.
+            // The instance descs reference the BLASes by address and need to be regenerated.
             invalidateTlasCache();
+            mInstanceDescsValid = false;
 
             if (mBlasData.empty())
             {
@@ -3436,6 +3480,7 @@ namespace Falcor
                 if (!hasDynamicGeometry && !hasProceduralPrimitives) mpBlasScratch.reset();
             }
 
+            updateBlasBuildCache();
             updateRaytracingBLASStats();
             mRebuildBlas = false;
             return;
@@ -3502,9 +3547,62 @@ namespace Falcor
         }
     }
 
-    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
+    void Scene::updateBlasBuildCache()
+    {
+        // Record the build inputs and sizes of the BLASes just built. Device addresses are not recorded,
+        // the inputs only describe the amount and layout of the geometry.
+        BlasBuildCache cache;
+        cache.deviceName = mpDevice->getInfo().adapterName + " (" + mpDevice->getInfo().apiName + ")";
+        cache.blases.reserve(mBlasData.size());
+
+        for (const auto& blas : mBlasData)
+        {
+            auto& record = cache.blases.emplace_back();
+            record.buildFlags = blas.buildInputs.flags;
+            record.prebuildInfo = blas.prebuildInfo;
+            record.finalByteSize = blas.blasByteSize;
+
+            record.geometries.reserve(blas.geomDescs.size());
+            for (const auto& desc : blas.geomDescs)
+            {
+                auto& geometry = record.geometries.emplace_back();
+                geometry.type = desc.type;
+                geometry.flags = desc.flags;
+                if (desc.type == RtGeometryType::Triangles)
+                {
+                    geometry.vertexCount = desc.content.triangles.vertexCount;
+                    geometry.indexCount = desc.content.triangles.indexCount;
+                    geometry.indexFormat = desc.content.triangles.indexFormat;
+                    geometry.hasTransform = desc.content.triangles.transform3x4 != 0;
+                }
+                else
+                {
+                    geometry.aabbCount = desc.content.proceduralAABBs.count;
+                }
+            }
+        }
+
+        if (cache == mBlasBuildCache) return;
+        mBlasBuildCache = std::move(cache);
+
+        // Store the records next to the scene cache, so tools can report the memory usage without a device.
+        if (mSceneCacheKey)
+        {
+            try
+            {
+                SceneCache::writeBlasBuildCache(mBlasBuildCache, *mSceneCacheKey);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to write BLAS build cache: {}", e.what());
+            }
+        }
+    }
+
+    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& instanceDescMatrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const
     {
         instanceDescs.clear();
+        instanceDescMatrixIDs.clear();
         uint32_t instanceContributionToHitGroupIndex = 0;
         uint32_t instanceID = 0;
 
@@ -3568,12 +3666,14 @@ namespace Falcor
                 instanceID += (uint32_t)meshList.size();
 
                 float4x4 transform4x4 = float4x4::identity();
+                uint32_t descMatrixID = kIdentityMatrixID;
                 if (!isStatic)
                 {
                     // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
                     // Just pick the matrix from the first mesh.
                     const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
                     transform4x4 = mpAnimationController->getGlobalMatrices()[matrixId];
+                    descMatrixID = matrixId;
 
                     // Verify that all meshes have matching tranforms.
                     for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
@@ -3591,6 +3691,7 @@ namespace Falcor
                 }
 
                 instanceDescs.push_back(desc);
+                instanceDescMatrixIDs.push_back(descMatrixID);
             }
         }
 
@@ -3632,6 +3733,7 @@ namespace Falcor
             }
 
             instanceDescs.push_back(desc);
+            instanceDescMatrixIDs.push_back(matrixId);
         }
 
         // One instance per SDF grid instance.
@@ -3675,6 +3777,7 @@ namespace Falcor
                 FALCOR_ASSERT(0 == instance.geometryIndex);
 
                 instanceDescs.push_back(desc);
+                instanceDescMatrixIDs.push_back(instance.globalMatrixID);
             }
 
             blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -3702,6 +3805,23 @@ namespace Falcor
             float4x4 identityMat = float4x4::identity();
             std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
             instanceDescs.push_back(desc);
+            instanceDescMatrixIDs.push_back(kIdentityMatrixID);
+        }
+
+        FALCOR_ASSERT(instanceDescMatrixIDs.size() == instanceDescs.size());
+    }
+
+    void Scene::updateInstanceDescTransforms()
+    {
+        FALCOR_ASSERT(mInstanceDescsValid && mInstanceDescMatrixIDs.size() == mInstanceDescs.size());
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        for (uint32_t descIndex : mDirtyInstanceDescs.getDirtyInstances())
+        {
+            const uint32_t matrixID = mInstanceDescMatrixIDs[descIndex];
+            if (matrixID == kIdentityMatrixID) continue;
+            FALCOR_ASSERT(matrixID < globalMatrices.size());
+            mInstanceDescs[descIndex].setTransform(globalMatrices[matrixID]);
         }
     }
 
@@ -3724,7 +3844,20 @@ namespace Falcor
 
         // Prepare instance descs.
         // Note if there are no instances, we'll build an empty TLAS.
-        fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+        // If the descs were generated for the same hit group indexing, only the transforms of the descs of moved instances are updated.
+        bool fullDescUpdate = !mInstanceDescsValid || mInstanceDescsRayTypeCount != rayTypeCount || mInstanceDescsPerMeshHitEntry != perMeshHitEntry;
+        if (fullDescUpdate)
+        {
+            fillInstanceDesc(mInstanceDescs, mInstanceDescMatrixIDs, rayTypeCount, perMeshHitEntry);
+            mInstanceDescsRayTypeCount = rayTypeCount;
+            mInstanceDescsPerMeshHitEntry = perMeshHitEntry;
+            mDirtyInstanceDescs.resize((uint32_t)mInstanceDescs.size());
+            mDirtyInstanceDescs.markAllDirty();
+        }
+        else
+        {
+            updateInstanceDescTransforms();
+        }
 
         RtAccelerationStructureBuildInputs inputs = {};
         inputs.kind = RtAccelerationStructureKind::TopLevel;
@@ -3786,14 +3919,33 @@ namespace Falcor
 
         FALCOR_ASSERT(tlas.pTlasBuffer && tlas.pTlasBuffer->getGfxResource() && mpTlasScratch->getGfxResource());
 
-        // Upload instance data
+        // Upload instance data.
+        // The descs are kept in a persistent buffer so that only the modified descs need to be uploaded.
+        mSceneStats.instanceDescUpdateCount = mDirtyInstanceDescs.getDirtyCount();
+        mSceneStats.instanceDescUploadRangeCount = 0;
         if (inputs.descCount > 0)
         {
-            GpuMemoryHeap::Allocation allocation = mpDevice->getUploadHeap()->allocate(inputs.descCount * sizeof(RtInstanceDesc), sizeof(RtInstanceDesc));
-            std::memcpy(allocation.pData, mInstanceDescs.data(), inputs.descCount * sizeof(RtInstanceDesc));
-            asDesc.inputs.instanceDescs = allocation.getGpuAddress();
-            mpDevice->getUploadHeap()->release(allocation);
+            if (!mpInstanceDescsBuffer || mpInstanceDescsBuffer->getSize() < inputs.descCount * sizeof(RtInstanceDesc))
+            {
+                mpInstanceDescsBuffer = mpDevice->createBuffer(inputs.descCount * sizeof(RtInstanceDesc), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, mInstanceDescs.data());
+                mpInstanceDescsBuffer->setName("Scene::mpInstanceDescsBuffer");
+                mSceneStats.instanceDescUploadRangeCount = 1;
+            }
+            else
+            {
+                for (const auto& range : mDirtyInstanceDescs.getDirtyRanges(kMaxUploadRangeGap))
+                {
+                    mpInstanceDescsBuffer->setBlob(mInstanceDescs.data() + range.offset, range.offset * sizeof(RtInstanceDesc), range.count * sizeof(RtInstanceDesc));
+                    mSceneStats.instanceDescUploadRangeCount++;
+                }
+            }
+
+            // Transition the resource to non-pixel shader state as expected by DXR.
+            pRenderContext->resourceBarrier(mpInstanceDescsBuffer.get(), Resource::State::NonPixelShader);
+            asDesc.inputs.instanceDescs = mpInstanceDescsBuffer->getGpuAddress();
         }
+        mDirtyInstanceDescs.clear();
+        mInstanceDescsValid = true;
         asDesc.scratchData = mpTlasScratch->getGpuAddress();
         asDesc.dest = tlas.pTlasObject.get();
 
@@ -4161,6 +4313,12 @@ namespace Falcor
         d["tlasMemoryInBytes"] = stats.tlasMemoryInBytes;
         d["tlasScratchMemoryInBytes"] = stats.tlasScratchMemoryInBytes;
 
+        // Per-frame update stats
+        d["dirtyInstanceCount"] = stats.dirtyInstanceCount;
+        d["instanceUploadRangeCount"] = stats.instanceUploadRangeCount;
+        d["instanceDescUpdateCount"] = stats.instanceDescUpdateCount;
+        d["instanceDescUploadRangeCount"] = stats.instanceDescUploadRangeCount;
+
         // Light stats
         d["activeLightCount"] = stats.activeLightCount;
         d["totalLightCount"] = stats.totalLightCount;
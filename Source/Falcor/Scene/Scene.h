@@ -27,8 +27,10 @@
  **************************************************************************/
 #pragma once
 #include "SceneIDs.h"
+#include "BlasBuildCache.h"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "DirtyInstanceTracker.h"
 #include "IScene.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
@@ -48,6 +50,7 @@
 #include "Core/Object.h"
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Rectangle.h"
 #include "Utils/Math/Vector.h"
@@ -298,6 +301,10 @@ namespace Falcor
             // Custom primitive data
             std::vector<CustomPrimitiveDesc> customPrimitiveDesc;   ///< Custom primitive descriptors.
             std::vector<AABB> customPrimitiveAABBs;                 ///< List of AABBs for custom primitives in world space. Each custom primitive consists of one AABB.
+
+            // Scene cache data
+            std::optional<SHA1::MD> sceneCacheKey;                  ///< Key of the scene cache holding this scene, if any.
+            BlasBuildCache blasBuildCache;                          ///< BLAS build inputs and sizes observed the last time the scene was built.
         };
 
         /** Statistics.
@@ -353,6 +360,12 @@ namespace Falcor
             uint64_t tlasMemoryInBytes = 0;             ///< Total memory in bytes used by the TLASes.
             uint64_t tlasScratchMemoryInBytes = 0;      ///< Additional memory in bytes kept around for TLAS updates etc.
 
+            // Per-frame update stats
+            uint64_t dirtyInstanceCount = 0;            ///< Number of geometry instances updated in the last geometry instance update.
+            uint64_t instanceUploadRangeCount = 0;      ///< Number of contiguous ranges of geometry instances uploaded in the last update.
+            uint64_t instanceDescUpdateCount = 0;       ///< Number of TLAS instance descs updated in the last TLAS build.
+            uint64_t instanceDescUploadRangeCount = 0;  ///< Number of contiguous ranges of TLAS instance descs uploaded in the last TLAS build.
+
             // Light stats
             uint64_t activeLightCount = 0;              ///< Number of active lights.
             uint64_t totalLightCount = 0;               ///< Number of lights in the scene.
@@ -1134,9 +1147,15 @@ namespace Falcor
         void updateBounds();
 
         /** Update geometry instances.
+            Only the instances marked in mDirtyInstances are updated, unless forceUpdate is set.
         */
         void updateGeometryInstances(bool forceUpdate);
 
+        /** Update the flags of a geometry instance based on its current transform.
+            \return True if the flags changed.
+        */
+        bool updateGeometryInstanceFlags(GeometryInstanceData& inst) const;
+
         /** Update geometry type flags.
         */
         void updateGeometryTypes();
@@ -1165,10 +1184,19 @@ namespace Falcor
         */
         void buildBlas(RenderContext* pRenderContext);
 
+        /** Record the build inputs and sizes of all BLASes after a full build, and store them in the scene cache if they changed.
+        */
+        void updateBlasBuildCache();
+
         /** Generate data for creating a TLAS.
             #SCENE TODO: Add argument to build descs based off a draw list.
         */
-        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& instanceDescMatrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+
+        /** Update the transforms of the TLAS instance descs marked in mDirtyInstanceDescs.
+            The descs must have been generated by fillInstanceDesc() before.
+        */
+        void updateInstanceDescTransforms();
 
         /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
             \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1366,6 +1394,14 @@ namespace Falcor
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
 
         std::vector<RtInstanceDesc> mInstanceDescs;         ///< Shared between TLAS builds to avoid reallocating CPU memory.
+        std::vector<uint32_t> mInstanceDescMatrixIDs;       ///< Global matrix ID for each instance desc, or an invalid ID if the desc has an identity transform.
+        bool mInstanceDescsValid = false;                   ///< True if mInstanceDescs and mpInstanceDescsBuffer are up-to-date except for the instances in mDirtyInstanceDescs.
+        uint32_t mInstanceDescsRayTypeCount = 0;            ///< Ray type count mInstanceDescs were generated for.
+        bool mInstanceDescsPerMeshHitEntry = false;         ///< Hit group indexing mInstanceDescs were generated for.
+        ref<Buffer> mpInstanceDescsBuffer;                  ///< GPU copy of mInstanceDescs used as TLAS build input.
+
+        DirtyInstanceTracker mDirtyInstances;               ///< Geometry instances whose transforms changed since the last call to updateGeometryInstances().
+        DirtyInstanceTracker mDirtyInstanceDescs;           ///< TLAS instance descs whose transforms changed since the last TLAS build.
 
         struct TlasData
         {
@@ -1431,6 +1467,8 @@ namespace Falcor
         ref<Buffer> mpBlasStaticWorldMatrices;              ///< Object-to-world transform matrices in row-major format. Only valid for static meshes.
         bool mBlasDataValid = false;                        ///< Flag to indicate if the BLAS data is valid. This will be reset when geometry is changed.
         bool mRebuildBlas = true;                           ///< Flag to indicate BLASes need to be rebuilt.
+        std::optional<SHA1::MD> mSceneCacheKey;             ///< Key of the scene cache this scene was loaded from or written to, if any.
+        BlasBuildCache mBlasBuildCache;                     ///< BLAS build records read from or written to the scene cache.
 
         std::vector<std::filesystem::path> mImportPaths;    ///< Vector of paths to assets loaded to create scene.
         std::vector<SceneData::ImportDict> mImportDicts;    ///< Vector of dictionaries associated with each asset loaded to create scene.
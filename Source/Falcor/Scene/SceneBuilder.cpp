@@ -28,6 +28,7 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "VertexCacheOptimizer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
@@ -35,21 +36,40 @@
 #include "Utils/Image/TextureAnalyzer.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Core/API/PythonHelpers.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/NumericRange.h"
+#include "Utils/ScratchArena.h"
 #include <mikktspace.h>
+#include <algorithm>
+#include <array>
 #include <filesystem>
 #include <cmath>
 #include <execution>
+#include <limits>
+#include <unordered_map>
 
 namespace Falcor
 {
     namespace
     {
         // Large mesh groups are split in order to reduce the size of the largest BLAS.
-        // The target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
-        const size_t kMaxTrianglesPerBLAS = 1ull << 24;
+        // The default target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
+        const uint64_t kDefaultMaxTrianglesPerBLAS = 1ull << 24;
+
+        // Parameters of the binned SAH mesh group splitting.
+        // The overlap weight scales the penalty for the surface area of the intersection of the two halves.
+        const size_t kSAHBinCount = 16;
+        const double kSAHOverlapWeight = 1.0;
+
+        // Settings options controlling mesh group splitting.
+        const char kMeshGroupSplitStrategyOption[] = "SceneBuilder:meshGroupSplitStrategy";
+        const char kMeshGroupSplitReportOption[] = "SceneBuilder:meshGroupSplitReport";
+        const char kMaxTrianglesPerBLASOption[] = "SceneBuilder:maxTrianglesPerBLAS";
+
+        // Settings option controlling whether SDF grids with identical content are merged.
+        const char kMergeSDFGridsByContentOption[] = "SceneBuilder:mergeSDFGridsByContent";
 
         // Texture coordinates for textured emissive materials are quantized for performance reasons.
         // We'll log a warning if the maximum quantization error exceeds this value.
@@ -65,13 +85,22 @@ namespace Falcor
         class MikkTSpaceWrapper
         {
         public:
-            static std::vector<float4> generateTangents(const SceneBuilder::Mesh& mesh)
+            static bool hasRequiredAttributes(const SceneBuilder::Mesh& mesh)
             {
                 if (!mesh.normals.pData || !mesh.positions.pData || !mesh.texCrds.pData || !mesh.pIndices)
                 {
                     logWarning("Can't generate tangent space. The mesh '{}' doesn't have positions/normals/texCrd/indices.", mesh.name);
-                    return {};
+                    return false;
                 }
+                return true;
+            }
+
+            /** Generate tangents into the given array, which must hold one tangent per index.
+                Temporary storage is drawn from the given scratch arena.
+            */
+            static void generateTangents(const SceneBuilder::Mesh& mesh, float4* pTangents, ScratchArena& arena)
+            {
+                FALCOR_ASSERT(hasRequiredAttributes(mesh));
 
                 // Generate new tangent space.
                 SMikkTSpaceInterface mikktspace = {};
@@ -82,7 +111,8 @@ namespace Falcor
                 mikktspace.m_getTexCoord = [](const SMikkTSpaceContext* pContext, float texCrd[], int32_t face, int32_t vert) { ((MikkTSpaceWrapper*)(pContext->m_pUserData))->getTexCrd(texCrd, face, vert); };
                 mikktspace.m_setTSpaceBasic = [](const SMikkTSpaceContext* pContext, const float tangent[], float sign, int32_t face, int32_t vert) { ((MikkTSpaceWrapper*)(pContext->m_pUserData))->setTangent(tangent, sign, face, vert); };
 
-                MikkTSpaceWrapper wrapper(mesh);
+                ScratchArena::Scope scratch(arena);
+                MikkTSpaceWrapper wrapper(mesh, pTangents, scratch.getArena());
                 SMikkTSpaceContext context = {};
                 context.m_pInterface = &mikktspace;
                 context.m_pUserData = &wrapper;
@@ -91,16 +121,16 @@ namespace Falcor
                 {
                     FALCOR_THROW("MikkTSpace failed to generate tangents for the mesh '{}'.", mesh.name);
                 }
-
-                return wrapper.mTangents;
             }
 
         private:
-            MikkTSpaceWrapper(const SceneBuilder::Mesh& mesh)
+            MikkTSpaceWrapper(const SceneBuilder::Mesh& mesh, float4* pTangents, ScratchArena& arena)
                 : mMesh(mesh)
+                , mpTangents(pTangents)
+                , mPositions(arena)
             {
                 FALCOR_ASSERT(mesh.indexCount > 0);
-                mTangents.resize(mesh.indexCount, float4(0));
+                std::fill_n(mpTangents, mesh.indexCount, float4(0));
 
                 FALCOR_ASSERT_EQ(mesh.indexCount, mMesh.faceCount * 3);
                 mPositions.resize(mMesh.faceCount * 3);
@@ -135,8 +165,8 @@ namespace Falcor
 
             }
             const SceneBuilder::Mesh& mMesh;
-            std::vector<float4> mTangents;
-            std::vector<float3> mPositions;
+            float4* mpTangents;
+            ScratchVector<float3> mPositions;
             int32_t getFaceCount() const { return (int32_t)mMesh.faceCount; }
             void getPosition(float position[], int32_t face, int32_t vert) const { FALCOR_ASSERT_LT(size_t(face) * 3 + vert, mPositions.size()); memcpy(position, mPositions.data() + (face * 3 + vert), sizeof(float3)); }
             void getNormal(float normal[], int32_t face, int32_t vert) { *reinterpret_cast<float3*>(normal) = mMesh.getNormal(face, vert); }
@@ -145,10 +175,45 @@ namespace Falcor
             void setTangent(const float tangent[], float sign, int32_t face, int32_t vert)
             {
                 float3 T = *reinterpret_cast<const float3*>(tangent);
-                mTangents[face * 3 + vert] = float4(normalize(T), sign);
+                mpTangents[face * 3 + vert] = float4(normalize(T), sign);
             }
         };
 
+        /** Generate the tangent space for a mesh and point the mesh tangents at the result.
+            The tangents are stored in 'tangents', which can be a std::vector or a ScratchVector.
+        */
+        template<typename TangentVector>
+        void generateTangentSpace(SceneBuilder::Mesh& mesh, TangentVector& tangents, ScratchArena& arena = ScratchArena::getThreadLocal())
+        {
+            if (!MikkTSpaceWrapper::hasRequiredAttributes(mesh))
+            {
+                tangents.clear();
+                mesh.tangents.pData = nullptr;
+                mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::None;
+                return;
+            }
+
+            tangents.resize(mesh.indexCount);
+            MikkTSpaceWrapper::generateTangents(mesh, tangents.data(), arena);
+
+            mesh.tangents.pData = tangents.data();
+            mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::FaceVarying;
+
+            /// MikkTSpace can produces NaN tangents in case of degenerate triangles,
+            /// e.g. triangles where all three points, normals, and texture coordinates happen to be identical.
+            /// We are replacing these NaN tangents by arbitrary tangent orthonormal to the vertex normal
+            NumericRange<uint32_t> range(0, mesh.indexCount);
+            std::for_each(std::execution::par_unseq, range.begin(), range.end(), [&](uint32_t fvIndex)
+            {
+                if (!any(isnan(mesh.tangents.pData[fvIndex])))
+                    return;
+                uint32_t faceIndex = fvIndex / 3;
+                uint32_t vertexIndex = fvIndex % 3;
+                float3 normal = mesh.getNormal(faceIndex, vertexIndex);
+                tangents[fvIndex] = float4(perp_stark(normal), 1.f);
+            });
+        }
+
         void validateVertex(const SceneBuilder::Mesh::Vertex& v, size_t& invalidCount, size_t& zeroCount)
         {
             auto isInvalid = [](const auto& x)
@@ -177,16 +242,16 @@ namespace Falcor
             return true;
         }
 
-        std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
+        std::vector<uint32_t> compact16BitIndices(const uint32_t* pIndices, size_t indexCount)
         {
-            if (indices.empty()) return {};
-            size_t sz = div_round_up(indices.size(), (std::size_t)2); // Storing two 16-bit indices per dword.
+            if (indexCount == 0) return {};
+            size_t sz = div_round_up(indexCount, (std::size_t)2); // Storing two 16-bit indices per dword.
             std::vector<uint32_t> indexData(sz);
-            uint16_t* pIndices = reinterpret_cast<uint16_t*>(indexData.data());
-            for (size_t i = 0; i < indices.size(); i++)
+            uint16_t* pCompactIndices = reinterpret_cast<uint16_t*>(indexData.data());
+            for (size_t i = 0; i < indexCount; i++)
             {
-                FALCOR_ASSERT(indices[i] < (1u << 16));
-                pIndices[i] = static_cast<uint16_t>(indices[i]);
+                FALCOR_ASSERT(pIndices[i] < (1u << 16));
+                pCompactIndices[i] = static_cast<uint16_t>(pIndices[i]);
             }
             return indexData;
         }
@@ -210,6 +275,7 @@ namespace Falcor
     {
         mAssetResolver = AssetResolver::getDefaultResolver();
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+        mScratchStatsAtStart = ScratchArena::getGlobalStats();
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -230,7 +296,12 @@ namespace Falcor
         mWriteSceneCache = useCache || rebuildCache;
 
         // Try to load scene cache if supported, available and requested.
-        if (useCache && !rebuildCache && SceneCache::hasValidCache(mSceneCacheKey))
+        // If the cache is missing, this process becomes its builder, other processes wait for it to write the cache.
+        bool cacheFound = false;
+        if (useCache && !rebuildCache) cacheFound = SceneCache::findCache(mSceneCacheKey, mSceneCacheBuildLock);
+        else if (rebuildCache) mSceneCacheBuildLock = SceneCache::lockForBuild(mSceneCacheKey);
+
+        if (cacheFound)
         {
             try
             {
@@ -239,7 +310,9 @@ namespace Falcor
             }
             catch (const std::exception& e)
             {
-                throw ImporterError(resolvedPath, "Failed to load scene cache: {}", e.what());
+                // The cache can be evicted or replaced by another process after it was found. Rebuild it instead of failing.
+                logWarning("Failed to load scene cache, importing '{}' instead: {}", resolvedPath, e.what());
+                mSceneCacheBuildLock = SceneCache::lockForBuild(mSceneCacheKey);
             }
         }
 
@@ -254,6 +327,16 @@ namespace Falcor
 
     SceneBuilder::~SceneBuilder() {}
 
+    std::optional<BlasMemoryReport> SceneBuilder::getCachedBlasMemoryReport(const std::filesystem::path& path, Flags flags)
+    {
+        std::filesystem::path resolvedPath = AssetResolver::getDefaultResolver().resolvePath(path, AssetCategory::Scene);
+        if (resolvedPath.empty()) FALCOR_THROW("Can't find scene file '{}'.", path);
+
+        auto blasBuildCache = SceneCache::readBlasBuildCache(computeSceneCacheKey(resolvedPath, flags));
+        if (!blasBuildCache) return {};
+        return computeBlasMemoryReport(*blasBuildCache);
+    }
+
     inline std::map<std::string, std::string> convertDictToMap(const pybind11::dict& dict_)
     {
         std::map<std::string, std::string> dict;
@@ -394,7 +477,8 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, std::move(mSceneCacheBuildLock));
+            mSceneData.sceneCacheKey = mSceneCacheKey;
             timeReport.measure("Writing cache");
         }
 
@@ -405,6 +489,14 @@ namespace Falcor
         timeReport.measure("Creating resources");
         timeReport.printToLog();
 
+        // The statistics are global, so they include builders running concurrently on other threads.
+        auto scratchStats = ScratchArena::getGlobalStats();
+        scratchStats -= mScratchStatsAtStart;
+        logDebug("Scratch arenas served {} allocations ({} from the system allocator) in {} scopes.", scratchStats.allocationCount, scratchStats.heapAllocationCount, scratchStats.scopeCount);
+
+        // Give back the peak scratch memory of this thread. Arenas of worker threads keep at most their maximum retained capacity.
+        ScratchArena::getThreadLocal().trim(ScratchArena::kDefaultBlockSize);
+
         return mpScene;
     }
 
@@ -449,7 +541,7 @@ namespace Falcor
         return addMesh(mesh);
     }
 
-    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices, std::vector<float4>* pTangents) const
+    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices, std::vector<float4>* pTangents, ScratchArena* pScratchArena) const
     {
         // This function preprocesses a mesh into the final runtime representation.
         // Note the function needs to be thread safe. The following steps are performed:
@@ -458,6 +550,9 @@ namespace Falcor
         //  - Merge identical vertices, compute new indices (optional)
         //  - Validate final vertex data
         //  - Compact vertices/indices into runtime format
+        // Temporary data is allocated from the given or thread-local scratch arena, which is reset when the function returns.
+
+        ScratchArena::Scope scratch(pScratchArena ? *pScratchArena : ScratchArena::getThreadLocal());
 
         // Copy the mesh desc so we can update it. The caller retains the ownership of the data.
         Mesh mesh = mesh_;
@@ -500,16 +595,15 @@ namespace Falcor
         }
 
         // Generate tangent space if that's required.
-        std::vector<float4> localTangents;
-        if (!pTangents)
-            pTangents = &localTangents;
+        ScratchVector<float4> localTangents(scratch.getArena());
         if (!(is_set(mFlags, Flags::UseOriginalTangentSpace) || mesh.useOriginalTangentSpace) || !mesh.tangents.pData)
         {
-            generateTangents(mesh, *pTangents);
+            if (pTangents) generateTangentSpace(mesh, *pTangents, scratch.getArena());
+            else generateTangentSpace(mesh, localTangents, scratch.getArena());
         }
 
         // Pretransform the texture coordinates, rather than transforming them at runtime.
-        std::vector<float2> transformedTexCoords;
+        ScratchVector<float2> transformedTexCoords(scratch.getArena());
         if (mesh.texCrds.pData != nullptr)
         {
             const float4x4 xform = mesh.pMaterial->getTextureTransform().getMatrix();
@@ -545,8 +639,8 @@ namespace Falcor
         // This ensures that adding to the linked lists do not require any dynamic memory allocation.
         //
         const uint32_t invalidIndex = 0xffffffff;
-        std::vector<std::pair<Mesh::Vertex, uint32_t>> vertices;
-        std::vector<uint32_t> indices(mesh.indexCount);
+        ScratchVector<std::pair<Mesh::Vertex, uint32_t>> vertices(scratch.getArena());
+        ScratchVector<uint32_t> indices(mesh.indexCount, scratch.getArena());
 
         if (pAttributeIndices)
         {
@@ -557,7 +651,7 @@ namespace Falcor
         {
             vertices.reserve(mesh.vertexCount);
 
-            std::vector<uint32_t> heads(mesh.vertexCount, invalidIndex);
+            ScratchVector<uint32_t> heads(mesh.vertexCount, invalidIndex, scratch.getArena());
 
             for (uint32_t face = 0; face < mesh.faceCount; face++)
             {
@@ -604,7 +698,7 @@ namespace Falcor
         }
         else
         {
-            vertices = { mesh.vertexCount, std::make_pair(Mesh::Vertex{}, invalidIndex) };
+            vertices.assign(mesh.vertexCount, std::make_pair(Mesh::Vertex{}, invalidIndex));
 
             for (uint32_t face = 0; face < mesh.faceCount; face++)
             {
@@ -658,8 +752,8 @@ namespace Falcor
             processedMesh.indexCount = indices.size();
             processedMesh.use16BitIndices = (vertices.size() <= (1u << 16)) && !(is_set(mFlags, Flags::Force32BitIndices));
 
-            if (!processedMesh.use16BitIndices) processedMesh.indexData = std::move(indices);
-            else processedMesh.indexData = compact16BitIndices(indices);
+            if (!processedMesh.use16BitIndices) processedMesh.indexData.assign(indices.begin(), indices.end());
+            else processedMesh.indexData = compact16BitIndices(indices.data(), indices.size());
         }
 
         // Copy vertices into processed mesh.
@@ -699,36 +793,7 @@ namespace Falcor
 
     void SceneBuilder::generateTangents(Mesh& mesh, std::vector<float4>& tangents)
     {
-        tangents = MikkTSpaceWrapper::generateTangents(mesh);
-        if (!tangents.empty())
-        {
-            FALCOR_ASSERT(tangents.size() == mesh.indexCount);
-            mesh.tangents.pData = tangents.data();
-            mesh.tangents.frequency = Mesh::AttributeFrequency::FaceVarying;
-
-            /// MikkTSpace can produces NaN tangents in case of degenerate triangles,
-            /// e.g. triangles where all three points, normals, and texture coordinates happen to be identical.
-            /// We are replacing these NaN tangents by arbitrary tangent orthonormal to the vertex normal
-            if (mesh.tangents.pData)
-            {
-                FALCOR_ASSERT(mesh.tangents.frequency == Mesh::AttributeFrequency::FaceVarying);
-                NumericRange<uint32_t> range(0, mesh.indexCount);
-                std::for_each(std::execution::par_unseq, range.begin(), range.end(), [&](uint32_t fvIndex)
-                {
-                    if (!any(isnan(mesh.tangents.pData[fvIndex])))
-                        return;
-                    uint32_t faceIndex = fvIndex / 3;
-                    uint32_t vertexIndex = fvIndex % 3;
-                    float3 normal = mesh.getNormal(faceIndex, vertexIndex);
-                    tangents[fvIndex] = float4(perp_stark(normal), 1.f);
-                });
-            }
-        }
-        else
-        {
-            mesh.tangents.pData = nullptr;
-            mesh.tangents.frequency = Mesh::AttributeFrequency::None;
-        }
+        generateTangentSpace(mesh, tangents);
     }
 
     MeshID SceneBuilder::addProcessedMesh(const ProcessedMesh& mesh)
@@ -942,7 +1007,8 @@ namespace Falcor
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
         if (!mpMaterialTextureLoader)
         {
-            mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
+            mpMaterialTextureLoader.reset(new MaterialTextureLoader(
+                mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures), !is_set(mFlags, Flags::DontOptimizeMaterials)));
         }
         std::filesystem::path resolvedPath = mAssetResolver.resolvePath(path);
         mpMaterialTextureLoader->loadTexture(pMaterial, slot, resolvedPath);
@@ -1762,24 +1828,24 @@ namespace Falcor
         mesh.isFrontFaceCW = !mesh.isFrontFaceCW;
     }
 
-    void SceneBuilder::updateSDFGridID(SdfGridID oldID, SdfGridID newID)
+    void SceneBuilder::remapSDFGridIDs(const std::vector<SdfGridID>& idMap)
     {
-        // This is a helper function to update all the references to a specific SDF grid ID
-        // to a new SDF grid ID.
+        // This is a helper function to update all the references to SDF grid IDs in a single sweep.
+        // idMap maps each old SDF grid ID to its new SDF grid ID.
 
         for (Scene::SDFGridDesc& sdfGridDesc : mSceneData.sdfGridDesc)
         {
-            if (sdfGridDesc.sdfGridID == oldID) sdfGridDesc.sdfGridID = newID;
+            sdfGridDesc.sdfGridID = idMap[sdfGridDesc.sdfGridID.get()];
         }
 
         for (GeometryInstanceData& sdfGridInstance : mSceneData.sdfGridInstances)
         {
-            if (SdfGridID::fromSlang(sdfGridInstance.geometryID) == oldID)
-            {
-                sdfGridInstance.geometryID = newID.getSlang();
-                InternalNode& node = mSceneGraph[sdfGridInstance.globalMatrixID];
-                std::replace(node.sdfGrids.begin(), node.sdfGrids.end(), oldID, newID);
-            }
+            sdfGridInstance.geometryID = idMap[sdfGridInstance.geometryID].getSlang();
+        }
+
+        for (InternalNode& node : mSceneGraph)
+        {
+            for (SdfGridID& sdfGridID : node.sdfGrids) sdfGridID = idMap[sdfGridID.get()];
         }
     }
 
@@ -2058,9 +2124,11 @@ namespace Falcor
     {
         FALCOR_ASSERT(mesh.indexCount > 0 && !mesh.indexData.empty());
 
+        ScratchArena::Scope scratch;
+
         const uint32_t invalidIdx = uint32_t(-1);
-        std::vector<uint32_t> leftIndexMap(mesh.indexCount, invalidIdx);
-        std::vector<uint32_t> rightIndexMap(mesh.indexCount, invalidIdx);
+        ScratchVector<uint32_t> leftIndexMap(mesh.indexCount, invalidIdx, scratch.getArena());
+        ScratchVector<uint32_t> rightIndexMap(mesh.indexCount, invalidIdx, scratch.getArena());
 
         // Iterate over the triangles.
         const size_t triangleCount = mesh.getTriangleCount();
@@ -2068,7 +2136,7 @@ namespace Falcor
         {
             const uint32_t indices[3] = { mesh.getIndex(i + 0), mesh.getIndex(i + 1), mesh.getIndex(i + 2) };
 
-            auto addVertex = [&](const uint32_t vtxIndex, MeshSpec& dstMesh, std::vector<uint32_t>& indexMap)
+            auto addVertex = [&](const uint32_t vtxIndex, MeshSpec& dstMesh, ScratchVector<uint32_t>& indexMap)
             {
                 if (indexMap[vtxIndex] != invalidIdx) return indexMap[vtxIndex];
 
@@ -2077,7 +2145,7 @@ namespace Falcor
                 indexMap[vtxIndex] = dstIndex;
                 return dstIndex;
             };
-            auto addTriangleToMesh = [&](MeshSpec& dstMesh, std::vector<uint32_t>& indexMap)
+            auto addTriangleToMesh = [&](MeshSpec& dstMesh, ScratchVector<uint32_t>& indexMap)
             {
                 for (size_t j = 0; j < 3; j++)
                 {
@@ -2105,7 +2173,7 @@ namespace Falcor
             m.staticVertexCount = m.vertexCount;
 
             m.use16BitIndices = (m.vertexCount <= (1u << 16)) && !(is_set(mFlags, Flags::Force32BitIndices));
-            if (m.use16BitIndices) m.indexData = compact16BitIndices(m.indexData);
+            if (m.use16BitIndices) m.indexData = compact16BitIndices(m.indexData.data(), m.indexData.size());
 
             m.boundingBox = AABB();
             for (auto& v : m.staticData) m.boundingBox.include(v.position);
@@ -2158,7 +2226,7 @@ namespace Falcor
 
         triangleCount = countTriangles(meshGroup);
 
-        if (triangleCount <= kMaxTrianglesPerBLAS)
+        if (triangleCount <= mMaxTrianglesPerBLAS)
         {
             return false;
         }
@@ -2173,7 +2241,7 @@ namespace Falcor
             return false;
         }
         FALCOR_ASSERT(meshGroup.meshList.size() > 1);
-        FALCOR_ASSERT(triangleCount > kMaxTrianglesPerBLAS);
+        FALCOR_ASSERT(triangleCount > mMaxTrianglesPerBLAS);
 
         return true;
     }
@@ -2190,7 +2258,7 @@ namespace Falcor
 
         // Each new group holds at least one mesh, or if multiple, up to the target number of triangles.
         FALCOR_ASSERT(triangleCount > 0);
-        size_t targetGroupCount = div_round_up(triangleCount, kMaxTrianglesPerBLAS);
+        size_t targetGroupCount = div_round_up(triangleCount, mMaxTrianglesPerBLAS);
         size_t targetTrianglesPerGroup = triangleCount / targetGroupCount;
 
         triangleCount = 0;
@@ -2337,6 +2405,171 @@ namespace Falcor
         return leftList;
     }
 
+    SceneBuilder::MeshGroupList SceneBuilder::splitMeshGroupSAH(MeshGroup& meshGroup) const
+    {
+        // This function implements a recursive top-down BVH builder that partitions a mesh group
+        // using a binned surface area heuristic. Mesh centroids are binned along each axis and
+        // every plane between bins is scored by the cost
+        //
+        //   C = A(L) * N(L) + A(R) * N(R) + w * A(L & R) * (N(L) + N(R)),
+        //
+        // where A is the surface area of a bounding box and N the triangle count. The last term
+        // penalizes spatial overlap between the two groups, which slows down TLAS traversal.
+        // Individual meshes are not split.
+
+        // Early out if splitting is not needed or possible.
+        size_t triangleCount = 0;
+        if (!needsSplit(meshGroup, triangleCount)) return MeshGroupList{ std::move(meshGroup) };
+
+        AABB centroidBounds;
+        for (auto meshID : meshGroup.meshList) centroidBounds.include(mMeshes[meshID.get()].boundingBox.center());
+
+        auto getBinIndex = [&](MeshID meshID, int axis)
+        {
+            const float extent = centroidBounds.extent()[axis];
+            const float t = (mMeshes[meshID.get()].boundingBox.center()[axis] - centroidBounds.minPoint[axis]) / extent;
+            return std::min((size_t)(t * kSAHBinCount), kSAHBinCount - 1);
+        };
+
+        struct Bin
+        {
+            AABB bounds;
+            size_t triangleCount = 0;
+            size_t meshCount = 0;
+        };
+
+        double bestCost = std::numeric_limits<double>::infinity();
+        int bestAxis = -1;
+        size_t bestSplit = 0;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (!(centroidBounds.extent()[axis] > 0.f)) continue;
+
+            std::array<Bin, kSAHBinCount> bins;
+            for (auto meshID : meshGroup.meshList)
+            {
+                const auto& mesh = mMeshes[meshID.get()];
+                Bin& bin = bins[getBinIndex(meshID, axis)];
+                bin.bounds.include(mesh.boundingBox);
+                bin.triangleCount += mesh.getTriangleCount();
+                bin.meshCount++;
+            }
+
+            // Sweep from the right to get the bounds and triangle count of all bins at or above each split.
+            std::array<Bin, kSAHBinCount> right;
+            for (size_t i = kSAHBinCount - 1; i > 0; i--)
+            {
+                right[i] = i + 1 < kSAHBinCount ? right[i + 1] : Bin{};
+                right[i].bounds.include(bins[i].bounds);
+                right[i].triangleCount += bins[i].triangleCount;
+                right[i].meshCount += bins[i].meshCount;
+            }
+
+            // Sweep from the left and evaluate the cost of splitting below each bin.
+            Bin left;
+            for (size_t i = 1; i < kSAHBinCount; i++)
+            {
+                left.bounds.include(bins[i - 1].bounds);
+                left.triangleCount += bins[i - 1].triangleCount;
+                left.meshCount += bins[i - 1].meshCount;
+                if (left.meshCount == 0 || right[i].meshCount == 0) continue;
+
+                AABB overlap = left.bounds;
+                overlap.intersection(right[i].bounds);
+                const double overlapArea = overlap.valid() ? overlap.area() : 0.0;
+
+                const double cost = (double)left.bounds.area() * left.triangleCount + (double)right[i].bounds.area() * right[i].triangleCount
+                    + kSAHOverlapWeight * overlapArea * (left.triangleCount + right[i].triangleCount);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        std::vector<MeshID> meshes = std::move(meshGroup.meshList);
+        auto splitIter = meshes.begin();
+
+        if (bestAxis >= 0)
+        {
+            // The partition is stable to keep the mesh order deterministic.
+            splitIter = std::stable_partition(meshes.begin(), meshes.end(), [&](MeshID meshID) { return getBinIndex(meshID, bestAxis) < bestSplit; });
+        }
+        else
+        {
+            // All centroids coincide, fall back on splitting at the middle mesh.
+            FALCOR_ASSERT(meshes.size() >= 2);
+            splitIter = meshes.begin() + meshes.size() / 2;
+        }
+        FALCOR_ASSERT(splitIter != meshes.begin() && splitIter != meshes.end());
+
+        // Recursively split the left and right mesh groups.
+        MeshGroup leftGroup{ std::vector<MeshID>(meshes.begin(), splitIter), meshGroup.isStatic };
+        MeshGroup rightGroup{ std::vector<MeshID>(splitIter, meshes.end()), meshGroup.isStatic };
+
+        MeshGroupList leftList = splitMeshGroupSAH(leftGroup);
+        MeshGroupList rightList = splitMeshGroupSAH(rightGroup);
+
+        // Move elements into a single list and return.
+        leftList.insert(
+            leftList.end(),
+            std::make_move_iterator(rightList.begin()),
+            std::make_move_iterator(rightList.end()));
+
+        return leftList;
+    }
+
+    SceneBuilder::MeshGroupList SceneBuilder::splitMeshGroup(MeshGroup& meshGroup, MeshGroupSplitStrategy strategy)
+    {
+        switch (strategy)
+        {
+        case MeshGroupSplitStrategy::Simple: return splitMeshGroupSimple(meshGroup);
+        case MeshGroupSplitStrategy::Median: return splitMeshGroupMedian(meshGroup);
+        case MeshGroupSplitStrategy::Midpoint: return splitMeshGroupMidpointMeshes(meshGroup);
+        case MeshGroupSplitStrategy::SAH: return splitMeshGroupSAH(meshGroup);
+        default: FALCOR_UNREACHABLE();
+        }
+        return {};
+    }
+
+    SceneBuilder::MeshGroupSplitStats SceneBuilder::computeMeshGroupSplitStats(const std::vector<MeshGroupList>& splitGroups) const
+    {
+        MeshGroupSplitStats stats;
+
+        for (const auto& groups : splitGroups)
+        {
+            if (groups.size() <= 1) continue;
+
+            std::vector<AABB> bounds;
+            for (const auto& group : groups)
+            {
+                bounds.push_back(calculateBoundingBox(group));
+                stats.surfaceArea += bounds.back().area();
+                stats.meshCount += group.meshList.size();
+                stats.maxTriangleCount = std::max(stats.maxTriangleCount, countTriangles(group));
+            }
+
+            // Overlap between BLASes from different source groups does not depend on the split strategy and is not included.
+            for (size_t i = 0; i < bounds.size(); i++)
+            {
+                for (size_t j = i + 1; j < bounds.size(); j++)
+                {
+                    AABB overlap = bounds[i];
+                    overlap.intersection(bounds[j]);
+                    if (overlap.valid()) stats.overlapArea += overlap.area();
+                }
+            }
+
+            stats.splitGroupCount++;
+            stats.blasCount += groups.size();
+        }
+
+        return stats;
+    }
+
     void SceneBuilder::optimizeGeometry()
     {
         // This function optimizes the geometry for raytracing performance and memory usage.
@@ -2349,15 +2582,55 @@ namespace Falcor
         //  - Split large mesh groups (BLASes) into multiple smaller ones.
         //  - Split large meshes into smaller to reduce spatial overlap between BLASes.
         //  - Sort meshes into BLASes based on spatial locality.
+        //
+        // The split strategy is selected in the settings. If requested, the strategies that don't modify
+        // the meshes are evaluated up front and their BLAS surface area and overlap are logged for comparison.
+        //
+        // Finally, if requested, the triangles and vertices of each mesh are reordered for locality.
 
-        MeshGroupList optimizedGroups;
+        const auto strategy = stringToEnum<MeshGroupSplitStrategy>(mSettings.getOption<std::string>(kMeshGroupSplitStrategyOption, "Midpoint"));
+        const bool report = mSettings.getOption(kMeshGroupSplitReportOption, false);
+        mMaxTrianglesPerBLAS = std::max<size_t>(mSettings.getOption(kMaxTrianglesPerBLASOption, kDefaultMaxTrianglesPerBLAS), 1);
+
+        // Splits all mesh groups with the given strategy. Strategies that don't split meshes run in parallel over the groups.
+        auto splitMeshGroups = [this](MeshGroupList meshGroups, MeshGroupSplitStrategy splitStrategy)
+        {
+            std::vector<MeshGroupList> splitGroups(meshGroups.size());
+            if (splitStrategy == MeshGroupSplitStrategy::Midpoint)
+            {
+                for (size_t i = 0; i < meshGroups.size(); i++) splitGroups[i] = splitMeshGroup(meshGroups[i], splitStrategy);
+            }
+            else
+            {
+                NumericRange<size_t> range(0, meshGroups.size());
+                std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) { splitGroups[i] = splitMeshGroup(meshGroups[i], splitStrategy); });
+            }
+            return splitGroups;
+        };
+
+        auto logStats = [](MeshGroupSplitStrategy splitStrategy, const MeshGroupSplitStats& stats)
+        {
+            logInfo("  {:<8} {} groups split into {} BLASes, surface area {:.6g}, overlap ratio {:.4f}", enumToString(splitStrategy), stats.splitGroupCount, stats.blasCount, stats.surfaceArea, stats.getOverlapRatio());
+        };
 
-        for (auto& meshGroup : mMeshGroups)
+        if (report)
         {
-            //auto groups = splitMeshGroupSimple(meshGroup);
-            //auto groups = splitMeshGroupMedian(meshGroup);
-            auto groups = splitMeshGroupMidpointMeshes(meshGroup);
+            logInfo("Mesh group split report:");
+            for (auto splitStrategy : { MeshGroupSplitStrategy::Simple, MeshGroupSplitStrategy::Median, MeshGroupSplitStrategy::SAH })
+            {
+                if (splitStrategy == strategy) continue;
+                logStats(splitStrategy, computeMeshGroupSplitStats(splitMeshGroups(mMeshGroups, splitStrategy)));
+            }
+        }
+
+        std::vector<MeshGroupList> splitGroups = splitMeshGroups(std::move(mMeshGroups), strategy);
+        mMeshGroupSplitStats = computeMeshGroupSplitStats(splitGroups);
+        if (report) logStats(strategy, mMeshGroupSplitStats);
+
+        MeshGroupList optimizedGroups;
 
+        for (auto& groups : splitGroups)
+        {
             if (groups.size() > 1) logWarning("SceneBuilder::optimizeGeometry() performance warning - Mesh group was split into {} groups.", groups.size());
 
             optimizedGroups.insert(
@@ -2367,6 +2640,59 @@ namespace Falcor
         }
 
         mMeshGroups = std::move(optimizedGroups);
+
+        optimizeMeshVertexOrder();
+    }
+
+    void SceneBuilder::optimizeMeshVertexOrder()
+    {
+        // This function reorders the triangles of each mesh for post-transform vertex cache efficiency and overdraw,
+        // and the vertices for fetch locality. Import order is often poor, which hurts raster passes and BLAS builds.
+        // The vertex data used by skinning and vertex animation is reordered along with the static vertices.
+
+        if (!is_set(mFlags, Flags::OptimizeVertexOrder)) return;
+
+        std::vector<CachedMesh*> cachedMeshes(mMeshes.size(), nullptr);
+        for (auto& cachedMesh : mSceneData.cachedMeshes) cachedMeshes[cachedMesh.meshID.get()] = &cachedMesh;
+
+        // Meshes tessellated from animated curves are updated in tessellation order at runtime, so they are left unchanged.
+        std::vector<uint8_t> isCurveMesh(mMeshes.size(), 0);
+        for (const auto& cache : mSceneData.cachedCurves)
+        {
+            if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere) isCurveMesh[cache.geometryID.get()] = 1;
+        }
+
+        std::vector<VertexOrderStats> stats(mMeshes.size());
+
+        NumericRange<size_t> range(0, mMeshes.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t meshIndex)
+        {
+            auto& mesh = mMeshes[meshIndex];
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || isCurveMesh[meshIndex]) return;
+
+            CachedMesh* pCachedMesh = cachedMeshes[meshIndex];
+            stats[meshIndex] = optimizeVertexOrder(
+                mesh.indexData, mesh.indexCount, mesh.use16BitIndices, mesh.staticData, mesh.skinningData, pCachedMesh ? &pCachedMesh->vertexData : nullptr
+            );
+        });
+
+        VertexCacheStats totalBefore;
+        VertexCacheStats totalAfter;
+        uint32_t meshCount = 0;
+        uint32_t overdrawMeshCount = 0;
+        for (size_t meshIndex = 0; meshIndex < mMeshes.size(); meshIndex++)
+        {
+            if (stats[meshIndex].before.triangleCount == 0) continue;
+            totalBefore += stats[meshIndex].before;
+            totalAfter += stats[meshIndex].after;
+            meshCount++;
+            overdrawMeshCount += stats[meshIndex].overdrawOptimized ? 1 : 0;
+        }
+
+        logInfo(
+            "Optimized vertex order of {} meshes ({} with overdraw reordering): ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} (FIFO cache of {} vertices).",
+            meshCount, overdrawMeshCount, totalBefore.getACMR(), totalAfter.getACMR(), totalBefore.getATVR(), totalAfter.getATVR(), kVertexCacheSize
+        );
     }
 
     void SceneBuilder::sortMeshes()
@@ -2644,33 +2970,58 @@ namespace Falcor
     void SceneBuilder::removeDuplicateSDFGrids()
     {
         // Removes duplicate SDF grids.
+        // Grids are considered duplicates if they are the same object or if they have identical content,
+        // e.g., grids loaded separately from the same file or created from the same list of primitives.
+        // Grids are bucketed by content hash so that each grid is only compared against grids with the same hash.
+
+        const bool mergeByContent = mSettings.getOption(kMergeSDFGridsByContentOption, true);
+        const size_t gridCount = mSceneData.sdfGrids.size();
+        if (gridCount <= 1) return;
 
         std::vector<ref<SDFGrid>> uniqueSDFGrids;
-        std::unordered_set<SdfGridID> removedIDs;
+        std::vector<SdfGridID> idMap(gridCount);
+        std::unordered_map<const SDFGrid*, SdfGridID> gridToUniqueID;
+        std::unordered_map<uint64_t, std::vector<SdfGridID>> hashToUniqueIDs;
 
-        for (SdfGridID i{ 0 }; i.get() < mSceneData.sdfGrids.size(); ++i)
+        for (size_t i = 0; i < gridCount; ++i)
         {
-            if (removedIDs.count(i) > 0)
-                continue;
-
-            const ref<SDFGrid>& pSDFGridA = mSceneData.sdfGrids[i.get()];
-            uniqueSDFGrids.push_back(pSDFGridA);
-
-            if (removedIDs.size() > 0)
-                updateSDFGridID(i, SdfGridID{ i.get() - (uint32_t)removedIDs.size() });
+            const ref<SDFGrid>& pSDFGrid = mSceneData.sdfGrids[i];
 
-            for (SdfGridID j{ i.get() + 1 }; j.get() < mSceneData.sdfGrids.size(); ++j)
+            // Check if the same grid object has been seen before.
+            auto it = gridToUniqueID.find(pSDFGrid.get());
+            if (it != gridToUniqueID.end())
             {
-                const ref<SDFGrid>& pSDFGridB = mSceneData.sdfGrids[j.get()];
+                idMap[i] = it->second;
+                continue;
+            }
 
-                if (pSDFGridA == pSDFGridB)
+            // Check if a grid with identical content has been seen before.
+            std::vector<SdfGridID>* pCandidates = nullptr;
+            if (mergeByContent)
+            {
+                pCandidates = &hashToUniqueIDs[pSDFGrid->getContentHash()];
+                auto match = std::find_if(pCandidates->begin(), pCandidates->end(),
+                    [&](SdfGridID id) { return uniqueSDFGrids[id.get()]->isContentEqual(*pSDFGrid); });
+                if (match != pCandidates->end())
                 {
-                    removedIDs.insert(j);
-                    updateSDFGridID(j, i);
+                    idMap[i] = *match;
+                    gridToUniqueID[pSDFGrid.get()] = *match;
+                    continue;
                 }
             }
+
+            SdfGridID newID{ uniqueSDFGrids.size() };
+            uniqueSDFGrids.push_back(pSDFGrid);
+            idMap[i] = newID;
+            gridToUniqueID[pSDFGrid.get()] = newID;
+            if (pCandidates) pCandidates->push_back(newID);
         }
 
+        if (uniqueSDFGrids.size() == gridCount) return;
+
+        logInfo("Removed {} duplicate SDF grids (of {} total).", gridCount - uniqueSDFGrids.size(), gridCount);
+
+        remapSDFGridIDs(idMap);
         mSceneData.sdfGrids = std::move(uniqueSDFGrids);
     }
 
@@ -2962,6 +3313,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("OptimizeVertexOrder", SceneBuilder::Flags::OptimizeVertexOrder);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2978,8 +3330,77 @@ namespace Falcor
         sceneBuilder.def_property("envMap", &SceneBuilder::getEnvMap, &SceneBuilder::setEnvMap);
         sceneBuilder.def_property("selectedCamera", &SceneBuilder::getSelectedCamera, &SceneBuilder::setSelectedCamera);
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
+        sceneBuilder.def_static("getCachedBlasMemoryReport",
+            [](const std::filesystem::path& path, SceneBuilder::Flags flags) -> std::optional<pybind11::dict>
+            {
+                auto report = SceneBuilder::getCachedBlasMemoryReport(path, flags);
+                if (!report) return {};
+                pybind11::dict d;
+                d["blasCount"] = report->blasCount;
+                d["estimatedBlasCount"] = report->estimatedBlasCount;
+                d["primitiveCount"] = report->primitiveCount;
+                d["groupCount"] = report->groupCount;
+                d["buildByteSize"] = report->buildByteSize;
+                d["finalByteSize"] = report->finalByteSize;
+                return d;
+            },
+            "path"_a, "flags"_a = SceneBuilder::Flags::Default
+        );
         sceneBuilder.def("importScene", &SceneBuilder::import, "path"_a, "dict"_a = pybind11::dict());
         sceneBuilder.def("addTriangleMesh", &SceneBuilder::addTriangleMesh, "triangleMesh"_a, "material"_a, "isAnimated"_a = false);
+        using FloatArray = pybind11::ndarray<pybind11::numpy, float, pybind11::c_contig, pybind11::device::cpu>;
+        using IndexArray = pybind11::ndarray<pybind11::numpy, uint32_t, pybind11::c_contig, pybind11::device::cpu>;
+        sceneBuilder.def("addMesh",
+            [](SceneBuilder* pSceneBuilder, FloatArray positions, IndexArray indices, const ref<Material>& pMaterial,
+               std::optional<FloatArray> normals, std::optional<FloatArray> texCoords, std::optional<FloatArray> tangents,
+               const std::string& name, bool frontFaceCW, bool isAnimated)
+            {
+                // The mesh attributes point directly into the arrays, which are only read while the mesh is processed.
+                FALCOR_CHECK(pSceneBuilder, "'pSceneBuilder' is missing");
+                FALCOR_CHECK(pMaterial != nullptr, "'material' is missing");
+
+                size_t vertexCount = getNdarrayElementCount(positions, 3, "positions");
+                size_t indexCount = getNdarraySize(indices);
+                FALCOR_CHECK(vertexCount > 0 && vertexCount <= std::numeric_limits<uint32_t>::max(), "'positions' has an invalid number of elements ({})", vertexCount);
+                FALCOR_CHECK(indexCount > 0 && indexCount % 3 == 0 && indexCount <= std::numeric_limits<uint32_t>::max(), "'indices' must hold a multiple of 3 indices, got {}", indexCount);
+
+                auto checkAttribute = [&](const std::optional<FloatArray>& array, size_t componentCount, const char* arrayName)
+                {
+                    if (!array) return (const float*)nullptr;
+                    FALCOR_CHECK(getNdarrayElementCount(*array, componentCount, arrayName) == vertexCount, "'{}' must have the same number of elements as 'positions'", arrayName);
+                    return array->data();
+                };
+
+                const uint32_t* pIndices = indices.data();
+                uint32_t maxIndex = *std::max_element(pIndices, pIndices + indexCount);
+                FALCOR_CHECK(maxIndex < vertexCount, "Vertex index {} is out of range (vertex count is {})", maxIndex, vertexCount);
+
+                SceneBuilder::Mesh mesh;
+                mesh.name = name;
+                mesh.faceCount = (uint32_t)(indexCount / 3);
+                mesh.vertexCount = (uint32_t)vertexCount;
+                mesh.indexCount = (uint32_t)indexCount;
+                mesh.pIndices = pIndices;
+                mesh.topology = Vao::Topology::TriangleList;
+                mesh.isFrontFaceCW = frontFaceCW;
+                mesh.pMaterial = pMaterial;
+                mesh.isAnimated = isAnimated;
+                mesh.positions = { reinterpret_cast<const float3*>(positions.data()), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                if (auto pNormals = checkAttribute(normals, 3, "normals"))
+                    mesh.normals = { reinterpret_cast<const float3*>(pNormals), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                if (auto pTexCoords = checkAttribute(texCoords, 2, "texCoords"))
+                    mesh.texCrds = { reinterpret_cast<const float2*>(pTexCoords), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                if (auto pTangents = checkAttribute(tangents, 4, "tangents"))
+                {
+                    mesh.tangents = { reinterpret_cast<const float4*>(pTangents), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+                    mesh.useOriginalTangentSpace = true;
+                }
+
+                return pSceneBuilder->addMesh(mesh);
+            },
+            "positions"_a, "indices"_a, "material"_a, "normals"_a = pybind11::none(), "texCoords"_a = pybind11::none(), "tangents"_a = pybind11::none(),
+            "name"_a = "", "frontFaceCW"_a = false, "isAnimated"_a = false
+        );
         sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
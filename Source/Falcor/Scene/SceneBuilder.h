@@ -36,17 +36,20 @@
 #include "Material/MaterialTextureLoader.h"
 
 #include "Core/Macros.h"
+#include "Core/Enum.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/VAO.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
+#include "Utils/ScratchArena.h"
 #include "Utils/Settings/Settings.h"
 
 #include <pybind11/pytypes.h>
 
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -77,6 +80,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            OptimizeVertexOrder             = 0x40000,  ///< Reorder the triangles of each mesh for post-transform vertex cache efficiency and overdraw, and the vertices for fetch locality.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -84,6 +88,41 @@ namespace Falcor
             Default = None
         };
 
+        /** Strategy for splitting static mesh groups that exceed the triangle limit per BLAS.
+            The strategy is selected with the 'SceneBuilder:meshGroupSplitStrategy' option in the settings.
+            The triangle limit is set with the 'SceneBuilder:maxTrianglesPerBLAS' option (default 16M).
+        */
+        enum class MeshGroupSplitStrategy
+        {
+            Simple,     ///< Partition by triangle count, keeping the original mesh order.
+            Median,     ///< Recursively split at the triangle count median along the largest axis.
+            Midpoint,   ///< Recursively split at the spatial midpoint along the largest axis. Meshes straddling the plane are split. This is the default.
+            SAH,        ///< Recursively split using a binned surface area heuristic that penalizes overlap between the BLASes.
+        };
+
+        FALCOR_ENUM_INFO(MeshGroupSplitStrategy, {
+            { MeshGroupSplitStrategy::Simple, "Simple" },
+            { MeshGroupSplitStrategy::Median, "Median" },
+            { MeshGroupSplitStrategy::Midpoint, "Midpoint" },
+            { MeshGroupSplitStrategy::SAH, "SAH" },
+        });
+
+        /** Quality metrics of the BLASes created by splitting mesh groups.
+            Only mesh groups that were split contribute.
+        */
+        struct MeshGroupSplitStats
+        {
+            size_t splitGroupCount = 0; ///< Number of mesh groups that were split.
+            size_t blasCount = 0;       ///< Number of BLASes the groups were split into.
+            size_t meshCount = 0;       ///< Number of meshes in these BLASes.
+            size_t maxTriangleCount = 0; ///< Triangle count of the largest of these BLASes.
+            double surfaceArea = 0.0;   ///< Sum of the surface areas of the BLAS bounding boxes.
+            double overlapArea = 0.0;   ///< Sum of the surface areas of the pairwise intersections between BLASes from the same group.
+
+            /// Returns the overlap relative to the total surface area.
+            double getOverlapRatio() const { return surfaceArea > 0.0 ? overlapArea / surfaceArea : 0.0; }
+        };
+
         /** Mesh description.
             This struct is used by the importers to add new meshes.
             The description is then processed by the scene builder into an optimized runtime format.
@@ -343,6 +382,15 @@ namespace Falcor
 
         ~SceneBuilder();
 
+        /** Compute the expected BLAS memory of a scene from the BLAS build records in its scene cache.
+            This does not require a GPU device. The records are written the first time the scene is rendered
+            with ray tracing after its scene cache has been written.
+            \param[in] path Scene file path.
+            \param[in] flags Build flags the scene cache was written with.
+            \return Memory report, or an empty optional if no records are cached for the scene.
+        */
+        static std::optional<BlasMemoryReport> getCachedBlasMemoryReport(const std::filesystem::path& path, Flags flags = Flags::Default);
+
         /** Import a scene/model file
             \param path The file path to load
             Throws an ImporterError if something went wrong.
@@ -378,6 +426,10 @@ namespace Falcor
         const Settings& getSettings() const { return mSettings; }
         Settings& getSettings() { return mSettings; }
 
+        /** Get the quality metrics of the mesh group split performed when the scene was built.
+        */
+        const MeshGroupSplitStats& getMeshGroupSplitStats() const { return mMeshGroupSplitStats; }
+
         /** Get the build flags
         */
         Flags getFlags() const { return mFlags; }
@@ -428,9 +480,10 @@ namespace Falcor
             \param mesh The mesh to pre-process.
             \param pAttributeIndices Optional. If specified, the attribute indices used to create the final mesh vertices will be saved here.
             \param pTangents Optional. When specified and processMesh creates tangents for the mesh, the tangents are also stored in this parameter.
+            \param pScratchArena Optional. Arena for temporary allocations. If not specified, the arena of the calling thread is used.
             \return The pre-processed mesh.
         */
-        ProcessedMesh processMesh(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices = nullptr, std::vector<float4>* pTangents = nullptr) const;
+        ProcessedMesh processMesh(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices = nullptr, std::vector<float4>* pTangents = nullptr, ScratchArena* pScratchArena = nullptr) const;
 
         /** Generate tangents for a mesh.
             \param mesh The mesh to generate tangents for. If successful, the tangent attribute on the mesh will be set to the output vector.
@@ -776,12 +829,16 @@ namespace Falcor
         Scene::SceneData mSceneData;
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
+        SceneCache::BuildLock mSceneCacheBuildLock;    ///< Build lock of the scene cache, held from import until the cache is written.
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        ScratchArena::Stats mScratchStatsAtStart;   ///< Global scratch arena statistics when the builder was created.
 
         SceneGraph mSceneGraph;
 
         MeshList mMeshes;
         MeshGroupList mMeshGroups; ///< Groups of meshes. Each group represents all the geometries in a BLAS for ray tracing.
+        size_t mMaxTrianglesPerBLAS = 0; ///< Triangle count above which mesh groups are split. Set from the settings in optimizeGeometry().
+        MeshGroupSplitStats mMeshGroupSplitStats; ///< Quality metrics of the mesh group split.
 
         CurveList mCurves;
 
@@ -793,7 +850,7 @@ namespace Falcor
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
         bool mergeNodes(NodeID dstNodeID, NodeID srcNodeID);
         void flipTriangleWinding(MeshSpec& mesh);
-        void updateSDFGridID(SdfGridID oldID, SdfGridID newID);
+        void remapSDFGridIDs(const std::vector<SdfGridID>& idMap);
 
         /** Split a mesh by the given axis-aligned splitting plane.
             \return Pair of optional mesh IDs for the meshes on the left and right side, respectively.
@@ -810,6 +867,9 @@ namespace Falcor
         MeshGroupList splitMeshGroupSimple(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMedian(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
+        MeshGroupList splitMeshGroupSAH(MeshGroup& meshGroup) const;
+        MeshGroupList splitMeshGroup(MeshGroup& meshGroup, MeshGroupSplitStrategy strategy);
+        MeshGroupSplitStats computeMeshGroupSplitStats(const std::vector<MeshGroupList>& splitGroups) const;
 
         // Post processing
         void prepareDisplacementMaps();
@@ -823,6 +883,7 @@ namespace Falcor
         void calculateMeshBoundingBoxes();
         void createMeshGroups();
         void optimizeGeometry();
+        void optimizeMeshVertexOrder();
         void sortMeshes();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
@@ -846,4 +907,5 @@ namespace Falcor
     };
 
     FALCOR_ENUM_CLASS_OPERATORS(SceneBuilder::Flags);
+    FALCOR_ENUM_REGISTER(SceneBuilder::MeshGroupSplitStrategy);
 }
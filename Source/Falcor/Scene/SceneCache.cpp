@@ -26,15 +26,31 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "SceneCache.h"
+#include "SceneCacheFile.h"
+#include "SceneCacheIndex.h"
 #include "Material/StandardMaterial.h"
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/LockFile.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
-
-#include <lz4_stream/lz4_stream.h>
-
+#include "Utils/NumericRange.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Scripting/ScriptBindings.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <execution>
 #include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
 
 namespace Falcor
 {
@@ -43,25 +59,161 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 29;
 
-        /** Scene cache directory (subdirectory in the application data directory).
+        /** Default scene cache directory (subdirectory in the application data directory).
+            Can be overridden with the FALCOR_SCENE_CACHE_DIR environment variable, e.g. to share the cache between processes.
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
+        /** Default size limit of the scene cache directory.
+            Can be overridden with the FALCOR_SCENE_CACHE_SIZE_LIMIT_MB environment variable.
+        */
+        const uint64_t kDefaultSizeLimit = 64ull << 30;
+
+        /** Extension of the lock file held by the process building a scene cache.
+        */
+        const std::string kBuildLockExtension = ".build.lock";
 
-        const char* kMagic = "FalcorS$";
-        struct Header
+        /** Specifies the current BLAS build cache file version.
+            This needs to be incremented every time the file format changes!
+        */
+        const uint32_t kBlasBuildCacheVersion = 1;
+
+        /** Extension of the BLAS build cache file stored next to the scene cache file.
+        */
+        const std::string kBlasBuildCacheExtension = ".blas";
+
+        const char* kBlasBuildCacheMagic = "FalcorB$";
+        struct BlasBuildCacheHeader
         {
             uint8_t magic[8]{};
             uint32_t version{};
 
             bool isValid() const
             {
-                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+                return std::memcmp(magic, kBlasBuildCacheMagic, sizeof(BlasBuildCacheHeader::magic)) == 0 && version == kBlasBuildCacheVersion;
+            }
+        };
+
+        /** Scene cache settings of this process.
+        */
+        struct CacheConfig
+        {
+            CacheConfig()
+            {
+                if (auto value = getEnvironmentVariable("FALCOR_SCENE_CACHE_DIR")) directory = *value;
+                else directory = getAppDataDirectory() / kDirectory;
+
+                if (auto value = getEnvironmentVariable("FALCOR_SCENE_CACHE_SIZE_LIMIT_MB"))
+                {
+                    try
+                    {
+                        sizeLimit = std::stoull(*value) << 20;
+                    }
+                    catch (const std::exception&)
+                    {
+                        logWarning("Ignoring invalid FALCOR_SCENE_CACHE_SIZE_LIMIT_MB value '{}'.", *value);
+                    }
+                }
+            }
+
+            std::mutex mutex;
+            std::filesystem::path directory;
+            uint64_t sizeLimit = kDefaultSizeLimit;
+        };
+
+        CacheConfig& getConfig()
+        {
+            static CacheConfig config;
+            return config;
+        }
+
+        struct CacheStats
+        {
+            std::atomic<uint64_t> hitCount{0};
+            std::atomic<uint64_t> missCount{0};
+            std::atomic<uint64_t> waitCount{0};
+            std::atomic<uint64_t> evictionCount{0};
+            std::atomic<uint64_t> evictedByteSize{0};
+        };
+
+        CacheStats& getCacheStats()
+        {
+            static CacheStats stats;
+            return stats;
+        }
+
+        /** Open the LRU index of a scene cache directory.
+        */
+        SceneCacheIndex openIndex(const std::filesystem::path& directory)
+        {
+            return SceneCacheIndex(directory, kVersion, { SceneCacheFile::kLockExtension, kBuildLockExtension, kBlasBuildCacheExtension });
+        }
+
+        /** Stream buffer reading from a block of memory.
+        */
+        class MemoryStreamBuf : public std::streambuf
+        {
+        public:
+            MemoryStreamBuf(char* data, size_t size) { setg(data, data, data + size); }
+        };
+
+        /** Scene cache files that are being written in the background.
+            Pending writes are flushed when Falcor's thread pool is shut down, so they are not lost when the application exits.
+        */
+        struct PendingWrites
+        {
+            PendingWrites()
+            {
+                Threading::registerShutdownCallback([]() { SceneCache::waitForPendingWrites(); });
             }
+
+            std::mutex mutex;
+            BS::thread_pool threadPool;
+            std::vector<std::future<void>> futures;
+        };
+
+        PendingWrites& getPendingWrites()
+        {
+            static PendingWrites pendingWrites;
+            return pendingWrites;
+        }
+
+        /** Scene cache file that is written in the background, and the build lock to release once it is written.
+        */
+        struct PendingWrite
+        {
+            std::unique_ptr<SceneCacheFile::Writer> pWriter;
+            SceneCache::BuildLock buildLock;
         };
+
+        /** Finish writing a scene cache file and add it to the LRU index.
+            Least recently used caches are evicted if the size limit is exceeded.
+            Errors are logged, as failing to write the cache doesn't prevent using the scene.
+        */
+        void finishCacheFile(SceneCacheFile::Writer& writer, const std::filesystem::path& cachePath, uint64_t sizeLimit)
+        {
+            try
+            {
+                writer.finish();
+                logInfo("Wrote scene cache to '{}' ({} chunks).", cachePath, writer.getChunkCount());
+
+                auto index = openIndex(cachePath.parent_path());
+                const auto name = cachePath.filename().string();
+                index.touch(name);
+                auto evictionStats = index.evict(sizeLimit, name);
+                index.save();
+
+                auto& stats = getCacheStats();
+                stats.evictionCount += evictionStats.evictionCount;
+                stats.evictedByteSize += evictionStats.evictedByteSize;
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to write scene cache to '{}': {}", cachePath, e.what());
+            }
+        }
     }
 
     /** Wrapper around std::ostream to ease serialization of basic types.
@@ -217,71 +369,298 @@ namespace Falcor
 
     bool SceneCache::hasValidCache(const Key& key)
     {
-        auto cachePath = getCachePath(key);
-        if (!std::filesystem::exists(cachePath)) return false;
+        waitForPendingWrites();
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) return false;
+        return SceneCacheFile::hasValidHeader(getCachePath(key), kVersion);
+    }
 
-        // Verify header.
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+    bool SceneCache::findCache(const Key& key, BuildLock& buildLock)
+    {
+        buildLock.reset();
+        auto& stats = getCacheStats();
+
+        if (hasValidCache(key))
+        {
+            stats.hitCount++;
+            return true;
+        }
+
+        // Only one process builds a given cache at a time. If another process holds the build lock,
+        // wait for it to finish and use its result instead of building the same cache again.
+        auto pLockFile = lockForBuild(key, false);
+        if (pLockFile && !pLockFile->tryLock(LockFile::LockType::Exclusive))
+        {
+            logInfo("Waiting for another process to build scene cache '{}'.", getCachePath(key));
+            stats.waitCount++;
+            if (!pLockFile->lock(LockFile::LockType::Exclusive)) pLockFile.reset();
+        }
+
+        if (hasValidCache(key))
+        {
+            stats.hitCount++;
+            return true;
+        }
+
+        stats.missCount++;
+        buildLock = std::move(pLockFile);
+        return false;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    SceneCache::BuildLock SceneCache::lockForBuild(const Key& key, bool acquire)
     {
         auto cachePath = getCachePath(key);
+        std::error_code ec;
+        std::filesystem::create_directories(cachePath.parent_path(), ec);
 
-        logInfo("Writing scene cache to '{}'.", cachePath);
+        auto pLockFile = std::make_shared<LockFile>();
+        if (!pLockFile->open(std::filesystem::path(cachePath) += kBuildLockExtension))
+        {
+            logWarning("Failed to open build lock for scene cache '{}'.", cachePath);
+            return {};
+        }
+        if (acquire && !pLockFile->lock(LockFile::LockType::Exclusive)) return {};
+        return pLockFile;
+    }
 
-        // Create directories if not existing.
-        std::filesystem::create_directories(cachePath.parent_path());
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, BuildLock buildLock)
+    {
+        auto cachePath = getCachePath(key);
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", cachePath);
+        logInfo("Writing scene cache to '{}'.", cachePath);
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        // Remove BLAS build records of a previous version of the scene. They are written again once the BLASes are built.
+        std::error_code ec;
+        std::filesystem::remove(getBlasBuildCachePath(key), ec);
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", cachePath);
+        // Serialize the scene data on the calling thread, as it is handed over to the scene afterwards.
+        // The serialized data is streamed to the writer, which compresses it one chunk at a time on the thread pool.
+        auto& pendingWrites = getPendingWrites();
+        // Errors are logged, as failing to write the cache doesn't prevent using the scene.
+        auto pWrite = std::make_shared<PendingWrite>();
+        try
+        {
+            pWrite->pWriter = std::make_unique<SceneCacheFile::Writer>(cachePath, kVersion, pendingWrites.threadPool);
+            std::ostream os(pWrite->pWriter.get());
+            OutputStream stream(os);
+            writeSceneData(stream, sceneData);
+            if (os.bad()) FALCOR_THROW("Failed to serialize scene data.");
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write scene cache to '{}': {}", cachePath, e.what());
+            return;
+        }
+        pWrite->buildLock = std::move(buildLock);
+
+        // Write the remaining chunks and rename the file in the background.
+        std::lock_guard<std::mutex> lock(pendingWrites.mutex);
+        auto& futures = pendingWrites.futures;
+        futures.erase(
+            std::remove_if(futures.begin(), futures.end(), [](const std::future<void>& f) { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }),
+            futures.end()
+        );
+        futures.push_back(pendingWrites.threadPool.submit([pWrite, cachePath, sizeLimit = getSizeLimit()]()
+        {
+            finishCacheFile(*pWrite->pWriter, cachePath, sizeLimit);
+            // Release the writer and the build lock right away, the pool keeps the task object alive until its thread runs the next task.
+            pWrite->pWriter.reset();
+            pWrite->buildLock.reset();
+        }));
     }
 
     Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
     {
+        waitForPendingWrites();
+
         auto cachePath = getCachePath(key);
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to open scene cache file '{}'.", cachePath);
+        // Read and decompress the file while holding the lock, so it isn't replaced by another process meanwhile.
+        std::vector<char> data;
+        {
+            LockFile lockFile(SceneCacheFile::getLockPath(cachePath));
+            if (lockFile.isOpen()) lockFile.lock(LockFile::LockType::Shared);
+            data = SceneCacheFile::read(cachePath, kVersion);
+        }
 
-        // Read header (uncompressed).
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) FALCOR_THROW("Invalid header in scene cache file '{}'.", cachePath);
+        try
+        {
+            auto index = openIndex(cachePath.parent_path());
+            index.touch(cachePath.filename().string());
+            index.save();
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to update scene cache index: {}", e.what());
+        }
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
+        MemoryStreamBuf buffer(data.data(), data.size());
+        std::istream is(&buffer);
+        InputStream stream(is);
         auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
+        if (!is) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
+
+        sceneData.sceneCacheKey = key;
+        if (auto blasBuildCache = readBlasBuildCache(key)) sceneData.blasBuildCache = std::move(*blasBuildCache);
+
         return sceneData;
     }
 
+    void SceneCache::waitForPendingWrites()
+    {
+        std::vector<std::future<void>> futures;
+        {
+            auto& pendingWrites = getPendingWrites();
+            std::lock_guard<std::mutex> lock(pendingWrites.mutex);
+            futures = std::move(pendingWrites.futures);
+            pendingWrites.futures.clear();
+        }
+        for (auto& f : futures) f.wait();
+    }
+
+    void SceneCache::writeBlasBuildCache(const BlasBuildCache& blasBuildCache, const Key& key)
+    {
+        auto cachePath = getBlasBuildCachePath(key);
+
+        logInfo("Writing BLAS build cache to '{}'.", cachePath);
+
+        std::filesystem::create_directories(cachePath.parent_path());
+
+        // Write to a temporary file and rename it, so readers never see a partially written file.
+        const auto tempPath = SceneCacheFile::getTempPath(cachePath);
+        try
+        {
+            {
+                std::ofstream fs(tempPath, std::ios_base::binary);
+                if (!fs) FALCOR_THROW("Failed to create BLAS build cache file '{}'.", tempPath);
+
+                // The records are small, so the file is not compressed.
+                BlasBuildCacheHeader header;
+                std::memcpy(header.magic, kBlasBuildCacheMagic, sizeof(BlasBuildCacheHeader::magic));
+                header.version = kBlasBuildCacheVersion;
+                fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+                OutputStream stream(fs);
+                stream.write(blasBuildCache.deviceName);
+                stream.write((uint64_t)blasBuildCache.blases.size());
+                for (const auto& record : blasBuildCache.blases) writeBlasBuildRecord(stream, record);
+                writeMarker(stream, "End");
+
+                fs.close();
+                if (!fs) FALCOR_THROW("Failed to write BLAS build cache file '{}'.", tempPath);
+            }
+            std::filesystem::rename(tempPath, cachePath);
+        }
+        catch (const std::exception&)
+        {
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            throw;
+        }
+
+        // The BLAS build records count toward the size of the scene cache entry.
+        try
+        {
+            auto index = openIndex(cachePath.parent_path());
+            index.touch(SHA1::toString(key));
+            index.save();
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to update scene cache index: {}", e.what());
+        }
+    }
+
+    std::optional<BlasBuildCache> SceneCache::readBlasBuildCache(const Key& key)
+    {
+        auto cachePath = getBlasBuildCachePath(key);
+        if (!std::filesystem::exists(cachePath)) return {};
+
+        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
+        if (fs.bad()) return {};
+
+        BlasBuildCacheHeader header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs || !header.isValid()) return {};
+
+        try
+        {
+            fs.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+
+            InputStream stream(fs);
+            BlasBuildCache blasBuildCache;
+            stream.read(blasBuildCache.deviceName);
+            uint64_t blasCount = stream.read<uint64_t>();
+            for (uint64_t i = 0; i < blasCount; i++) blasBuildCache.blases.push_back(readBlasBuildRecord(stream));
+            readMarker(stream, "End");
+            return blasBuildCache;
+        }
+        catch (const std::exception&)
+        {
+            logWarning("Ignoring invalid BLAS build cache file '{}'.", cachePath);
+            return {};
+        }
+    }
+
+    void SceneCache::setCacheDirectory(const std::filesystem::path& path)
+    {
+        auto& config = getConfig();
+        std::lock_guard<std::mutex> lock(config.mutex);
+        config.directory = path;
+    }
+
+    std::filesystem::path SceneCache::getCacheDirectory()
+    {
+        auto& config = getConfig();
+        std::lock_guard<std::mutex> lock(config.mutex);
+        return config.directory;
+    }
+
+    void SceneCache::setSizeLimit(uint64_t byteSize)
+    {
+        auto& config = getConfig();
+        std::lock_guard<std::mutex> lock(config.mutex);
+        config.sizeLimit = byteSize;
+    }
+
+    uint64_t SceneCache::getSizeLimit()
+    {
+        auto& config = getConfig();
+        std::lock_guard<std::mutex> lock(config.mutex);
+        return config.sizeLimit;
+    }
+
+    SceneCache::Stats SceneCache::getStats()
+    {
+        const auto& cacheStats = getCacheStats();
+        Stats stats;
+        stats.hitCount = cacheStats.hitCount;
+        stats.missCount = cacheStats.missCount;
+        stats.waitCount = cacheStats.waitCount;
+        stats.evictionCount = cacheStats.evictionCount;
+        stats.evictedByteSize = cacheStats.evictedByteSize;
+        return stats;
+    }
+
+    void SceneCache::resetStats()
+    {
+        auto& cacheStats = getCacheStats();
+        cacheStats.hitCount = 0;
+        cacheStats.missCount = 0;
+        cacheStats.waitCount = 0;
+        cacheStats.evictionCount = 0;
+        cacheStats.evictedByteSize = 0;
+    }
+
     std::filesystem::path SceneCache::getCachePath(const Key& key)
     {
-        return getAppDataDirectory() / kDirectory / SHA1::toString(key);
+        return getCacheDirectory() / SHA1::toString(key);
+    }
+
+    std::filesystem::path SceneCache::getBlasBuildCachePath(const Key& key)
+    {
+        return getCacheDirectory() / (SHA1::toString(key) + kBlasBuildCacheExtension);
     }
 
     // SceneData
@@ -968,6 +1347,50 @@ namespace Falcor
         return pAnimation;
     }
 
+    // BlasBuildRecord
+
+    void SceneCache::writeBlasBuildRecord(OutputStream& stream, const BlasBuildRecord& record)
+    {
+        stream.write((uint32_t)record.geometries.size());
+        for (const auto& geometry : record.geometries)
+        {
+            stream.write(geometry.type);
+            stream.write(geometry.flags);
+            stream.write(geometry.vertexCount);
+            stream.write(geometry.indexCount);
+            stream.write(geometry.indexFormat);
+            stream.write(geometry.aabbCount);
+            stream.write(geometry.hasTransform);
+        }
+        stream.write(record.buildFlags);
+        stream.write(record.prebuildInfo.resultDataMaxSize);
+        stream.write(record.prebuildInfo.scratchDataSize);
+        stream.write(record.prebuildInfo.updateScratchDataSize);
+        stream.write(record.finalByteSize);
+    }
+
+    BlasBuildRecord SceneCache::readBlasBuildRecord(InputStream& stream)
+    {
+        BlasBuildRecord record;
+        record.geometries.resize(stream.read<uint32_t>());
+        for (auto& geometry : record.geometries)
+        {
+            stream.read(geometry.type);
+            stream.read(geometry.flags);
+            stream.read(geometry.vertexCount);
+            stream.read(geometry.indexCount);
+            stream.read(geometry.indexFormat);
+            stream.read(geometry.aabbCount);
+            stream.read(geometry.hasTransform);
+        }
+        stream.read(record.buildFlags);
+        stream.read(record.prebuildInfo.resultDataMaxSize);
+        stream.read(record.prebuildInfo.scratchDataSize);
+        stream.read(record.prebuildInfo.updateScratchDataSize);
+        stream.read(record.finalByteSize);
+        return record;
+    }
+
     // Marker
 
     void SceneCache::writeMarker(OutputStream& stream, const std::string& id)
@@ -998,4 +1421,31 @@ namespace Falcor
         stream.read(buffer.mCpuBuffers);
     }
 
+    FALCOR_SCRIPT_BINDING(SceneCache)
+    {
+        using namespace pybind11::literals;
+
+        pybind11::class_<SceneCache> sceneCache(m, "SceneCache");
+        sceneCache.def_static("getCacheDirectory", &SceneCache::getCacheDirectory);
+        sceneCache.def_static("setCacheDirectory", &SceneCache::setCacheDirectory, "path"_a);
+        sceneCache.def_static("getSizeLimit", &SceneCache::getSizeLimit);
+        sceneCache.def_static("setSizeLimit", &SceneCache::setSizeLimit, "byteSize"_a);
+        sceneCache.def_static("getStats", []()
+            {
+                auto stats = SceneCache::getStats();
+                pybind11::dict d;
+                d["hitCount"] = stats.hitCount;
+                d["missCount"] = stats.missCount;
+                d["waitCount"] = stats.waitCount;
+                d["evictionCount"] = stats.evictionCount;
+                d["evictedByteSize"] = stats.evictedByteSize;
+                return d;
+            }
+        );
+        sceneCache.def_static("resetStats", &SceneCache::resetStats);
+        sceneCache.def_static("waitForPendingWrites", &SceneCache::waitForPendingWrites);
+
+        // Flush pending writes when the Python interpreter exits, as the thread pool is not shut down when Falcor is used as a Python module.
+        pybind11::module_::import("atexit").attr("register")(pybind11::cpp_function(&SceneCache::waitForPendingWrites));
+    }
 }
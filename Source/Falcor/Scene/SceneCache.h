@@ -42,6 +42,8 @@
 #include "Utils/CryptoUtils.h"
 
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -50,26 +52,98 @@ namespace Falcor
     template<typename T, bool TUseByteAddressBuffer>
     class SplitBuffer;
 
+    class LockFile;
+
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+
+        The cache directory can be shared by multiple processes, e.g. all processes on a render farm node.
+        Only one process builds a given cache at a time, the others wait for it and then load its result (see findCache()).
+        The total size of the directory is limited. When a new cache is written, the least recently used caches are
+        evicted, as recorded in an index file in the directory. The directory and the size limit can be set with the
+        FALCOR_SCENE_CACHE_DIR and FALCOR_SCENE_CACHE_SIZE_LIMIT_MB environment variables.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** Exclusive right to build the cache for a key. The lock is released when the last reference is dropped.
+        */
+        using BuildLock = std::shared_ptr<LockFile>;
+
+        /** Scene cache statistics of this process.
+        */
+        struct Stats
+        {
+            uint64_t hitCount = 0;          ///< Number of lookups that found a valid cache.
+            uint64_t missCount = 0;         ///< Number of lookups that found no valid cache, so the scene had to be built.
+            uint64_t waitCount = 0;         ///< Number of lookups that waited for another process to build the cache.
+            uint64_t evictionCount = 0;     ///< Number of caches evicted to stay within the size limit.
+            uint64_t evictedByteSize = 0;   ///< Total size in bytes of the evicted caches.
+        };
+
+        /** Set the cache directory. Defaults to a subdirectory of the application data directory.
+        */
+        static void setCacheDirectory(const std::filesystem::path& path);
+
+        /** Get the cache directory.
+        */
+        static std::filesystem::path getCacheDirectory();
+
+        /** Set the size limit of the cache directory in bytes. Zero disables eviction.
+        */
+        static void setSizeLimit(uint64_t byteSize);
+
+        /** Get the size limit of the cache directory in bytes.
+        */
+        static uint64_t getSizeLimit();
+
+        /** Get the statistics of this process.
+        */
+        static Stats getStats();
+
+        /** Reset the statistics of this process.
+        */
+        static void resetStats();
+
         /** Check if there is a valid scene cache for a given cache key.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
         static bool hasValidCache(const Key& key);
 
+        /** Look up the scene cache for a given cache key, coordinating with other processes using the cache directory.
+            If another process is building the cache, this waits until it is done.
+            A found cache can still be evicted by another process before it is read. readCache() throws in that case,
+            and the caller should build the scene with lockForBuild() instead.
+            \param[in] key Cache key.
+            \param[out] buildLock If there is no valid cache, the build lock for the key. Pass it to writeCache() once the scene is built.
+            \return Returns true if a valid cache exists.
+        */
+        static bool findCache(const Key& key, BuildLock& buildLock);
+
+        /** Get the build lock for a key, e.g. to rebuild an existing cache.
+            \param[in] key Cache key.
+            \param[in] acquire If true, blocks until the lock is acquired. Otherwise the lock is only opened.
+            \return Returns the build lock, or nullptr if the lock file could not be opened.
+        */
+        static BuildLock lockForBuild(const Key& key, bool acquire = true);
+
         /** Write a scene cache.
+            The scene data is serialized on the calling thread and compressed on a thread pool while it is serialized.
+            Finishing the file happens in the background, use waitForPendingWrites() to wait until the file is written.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] buildLock Build lock for the key, released once the file is written.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, BuildLock buildLock = {});
+
+        /** Wait until all scene caches written in the background are on disk.
+            This is also called when Falcor's thread pool is shut down (see Threading::shutdown()).
+        */
+        static void waitForPendingWrites();
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -78,11 +152,26 @@ namespace Falcor
         */
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
+        /** Write the BLAS build records of a scene.
+            The records are stored in a separate file next to the scene cache, as they are only known after the BLASes have been built.
+            \param[in] blasBuildCache BLAS build records.
+            \param[in] key Cache key of the scene.
+        */
+        static void writeBlasBuildCache(const BlasBuildCache& blasBuildCache, const Key& key);
+
+        /** Read the BLAS build records of a scene.
+            This does not require a GPU device.
+            \param[in] key Cache key of the scene.
+            \return Returns the BLAS build records, or an empty optional if there are none or they are out of date.
+        */
+        static std::optional<BlasBuildCache> readBlasBuildCache(const Key& key);
+
     private:
         class OutputStream;
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getBlasBuildCachePath(const Key& key);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
         static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
@@ -121,6 +210,9 @@ namespace Falcor
         static void writeAnimation(OutputStream& stream, const ref<Animation>& pAnimation);
         static ref<Animation> readAnimation(InputStream& stream);
 
+        static void writeBlasBuildRecord(OutputStream& stream, const BlasBuildRecord& record);
+        static BlasBuildRecord readBlasBuildRecord(InputStream& stream);
+
         static void writeMarker(OutputStream& stream, const std::string& id);
         static void readMarker(InputStream& stream, const std::string& id);
 
@@ -0,0 +1,308 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SceneCacheFile.h"
+#include "Core/Error.h"
+#include "Core/Platform/LockFile.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/NumericRange.h"
+#include "Utils/StringFormatters.h"
+
+#include <lz4.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <execution>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char* kMagic = "FalcorS$";
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+
+            bool isValid(uint32_t expectedVersion) const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == expectedVersion;
+            }
+        };
+
+        /** Sizes and checksum of one compressed chunk, stored in front of its data.
+            A chunk with an uncompressed size of zero terminates the file.
+        */
+        struct ChunkInfo
+        {
+            uint32_t uncompressedSize = 0;
+            uint32_t compressedSize = 0;
+            uint64_t checksum = 0;
+        };
+
+        /** Compute the checksum of a compressed chunk (64-bit FNV-1a over 8-byte words).
+        */
+        uint64_t computeChecksum(const char* data, size_t size)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+            {
+                uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+                hash = (hash ^ word) * 0x100000001b3ull;
+            }
+            for (; i < size; i++) hash = (hash ^ (uint8_t)data[i]) * 0x100000001b3ull;
+            return hash;
+        }
+    }
+
+    SceneCacheFile::Writer::Writer(const std::filesystem::path& path, uint32_t version, BS::thread_pool& threadPool)
+        : mPath(path)
+        , mTempPath(SceneCacheFile::getTempPath(path))
+        , mThreadPool(threadPool)
+    {
+        std::filesystem::create_directories(mPath.parent_path());
+
+        mStream.open(mTempPath, std::ios_base::binary);
+        if (!mStream) FALCOR_THROW("Failed to create file '{}'.", mTempPath);
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        header.version = version;
+        mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        mBuffer.resize(kChunkSize);
+        setp(mBuffer.data(), mBuffer.data() + mBuffer.size());
+    }
+
+    SceneCacheFile::Writer::~Writer()
+    {
+        if (mFinished) return;
+
+        // Wait for the compression tasks, so no work is left running for a file that is discarded.
+        for (auto& future : mPendingChunks) future.wait();
+        mStream.close();
+        std::error_code ec;
+        std::filesystem::remove(mTempPath, ec);
+    }
+
+    void SceneCacheFile::Writer::finish()
+    {
+        FALCOR_CHECK(!mFinished, "Scene cache file '{}' is already finished.", mPath);
+        if (mFailed) FALCOR_THROW("Failed to write file '{}'.", mTempPath);
+
+        submitChunk();
+        writeCompletedChunks(0);
+
+        // Terminate the chunks, followed by the total size for validation.
+        ChunkInfo end;
+        mStream.write(reinterpret_cast<const char*>(&end), sizeof(end));
+        mStream.write(reinterpret_cast<const char*>(&mByteSize), sizeof(mByteSize));
+        mStream.close();
+        if (!mStream) FALCOR_THROW("Failed to write file '{}'.", mTempPath);
+
+        // Replace the file while holding the lock, so readers in other processes never open it in between.
+        {
+            LockFile lockFile(getLockPath(mPath));
+            if (lockFile.isOpen()) lockFile.lock(LockFile::LockType::Exclusive);
+            std::filesystem::rename(mTempPath, mPath);
+        }
+
+        mBuffer = {};
+        setp(nullptr, nullptr);
+        mFinished = true;
+    }
+
+    SceneCacheFile::Writer::int_type SceneCacheFile::Writer::overflow(int_type ch)
+    {
+        if (mFailed || mFinished) return traits_type::eof();
+
+        // Exceptions are caught by std::ostream, so failures are recorded and reported by finish().
+        try
+        {
+            submitChunk();
+        }
+        catch (const std::exception&)
+        {
+            mFailed = true;
+            return traits_type::eof();
+        }
+
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    void SceneCacheFile::Writer::submitChunk()
+    {
+        const size_t size = pptr() - pbase();
+        if (size == 0) return;
+
+        std::vector<char> data = std::move(mBuffer);
+        data.resize(size);
+        mBuffer.resize(kChunkSize);
+        setp(mBuffer.data(), mBuffer.data() + mBuffer.size());
+        mByteSize += size;
+
+        mPendingChunks.push_back(mThreadPool.submit([data = std::move(data)]()
+        {
+            CompressedChunk chunk;
+            chunk.uncompressedSize = (uint32_t)data.size();
+            chunk.data.resize(LZ4_compressBound((int)data.size()));
+            const int compressedSize = LZ4_compress_default(data.data(), chunk.data.data(), (int)data.size(), (int)chunk.data.size());
+            if (compressedSize <= 0) FALCOR_THROW("Failed to compress scene cache chunk.");
+            chunk.data.resize(compressedSize);
+            return chunk;
+        }));
+
+        // Limit the number of chunks in flight, so memory use doesn't grow with the size of the data.
+        writeCompletedChunks(2 * mThreadPool.get_thread_count());
+    }
+
+    void SceneCacheFile::Writer::writeChunk(std::future<CompressedChunk>& future)
+    {
+        CompressedChunk chunk = future.get();
+
+        ChunkInfo info;
+        info.uncompressedSize = chunk.uncompressedSize;
+        info.compressedSize = (uint32_t)chunk.data.size();
+        info.checksum = computeChecksum(chunk.data.data(), chunk.data.size());
+        mStream.write(reinterpret_cast<const char*>(&info), sizeof(info));
+        mStream.write(chunk.data.data(), chunk.data.size());
+        if (!mStream) FALCOR_THROW("Failed to write file '{}'.", mTempPath);
+        mChunkCount++;
+    }
+
+    void SceneCacheFile::Writer::writeCompletedChunks(size_t maxPendingCount)
+    {
+        // Chunks are written in order. Block on the oldest chunk only if too many are pending.
+        while (!mPendingChunks.empty())
+        {
+            auto& future = mPendingChunks.front();
+            if (mPendingChunks.size() <= maxPendingCount && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) break;
+            writeChunk(future);
+            mPendingChunks.pop_front();
+        }
+    }
+
+    bool SceneCacheFile::hasValidHeader(const std::filesystem::path& path, uint32_t version)
+    {
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs) return false;
+
+        Header header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        return fs && header.isValid(version);
+    }
+
+    std::vector<char> SceneCacheFile::read(const std::filesystem::path& path, uint32_t version)
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) FALCOR_THROW("Failed to open scene cache file '{}'.", path);
+
+        const char* pFileData = static_cast<const char*>(file.getData());
+        const uint64_t fileSize = file.getSize();
+        uint64_t offset = 0;
+        auto readBytes = [&](void* pDst, uint64_t byteSize)
+        {
+            if (byteSize > fileSize - offset) FALCOR_THROW("Scene cache file '{}' is truncated.", path);
+            std::memcpy(pDst, pFileData + offset, byteSize);
+            offset += byteSize;
+        };
+
+        Header header;
+        readBytes(&header, sizeof(header));
+        if (!header.isValid(version)) FALCOR_THROW("Invalid header in scene cache file '{}'.", path);
+
+        // Collect the chunks. Only the last chunk can be smaller than the chunk size.
+        std::vector<ChunkInfo> chunks;
+        std::vector<uint64_t> compressedOffsets;
+        uint64_t byteSize = 0;
+        while (true)
+        {
+            ChunkInfo info;
+            readBytes(&info, sizeof(info));
+            if (info.uncompressedSize == 0)
+            {
+                if (info.compressedSize != 0) FALCOR_THROW("Invalid chunk {} in scene cache file '{}'.", chunks.size(), path);
+                break;
+            }
+            if (!chunks.empty() && chunks.back().uncompressedSize != kChunkSize)
+                FALCOR_THROW("Invalid chunk {} in scene cache file '{}'.", chunks.size(), path);
+            if (info.uncompressedSize > kChunkSize || info.compressedSize == 0 || info.compressedSize > (uint32_t)LZ4_compressBound((int)info.uncompressedSize))
+                FALCOR_THROW("Invalid chunk {} in scene cache file '{}'.", chunks.size(), path);
+            if (info.compressedSize > fileSize - offset) FALCOR_THROW("Scene cache file '{}' is truncated.", path);
+
+            chunks.push_back(info);
+            compressedOffsets.push_back(offset);
+            offset += info.compressedSize;
+            byteSize += info.uncompressedSize;
+        }
+
+        uint64_t expectedByteSize = 0;
+        readBytes(&expectedByteSize, sizeof(expectedByteSize));
+        if (expectedByteSize != byteSize || offset != fileSize) FALCOR_THROW("Invalid size in scene cache file '{}'.", path);
+
+        std::vector<char> data(byteSize);
+        std::atomic<bool> failed{false};
+
+        NumericRange<size_t> range(0, chunks.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            const char* pCompressed = pFileData + compressedOffsets[i];
+            if (computeChecksum(pCompressed, chunks[i].compressedSize) != chunks[i].checksum)
+            {
+                failed = true;
+                return;
+            }
+            const int size = LZ4_decompress_safe(pCompressed, data.data() + i * kChunkSize, (int)chunks[i].compressedSize, (int)chunks[i].uncompressedSize);
+            if (size != (int)chunks[i].uncompressedSize) failed = true;
+        });
+        if (failed) FALCOR_THROW("Failed to decompress scene cache file '{}'.", path);
+
+        return data;
+    }
+
+    std::filesystem::path SceneCacheFile::getLockPath(const std::filesystem::path& path)
+    {
+        auto lockPath = path;
+        lockPath += kLockExtension;
+        return lockPath;
+    }
+
+    std::filesystem::path SceneCacheFile::getTempPath(const std::filesystem::path& path)
+    {
+        std::random_device rd;
+        auto tempPath = path;
+        tempPath += fmt::format(".{:08x}{:08x}.tmp", rd(), rd());
+        return tempPath;
+    }
+}
@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+
+#include <BS_thread_pool/BS_thread_pool.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <streambuf>
+#include <vector>
+
+namespace Falcor
+{
+    /** Compressed file format of the scene cache.
+
+        A file starts with a header, followed by the serialized data split into chunks of kChunkSize bytes.
+        Each chunk is LZ4 compressed independently and stored with its sizes and a checksum, so that chunks can be
+        compressed and decompressed in parallel and corrupted files are detected. The chunks are terminated by an
+        empty chunk and the total uncompressed size.
+    */
+    class FALCOR_API SceneCacheFile
+    {
+    public:
+        /** Size of the uncompressed chunks. Only the last chunk can be smaller.
+        */
+        static constexpr size_t kChunkSize = 4 * 1024 * 1024;
+
+        /** Extension of the lock file guarding replacement of a file (see getLockPath()).
+        */
+        static constexpr const char* kLockExtension = ".lock";
+
+        /** Stream buffer writing a scene cache file.
+            Data written to the stream is compressed on a thread pool one chunk at a time while serialization continues,
+            so the uncompressed data is never held in memory as a whole. The file is written under a temporary name
+            and only renamed to its final path by finish(), so other processes never see a partially written file.
+            If the writer is destroyed without calling finish(), the temporary file is removed.
+        */
+        class FALCOR_API Writer : public std::streambuf
+        {
+        public:
+            /** Create a writer.
+                \param[in] path Path of the file to write.
+                \param[in] version File format version stored in the header.
+                \param[in] threadPool Thread pool used for compression. Must outlive the writer.
+            */
+            Writer(const std::filesystem::path& path, uint32_t version, BS::thread_pool& threadPool);
+            ~Writer();
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            /** Wait for all chunks to be compressed and written, and rename the file to its final path.
+                The file is renamed while holding its lock file (see getLockPath()), so readers holding a shared lock never see it replaced.
+                Throws an exception if compressing or writing failed.
+            */
+            void finish();
+
+            /** Get the path of the temporary file written until finish() is called.
+            */
+            const std::filesystem::path& getTempPath() const { return mTempPath; }
+
+            /** Get the number of chunks written so far.
+            */
+            uint64_t getChunkCount() const { return mChunkCount; }
+
+        protected:
+            int_type overflow(int_type ch) override;
+
+        private:
+            struct CompressedChunk
+            {
+                uint32_t uncompressedSize = 0;
+                std::vector<char> data;
+            };
+
+            void submitChunk();
+            void writeChunk(std::future<CompressedChunk>& future);
+            void writeCompletedChunks(size_t maxPendingCount);
+
+            std::filesystem::path mPath;
+            std::filesystem::path mTempPath;
+            std::ofstream mStream;
+            BS::thread_pool& mThreadPool;
+            std::vector<char> mBuffer;
+            std::deque<std::future<CompressedChunk>> mPendingChunks;
+            uint64_t mByteSize = 0;
+            uint64_t mChunkCount = 0;
+            bool mFailed = false;
+            bool mFinished = false;
+        };
+
+        /** Check if a file has a valid header.
+            \param[in] path File path.
+            \param[in] version Expected file format version.
+            \return Returns true if the file exists and has a valid header.
+        */
+        static bool hasValidHeader(const std::filesystem::path& path, uint32_t version);
+
+        /** Read a file and decompress its data.
+            The file is memory mapped and the chunks are decompressed in parallel.
+            Throws an exception if the file is missing, truncated or corrupted.
+            \param[in] path File path.
+            \param[in] version Expected file format version.
+            \return Returns the uncompressed data.
+        */
+        static std::vector<char> read(const std::filesystem::path& path, uint32_t version);
+
+        /** Get the path of the lock file guarding replacement of a file.
+        */
+        static std::filesystem::path getLockPath(const std::filesystem::path& path);
+
+        /** Get a unique temporary path next to a file.
+        */
+        static std::filesystem::path getTempPath(const std::filesystem::path& path);
+    };
+}
@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SceneCacheIndex.h"
+#include "SceneCacheFile.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/StringFormatters.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Length of a cache file name (hexadecimal SHA-1 digest).
+        */
+        const size_t kCacheFilenameLength = 40;
+
+        bool isLockExtension(const std::string& extension)
+        {
+            const std::string_view lockExtension = SceneCacheFile::kLockExtension;
+            return extension.size() >= lockExtension.size() && extension.compare(extension.size() - lockExtension.size(), lockExtension.size(), lockExtension) == 0;
+        }
+
+        std::filesystem::path getSidecarPath(const std::filesystem::path& cachePath, const std::string& extension)
+        {
+            auto path = cachePath;
+            path += extension;
+            return path;
+        }
+    }
+
+    SceneCacheIndex::SceneCacheIndex(const std::filesystem::path& directory, uint32_t version, std::vector<std::string> sidecarExtensions)
+        : mDirectory(directory)
+        , mVersion(version)
+        , mSidecarExtensions(std::move(sidecarExtensions))
+    {
+        std::filesystem::create_directories(mDirectory);
+        if (mLockFile.open(mDirectory / kIndexLockFilename)) mLockFile.lock(LockFile::LockType::Exclusive);
+        load();
+    }
+
+    void SceneCacheIndex::touch(const std::string& name)
+    {
+        // Access times are strictly increasing, so entries touched within the same millisecond keep their order.
+        int64_t lastAccess = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        for (const auto& [entryName, entry] : mEntries) lastAccess = std::max(lastAccess, entry.lastAccess + 1);
+
+        auto& entry = mEntries[name];
+        entry.byteSize = computeByteSize(name);
+        entry.lastAccess = lastAccess;
+    }
+
+    SceneCacheIndex::EvictionStats SceneCacheIndex::evict(uint64_t sizeLimit, const std::string& keep)
+    {
+        EvictionStats stats;
+        if (sizeLimit == 0) return stats;
+
+        uint64_t totalSize = getTotalByteSize();
+        for (const auto& name : getEntryNames())
+        {
+            if (totalSize <= sizeLimit) break;
+            if (name == keep) continue;
+
+            // Skip entries that are being read, replaced or built by another process.
+            // Lock files are only opened if they exist, as opening creates them.
+            const auto cachePath = mDirectory / name;
+            std::vector<std::unique_ptr<LockFile>> lockFiles;
+            bool locked = false;
+            for (const auto& extension : mSidecarExtensions)
+            {
+                const auto sidecarPath = getSidecarPath(cachePath, extension);
+                if (!isLockExtension(extension) || !std::filesystem::exists(sidecarPath)) continue;
+                auto pLockFile = std::make_unique<LockFile>(sidecarPath);
+                if (pLockFile->isOpen() && !pLockFile->tryLock(LockFile::LockType::Exclusive))
+                {
+                    locked = true;
+                    break;
+                }
+                lockFiles.push_back(std::move(pLockFile));
+            }
+            if (locked) continue;
+
+            std::error_code ec;
+            std::filesystem::remove(cachePath, ec);
+            if (ec) continue;
+
+            // Lock files are closed before removing them, as open files can't be removed on Windows.
+            lockFiles.clear();
+            for (const auto& extension : mSidecarExtensions) std::filesystem::remove(getSidecarPath(cachePath, extension), ec);
+
+            const uint64_t byteSize = mEntries[name].byteSize;
+            totalSize -= std::min(totalSize, byteSize);
+            mEntries.erase(name);
+
+            stats.evictionCount++;
+            stats.evictedByteSize += byteSize;
+            logInfo("Evicted scene cache '{}' ({}).", cachePath, formatByteSize(byteSize));
+        }
+
+        return stats;
+    }
+
+    void SceneCacheIndex::save() const
+    {
+        nlohmann::json entries = nlohmann::json::object();
+        for (const auto& [name, entry] : mEntries)
+            entries[name] = { { "byteSize", entry.byteSize }, { "lastAccess", entry.lastAccess } };
+        nlohmann::json json = { { "version", mVersion }, { "entries", entries } };
+
+        // Write to a temporary file first, so the index is never left partially written.
+        const auto indexPath = mDirectory / kIndexFilename;
+        const auto tempPath = SceneCacheFile::getTempPath(indexPath);
+        {
+            std::ofstream fs(tempPath);
+            fs << json.dump(1);
+            fs.close();
+            if (!fs)
+            {
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, indexPath, ec);
+        if (ec) std::filesystem::remove(tempPath, ec);
+    }
+
+    std::vector<std::string> SceneCacheIndex::getEntryNames() const
+    {
+        std::vector<std::pair<int64_t, std::string>> order;
+        for (const auto& [name, entry] : mEntries) order.emplace_back(entry.lastAccess, name);
+        std::sort(order.begin(), order.end());
+
+        std::vector<std::string> names;
+        for (auto& [lastAccess, name] : order) names.push_back(std::move(name));
+        return names;
+    }
+
+    uint64_t SceneCacheIndex::getByteSize(const std::string& name) const
+    {
+        auto it = mEntries.find(name);
+        return it != mEntries.end() ? it->second.byteSize : 0;
+    }
+
+    uint64_t SceneCacheIndex::getTotalByteSize() const
+    {
+        uint64_t totalSize = 0;
+        for (const auto& [name, entry] : mEntries) totalSize += entry.byteSize;
+        return totalSize;
+    }
+
+    void SceneCacheIndex::load()
+    {
+        try
+        {
+            std::ifstream fs(mDirectory / kIndexFilename);
+            if (fs)
+            {
+                auto json = nlohmann::json::parse(fs);
+                if (json.at("version").get<uint32_t>() == mVersion)
+                {
+                    for (const auto& [name, entry] : json.at("entries").items())
+                    {
+                        if (std::filesystem::exists(mDirectory / name))
+                            mEntries[name] = { entry.at("byteSize").get<uint64_t>(), entry.at("lastAccess").get<int64_t>() };
+                    }
+                    return;
+                }
+            }
+        }
+        catch (const std::exception&)
+        {
+            mEntries.clear();
+        }
+
+        // Rebuild the index from the cache files, which are named by their key. Their last use is unknown, so they are evicted first.
+        for (const auto& file : std::filesystem::directory_iterator(mDirectory))
+        {
+            const auto name = file.path().filename().string();
+            if (file.is_regular_file() && name.size() == kCacheFilenameLength && !file.path().has_extension())
+                mEntries[name] = { computeByteSize(name), 0 };
+        }
+    }
+
+    uint64_t SceneCacheIndex::computeByteSize(const std::string& name) const
+    {
+        const auto cachePath = mDirectory / name;
+        uint64_t byteSize = 0;
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(cachePath, ec);
+        if (!ec) byteSize += fileSize;
+        for (const auto& extension : mSidecarExtensions)
+        {
+            fileSize = std::filesystem::file_size(getSidecarPath(cachePath, extension), ec);
+            if (!ec) byteSize += fileSize;
+        }
+        return byteSize;
+    }
+}
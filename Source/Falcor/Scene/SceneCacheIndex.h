@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/LockFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** LRU index of a scene cache directory.
+
+        The index is shared by all processes using the directory. It is locked from construction until destruction.
+        If the index file is missing, invalid or was written for another cache version, it is rebuilt from the cache
+        files in the directory. Cache files are named by their key (40 hexadecimal digits) and have no extension.
+
+        Each entry consists of a cache file and its sidecar files, which are named by appending an extension to the
+        cache file name (e.g. lock files and BLAS build records). Sidecars are counted toward the size of the entry and
+        removed when it is evicted. Sidecars with a ".lock" extension are lock files, and an entry is not evicted while
+        another process holds one of them.
+    */
+    class FALCOR_API SceneCacheIndex
+    {
+    public:
+        /** Result of an eviction.
+        */
+        struct EvictionStats
+        {
+            uint64_t evictionCount = 0;     ///< Number of evicted entries.
+            uint64_t evictedByteSize = 0;   ///< Total size in bytes of the evicted entries, including their sidecar files.
+        };
+
+        /** Open and lock the index of a cache directory.
+            \param[in] directory Cache directory. It is created if it doesn't exist.
+            \param[in] version Cache version. An index written for another version is rebuilt.
+            \param[in] sidecarExtensions Extensions of the sidecar files stored next to each cache file.
+        */
+        SceneCacheIndex(const std::filesystem::path& directory, uint32_t version, std::vector<std::string> sidecarExtensions);
+
+        SceneCacheIndex(const SceneCacheIndex&) = delete;
+        SceneCacheIndex& operator=(const SceneCacheIndex&) = delete;
+
+        /** Mark an entry as most recently used and update its size from the files on disk.
+            \param[in] name Entry name (cache file name).
+        */
+        void touch(const std::string& name);
+
+        /** Evict least recently used entries until the total size is within the limit.
+            Entries that are locked by another process are skipped.
+            \param[in] sizeLimit Size limit in bytes. Zero disables eviction.
+            \param[in] keep Name of an entry that must not be evicted.
+            \return Returns the number and size of the evicted entries.
+        */
+        EvictionStats evict(uint64_t sizeLimit, const std::string& keep = {});
+
+        /** Write the index file. Errors are ignored, as the index is rebuilt if it is missing.
+        */
+        void save() const;
+
+        /** Get the names of all entries, least recently used first.
+        */
+        std::vector<std::string> getEntryNames() const;
+
+        /** Get the size of an entry in bytes, including its sidecar files. Returns zero if there is no such entry.
+        */
+        uint64_t getByteSize(const std::string& name) const;
+
+        /** Get the total size of all entries in bytes.
+        */
+        uint64_t getTotalByteSize() const;
+
+        /** Name of the index file in the cache directory.
+        */
+        static constexpr const char* kIndexFilename = "index.json";
+
+        /** Name of the lock file guarding the index.
+        */
+        static constexpr const char* kIndexLockFilename = "index.lock";
+
+    private:
+        struct Entry
+        {
+            uint64_t byteSize = 0;
+            int64_t lastAccess = 0;
+        };
+
+        void load();
+        uint64_t computeByteSize(const std::string& name) const;
+
+        std::filesystem::path mDirectory;
+        uint32_t mVersion;
+        std::vector<std::string> mSidecarExtensions;
+        LockFile mLockFile;
+        std::map<std::string, Entry> mEntries;
+    };
+}
@@ -31,10 +31,13 @@
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Core/API/PythonHelpers.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace Falcor
 {
@@ -43,9 +46,29 @@ namespace Falcor
         return ref<TriangleMesh>(new TriangleMesh());
     }
 
-    ref<TriangleMesh> TriangleMesh::create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
+    ref<TriangleMesh> TriangleMesh::create(VertexList vertices, IndexList indices, bool frontFaceCW)
     {
-        return ref<TriangleMesh>(new TriangleMesh(vertices, indices, frontFaceCW));
+        return ref<TriangleMesh>(new TriangleMesh(std::move(vertices), std::move(indices), frontFaceCW));
+    }
+
+    ref<TriangleMesh> TriangleMesh::create(size_t vertexCount, const float3* pPositions, const float3* pNormals, const float2* pTexCoords, size_t indexCount, const uint32_t* pIndices, bool frontFaceCW)
+    {
+        FALCOR_CHECK(vertexCount <= std::numeric_limits<uint32_t>::max(), "'vertexCount' ({}) is too large", vertexCount);
+        FALCOR_CHECK(vertexCount == 0 || (pPositions && pNormals), "'pPositions' and 'pNormals' are required");
+        FALCOR_CHECK(indexCount % 3 == 0, "'indexCount' ({}) must be a multiple of 3", indexCount);
+        FALCOR_CHECK(indexCount == 0 || pIndices, "'pIndices' is missing");
+
+        VertexList vertices(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            vertices[i] = { pPositions[i], pNormals[i], pTexCoords ? pTexCoords[i] : float2(0.f) };
+        }
+
+        IndexList indices(pIndices, pIndices + indexCount);
+        auto maxIndex = std::max_element(indices.begin(), indices.end());
+        FALCOR_CHECK(maxIndex == indices.end() || *maxIndex < vertexCount, "Vertex index {} is out of range (vertex count is {})", *maxIndex, vertexCount);
+
+        return ref<TriangleMesh>(new TriangleMesh(std::move(vertices), std::move(indices), frontFaceCW));
     }
 
     ref<TriangleMesh> TriangleMesh::createDummy()
@@ -316,9 +339,9 @@ namespace Falcor
     TriangleMesh::TriangleMesh()
     {}
 
-    TriangleMesh::TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
-        : mVertices(vertices)
-        , mIndices(indices)
+    TriangleMesh::TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW)
+        : mVertices(std::move(vertices))
+        , mIndices(std::move(indices))
         , mFrontFaceCW(frontFaceCW)
     {}
 
@@ -346,6 +369,25 @@ namespace Falcor
         triangleMesh.def(pybind11::init(pybind11::overload_cast<>(&TriangleMesh::create)));
         triangleMesh.def("addVertex", &TriangleMesh::addVertex, "position"_a, "normal"_a, "texCoord"_a);
         triangleMesh.def("addTriangle", &TriangleMesh::addTriangle, "i0"_a, "i1"_a, "i2"_a);
+        triangleMesh.def_static("createFromNumpy",
+            [](pybind11::ndarray<pybind11::numpy, float, pybind11::c_contig, pybind11::device::cpu> positions,
+               pybind11::ndarray<pybind11::numpy, float, pybind11::c_contig, pybind11::device::cpu> normals,
+               pybind11::ndarray<pybind11::numpy, uint32_t, pybind11::c_contig, pybind11::device::cpu> indices,
+               std::optional<pybind11::ndarray<pybind11::numpy, float, pybind11::c_contig, pybind11::device::cpu>> texCoords,
+               bool frontFaceCW)
+            {
+                size_t vertexCount = getNdarrayElementCount(positions, 3, "positions");
+                FALCOR_CHECK(getNdarrayElementCount(normals, 3, "normals") == vertexCount, "'normals' must have the same number of elements as 'positions'");
+                FALCOR_CHECK(!texCoords || getNdarrayElementCount(*texCoords, 2, "texCoords") == vertexCount, "'texCoords' must have the same number of elements as 'positions'");
+                size_t indexCount = getNdarraySize(indices);
+
+                return TriangleMesh::create(
+                    vertexCount, reinterpret_cast<const float3*>(positions.data()), reinterpret_cast<const float3*>(normals.data()),
+                    texCoords ? reinterpret_cast<const float2*>(texCoords->data()) : nullptr, indexCount, indices.data(), frontFaceCW
+                );
+            },
+            "positions"_a, "normals"_a, "indices"_a, "texCoords"_a = pybind11::none(), "frontFaceCW"_a = false
+        );
         triangleMesh.def_static("createQuad", &TriangleMesh::createQuad, "size"_a = float2(1.f));
         triangleMesh.def_static("createDisk", &TriangleMesh::createDisk, "radius"_a = 1.f, "segments"_a = 32);
         triangleMesh.def_static("createCube", &TriangleMesh::createCube, "size"_a = float3(1.f));
@@ -71,12 +71,24 @@ namespace Falcor
         static ref<TriangleMesh> create();
 
         /** Creates a triangle mesh.
-            \param[in] vertices Vertex list.
-            \param[in] indices Index list.
+            \param[in] vertices Vertex list. Pass an rvalue to avoid copying the data.
+            \param[in] indices Index list. Pass an rvalue to avoid copying the data.
             \param[in] frontFaceCW Triangle winding.
             \return Returns the triangle mesh.
         */
-        static ref<TriangleMesh> create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW = false);
+        static ref<TriangleMesh> create(VertexList vertices, IndexList indices, bool frontFaceCW = false);
+
+        /** Creates a triangle mesh from separate vertex attribute arrays.
+            \param[in] vertexCount Number of vertices.
+            \param[in] pPositions Array of vertex positions.
+            \param[in] pNormals Array of vertex normals.
+            \param[in] pTexCoords Array of vertex texture coordinates, or nullptr to set all texture coordinates to zero.
+            \param[in] indexCount Number of indices, must be a multiple of 3.
+            \param[in] pIndices Array of vertex indices.
+            \param[in] frontFaceCW Triangle winding.
+            \return Returns the triangle mesh.
+        */
+        static ref<TriangleMesh> create(size_t vertexCount, const float3* pPositions, const float3* pNormals, const float2* pTexCoords, size_t indexCount, const uint32_t* pIndices, bool frontFaceCW = false);
 
         /** Creates a dummy mesh (single degenerate triangle).
             \return Returns the triangle mesh.
@@ -188,7 +200,7 @@ namespace Falcor
 
     private:
         TriangleMesh();
-        TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW);
+        TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW);
 
         std::string mName;
         std::vector<Vertex> mVertices;
@@ -0,0 +1,441 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheOptimizer.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        /** Parameters of Forsyth's vertex scoring. The modeled LRU cache is larger than the FIFO cache used for the statistics,
+            as the scoring works best with a cache size larger than the hardware's.
+        */
+        const uint32_t kScoringCacheSize = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriangleScore = 0.75f;
+        const float kValenceBoostScale = 2.f;
+        const float kValenceBoostPower = 0.5f;
+        const uint32_t kMaxTabulatedValence = 64;
+
+        /** Maximum number of remaining triangles of a cached vertex that are scored when picking the next triangle.
+            This bounds the work per emitted triangle, which would otherwise be quadratic in the valence of vertices
+            shared by many triangles (e.g., the center of a triangle fan).
+        */
+        const uint32_t kMaxCandidatesPerVertex = 16;
+
+        struct VertexScoreTable
+        {
+            std::array<float, kScoringCacheSize> cache;
+            std::array<float, kMaxTabulatedValence> valence;
+
+            VertexScoreTable()
+            {
+                for (uint32_t i = 0; i < kScoringCacheSize; i++)
+                {
+                    // The vertices of the last triangle get a fixed score, so that the next triangle doesn't just reuse the same edge.
+                    cache[i] = i < 3 ? kLastTriangleScore : std::pow(1.f - (float)(i - 3) / (kScoringCacheSize - 3), kCacheDecayPower);
+                }
+                for (uint32_t i = 0; i < kMaxTabulatedValence; i++)
+                {
+                    // Boost vertices with few remaining triangles, to finish them off and avoid leaving isolated triangles behind.
+                    valence[i] = i > 0 ? kValenceBoostScale * std::pow((float)i, -kValenceBoostPower) : 0.f;
+                }
+            }
+
+            float getScore(int32_t cachePosition, uint32_t remainingValence) const
+            {
+                if (remainingValence == 0) return -1.f;
+                float score = cachePosition >= 0 ? cache[cachePosition] : 0.f;
+                score += remainingValence < kMaxTabulatedValence ? valence[remainingValence] : kValenceBoostScale * std::pow((float)remainingValence, -kValenceBoostPower);
+                return score;
+            }
+        };
+
+        /** FIFO cache simulation. A vertex is in the cache if fewer than cacheSize misses happened since it was loaded.
+        */
+        class FifoCache
+        {
+        public:
+            FifoCache(uint32_t vertexCount, uint32_t cacheSize) : mLoadTime(vertexCount, 0), mCacheSize(cacheSize), mTime(cacheSize + 1) {}
+
+            /** Access a vertex. Returns true on a cache miss.
+            */
+            bool access(uint32_t v)
+            {
+                if (mTime - mLoadTime[v] <= mCacheSize) return false;
+                mLoadTime[v] = mTime++;
+                return true;
+            }
+
+            /** Get the number of distinct vertices accessed so far.
+            */
+            uint64_t getVertexCount() const
+            {
+                return std::count_if(mLoadTime.begin(), mLoadTime.end(), [](uint64_t t) { return t != 0; });
+            }
+
+        private:
+            std::vector<uint64_t> mLoadTime;
+            uint64_t mCacheSize;
+            uint64_t mTime;
+        };
+    }
+
+    VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other)
+    {
+        triangleCount += other.triangleCount;
+        vertexCount += other.vertexCount;
+        cacheMissCount += other.cacheMissCount;
+        return *this;
+    }
+
+    VertexCacheStats computeVertexCacheStats(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+
+        VertexCacheStats stats;
+        FifoCache cache(vertexCount, cacheSize);
+        for (uint32_t v : indices)
+        {
+            FALCOR_ASSERT(v < vertexCount);
+            if (cache.access(v)) stats.cacheMissCount++;
+        }
+        stats.triangleCount = indices.size() / 3;
+        stats.vertexCount = cache.getVertexCount();
+        return stats;
+    }
+
+    void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        if (triangleCount == 0) return;
+
+        static const VertexScoreTable kScoreTable;
+
+        // Build the vertex to triangle adjacency. The triangle corners (3 * triangle + k) of each vertex are stored
+        // consecutively, the first 'valence[v]' of them belong to triangles that are not emitted yet.
+        // 'adjacencySlot' stores the position of each corner in the adjacency, so that emitted triangles are removed in constant time.
+        std::vector<uint32_t> valence(vertexCount, 0);
+        for (uint32_t v : indices)
+        {
+            FALCOR_ASSERT(v < vertexCount);
+            valence[v]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> adjacencySlot(indices.size());
+        {
+            std::vector<uint32_t> fillOffset(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (uint32_t c = 0; c < (uint32_t)indices.size(); c++)
+            {
+                uint32_t slot = fillOffset[indices[c]]++;
+                adjacency[slot] = c;
+                adjacencySlot[c] = slot;
+            }
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) vertexScore[v] = kScoreTable.getScore(-1, valence[v]);
+
+        auto getTriangleScore = [&](uint32_t t)
+        {
+            return vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+        };
+
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+
+        std::array<uint32_t, kScoringCacheSize + 3> cache;
+        std::array<uint32_t, kScoringCacheSize + 3> newCache;
+        uint32_t cacheCount = 0;
+
+        uint32_t bestTriangle = kInvalidIndex;
+        uint32_t inputCursor = 0;
+
+        for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            // At a dead end, where no cached vertex has triangles left, continue with the next triangle in input order.
+            if (bestTriangle == kInvalidIndex)
+            {
+                while (emitted[inputCursor]) inputCursor++;
+                bestTriangle = inputCursor;
+            }
+
+            const uint32_t t = bestTriangle;
+            const uint32_t tri[3] = { indices[3 * t], indices[3 * t + 1], indices[3 * t + 2] };
+            emitted[t] = 1;
+            output.insert(output.end(), tri, tri + 3);
+
+            // Remove the triangle from the remaining triangles of its vertices, by swapping its corners with the last remaining ones.
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                const uint32_t c = 3 * t + k;
+                const uint32_t v = tri[k];
+                FALCOR_ASSERT(valence[v] > 0);
+                const uint32_t slot = adjacencySlot[c];
+                const uint32_t lastSlot = adjacencyOffset[v] + valence[v] - 1;
+                FALCOR_ASSERT(slot <= lastSlot && adjacency[slot] == c);
+                const uint32_t lastCorner = adjacency[lastSlot];
+                adjacency[slot] = lastCorner;
+                adjacencySlot[lastCorner] = slot;
+                adjacency[lastSlot] = c;
+                adjacencySlot[c] = lastSlot;
+                valence[v]--;
+            }
+
+            // Move the triangle's vertices to the front of the LRU cache.
+            uint32_t newCount = 0;
+            for (uint32_t v : tri)
+            {
+                if (std::find(newCache.begin(), newCache.begin() + newCount, v) == newCache.begin() + newCount) newCache[newCount++] = v;
+            }
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                if (v != tri[0] && v != tri[1] && v != tri[2]) newCache[newCount++] = v;
+            }
+
+            // Update the vertices that dropped out of the cache.
+            for (uint32_t i = kScoringCacheSize; i < newCount; i++)
+            {
+                uint32_t v = newCache[i];
+                cachePosition[v] = -1;
+                vertexScore[v] = kScoreTable.getScore(-1, valence[v]);
+            }
+
+            cacheCount = std::min(newCount, kScoringCacheSize);
+            std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                cachePosition[v] = (int32_t)i;
+                vertexScore[v] = kScoreTable.getScore((int32_t)i, valence[v]);
+            }
+
+            // Pick the best remaining triangle using a cached vertex. Only a bounded number of triangles is scored per vertex.
+            bestTriangle = kInvalidIndex;
+            float bestScore = -std::numeric_limits<float>::infinity();
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                const uint32_t* pAdjacent = adjacency.data() + adjacencyOffset[v];
+                const uint32_t candidateCount = std::min(valence[v], kMaxCandidatesPerVertex);
+                for (uint32_t j = 0; j < candidateCount; j++)
+                {
+                    const uint32_t candidate = pAdjacent[j] / 3;
+                    float score = getTriangleScore(candidate);
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestTriangle = candidate;
+                    }
+                }
+            }
+        }
+
+        indices = std::move(output);
+    }
+
+    bool optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<float3>& positions, float threshold)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        const uint32_t vertexCount = (uint32_t)positions.size();
+        if (triangleCount == 0) return false;
+
+        // Split the triangles into clusters where all vertices of a triangle miss the cache.
+        // Reordering the clusters then only costs a few extra misses at the cluster boundaries.
+        std::vector<uint32_t> clusterStart;
+        {
+            FifoCache cache(vertexCount, kVertexCacheSize);
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                uint32_t missCount = 0;
+                for (uint32_t k = 0; k < 3; k++) missCount += cache.access(indices[3 * t + k]) ? 1 : 0;
+                if (t == 0 || missCount == 3) clusterStart.push_back(t);
+            }
+        }
+        const uint32_t clusterCount = (uint32_t)clusterStart.size();
+        if (clusterCount <= 1) return false;
+        clusterStart.push_back(triangleCount);
+
+        // Compute the area-weighted centroid and the average normal of each cluster, and the centroid of the mesh.
+        std::vector<float3> clusterCentroid(clusterCount, float3(0.f));
+        std::vector<float3> clusterNormal(clusterCount, float3(0.f));
+        float3 meshCentroid = float3(0.f);
+        float meshArea = 0.f;
+        for (uint32_t c = 0; c < clusterCount; c++)
+        {
+            float clusterArea = 0.f;
+            for (uint32_t t = clusterStart[c]; t < clusterStart[c + 1]; t++)
+            {
+                const float3 p0 = positions[indices[3 * t]];
+                const float3 p1 = positions[indices[3 * t + 1]];
+                const float3 p2 = positions[indices[3 * t + 2]];
+                const float3 n = cross(p1 - p0, p2 - p0);
+                const float area = length(n);
+                clusterCentroid[c] += (p0 + p1 + p2) * (area / 3.f);
+                clusterNormal[c] += n;
+                clusterArea += area;
+            }
+            meshCentroid += clusterCentroid[c];
+            meshArea += clusterArea;
+            if (clusterArea > 0.f) clusterCentroid[c] /= clusterArea;
+        }
+        if (meshArea > 0.f) meshCentroid /= meshArea;
+
+        // Draw the clusters facing away from the mesh center first, as they are likely to occlude the others.
+        std::vector<float> sortKey(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++)
+        {
+            float normalLength = length(clusterNormal[c]);
+            sortKey[c] = normalLength > 0.f ? dot(clusterCentroid[c] - meshCentroid, clusterNormal[c] / normalLength) : 0.f;
+        }
+        std::vector<uint32_t> clusterOrder(clusterCount);
+        std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        for (uint32_t c : clusterOrder)
+        {
+            output.insert(output.end(), indices.begin() + 3 * clusterStart[c], indices.begin() + 3 * clusterStart[c + 1]);
+        }
+
+        // Keep the original order if the cache efficiency degrades too much.
+        const double acmr = computeVertexCacheStats(indices, vertexCount).getACMR();
+        const double newAcmr = computeVertexCacheStats(output, vertexCount).getACMR();
+        if (newAcmr > acmr * threshold) return false;
+
+        indices = std::move(output);
+        return true;
+    }
+
+    std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+        uint32_t nextIndex = 0;
+        for (uint32_t& v : indices)
+        {
+            FALCOR_ASSERT(v < vertexCount);
+            if (remap[v] == kInvalidIndex) remap[v] = nextIndex++;
+            v = remap[v];
+        }
+        for (uint32_t& newIndex : remap)
+        {
+            if (newIndex == kInvalidIndex) newIndex = nextIndex++;
+        }
+        return remap;
+    }
+
+    VertexOrderStats optimizeVertexOrder(
+        std::vector<uint32_t>& indexData,
+        uint32_t indexCount,
+        bool use16BitIndices,
+        std::vector<StaticVertexData>& staticData,
+        std::vector<SkinningVertexData>& skinningData,
+        std::vector<std::vector<PackedStaticVertexData>>* pKeyframes)
+    {
+        const uint32_t vertexCount = (uint32_t)staticData.size();
+        FALCOR_CHECK(indexCount % 3 == 0, "Index count must be a multiple of 3.");
+        FALCOR_CHECK(indexData.size() * sizeof(uint32_t) >= indexCount * (use16BitIndices ? sizeof(uint16_t) : sizeof(uint32_t)), "Index data is too small.");
+        FALCOR_CHECK(skinningData.empty() || skinningData.size() == vertexCount, "Skinning data must have one entry per vertex.");
+        for (const auto& s : skinningData) FALCOR_CHECK(s.staticIndex < vertexCount, "Skinning static index out of range.");
+        if (pKeyframes)
+        {
+            for (const auto& vertexData : *pKeyframes) FALCOR_CHECK(vertexData.size() == vertexCount, "Keyframe vertex data must have one entry per vertex.");
+        }
+
+        std::vector<uint32_t> indices(indexCount);
+        const uint16_t* pIndices16 = reinterpret_cast<const uint16_t*>(indexData.data());
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            indices[i] = use16BitIndices ? pIndices16[i] : indexData[i];
+            FALCOR_CHECK(indices[i] < vertexCount, "Vertex index out of range.");
+        }
+
+        VertexOrderStats stats;
+        stats.before = computeVertexCacheStats(indices, vertexCount);
+
+        optimizeVertexCache(indices, vertexCount);
+
+        std::vector<float3> positions(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) positions[v] = staticData[v].position;
+        stats.overdrawOptimized = optimizeOverdraw(indices, positions);
+
+        std::vector<uint32_t> remap = optimizeVertexFetch(indices, vertexCount);
+
+        stats.after = computeVertexCacheStats(indices, vertexCount);
+
+        // Write back the indices in their original format.
+        if (use16BitIndices)
+        {
+            uint16_t* pIndices = reinterpret_cast<uint16_t*>(indexData.data());
+            for (uint32_t i = 0; i < indexCount; i++) pIndices[i] = (uint16_t)indices[i];
+        }
+        else
+        {
+            std::copy(indices.begin(), indices.end(), indexData.begin());
+        }
+
+        // Reorder the vertex data.
+        auto reorder = [&remap](auto& data)
+        {
+            std::remove_reference_t<decltype(data)> reordered(data.size());
+            for (size_t v = 0; v < data.size(); v++) reordered[remap[v]] = data[v];
+            data = std::move(reordered);
+        };
+
+        reorder(staticData);
+
+        // The static index of a skinned vertex refers to the mesh's own static vertices at this point.
+        reorder(skinningData);
+        for (auto& s : skinningData) s.staticIndex = remap[s.staticIndex];
+
+        if (pKeyframes)
+        {
+            for (auto& vertexData : *pKeyframes) reorder(vertexData);
+        }
+
+        return stats;
+    }
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SceneTypes.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Size of the FIFO vertex cache used to measure the post-transform cache efficiency.
+    */
+    const uint32_t kVertexCacheSize = 16;
+
+    /** Post-transform vertex cache statistics of an index buffer.
+    */
+    struct VertexCacheStats
+    {
+        uint64_t triangleCount = 0;     ///< Number of triangles.
+        uint64_t vertexCount = 0;       ///< Number of distinct vertices referenced by the triangles.
+        uint64_t cacheMissCount = 0;    ///< Number of vertices transformed, i.e., cache misses.
+
+        /** Get the average cache miss ratio, the number of transformed vertices per triangle. The lower bound is 0.5 for large regular meshes.
+        */
+        double getACMR() const { return triangleCount > 0 ? (double)cacheMissCount / triangleCount : 0.0; }
+
+        /** Get the average transformed to vertex ratio. The lower bound is 1.
+        */
+        double getATVR() const { return vertexCount > 0 ? (double)cacheMissCount / vertexCount : 0.0; }
+
+        VertexCacheStats& operator+=(const VertexCacheStats& other);
+    };
+
+    /** Simulate a FIFO post-transform vertex cache.
+        \param[in] indices Triangle list indices.
+        \param[in] vertexCount Number of vertices.
+        \param[in] cacheSize Number of entries in the cache.
+        \return Cache statistics.
+    */
+    FALCOR_API VertexCacheStats computeVertexCacheStats(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = kVertexCacheSize);
+
+    /** Reorder triangles for post-transform vertex cache efficiency.
+        This is an implementation of Forsyth's linear-speed vertex cache optimization. The winding of the triangles is preserved.
+        The number of candidate triangles scored per cached vertex is bounded, so the cost stays linear for high-valence vertices.
+        \param[in,out] indices Triangle list indices.
+        \param[in] vertexCount Number of vertices.
+    */
+    FALCOR_API void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+    /** Reorder clusters of triangles to reduce overdraw, keeping the vertex cache efficiency.
+        The indices should be optimized with optimizeVertexCache() first. The triangles are split into clusters where
+        the cache is restarted, and the clusters are sorted so that the ones facing away from the mesh center are drawn
+        first. The new order is only used if the cache miss ratio stays within the threshold.
+        \param[in,out] indices Triangle list indices.
+        \param[in] positions Vertex positions.
+        \param[in] threshold Maximum allowed ratio of the cache miss ratio after and before reordering.
+        \return True if the indices were reordered.
+    */
+    FALCOR_API bool optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<float3>& positions, float threshold = 1.05f);
+
+    /** Compute a vertex order for fetch locality, where vertices are ordered by their first use.
+        The indices are updated to the new order. Vertices not referenced by the indices are placed last, in their original order.
+        \param[in,out] indices Triangle list indices.
+        \param[in] vertexCount Number of vertices.
+        \return Mapping from old to new vertex indices.
+    */
+    FALCOR_API std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+    /** Result of optimizing the vertex order of a mesh.
+    */
+    struct VertexOrderStats
+    {
+        VertexCacheStats before;            ///< Cache statistics before optimization.
+        VertexCacheStats after;             ///< Cache statistics after optimization.
+        bool overdrawOptimized = false;     ///< True if the triangles were reordered for overdraw.
+    };
+
+    /** Optimize the triangle and vertex order of an indexed triangle list mesh.
+        The triangles are reordered with optimizeVertexCache() and optimizeOverdraw(), and the vertices with optimizeVertexFetch().
+        All per-vertex data is reordered consistently, so that every triangle references the same vertex data as before.
+        \param[in,out] indexData Vertex indices in either 32-bit or 16-bit format packed tightly. The format is preserved.
+        \param[in] indexCount Number of indices.
+        \param[in] use16BitIndices True if the indices are in 16-bit format.
+        \param[in,out] staticData Static vertex data.
+        \param[in,out] skinningData Skinning vertex data, either empty or one per static vertex. The static indices are remapped.
+        \param[in,out] pKeyframes Vertex data of each keyframe of a vertex-animated mesh, one per static vertex, or nullptr.
+        eturn Cache statistics before and after optimization.
+    */
+    FALCOR_API VertexOrderStats optimizeVertexOrder(
+        std::vector<uint32_t>& indexData,
+        uint32_t indexCount,
+        bool use16BitIndices,
+        std::vector<StaticVertexData>& staticData,
+        std::vector<SkinningVertexData>& skinningData,
+        std::vector<std::vector<PackedStaticVertexData>>* pKeyframes);
+}
@@ -38,15 +38,19 @@
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/Vector.h"
+#include "Utils/Timing/CpuTimer.h"
 
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <pugixml.hpp>
 #include <BS_thread_pool/BS_thread_pool_light.hpp>
+#include <nlohmann/json.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <regex>
+#include <cmath>
 #include <cstdint>
 
 namespace Falcor
@@ -61,6 +65,7 @@ struct TestDesc
     unittest::Options options;
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    CPUBenchmarkFunc benchmarkFunc;
 };
 
 struct TestResult
@@ -76,6 +81,7 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    BenchmarkResult benchmark;
 };
 
 static std::vector<TestDesc>& getTestRegistry()
@@ -143,6 +149,16 @@ void registerGPUTest(std::filesystem::path path, std::string name, unittest::Opt
     getTestRegistry().push_back(desc);
 }
 
+void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, CPUBenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.benchmarkFunc = std::move(func);
+    getTestRegistry().push_back(desc);
+}
+
 /// Prints the UnitTest report line, making sure it is always printed to the console once.
 template<typename... Args>
 void reportLine(const std::string_view format, Args&&... args)
@@ -211,7 +227,125 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
-inline TestResult runTest(const Test& test, DevicePool& devicePool)
+/**
+ * Write the benchmark results in JSON format.
+ * The same format is read back by loadBenchmarkBaseline().
+ * @param[in] path File path.
+ * @param[in] report List of tests/results.
+ */
+inline void writeBenchmarkReport(const std::filesystem::path& path, const std::vector<std::pair<Test, TestResult>>& report)
+{
+    nlohmann::json benchmarks = nlohmann::json::array();
+    for (const auto& [test, result] : report)
+    {
+        if (!result.benchmark.isValid())
+            continue;
+
+        const BenchmarkResult& benchmark = result.benchmark;
+        nlohmann::json entry = {
+            {"suite", test.suiteName},
+            {"name", test.name},
+            {"iterations", benchmark.iterations},
+            {"repetitions", benchmark.repetitions},
+            {"median_ms", benchmark.timeMS.median},
+            {"mad_ms", benchmark.timeMS.mad},
+            {"min_ms", benchmark.timeMS.min},
+        };
+        if (benchmark.itemsPerIteration > 0)
+            entry["items_per_second"] = benchmark.getItemsPerSecond();
+        if (benchmark.bytesPerIteration > 0)
+            entry["bytes_per_second"] = benchmark.getBytesPerSecond();
+        entry["passed"] = result.status != TestResult::Status::Failed;
+        benchmarks.push_back(entry);
+    }
+
+    nlohmann::json doc = {{"version", getLongVersionString()}, {"benchmarks", benchmarks}};
+
+    std::ofstream ofs(path);
+    if (!ofs.good())
+        FALCOR_THROW("Failed to write benchmark report to '{}'.", path);
+    ofs << doc.dump(4) << std::endl;
+}
+
+/**
+ * Load the median times of a previous benchmark report.
+ * @param[in] path File path.
+ * @return Map from "suite:name" to the median time in milliseconds.
+ */
+inline std::map<std::string, double> loadBenchmarkBaseline(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs.good())
+        FALCOR_THROW("Failed to open benchmark baseline '{}'.", path);
+
+    std::map<std::string, double> baseline;
+    try
+    {
+        nlohmann::json doc = nlohmann::json::parse(ifs);
+        for (const auto& entry : doc.at("benchmarks"))
+        {
+            std::string key = entry.at("suite").get<std::string>() + ":" + entry.at("name").get<std::string>();
+            baseline[key] = entry.at("median_ms").get<double>();
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        FALCOR_THROW("Failed to parse benchmark baseline '{}': {}", path, e.what());
+    }
+    return baseline;
+}
+
+/**
+ * Report the result of a benchmark and compare it against the baseline.
+ * The result is marked as failed if the median time regressed by more than the threshold.
+ */
+inline void checkBenchmarkResult(
+    const Test& test,
+    TestResult& result,
+    const std::map<std::string, double>& baseline,
+    const BenchmarkOptions& options
+)
+{
+    const BenchmarkResult& benchmark = result.benchmark;
+    if (!benchmark.isValid())
+        return;
+
+    std::string throughput;
+    if (benchmark.itemsPerIteration > 0)
+        throughput += fmt::format(", {:.3f} Mitems/s", benchmark.getItemsPerSecond() * 1e-6);
+    if (benchmark.bytesPerIteration > 0)
+        throughput += fmt::format(", {:.3f} MB/s", benchmark.getBytesPerSecond() * 1e-6);
+    reportLine(
+        "[    STATS ] median {:.6f} ms, MAD {:.6f} ms, min {:.6f} ms ({} x {} iterations){}",
+        benchmark.timeMS.median,
+        benchmark.timeMS.mad,
+        benchmark.timeMS.min,
+        benchmark.repetitions,
+        benchmark.iterations,
+        throughput
+    );
+
+    auto it = baseline.find(test.suiteName + ":" + test.name);
+    if (it == baseline.end() || it->second <= 0.0)
+        return;
+
+    double change = benchmark.timeMS.median / it->second - 1.0;
+    reportLine("[ BASELINE ] median {:.6f} ms ({:+.1f}%)", it->second, change * 100.0);
+    if (change > options.regressionThreshold)
+    {
+        result.status = TestResult::Status::Failed;
+        result.messages.push_back(fmt::format(
+            "Median time {:.6f} ms regressed by {:.1f}% over baseline {:.6f} ms (threshold {:.1f}%).",
+            benchmark.timeMS.median,
+            change * 100.0,
+            it->second,
+            options.regressionThreshold * 100.0
+        ));
+        reportLine("{}", result.messages.back());
+    }
+}
+
+inline TestResult runTest(const Test& test, DevicePool& devicePool, const RunOptions& options)
 {
     if (!test.skipMessage.empty())
         return {TestResult::Status::Skipped, {test.skipMessage}};
@@ -243,6 +377,15 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
             pDevice->wait();
             devicePool.releaseDevice(std::move(pDevice));
         }
+        else if (test.benchmarkFunc)
+        {
+            CPUBenchmarkContext benchmarkCtx(options.benchmarkOptions);
+            test.benchmarkFunc(benchmarkCtx);
+            result.messages = benchmarkCtx.getFailureMessages();
+            if (!benchmarkCtx.getResult().isValid())
+                result.messages.push_back("Benchmark did not call measure().");
+            result.benchmark = benchmarkCtx.getResult();
+        }
     }
     catch (const SkippingTestException& e)
     {
@@ -282,6 +425,20 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     return result;
 }
 
+/// Gather the tests to run. Depending on the options, these are either the unit tests or the benchmarks.
+inline std::vector<Test> gatherTests(const RunOptions& options)
+{
+    std::vector<Test> tests = enumerateTests();
+    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests.erase(
+        std::remove_if(
+            tests.begin(), tests.end(), [&options](const Test& test) { return bool(test.benchmarkFunc) != options.benchmarks; }
+        ),
+        tests.end()
+    );
+    return tests;
+}
+
 inline int32_t runTestsParallel(const RunOptions& options)
 {
     // Abort on Ctrl-C.
@@ -298,9 +455,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
     DevicePool devicePool(options.deviceDesc);
 
-    // Gather tests.
-    std::vector<Test> tests = enumerateTests();
-    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    std::vector<Test> tests = gatherTests(options);
 
     std::vector<TestResult> results(tests.size());
 
@@ -311,7 +466,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
     {
         threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
+            [&abort, &options, &tests, &results, &devicePool, testIndex]()
             {
                 if (abort)
                     return;
@@ -322,7 +477,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
                 reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+                result = runTest(test, devicePool, options);
 
                 std::string statusTag;
                 switch (result.status)
@@ -390,9 +545,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     DevicePool devicePool(options.deviceDesc);
 
-    // Gather tests.
-    std::vector<Test> tests = enumerateTests();
-    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    std::vector<Test> tests = gatherTests(options);
 
     // Split tests into suites.
     std::map<std::string, std::vector<Test>> suites;
@@ -402,6 +555,10 @@ inline int32_t runTestsSerial(const RunOptions& options)
     std::map<std::string, std::vector<Test>> failedTests;
     std::vector<std::pair<Test, TestResult>> report;
 
+    std::map<std::string, double> benchmarkBaseline;
+    if (options.benchmarks && !options.benchmarkOptions.baselinePath.empty())
+        benchmarkBaseline = loadBenchmarkBaseline(options.benchmarkOptions.baselinePath);
+
     size_t suiteCount = suites.size();
     size_t testCount = tests.size();
     int32_t failureCount = 0;
@@ -430,7 +587,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 if (options.repeat > 1)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
-                TestResult result = runTest(test, devicePool);
+                TestResult result = runTest(test, devicePool, options);
+                checkBenchmarkResult(test, result, benchmarkBaseline, options.benchmarkOptions);
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -473,6 +631,8 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
+    if (options.benchmarks && !options.benchmarkOptions.jsonReportPath.empty())
+        writeBenchmarkReport(options.benchmarkOptions.jsonReportPath, report);
 
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)",
@@ -507,7 +667,7 @@ int32_t runTests(const RunOptions& options)
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    int32_t failureCount = options.parallel > 1 && !options.benchmarks ? runTestsParallel(options) : runTestsSerial(options);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -531,8 +691,9 @@ std::vector<Test> enumerateTests()
         test.deviceType = Device::Type::Default;
         test.cpuFunc = desc.cpuFunc;
         test.gpuFunc = desc.gpuFunc;
+        test.benchmarkFunc = desc.benchmarkFunc;
 
-        if (test.cpuFunc)
+        if (test.cpuFunc || test.benchmarkFunc)
         {
             tests.push_back(test);
         }
@@ -645,6 +806,74 @@ void UnitTestContext::reportFailure(const std::string& message)
 
 ///////////////////////////////////////////////////////////////////////////
 
+BenchmarkStats computeBenchmarkStats(std::vector<double> samples)
+{
+    BenchmarkStats stats;
+    if (samples.empty())
+        return stats;
+
+    auto median = [](std::vector<double>& values)
+    {
+        size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        double upper = values[mid];
+        if (values.size() % 2 == 1)
+            return upper;
+        double lower = *std::max_element(values.begin(), values.begin() + mid);
+        return 0.5 * (lower + upper);
+    };
+
+    stats.min = *std::min_element(samples.begin(), samples.end());
+    stats.median = median(samples);
+    for (double& sample : samples)
+        sample = std::abs(sample - stats.median);
+    stats.mad = median(samples);
+
+    return stats;
+}
+
+void CPUBenchmarkContext::measure(const std::function<void()>& func)
+{
+    FALCOR_CHECK(!mResult.isValid(), "CPUBenchmarkContext::measure() can only be called once per benchmark.");
+    FALCOR_CHECK(mOptions.repetitions > 0, "Benchmark repetitions must be larger than zero.");
+
+    auto runIterations = [&func](uint64_t iterations)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint64_t i = 0; i < iterations; ++i)
+            func();
+        return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    };
+
+    // Find the number of iterations per repetition needed to get well above the timer resolution.
+    const uint64_t kMaxIterations = 1ull << 30;
+    uint64_t iterations = 1;
+    while (runIterations(iterations) < mOptions.minRepetitionTimeMS && iterations < kMaxIterations)
+        iterations *= 2;
+
+    for (uint32_t i = 0; i < mOptions.warmupRepetitions; ++i)
+        runIterations(iterations);
+
+    std::vector<double> samples(mOptions.repetitions);
+    for (auto& sample : samples)
+        sample = runIterations(iterations) / iterations;
+
+    mResult.iterations = iterations;
+    mResult.repetitions = mOptions.repetitions;
+    mResult.timeMS = computeBenchmarkStats(std::move(samples));
+}
+
+namespace detail
+{
+void escape(const void* ptr)
+{
+    static const void* volatile sSink;
+    sSink = ptr;
+}
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////
+
 void GPUUnitTestContext::createProgram(
     const std::filesystem::path& path,
     const std::string& entry,
@@ -798,4 +1027,41 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_TEST(TestBenchmarkStats)
+{
+    unittest::BenchmarkStats stats = unittest::computeBenchmarkStats({3.0, 1.0, 2.0, 100.0, 2.5});
+    EXPECT_EQ(stats.median, 2.5);
+    EXPECT_EQ(stats.mad, 0.5);
+    EXPECT_EQ(stats.min, 1.0);
+
+    stats = unittest::computeBenchmarkStats({4.0, 1.0, 2.0, 3.0});
+    EXPECT_EQ(stats.median, 2.5);
+    EXPECT_EQ(stats.mad, 1.0);
+    EXPECT_EQ(stats.min, 1.0);
+
+    stats = unittest::computeBenchmarkStats({});
+    EXPECT_EQ(stats.median, 0.0);
+}
+
+CPU_TEST(TestBenchmarkMeasure)
+{
+    unittest::BenchmarkOptions options;
+    options.warmupRepetitions = 2;
+    options.repetitions = 5;
+    options.minRepetitionTimeMS = 0.1;
+
+    CPUBenchmarkContext benchmarkCtx(options);
+    benchmarkCtx.setItemsPerIteration(100);
+    uint64_t callCount = 0;
+    benchmarkCtx.measure([&callCount]() { doNotOptimize(++callCount); });
+
+    const unittest::BenchmarkResult& result = benchmarkCtx.getResult();
+    EXPECT(result.isValid());
+    EXPECT_EQ(result.repetitions, 5u);
+    EXPECT_GE(result.iterations, 1u);
+    EXPECT_GE(callCount, result.iterations * (options.warmupRepetitions + options.repetitions));
+    EXPECT_LE(result.timeMS.min, result.timeMS.median);
+    EXPECT_GE(result.getItemsPerSecond(), 0.0);
+}
+
 } // namespace Falcor
@@ -84,6 +84,22 @@ public:
     SkippingTestException(const std::string& what) : std::runtime_error(what.c_str()) {}
 };
 
+struct BenchmarkOptions
+{
+    /// Number of repetitions run before measuring.
+    uint32_t warmupRepetitions = 1;
+    /// Number of measured repetitions.
+    uint32_t repetitions = 10;
+    /// The number of iterations per repetition is increased until a repetition takes at least this long.
+    double minRepetitionTimeMS = 10.0;
+    /// JSON report output file.
+    std::filesystem::path jsonReportPath;
+    /// JSON report of a previous run to compare against.
+    std::filesystem::path baselinePath;
+    /// Maximum allowed relative increase of the median time over the baseline before a benchmark fails.
+    double regressionThreshold = 0.1;
+};
+
 struct RunOptions
 {
     Device::Desc deviceDesc;
@@ -93,15 +109,20 @@ struct RunOptions
     std::filesystem::path xmlReportPath;
     uint32_t parallel = 1;
     uint32_t repeat = 1;
+    /// Run the benchmarks instead of the tests. Benchmarks are always run serially.
+    bool benchmarks = false;
+    BenchmarkOptions benchmarkOptions;
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
 
 class CPUUnitTestContext;
 class GPUUnitTestContext;
+class CPUBenchmarkContext;
 
 using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
 using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
+using CPUBenchmarkFunc = std::function<void(CPUBenchmarkContext& ctx)>;
 
 struct Test
 {
@@ -113,6 +134,7 @@ struct Test
 
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    CPUBenchmarkFunc benchmarkFunc;
 };
 
 /// Enumerate all tests.
@@ -279,6 +301,77 @@ private:
     std::map<std::string, ref<Buffer>> mStructuredBuffers;
 };
 
+/// Robust statistics of a set of timing samples.
+struct BenchmarkStats
+{
+    double median = 0.0;
+    double mad = 0.0; ///< Median absolute deviation from the median.
+    double min = 0.0;
+};
+
+/// Compute the statistics of a set of samples.
+FALCOR_API BenchmarkStats computeBenchmarkStats(std::vector<double> samples);
+
+struct BenchmarkResult
+{
+    uint64_t iterations = 0;        ///< Number of iterations per repetition.
+    uint32_t repetitions = 0;       ///< Number of measured repetitions.
+    uint64_t itemsPerIteration = 0; ///< Number of items processed per iteration (0 if not reported).
+    uint64_t bytesPerIteration = 0; ///< Number of bytes processed per iteration (0 if not reported).
+    BenchmarkStats timeMS;          ///< Statistics of the time per iteration in milliseconds.
+
+    bool isValid() const { return repetitions > 0; }
+    double getItemsPerSecond() const { return timeMS.median > 0.0 ? itemsPerIteration * 1000.0 / timeMS.median : 0.0; }
+    double getBytesPerSecond() const { return timeMS.median > 0.0 ? bytesPerIteration * 1000.0 / timeMS.median : 0.0; }
+};
+
+class FALCOR_API CPUBenchmarkContext : public UnitTestContext
+{
+public:
+    CPUBenchmarkContext(const BenchmarkOptions& options) : mOptions(options) {}
+
+    /**
+     * Set the number of items processed by one iteration of the measured function.
+     * Used to report the throughput in items per second.
+     */
+    void setItemsPerIteration(uint64_t items) { mResult.itemsPerIteration = items; }
+
+    /**
+     * Set the number of bytes processed by one iteration of the measured function.
+     * Used to report the throughput in bytes per second.
+     */
+    void setBytesPerIteration(uint64_t bytes) { mResult.bytesPerIteration = bytes; }
+
+    /**
+     * Measure the run time of a function.
+     * The function is first called repeatedly to find a number of iterations that takes at least
+     * BenchmarkOptions::minRepetitionTimeMS, then run for the warmup repetitions, and finally timed
+     * for the measured repetitions. Setup code should be placed outside of the function.
+     * Can only be called once per benchmark.
+     */
+    void measure(const std::function<void()>& func);
+
+    const BenchmarkResult& getResult() const { return mResult; }
+
+private:
+    BenchmarkOptions mOptions;
+    BenchmarkResult mResult;
+};
+
+namespace detail
+{
+FALCOR_API void escape(const void* ptr);
+}
+
+/**
+ * Prevent the compiler from optimizing away the computation of a value in a benchmark.
+ */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+    detail::escape(&value);
+}
+
 struct Tags
 {
     Tags(std::string tag) { tags.push_back(std::move(tag)); }
@@ -351,6 +444,7 @@ void applyArgs(Options& options, Args&&... args)
 
 FALCOR_API void registerCPUTest(std::filesystem::path path, std::string name, unittest::Options options, CPUTestFunc func);
 FALCOR_API void registerGPUTest(std::filesystem::path path, std::string name, unittest::Options options, GPUTestFunc func);
+FALCOR_API void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, CPUBenchmarkFunc func);
 
 /**
  * StreamSink is a utility class used by the testing framework that either
@@ -533,6 +627,8 @@ inline std::optional<std::string> createBinaryMessage(std::string_view lhsStr, s
 using UnitTestContext = unittest::UnitTestContext;
 using CPUUnitTestContext = unittest::CPUUnitTestContext;
 using GPUUnitTestContext = unittest::GPUUnitTestContext;
+using CPUBenchmarkContext = unittest::CPUBenchmarkContext;
+using unittest::doNotOptimize;
 
 /**
  * Macro to define a CPU unit test. The optional arguments include:
@@ -609,6 +705,38 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterGPUTest##name;                                                    \
     static void GPUUnitTest##name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macro to define a CPU benchmark. Benchmarks are not run as part of the
+ * unit tests, but only when running with the benchmarks option.
+ * The optional arguments are the same as for CPU_TEST.
+ *
+ * The benchmark sets up its input and passes the code to time to ctx.measure():
+ *
+ * CPU_BENCHMARK(Bench1)
+ * {
+ *     std::vector<uint8_t> data = ...;
+ *     ctx.setBytesPerIteration(data.size());
+ *     ctx.measure([&]() { doNotOptimize(process(data)); });
+ * }
+ *
+ * Note: All benchmarks are implicitly tagged with "cpu" and "benchmark".
+ */
+#define CPU_BENCHMARK(name, ...)                                                      \
+    static void CPUBenchmark##name(CPUBenchmarkContext& ctx);                         \
+    struct CPUBenchmarkRegisterer##name                                               \
+    {                                                                                 \
+        CPUBenchmarkRegisterer##name()                                                \
+        {                                                                             \
+            std::filesystem::path path = __FILE__;                                    \
+            unittest::Options options;                                                \
+            applyArgs(options, ##__VA_ARGS__);                                        \
+            options.tags.insert("cpu");                                               \
+            options.tags.insert("benchmark");                                         \
+            unittest::registerCPUBenchmark(path, #name, options, CPUBenchmark##name); \
+        }                                                                             \
+    } RegisterCPUBenchmark##name;                                                     \
+    static void CPUBenchmark##name(CPUBenchmarkContext& ctx) /* over to the user for the braces */
+
 // clang-format off
 
 /// Used as an argument of CPU_TEST/GPU_TEST to tag a test with a set of strings.
@@ -27,16 +27,19 @@
  **************************************************************************/
 #include "AsyncTextureLoader.h"
 #include "Core/API/Device.h"
-#include "Utils/Threading.h"
+#include "Utils/Logger.h"
+#include <algorithm>
 
 namespace Falcor
 {
 namespace
 {
-constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
-}
+/// Number of bytes of texel data uploaded before issuing a flush (to keep upload heap from growing).
+constexpr size_t kUploadBytesPerFlush = size_t(256) << 20;
+} // namespace
 
-AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount) : mpDevice(pDevice)
+AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount, size_t uploadQueueBudget)
+    : mpDevice(pDevice), mUploadQueueBudget(uploadQueueBudget)
 {
     runWorkers(threadCount);
 }
@@ -53,11 +56,12 @@ std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
     Bitmap::ImportFlags importFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    bool deferConstant
 )
 {
     std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback});
+    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback, deferConstant});
     mCondition.notify_one();
     return mLoadRequestQueue.back().promise.get_future();
 }
@@ -68,101 +72,181 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
     Bitmap::ImportFlags importFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    bool deferConstant
 )
 {
     std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback});
+    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback, deferConstant});
     mCondition.notify_one();
     return mLoadRequestQueue.back().promise.get_future();
 }
 
-void AsyncTextureLoader::runWorkers(size_t threadCount)
+AsyncTextureLoader::Stats AsyncTextureLoader::getStats() const
 {
-    // Create a barrier to synchronize worker threads before issuing a global flush.
-    mFlushBarrier = std::make_shared<Barrier>(
-        threadCount,
-        [&]()
-        {
-            mpDevice->wait();
-            mFlushPending = false;
-            mUploadCounter = 0;
-        }
-    );
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
 
-    for (size_t i = 0; i < threadCount; ++i)
+void AsyncTextureLoader::runWorkers(size_t threadCount)
+{
+    for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i)
     {
-        mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
+        mDecodeThreads.emplace_back(&AsyncTextureLoader::runDecoder, this);
     }
+
+    mUploadThread = std::thread(&AsyncTextureLoader::runUploader, this);
 }
 
-void AsyncTextureLoader::runWorker()
+void AsyncTextureLoader::runDecoder()
 {
-    // This function is the entry point for worker threads.
-    // The workers wait on the load request queue and load a texture when woken up.
-    // To avoid the upload heap growing too large, we synchronize the threads and
-    // issue a global GPU flush at regular intervals.
+    // This function is the entry point for decode threads.
+    // The threads wait on the load request queue and decode a texture when woken up.
+    // The decoded texture is passed on to the upload queue once it fits in the byte budget.
 
     while (true)
     {
         // Wait on condition until more work is ready.
         std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
-
-        // Sync thread if a flush is pending.
-        if (mFlushPending)
-        {
-            lock.unlock();
-            mFlushBarrier->wait();
-            mCondition.notify_one();
-            continue;
-        }
+        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty(); });
 
         // Terminate thread unless there is more work to do.
-        if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending)
-            break;
-
-        // Go back waiting if queue is currently empty.
         if (mLoadRequestQueue.empty())
-            continue;
+            break;
 
         // Pop next load request from queue.
-        auto request = std::move(mLoadRequestQueue.front());
+        UploadRequest upload;
+        upload.request = std::move(mLoadRequestQueue.front());
         mLoadRequestQueue.pop();
 
         lock.unlock();
 
-        // Load the textures (this part is running in parallel).
-        ref<Texture> pTexture;
+        // Decode the texture (this part is running in parallel).
+        // The decoded bitmap is analyzed if a callback wants the result. Textures of constant value are reduced to a single texel
+        // if their creation is deferred.
+        auto decodeStart = CpuTimer::getCurrentTimePoint();
+        const LoadRequest& request = upload.request;
         if (request.paths.size() == 1)
         {
-            pTexture = Texture::createFromFile(
-                mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
-            );
+            upload.decoded =
+                DecodedTexture::decodeFromFile(request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.importFlags);
         }
         else
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags, request.importFlags);
+            upload.decoded = DecodedTexture::decodeMippedFromFiles(request.paths, request.loadAsSRGB, request.importFlags);
         }
 
-        request.promise.set_value(pTexture);
-
-        if (request.callback)
+        if (upload.decoded)
         {
-            request.callback(pTexture);
+            if (request.callback && upload.decoded->pBitmap)
+                upload.analysis = TextureAnalyzer::analyzeBitmap(*upload.decoded->pBitmap, upload.decoded->format);
+            if (request.callback && request.deferConstant && upload.analysis && upload.analysis->isConstant(TextureChannelFlags::RGBA))
+                upload.decoded->makeConstant();
+            upload.byteSize = upload.decoded->getDataSize();
         }
+        upload.decodeEnd = CpuTimer::getCurrentTimePoint();
+        upload.decodeTime = CpuTimer::calcDuration(decodeStart, upload.decodeEnd);
 
         lock.lock();
 
-        // Issue a global flush if necessary.
-        // TODO: It would be better to check the size of the upload heap instead.
-        if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
+        // Wait until the texel data fits in the upload queue budget.
+        // A texture larger than the whole budget is accepted once the queue has drained.
+        mQueueSpaceCondition.wait(lock, [&]() { return mQueuedBytes == 0 || mQueuedBytes + upload.byteSize <= mUploadQueueBudget; });
+
+        mQueuedBytes += upload.byteSize;
+        mStats.peakQueuedBytes = std::max(mStats.peakQueuedBytes, mQueuedBytes);
+        mUploadQueue.push(std::move(upload));
+
+        lock.unlock();
+        mUploadCondition.notify_one();
+    }
+}
+
+void AsyncTextureLoader::runUploader()
+{
+    // This function is the entry point for the upload thread.
+    // It creates the textures from the upload queue one at a time, so decode threads never wait on the GPU.
+    // To avoid the upload heap growing too large, a GPU flush is issued after a fixed number of bytes.
+
+    size_t bytesSinceFlush = 0;
+
+    while (true)
+    {
+        // Wait on condition until a decoded texture is ready.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mUploadCondition.wait(lock, [&]() { return mTerminateUpload || !mUploadQueue.empty(); });
+
+        // Terminate thread once all decode threads are done and the queue has drained.
+        if (mUploadQueue.empty())
+            break;
+
+        UploadRequest upload = std::move(mUploadQueue.front());
+        mUploadQueue.pop();
+
+        lock.unlock();
+
+        auto uploadStart = CpuTimer::getCurrentTimePoint();
+        double queueWaitTime = CpuTimer::calcDuration(upload.decodeEnd, uploadStart);
+
+        ref<Texture> pTexture;
+        std::optional<DecodedTexture> constantTexture;
+        if (upload.decoded && upload.decoded->isConstant)
+            constantTexture = std::move(upload.decoded);
+        else if (upload.decoded)
         {
-            mFlushPending = true;
-            mCondition.notify_all();
+            // An exception must not escape the upload thread. Failed textures are reported as null, same as failed decodes.
+            try
+            {
+                pTexture = Texture::createFromDecoded(mpDevice, *upload.decoded, upload.request.bindFlags);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("AsyncTextureLoader: Failed to create texture from '{}': {}", upload.decoded->sourcePath, e.what());
+            }
         }
 
-        mCondition.notify_one();
+        if (pTexture)
+        {
+            bytesSinceFlush += upload.byteSize;
+            if (bytesSinceFlush >= kUploadBytesPerFlush)
+            {
+                mpDevice->wait();
+                bytesSinceFlush = 0;
+            }
+        }
+
+        // Release the host memory before making room in the queue.
+        upload.decoded.reset();
+
+        double uploadTime = CpuTimer::calcDuration(uploadStart, CpuTimer::getCurrentTimePoint());
+
+        lock.lock();
+        mQueuedBytes -= upload.byteSize;
+        mStats.textureCount++;
+        if (pTexture)
+            mStats.uploadedBytes += upload.byteSize;
+        mStats.decodeTime += upload.decodeTime;
+        mStats.queueWaitTime += queueWaitTime;
+        mStats.uploadTime += uploadTime;
+        lock.unlock();
+        mQueueSpaceCondition.notify_all();
+
+        std::filesystem::path path = upload.request.paths.empty() ? std::filesystem::path() : upload.request.paths[0];
+        logDebug(
+            "AsyncTextureLoader: '{}' decode {:.2f} ms, queue wait {:.2f} ms, upload {:.2f} ms ({} bytes).",
+            path,
+            upload.decodeTime,
+            queueWaitTime,
+            uploadTime,
+            upload.byteSize
+        );
+
+        upload.request.promise.set_value(pTexture);
+
+        if (upload.request.callback)
+        {
+            upload.request.callback(pTexture, upload.analysis, std::move(constantTexture));
+        }
     }
 }
 
@@ -175,7 +259,17 @@ void AsyncTextureLoader::terminateWorkers()
 
     mCondition.notify_all();
 
-    for (auto& thread : mThreads)
+    for (auto& thread : mDecodeThreads)
         thread.join();
+
+    // All decoded textures are in the upload queue now.
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTerminateUpload = true;
+    }
+
+    mUploadCondition.notify_all();
+
+    mUploadThread.join();
 }
 } // namespace Falcor
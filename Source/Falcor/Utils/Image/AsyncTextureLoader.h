@@ -26,15 +26,19 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "DecodedTexture.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
+#include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Timing/CpuTimer.h"
 #include <condition_variable>
 #include <filesystem>
 #include <functional>
 #include <future>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <thread>
 #include <vector>
@@ -42,21 +46,61 @@
 
 namespace Falcor
 {
-class Barrier;
-
 /**
- * Utility class to load textures asynchronously using multiple worker threads.
+ * Utility class to load textures asynchronously.
+ *
+ * Loading runs in two stages:
+ * - Multiple decode threads read and decode the image files on the CPU (see DecodedTexture).
+ * - A single upload thread creates the textures on the GPU.
+ *
+ * Decoded textures are passed to the upload thread through a queue bounded by a byte budget.
+ * Decode threads block while the queue is full, which bounds the host memory used for decoded texel data.
+ * The upload thread flushes the GPU after every few hundred MB uploaded to keep the upload heap from growing.
+ *
+ * If a load callback is given, the decoded texels are also analyzed on the decode thread (see TextureAnalyzer::analyzeBitmap())
+ * and the result is passed to the callback. This avoids analyzing the texture on the GPU later.
+ * The promise and the callback are fulfilled on the upload thread.
+ *
+ * Requests can defer creating textures of constant value. If the analysis finds all texels equal, the texture is not created
+ * and the callback receives the decoded texel instead (see DecodedTexture::makeConstant()). This lets the caller replace
+ * the texture by a constant and only create it if needed.
  */
 class FALCOR_API AsyncTextureLoader
 {
 public:
-    using LoadCallback = std::function<void(ref<Texture> pTexture)>;
+    /// Callback receiving the loaded texture (or nullptr) and the result of the CPU analysis if the texture's format supports it.
+    /// If creation of a constant texture was deferred, the texture is nullptr and the decoded texel is passed in the last argument.
+    using LoadCallback = std::function<void(
+        ref<Texture> pTexture,
+        const std::optional<TextureAnalyzer::Result>& analysis,
+        std::optional<DecodedTexture>&& constantTexture
+    )>;
+
+    /// Default byte budget of the upload queue.
+    static constexpr size_t kDefaultUploadQueueBudget = size_t(512) << 20;
+
+    /// Statistics accumulated over all textures loaded. Times are in ms.
+    struct Stats
+    {
+        uint64_t textureCount = 0;  ///< Number of textures processed, including textures that failed to load.
+        uint64_t uploadedBytes = 0; ///< Number of bytes of texel data uploaded.
+        size_t peakQueuedBytes = 0; ///< Peak number of bytes of decoded texel data waiting for upload.
+        double decodeTime = 0.0;    ///< Time spent decoding and analyzing textures, summed over all decode threads.
+        double queueWaitTime = 0.0; ///< Time decoded textures spent waiting for upload.
+        double uploadTime = 0.0;    ///< Time spent creating and uploading textures, including GPU flushes.
+    };
 
     /**
      * Constructor.
-     * @param[in] threadCount Number of worker threads.
+     * @param[in] threadCount Number of decode threads.
+     * @param[in] uploadQueueBudget Maximum number of bytes of decoded texel data waiting for upload.
+     *            A single texture larger than the budget is still accepted when the queue is empty.
      */
-    AsyncTextureLoader(ref<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency());
+    AsyncTextureLoader(
+        ref<Device> pDevice,
+        size_t threadCount = std::thread::hardware_concurrency(),
+        size_t uploadQueueBudget = kDefaultUploadQueueBudget
+    );
 
     /**
      * Destructor.
@@ -71,14 +115,16 @@ public:
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
      * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] deferConstant Don't create the texture if it has a constant value, pass the decoded texel to the callback instead.
+     * @return A future to a new texture, or nullptr if the texture failed to load or its creation was deferred.
      */
     std::future<ref<Texture>> loadMippedFromFiles(
         fstd::span<const std::filesystem::path> paths,
         bool loadAsSRGB,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        bool deferConstant = false
     );
 
     /**
@@ -89,7 +135,8 @@ public:
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
      * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] deferConstant Don't create the texture if it has a constant value, pass the decoded texel to the callback instead.
+     * @return A future to a new texture, or nullptr if the texture failed to load or its creation was deferred.
      */
     std::future<ref<Texture>> loadFromFile(
         const std::filesystem::path& path,
@@ -97,14 +144,14 @@ public:
         bool loadAsSRGB,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        bool deferConstant = false
     );
 
-private:
-    void runWorkers(size_t threadCount);
-    void runWorker();
-    void terminateWorkers();
+    /// Returns the statistics accumulated so far.
+    Stats getStats() const;
 
+private:
     struct LoadRequest
     {
         std::vector<std::filesystem::path> paths;
@@ -113,21 +160,42 @@ private:
         ResourceBindFlags bindFlags;
         Bitmap::ImportFlags importFlags;
         LoadCallback callback;
+        bool deferConstant;
         std::promise<ref<Texture>> promise;
     };
 
+    struct UploadRequest
+    {
+        LoadRequest request;
+        std::optional<DecodedTexture> decoded; ///< Decoded texture, or std::nullopt if decoding failed.
+        std::optional<TextureAnalyzer::Result> analysis;
+        size_t byteSize = 0;                   ///< Size of the decoded texel data counted against the queue budget.
+        double decodeTime = 0.0;
+        CpuTimer::TimePoint decodeEnd;
+    };
+
+    void runWorkers(size_t threadCount);
+    void runDecoder();
+    void runUploader();
+    void terminateWorkers();
+
     ref<Device> mpDevice;
+    size_t mUploadQueueBudget;
 
-    std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
-    std::condition_variable mCondition;     ///< Condition variable for workers to wait on.
-    std::shared_ptr<Barrier> mFlushBarrier; ///< Barrier for flushing the GPU to upload textures.
-    std::vector<std::thread> mThreads;      ///< Worker threads.
+    mutable std::mutex mMutex;                    ///< Mutex for synchronizing access to shared resources.
+    std::condition_variable mCondition;           ///< Condition variable for decode threads to wait on load requests.
+    std::condition_variable mUploadCondition;     ///< Condition variable for the upload thread to wait on decoded textures.
+    std::condition_variable mQueueSpaceCondition; ///< Condition variable for decode threads to wait on space in the upload queue.
+    std::vector<std::thread> mDecodeThreads;      ///< Decode threads.
+    std::thread mUploadThread;                    ///< Upload thread.
 
     // Internal state. Do not access outside of critical section.
     std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
+    std::queue<UploadRequest> mUploadQueue;    ///< Decoded textures waiting for upload.
+    size_t mQueuedBytes = 0;                   ///< Number of bytes of decoded texel data in the upload queue.
+    Stats mStats;
 
-    bool mTerminate = false;     ///< Flag to terminate worker threads.
-    bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
-    uint32_t mUploadCounter = 0; ///< Counter to issue a flush every few uploads.
+    bool mTerminate = false;       ///< Flag to terminate decode threads.
+    bool mTerminateUpload = false; ///< Flag to terminate the upload thread.
 };
 } // namespace Falcor
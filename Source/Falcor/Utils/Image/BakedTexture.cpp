@@ -0,0 +1,114 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BakedTexture.h"
+#include "Core/Error.h"
+#include "Core/API/Formats.h"
+#include "Utils/StringFormatters.h"
+#include <atomic>
+#include <system_error>
+
+namespace Falcor
+{
+namespace
+{
+std::atomic<bool> sEnabled{true};
+}
+
+std::filesystem::path BakedTexture::getBakedPath(const std::filesystem::path& sourcePath)
+{
+    std::filesystem::path bakedPath = sourcePath;
+    bakedPath += ".dds";
+    return bakedPath;
+}
+
+std::optional<std::filesystem::path> BakedTexture::find(const std::filesystem::path& sourcePath)
+{
+    std::filesystem::path bakedPath = getBakedPath(sourcePath);
+
+    // Use the non-throwing overloads, a missing baked texture is the common case.
+    std::error_code ec;
+    auto bakedTime = std::filesystem::last_write_time(bakedPath, ec);
+    if (ec)
+        return std::nullopt;
+    auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec || bakedTime < sourceTime)
+        return std::nullopt;
+
+    return bakedPath;
+}
+
+bool BakedTexture::canBake(const Bitmap& bitmap, ImageIO::CompressionMode mode)
+{
+    // ImageIO::saveToDDS only supports BC5 for two channel images.
+    if (getFormatChannelCount(bitmap.getFormat()) == 2 && mode != ImageIO::CompressionMode::BC5)
+        return false;
+    // Block compressed images would be cropped to a multiple of 4.
+    if (mode != ImageIO::CompressionMode::None && (bitmap.getWidth() % 4 != 0 || bitmap.getHeight() % 4 != 0))
+        return false;
+    return true;
+}
+
+void BakedTexture::bake(const Bitmap& bitmap, const std::filesystem::path& bakedPath, ImageIO::CompressionMode mode, bool srgb)
+{
+    FALCOR_CHECK(canBake(bitmap, mode), "Bitmap of size {}x{} cannot be baked without resizing.", bitmap.getWidth(), bitmap.getHeight());
+
+    // Bitmaps are loaded in linear formats. Reinterpret sRGB data in the matching sRGB format,
+    // so that ImageIO generates the mips in linear space and tags the DDS file as sRGB.
+    const Bitmap* pBitmap = &bitmap;
+    Bitmap::UniqueConstPtr pSrgbBitmap;
+    ResourceFormat srgbFormat = linearToSrgbFormat(bitmap.getFormat());
+    if (srgb && srgbFormat != bitmap.getFormat())
+    {
+        pSrgbBitmap = Bitmap::create(bitmap.getWidth(), bitmap.getHeight(), srgbFormat, bitmap.getData());
+        pBitmap = pSrgbBitmap.get();
+    }
+
+    std::filesystem::path tempPath = bakedPath;
+    tempPath.replace_extension(".tmp.dds");
+    ImageIO::saveToDDS(tempPath, *pBitmap, mode, true /* generateMips */);
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, bakedPath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        FALCOR_THROW("Failed to write baked texture '{}'.", bakedPath);
+    }
+}
+
+void BakedTexture::setEnabled(bool enabled)
+{
+    sEnabled = enabled;
+}
+
+bool BakedTexture::isEnabled()
+{
+    return sEnabled;
+}
+
+} // namespace Falcor
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include <filesystem>
+#include <optional>
+
+namespace Falcor
+{
+/**
+ * Helpers for textures baked offline to block-compressed DDS files with a full mip chain.
+ *
+ * The baked variant of a texture is stored next to the source file, with ".dds" appended
+ * to the file name (e.g. "wood.png" is baked to "wood.png.dds"). The TextureBaker tool
+ * bakes the textures of a scene, and TextureManager loads the baked variant instead of
+ * the source file when it is up to date.
+ */
+class FALCOR_API BakedTexture
+{
+public:
+    /**
+     * Get the path of the baked variant of a texture.
+     * @param[in] sourcePath Path of the source texture.
+     * @return Path of the baked texture.
+     */
+    static std::filesystem::path getBakedPath(const std::filesystem::path& sourcePath);
+
+    /**
+     * Find the baked variant of a texture.
+     * @param[in] sourcePath Path of the source texture.
+     * @return Path of the baked texture if it exists and is not older than the source, std::nullopt otherwise.
+     */
+    static std::optional<std::filesystem::path> find(const std::filesystem::path& sourcePath);
+
+    /**
+     * Check if a bitmap can be baked without changing its dimensions.
+     * Block compression requires the base level dimensions to be a multiple of 4.
+     * @param[in] bitmap Source bitmap.
+     * @param[in] mode Block compression mode.
+     */
+    static bool canBake(const Bitmap& bitmap, ImageIO::CompressionMode mode);
+
+    /**
+     * Bake a bitmap to a DDS file with a full mip chain.
+     * The file is written to a temporary file first, so that a partially written file is never picked up.
+     * Throws an exception if the bitmap cannot be baked or the file cannot be written.
+     * @param[in] bitmap Source bitmap. Should be loaded top-down.
+     * @param[in] bakedPath Path of the baked texture.
+     * @param[in] mode Block compression mode.
+     * @param[in] srgb If true, the bitmap holds sRGB data. The texture is stored in an sRGB format and mips are filtered in linear space.
+     */
+    static void bake(const Bitmap& bitmap, const std::filesystem::path& bakedPath, ImageIO::CompressionMode mode, bool srgb = false);
+
+    /**
+     * Enable or disable loading of baked textures globally. Enabled by default.
+     * The TextureBaker tool disables this to see the source textures of a scene.
+     */
+    static void setEnabled(bool enabled);
+
+    /// Returns true if baked textures are loaded.
+    static bool isEnabled();
+};
+} // namespace Falcor
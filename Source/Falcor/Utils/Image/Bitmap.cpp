@@ -105,7 +105,7 @@ static void genWarning(const std::string& errMsg, const std::filesystem::path& p
     logWarning("Error when loading image file from '{}': {}", path, errMsg);
 }
 
-static bool isConvertibleToRGBA32Float(ResourceFormat format)
+bool Bitmap::isConvertibleToRGBA32Float(ResourceFormat format)
 {
     FormatType type = getFormatType(format);
     bool isHalfFormat = (type == FormatType::Float && getNumChannelBits(format, 0) == 16);
@@ -118,17 +118,23 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
  */
 static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
 {
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
+    const size_t pixelCount = size_t(width) * height;
+    fstd::span<const uint16_t> src(reinterpret_cast<const uint16_t*>(pData), pixelCount * channelCount);
+    std::vector<float> newData(pixelCount * 4u, 0.f);
 
-    for (uint32_t i = 0; i < width * height; ++i)
+    if (channelCount == 4)
+    {
+        math::float16ToFloat32(src, newData);
+        return newData;
+    }
+
+    // Convert all channels at once and expand to RGBA afterwards.
+    std::vector<float> floatData(src.size());
+    math::float16ToFloat32(src, floatData);
+    for (size_t i = 0; i < pixelCount; ++i)
     {
         for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++);
-        }
-        pDst += (4 - channelCount);
+            newData[i * 4 + c] = floatData[i * channelCount + c];
     }
 
     return newData;
@@ -157,10 +163,7 @@ static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t heigh
     return newData;
 }
 
-/**
- * Converts an image of the given format to an RGBA float image.
- */
-static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
+std::vector<float> Bitmap::convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
 {
     FALCOR_ASSERT(isConvertibleToRGBA32Float(format));
 
@@ -265,18 +268,30 @@ static FIBITMAP* convertToRGBA16Float(FIBITMAP* pDib)
     const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
     BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
+    // Rows of RGB pixels are converted to a temporary buffer before adding a "dummy" alpha of 1.0.
+    const uint32_t channelCount = type == FIT_RGBAF ? 4 : 3;
+    std::vector<uint16_t> rowData(type == FIT_RGBAF ? 0 : width * 3);
+    const uint16_t alpha = float16_t(1.f).toBits();
+
     for (uint32_t y = 0; y < height; y++)
     {
-        const FIRGBAF* src_pixel = (FIRGBAF*)src_bits;
-        FIRGBA16* dst_pixel = (tagFIRGBA16*)dst_bits;
+        fstd::span<const float> src_row(reinterpret_cast<const float*>(src_bits), width * channelCount);
+        uint16_t* dst_row = reinterpret_cast<uint16_t*>(dst_bits);
 
-        for (uint32_t x = 0; x < width; x++)
+        if (type == FIT_RGBAF)
+        {
+            math::float32ToFloat16(src_row, fstd::span<uint16_t>(dst_row, width * 4));
+        }
+        else
         {
-            // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
-            dst_pixel[x].red = float16_t(src_pixel[x].red).toBits();
-            dst_pixel[x].green = float16_t(src_pixel[x].green).toBits();
-            dst_pixel[x].blue = float16_t(src_pixel[x].blue).toBits();
-            dst_pixel[x].alpha = float16_t(type == FIT_RGBAF ? src_pixel[x].alpha : 1.0f).toBits();
+            math::float32ToFloat16(src_row, rowData);
+            for (uint32_t x = 0; x < width; x++)
+            {
+                dst_row[x * 4 + 0] = rowData[x * 3 + 0];
+                dst_row[x * 4 + 1] = rowData[x * 3 + 1];
+                dst_row[x * 4 + 2] = rowData[x * 3 + 2];
+                dst_row[x * 4 + 3] = alpha;
+            }
         }
         src_bits += src_pitch;
         dst_bits += dst_pitch;
@@ -31,6 +31,7 @@
 #include "Core/API/Formats.h"
 #include <memory>
 #include <filesystem>
+#include <vector>
 
 namespace Falcor
 {
@@ -115,6 +116,23 @@ public:
         void* pData
     );
 
+    /**
+     * Check if an image of the given format can be converted with convertToRGBA32Float().
+     * This is the case for 16-bit float and 16/32-bit integer formats.
+     */
+    static bool isConvertibleToRGBA32Float(ResourceFormat format);
+
+    /**
+     * Convert an image to RGBA32Float. Used by saveImage() to write formats not supported by PFM/EXR directly.
+     * Unsigned integers are normalized to [0,1], signed integers to [-1,1]. Missing channels are set to 0 and alpha to 1.
+     * @param[in] format The format of the source data. Must satisfy isConvertibleToRGBA32Float().
+     * @param[in] width The width of the image.
+     * @param[in] height The height of the image.
+     * @param[in] pData Pointer to the source data.
+     * @return The converted image with 4 floats per pixel.
+     */
+    static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData);
+
     /**
      * Open dialog to save image to a file
      * @param[in] pTexture Texture to save to file
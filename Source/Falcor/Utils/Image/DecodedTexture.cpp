@@ -0,0 +1,191 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "DecodedTexture.h"
+#include "ImageIO.h"
+#include "Core/Error.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falcor
+{
+namespace
+{
+constexpr bool kTopDown = true; // Memory layout when loading from file
+}
+
+bool DecodedTexture::makeConstant()
+{
+    if (isConstant)
+        return true;
+    if (type != Resource::Type::Texture2D || mipLevels != 1 || arraySize != 1 || isCompressedFormat(format) || width == 0 || height == 0)
+        return false;
+
+    const size_t texelSize = getFormatBytesPerBlock(format);
+    FALCOR_ASSERT(getDataSize() >= texelSize);
+    const uint8_t* pTexel = static_cast<const uint8_t*>(getData());
+    std::vector<uint8_t> texel(pTexel, pTexel + texelSize);
+
+    pBitmap.reset();
+    data = std::move(texel);
+    isConstant = true;
+    return true;
+}
+
+std::optional<DecodedTexture> DecodedTexture::decodeFromFile(
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    Bitmap::ImportFlags importFlags
+)
+{
+    if (!std::filesystem::exists(path))
+    {
+        logWarning("Error when loading image file. File '{}' does not exist.", path);
+        return std::nullopt;
+    }
+
+    if (hasExtension(path, "dds"))
+    {
+        std::optional<DecodedTexture> decoded;
+        try
+        {
+            decoded = ImageIO::decodeDDS(path, loadAsSrgb);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Error loading '{}': {}", path, e.what());
+        }
+        if (decoded)
+            decoded->importFlags = importFlags;
+        return decoded;
+    }
+
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
+    if (!pBitmap)
+        return std::nullopt;
+
+    DecodedTexture decoded;
+    decoded.format = loadAsSrgb ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+    decoded.width = pBitmap->getWidth();
+    decoded.height = pBitmap->getHeight();
+    decoded.generateMipLevels = generateMipLevels;
+    decoded.sourcePath = path;
+    decoded.importFlags = importFlags;
+    decoded.pBitmap = std::move(pBitmap);
+    return decoded;
+}
+
+std::optional<DecodedTexture> DecodedTexture::decodeMippedFromFiles(
+    fstd::span<const std::filesystem::path> paths,
+    bool loadAsSrgb,
+    Bitmap::ImportFlags importFlags
+)
+{
+    std::vector<Bitmap::UniqueConstPtr> mips;
+    mips.reserve(paths.size());
+    size_t combinedSize = 0;
+
+    for (const auto& path : paths)
+    {
+        Bitmap::UniqueConstPtr pBitmap;
+        if (hasExtension(path, "dds"))
+        {
+            try
+            {
+                pBitmap = ImageIO::loadBitmapFromDDS(path);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Error loading '{}': {}", path, e.what());
+            }
+        }
+        else
+        {
+            pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
+        }
+        if (!pBitmap)
+        {
+            logWarning("Error loading mip {}. Loading failed for image file '{}'.", mips.size(), path);
+            break;
+        }
+
+        if (!mips.empty())
+        {
+            if (mips.back()->getFormat() != pBitmap->getFormat())
+            {
+                logWarning("Error loading mip {} from file {}. Texture format of all mip levels must match.", mips.size(), path);
+                break;
+            }
+            if (std::max(mips.back()->getWidth() / 2, 1u) != pBitmap->getWidth() ||
+                std::max(mips.back()->getHeight() / 2, 1u) != pBitmap->getHeight())
+            {
+                logWarning(
+                    "Error loading mip {} from file {}. Image resolution must decrease by half. ({}, {}) != ({}, {})/2",
+                    mips.size(),
+                    path,
+                    pBitmap->getWidth(),
+                    pBitmap->getHeight(),
+                    mips.back()->getWidth(),
+                    mips.back()->getHeight()
+                );
+                break;
+            }
+        }
+        combinedSize += pBitmap->getSize();
+        mips.emplace_back(std::move(pBitmap));
+    }
+
+    if (mips.empty())
+        return std::nullopt;
+
+    DecodedTexture decoded;
+    decoded.format = loadAsSrgb ? linearToSrgbFormat(mips[0]->getFormat()) : mips[0]->getFormat();
+    decoded.width = mips[0]->getWidth();
+    decoded.height = mips[0]->getHeight();
+    decoded.mipLevels = (uint32_t)mips.size();
+    decoded.sourcePath = paths[0];
+    decoded.importFlags = importFlags;
+
+    // Combine all the mip data into a single buffer. A single mip is used directly from its bitmap.
+    if (mips.size() > 1)
+    {
+        decoded.data.resize(combinedSize);
+        size_t copyDst = 0;
+        for (auto& mip : mips)
+        {
+            std::memcpy(decoded.data.data() + copyDst, mip->getData(), mip->getSize());
+            copyDst += mip->getSize();
+        }
+    }
+    decoded.pBitmap = std::move(mips[0]);
+
+    return decoded;
+}
+} // namespace Falcor
@@ -0,0 +1,106 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/API/Resource.h"
+#include <filesystem>
+#include <optional>
+#include <vector>
+#include <fstd/span.h>
+
+namespace Falcor
+{
+/**
+ * Texel data of a texture decoded on the CPU.
+ *
+ * Decoding reads and decompresses the image files but doesn't need a GPU device, so it can run on any thread.
+ * The texture is created from the decoded data with Texture::createFromDecoded().
+ */
+struct FALCOR_API DecodedTexture
+{
+    Resource::Type type = Resource::Type::Texture2D;
+    ResourceFormat format = ResourceFormat::Unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depth = 1;
+    uint32_t arraySize = 1; ///< Number of array slices (6 per cube).
+    uint32_t mipLevels = 1; ///< Number of mip levels stored in the texel data.
+    bool generateMipLevels = false; ///< Generate the full mip-chain from mip0 when the texture is created.
+    std::filesystem::path sourcePath;
+    Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None;
+    bool isConstant = false; ///< The texel data holds a single texel that is replicated over the texture (see makeConstant()).
+
+    Bitmap::UniqueConstPtr pBitmap; ///< Decoded bitmap of mip0 if the texture was decoded through Bitmap.
+    std::vector<uint8_t> data;      ///< Texel data of all subresources. Empty if the texel data is held by pBitmap.
+
+    /// Returns the texel data of all subresources.
+    const void* getData() const { return data.empty() && pBitmap ? pBitmap->getData() : data.data(); }
+
+    /// Returns the size in bytes of the texel data.
+    size_t getDataSize() const { return data.empty() && pBitmap ? pBitmap->getSize() : data.size(); }
+
+    /**
+     * Replace the texel data by its first texel. Call this only for textures known to have the same value in all texels.
+     * Texture::createFromDecoded() replicates the texel to restore the full texture.
+     * Only uncompressed 2D textures with a single mip level and array slice are supported.
+     * @return True if the texel data was replaced.
+     */
+    bool makeConstant();
+
+    /**
+     * Decode a texture from a file. DDS files are loaded as is, other formats are decoded to a Bitmap.
+     * @param[in] path File path of the image (absolute or relative to working directory).
+     * @param[in] generateMipLevels Whether the mip-chain should be generated when the texture is created.
+     * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
+     * @param[in] importFlags Optional flags for the file import.
+     * @return Decoded texture, or std::nullopt if the file failed to load.
+     */
+    static std::optional<DecodedTexture> decodeFromFile(
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+    );
+
+    /**
+     * Decode a texture with mips specified explicitly from individual files.
+     * Mips are validated and combined into a single buffer. Loading stops at the first mip that fails to load or validate.
+     * @param[in] paths List of full paths of all mips, starting from mip0.
+     * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
+     * @param[in] importFlags Optional flags for the file import.
+     * @return Decoded texture, or std::nullopt if mip0 failed to load.
+     */
+    static std::optional<DecodedTexture> decodeMippedFromFiles(
+        fstd::span<const std::filesystem::path> paths,
+        bool loadAsSrgb,
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+    );
+};
+} // namespace Falcor
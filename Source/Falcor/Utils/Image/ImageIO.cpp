@@ -189,7 +189,8 @@ nvtt::InputFormat convertToNvttInputFormat(ResourceFormat format)
 
         if (xBits == 8)
         {
-            if (getFormatType(format) == FormatType::Uint || getFormatType(format) == FormatType::Unorm)
+            FormatType type = getFormatType(format);
+            if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
             {
                 return nvtt::InputFormat::InputFormat_BGRA_8UB;
             }
@@ -364,7 +365,9 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
     {
         outputOptions.setContainer(nvtt::Container::Container_DDS10);
     }
-    outputOptions.setSrgbFlag(isSrgbFormat(image.format));
+    // Generate mips of sRGB images in linear space.
+    const bool srgb = isSrgbFormat(image.format);
+    outputOptions.setSrgbFlag(srgb);
 
     nvtt::Context context;
     if (!context.outputHeader(
@@ -393,7 +396,11 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
         {
             if (generateMips)
             {
+                if (srgb)
+                    tmp.toLinearFromSrgb();
                 tmp.buildNextMipmap(nvtt::MipmapFilter::MipmapFilter_Box);
+                if (srgb)
+                    tmp.toSrgb();
             }
             else
             {
@@ -577,7 +584,7 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
     return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
 }
 
-ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+std::optional<DecodedTexture> ImageIO::decodeDDS(const std::filesystem::path& path, bool loadAsSrgb)
 {
     ImportData data;
     try
@@ -587,36 +594,30 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     catch (const RuntimeError& e)
     {
         logWarning("Failed to load DDS image from '{}': {}", path, e.what());
-        return nullptr;
-    }
+        return std::nullopt;
+    }
+
+    DecodedTexture decoded;
+    decoded.type = data.type;
+    decoded.format = data.format;
+    decoded.width = data.width;
+    decoded.height = data.height;
+    decoded.depth = data.depth;
+    decoded.arraySize = data.arraySize;
+    decoded.mipLevels = data.mipLevels;
+    decoded.sourcePath = path;
+    decoded.data = std::move(data.imageData);
+    return decoded;
+}
 
-    ref<Texture> pTex;
-    // TODO: Automatic mip generation
-    switch (data.type)
-    {
-    case Resource::Type::Texture1D:
-        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-        break;
-    case Resource::Type::Texture2D:
-        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-        break;
-    case Resource::Type::TextureCube:
-        pTex = pDevice->createTextureCube(data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
-        break;
-    case Resource::Type::Texture3D:
-        pTex = pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
-        break;
-    default:
-        logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
+ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+{
+    auto decoded = decodeDDS(path, loadAsSrgb);
+    if (!decoded)
         return nullptr;
-    }
-
-    if (pTex != nullptr)
-    {
-        pTex->setSourcePath(path);
-    }
 
-    return pTex;
+    // TODO: Automatic mip generation
+    return Texture::createFromDecoded(pDevice, *decoded);
 }
 
 void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips)
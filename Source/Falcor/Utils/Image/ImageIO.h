@@ -27,9 +27,11 @@
  **************************************************************************/
 #pragma once
 #include "Bitmap.h"
+#include "DecodedTexture.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include <filesystem>
+#include <optional>
 
 namespace Falcor
 {
@@ -80,6 +82,16 @@ public:
      */
     static Bitmap::UniqueConstPtr loadBitmapFromDDS(const std::filesystem::path& path); // top down = true
 
+    /**
+     * Load a DDS file including all array slices and mips, without creating a texture.
+     * This doesn't require a GPU device and can be called from any thread.
+     * @param[in] path Path of file to load.
+     * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not
+     * changed.
+     * @return Decoded texture if loading was successful. Otherwise, std::nullopt.
+     */
+    static std::optional<DecodedTexture> decodeDDS(const std::filesystem::path& path, bool loadAsSrgb);
+
     /**
      * Load a DDS file to a Texture.
      * Throws an exception if the DDS file is malformed.
@@ -27,6 +27,19 @@
  **************************************************************************/
 #include "TextureAnalyzer.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define TEXTURE_ANALYZER_USE_SSE2 1
+#else
+#define TEXTURE_ANALYZER_USE_SSE2 0
+#endif
 
 namespace Falcor
 {
@@ -39,6 +52,378 @@ static_assert((uint32_t)TextureChannelFlags::Blue == 0x4);
 static_assert((uint32_t)TextureChannelFlags::Alpha == 0x8);
 
 const char kShaderFilename[] = "Utils/Image/TextureAnalyzer.cs.slang";
+
+const uint32_t kMissingChannel = std::numeric_limits<uint32_t>::max();
+const float kFloatMax = std::numeric_limits<float>::max();
+
+/// Memory layout of texels for CPU analysis.
+struct TexelLayout
+{
+    FormatType type;
+    uint32_t channelCount;      ///< Number of channels stored per texel.
+    uint32_t bitsPerChannel;    ///< Number of bits per stored channel.
+    uint32_t channelIndex[4];   ///< Index of the stored channel holding each RGBA channel, or kMissingChannel.
+};
+
+/// Per-channel statistics of stored channels accumulated by the CPU analysis.
+struct ChannelStats
+{
+    float refValue[4] = {};
+    bool varying[4] = {};
+    uint32_t range[4] = {};
+    float minValue[4] = {kFloatMax, kFloatMax, kFloatMax, kFloatMax};
+    float maxValue[4] = {-kFloatMax, -kFloatMax, -kFloatMax, -kFloatMax};
+};
+
+std::optional<TexelLayout> getTexelLayout(ResourceFormat format)
+{
+    if (format == ResourceFormat::Unknown || isCompressedFormat(format) || isDepthStencilFormat(format))
+        return {};
+
+    TexelLayout layout = {getFormatType(format), getFormatChannelCount(format), getNumChannelBits(format, 0)};
+
+    switch (layout.type)
+    {
+    case FormatType::Float:
+    case FormatType::Snorm:
+    case FormatType::Unorm:
+    case FormatType::UnormSrgb:
+        break;
+    default:
+        return {};
+    }
+
+    // Only formats with byte-sized channels of equal size are supported. This excludes packed formats.
+    for (uint32_t i = 1; i < layout.channelCount; i++)
+    {
+        if (getNumChannelBits(format, i) != layout.bitsPerChannel)
+            return {};
+    }
+    if (getFormatBytesPerBlock(format) * 8 != layout.channelCount * layout.bitsPerChannel)
+        return {};
+    bool isFloat = layout.type == FormatType::Float;
+    if (!(layout.bitsPerChannel == 8 && !isFloat) && layout.bitsPerChannel != 16 && !(layout.bitsPerChannel == 32 && isFloat))
+        return {};
+
+    for (uint32_t i = 0; i < 4; i++)
+        layout.channelIndex[i] = i < layout.channelCount ? i : kMissingChannel;
+
+    switch (format)
+    {
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+        layout.channelIndex[0] = 2;
+        layout.channelIndex[2] = 0;
+        break;
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+        layout.channelIndex[0] = 2;
+        layout.channelIndex[2] = 0;
+        layout.channelIndex[3] = kMissingChannel;
+        break;
+    default:
+        break;
+    }
+
+    return layout;
+}
+
+float srgbToLinear(float srgb)
+{
+    return srgb <= 0.04045f ? srgb * (1.f / 12.92f) : std::pow((srgb + 0.055f) * (1.f / 1.055f), 2.4f);
+}
+
+/// Returns a table converting 8-bit unorm values to float.
+const std::array<float, 256>& getUnorm8Table(bool srgb)
+{
+    static const auto kTables = []()
+    {
+        std::array<std::array<float, 256>, 2> tables;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            tables[0][i] = i / 255.f;
+            tables[1][i] = srgbToLinear(i / 255.f);
+        }
+        return tables;
+    }();
+    return kTables[srgb ? 1 : 0];
+}
+
+uint32_t getRangeFlags(float value)
+{
+    uint32_t range = 0;
+    if (value > 0.f)
+        range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos;
+    if (value < 0.f)
+        range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg;
+    if (std::isinf(value))
+        range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf;
+    if (std::isnan(value))
+        range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN;
+    return range;
+}
+
+/**
+ * Analyze 8-bit unorm texels.
+ * The conversion to float is monotonic and one-to-one, so it is sufficient to find the per-channel minimum and maximum
+ * of the raw bytes. These are tracked in interleaved lanes of 16 bytes (48 for 3 channels, so that a lane always holds
+ * the same channel), which are processed with SSE2 instructions where available.
+ */
+template<uint32_t N>
+void analyzeUnorm8(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, bool srgb, ChannelStats& stats)
+{
+    constexpr uint32_t kLaneCount = N == 3 ? 48 : 16;
+    const size_t rowSize = (size_t)width * N;
+
+    uint8_t minLanes[kLaneCount];
+    uint8_t maxLanes[kLaneCount];
+    std::fill_n(minLanes, kLaneCount, uint8_t(255));
+    std::fill_n(maxLanes, kLaneCount, uint8_t(0));
+
+#if TEXTURE_ANALYZER_USE_SSE2
+    constexpr uint32_t kVectorCount = kLaneCount / 16;
+    __m128i minVectors[kVectorCount];
+    __m128i maxVectors[kVectorCount];
+    for (uint32_t v = 0; v < kVectorCount; v++)
+    {
+        minVectors[v] = _mm_set1_epi8(-1);
+        maxVectors[v] = _mm_setzero_si128();
+    }
+#endif
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t* pRow = pData + (size_t)y * rowPitch;
+        size_t i = 0;
+#if TEXTURE_ANALYZER_USE_SSE2
+        for (; i + kLaneCount <= rowSize; i += kLaneCount)
+        {
+            for (uint32_t v = 0; v < kVectorCount; v++)
+            {
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i + 16 * v));
+                minVectors[v] = _mm_min_epu8(minVectors[v], value);
+                maxVectors[v] = _mm_max_epu8(maxVectors[v], value);
+            }
+        }
+#endif
+        for (; i < rowSize; i++)
+        {
+            minLanes[i % kLaneCount] = std::min(minLanes[i % kLaneCount], pRow[i]);
+            maxLanes[i % kLaneCount] = std::max(maxLanes[i % kLaneCount], pRow[i]);
+        }
+    }
+
+#if TEXTURE_ANALYZER_USE_SSE2
+    // Merge the vector lanes into the scalar lanes.
+    for (uint32_t v = 0; v < kVectorCount; v++)
+    {
+        uint8_t minValues[16];
+        uint8_t maxValues[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(minValues), minVectors[v]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxValues), maxVectors[v]);
+        for (uint32_t j = 0; j < 16; j++)
+        {
+            minLanes[16 * v + j] = std::min(minLanes[16 * v + j], minValues[j]);
+            maxLanes[16 * v + j] = std::max(maxLanes[16 * v + j], maxValues[j]);
+        }
+    }
+#endif
+
+    for (uint32_t c = 0; c < N; c++)
+    {
+        uint8_t minValue = 255;
+        uint8_t maxValue = 0;
+        for (uint32_t j = c; j < kLaneCount; j += N)
+        {
+            minValue = std::min(minValue, minLanes[j]);
+            maxValue = std::max(maxValue, maxLanes[j]);
+        }
+
+        // The alpha channel of sRGB formats is stored as linear.
+        const auto& table = getUnorm8Table(srgb && c < 3);
+        stats.refValue[c] = table[pData[c]];
+        stats.varying[c] = minValue != maxValue;
+        stats.range[c] = maxValue > 0 ? (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos : 0;
+        stats.minValue[c] = table[minValue];
+        stats.maxValue[c] = table[maxValue];
+    }
+}
+
+/**
+ * Analyze texels given as rows of float channel values.
+ * Statistics are tracked in interleaved lanes of 4 floats (12 for 3 channels, so that a lane always holds the same channel),
+ * which are processed with SSE2 instructions where available. NaNs count as varying but are ignored by the min/max.
+ * @param[in] getRow Function returning a pointer to the channel values of a row. The pointer is valid until the next call.
+ */
+template<uint32_t N, typename GetRow>
+void analyzeFloats(uint32_t width, uint32_t height, GetRow getRow, ChannelStats& stats)
+{
+    constexpr uint32_t kLaneCount = N == 3 ? 12 : 4;
+    constexpr uint32_t kVaryingFlag = 0x10; // Stored next to the range flags.
+    const size_t rowSize = (size_t)width * N;
+
+    float refLanes[kLaneCount];
+    float minLanes[kLaneCount];
+    float maxLanes[kLaneCount];
+    uint32_t flagLanes[kLaneCount] = {};
+    const float* pFirst = getRow(0);
+    for (uint32_t j = 0; j < kLaneCount; j++)
+    {
+        refLanes[j] = pFirst[j % N];
+        minLanes[j] = kFloatMax;
+        maxLanes[j] = -kFloatMax;
+    }
+
+#if TEXTURE_ANALYZER_USE_SSE2
+    constexpr uint32_t kVectorCount = kLaneCount / 4;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 refVectors[kVectorCount];
+    __m128 minVectors[kVectorCount];
+    __m128 maxVectors[kVectorCount];
+    __m128 varyingVectors[kVectorCount];
+    __m128 posVectors[kVectorCount];
+    __m128 negVectors[kVectorCount];
+    __m128 infVectors[kVectorCount];
+    __m128 nanVectors[kVectorCount];
+    for (uint32_t v = 0; v < kVectorCount; v++)
+    {
+        refVectors[v] = _mm_loadu_ps(refLanes + 4 * v);
+        minVectors[v] = _mm_set1_ps(kFloatMax);
+        maxVectors[v] = _mm_set1_ps(-kFloatMax);
+        varyingVectors[v] = posVectors[v] = negVectors[v] = infVectors[v] = nanVectors[v] = zero;
+    }
+#endif
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const float* pRow = getRow(y);
+        size_t i = 0;
+#if TEXTURE_ANALYZER_USE_SSE2
+        for (; i + kLaneCount <= rowSize; i += kLaneCount)
+        {
+            for (uint32_t v = 0; v < kVectorCount; v++)
+            {
+                __m128 value = _mm_loadu_ps(pRow + i + 4 * v);
+                varyingVectors[v] = _mm_or_ps(varyingVectors[v], _mm_cmpneq_ps(value, refVectors[v]));
+                posVectors[v] = _mm_or_ps(posVectors[v], _mm_cmpgt_ps(value, zero));
+                negVectors[v] = _mm_or_ps(negVectors[v], _mm_cmplt_ps(value, zero));
+                infVectors[v] = _mm_or_ps(infVectors[v], _mm_cmpeq_ps(_mm_and_ps(value, absMask), inf));
+                nanVectors[v] = _mm_or_ps(nanVectors[v], _mm_cmpunord_ps(value, value));
+                // These return the second operand if the first is NaN, same as the scalar code below.
+                minVectors[v] = _mm_min_ps(value, minVectors[v]);
+                maxVectors[v] = _mm_max_ps(value, maxVectors[v]);
+            }
+        }
+#endif
+        for (; i < rowSize; i++)
+        {
+            const uint32_t j = i % kLaneCount;
+            const float value = pRow[i];
+            flagLanes[j] |= getRangeFlags(value) | (value != refLanes[j] ? kVaryingFlag : 0);
+            minLanes[j] = value < minLanes[j] ? value : minLanes[j];
+            maxLanes[j] = value > maxLanes[j] ? value : maxLanes[j];
+        }
+    }
+
+#if TEXTURE_ANALYZER_USE_SSE2
+    // Merge the vector lanes into the scalar lanes.
+    using RangeFlags = TextureAnalyzer::Result::RangeFlags;
+    for (uint32_t v = 0; v < kVectorCount; v++)
+    {
+        float minValues[4];
+        float maxValues[4];
+        _mm_storeu_ps(minValues, minVectors[v]);
+        _mm_storeu_ps(maxValues, maxVectors[v]);
+        const int varyingMask = _mm_movemask_ps(varyingVectors[v]);
+        const int posMask = _mm_movemask_ps(posVectors[v]);
+        const int negMask = _mm_movemask_ps(negVectors[v]);
+        const int infMask = _mm_movemask_ps(infVectors[v]);
+        const int nanMask = _mm_movemask_ps(nanVectors[v]);
+        for (uint32_t k = 0; k < 4; k++)
+        {
+            const uint32_t j = 4 * v + k;
+            flagLanes[j] |= ((varyingMask >> k) & 1 ? kVaryingFlag : 0) | ((posMask >> k) & 1 ? (uint32_t)RangeFlags::Pos : 0) |
+                            ((negMask >> k) & 1 ? (uint32_t)RangeFlags::Neg : 0) | ((infMask >> k) & 1 ? (uint32_t)RangeFlags::Inf : 0) |
+                            ((nanMask >> k) & 1 ? (uint32_t)RangeFlags::NaN : 0);
+            minLanes[j] = std::min(minLanes[j], minValues[k]);
+            maxLanes[j] = std::max(maxLanes[j], maxValues[k]);
+        }
+    }
+#endif
+
+    for (uint32_t c = 0; c < N; c++)
+    {
+        stats.refValue[c] = refLanes[c];
+        for (uint32_t j = c; j < kLaneCount; j += N)
+        {
+            stats.varying[c] |= (flagLanes[j] & kVaryingFlag) != 0;
+            stats.range[c] |= flagLanes[j] & ~kVaryingFlag;
+            stats.minValue[c] = std::min(stats.minValue[c], minLanes[j]);
+            stats.maxValue[c] = std::max(stats.maxValue[c], maxLanes[j]);
+        }
+    }
+}
+
+/// Analyze texels by converting each row of channel values to float.
+template<uint32_t N, typename T, typename Decode>
+void analyzeDecoded(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, Decode decode, ChannelStats& stats)
+{
+    std::vector<float> row((size_t)width * N);
+    auto getRow = [&](uint32_t y)
+    {
+        const T* pRow = reinterpret_cast<const T*>(pData + (size_t)y * rowPitch);
+        for (size_t i = 0; i < row.size(); i++)
+            row[i] = decode(pRow[i]);
+        return row.data();
+    };
+    analyzeFloats<N>(width, height, getRow, stats);
+}
+
+template<uint32_t N>
+void analyzeChannels(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, const TexelLayout& layout, ChannelStats& stats)
+{
+    switch (layout.bitsPerChannel)
+    {
+    case 8:
+        if (layout.type == FormatType::Snorm)
+        {
+            auto decode = [](int8_t v) { return std::max(v / 127.f, -1.f); };
+            analyzeDecoded<N, int8_t>(pData, width, height, rowPitch, decode, stats);
+        }
+        else
+        {
+            analyzeUnorm8<N>(pData, width, height, rowPitch, layout.type == FormatType::UnormSrgb, stats);
+        }
+        break;
+    case 16:
+        if (layout.type == FormatType::Float)
+        {
+            auto decode = [](uint16_t v) { return math::float16ToFloat32(v); };
+            analyzeDecoded<N, uint16_t>(pData, width, height, rowPitch, decode, stats);
+        }
+        else if (layout.type == FormatType::Snorm)
+        {
+            auto decode = [](int16_t v) { return std::max(v / 32767.f, -1.f); };
+            analyzeDecoded<N, int16_t>(pData, width, height, rowPitch, decode, stats);
+        }
+        else
+        {
+            auto decode = [](uint16_t v) { return v / 65535.f; };
+            analyzeDecoded<N, uint16_t>(pData, width, height, rowPitch, decode, stats);
+        }
+        break;
+    case 32:
+    {
+        auto getRow = [&](uint32_t y) { return reinterpret_cast<const float*>(pData + (size_t)y * rowPitch); };
+        analyzeFloats<N>(width, height, getRow, stats);
+        break;
+    }
+    default:
+        FALCOR_UNREACHABLE();
+    }
+}
 } // namespace
 
 // Verify that the result struct matches the size expected by the shader.
@@ -158,4 +543,76 @@ void TextureAnalyzer::checkFormatSupport(const ref<Texture> pInput, uint32_t mip
         FALCOR_THROW("Unknown format type");
     }
 }
+
+bool TextureAnalyzer::isCpuFormatSupported(ResourceFormat format)
+{
+    return getTexelLayout(format).has_value();
+}
+
+TextureAnalyzer::Result TextureAnalyzer::analyzeTexels(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format)
+{
+    auto layout = getTexelLayout(format);
+    if (!layout)
+        FALCOR_THROW("Format {} is not supported", to_string(format));
+    FALCOR_CHECK(pData != nullptr && width > 0 && height > 0, "Texel data must not be empty");
+    FALCOR_CHECK(rowPitch >= width * getFormatBytesPerBlock(format), "Row pitch is too small");
+
+    // Analyze the stored channels.
+    ChannelStats stats;
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+    switch (layout->channelCount)
+    {
+    case 1:
+        analyzeChannels<1>(pBytes, width, height, rowPitch, *layout, stats);
+        break;
+    case 2:
+        analyzeChannels<2>(pBytes, width, height, rowPitch, *layout, stats);
+        break;
+    case 3:
+        analyzeChannels<3>(pBytes, width, height, rowPitch, *layout, stats);
+        break;
+    case 4:
+        analyzeChannels<4>(pBytes, width, height, rowPitch, *layout, stats);
+        break;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+
+    // Write the result for the RGBA channels.
+    // Missing channels read as constant (0,0,0,1) in shaders. Min/max values are clamped to zero like on the GPU.
+    Result result = {};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        float value = i == 3 ? 1.f : 0.f;
+        float minValue = value;
+        float maxValue = value;
+        bool varying = false;
+        uint32_t range = getRangeFlags(value);
+
+        if (uint32_t c = layout->channelIndex[i]; c != kMissingChannel)
+        {
+            value = stats.refValue[c];
+            minValue = stats.minValue[c];
+            maxValue = stats.maxValue[c];
+            varying = stats.varying[c];
+            range = stats.range[c];
+        }
+
+        result.mask |= (varying ? 1u : 0u) << i;
+        result.mask |= range << (4 + 4 * i);
+        result.value[i] = value;
+        result.minValue[i] = std::max(minValue, 0.f);
+        result.maxValue[i] = std::max(maxValue, 0.f);
+    }
+
+    return result;
+}
+
+std::optional<TextureAnalyzer::Result> TextureAnalyzer::analyzeBitmap(const Bitmap& bitmap, ResourceFormat format)
+{
+    FALCOR_ASSERT(srgbToLinearFormat(format) == srgbToLinearFormat(bitmap.getFormat()));
+    if (!isCpuFormatSupported(format))
+        return {};
+    return analyzeTexels(bitmap.getData(), bitmap.getWidth(), bitmap.getHeight(), bitmap.getRowPitch(), format);
+}
 } // namespace Falcor
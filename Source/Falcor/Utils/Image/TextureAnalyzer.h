@@ -33,6 +33,7 @@
 #include "Core/Pass/ComputePass.h"
 #include "Utils/Math/Vector.h"
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace Falcor
@@ -145,6 +146,35 @@ public:
      */
     static size_t getResultSize();
 
+    /**
+     * Check if texel data of the given format can be analyzed on the CPU.
+     * Uncompressed floating-point, unorm, sRGB and snorm formats with the same number of bits (8, 16 or 32) in all channels are supported.
+     */
+    static bool isCpuFormatSupported(ResourceFormat format);
+
+    /**
+     * Analyze 2D texel data on the CPU.
+     * This produces the same result as analyzing a texture holding the data on the GPU. Texels are converted to RGBA fp32
+     * the way a shader reads them, including sRGB decoding and default values for missing channels.
+     * Throws an exception if the format is not supported.
+     * @param[in] pData Texel data.
+     * @param[in] width Width in texels.
+     * @param[in] height Height in texels.
+     * @param[in] rowPitch Size of a row of texels in bytes.
+     * @param[in] format Texel format.
+     * @return The analysis result.
+     */
+    static Result analyzeTexels(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format);
+
+    /**
+     * Analyze a decoded bitmap on the CPU.
+     * This allows analyzing textures while they are loaded, without a round-trip to the GPU.
+     * @param[in] bitmap The bitmap.
+     * @param[in] format Format of the texture created from the bitmap. This may be the sRGB variant of the bitmap's format.
+     * @return The analysis result, or an empty optional if the format is not supported.
+     */
+    static std::optional<Result> analyzeBitmap(const Bitmap& bitmap, ResourceFormat format);
+
 private:
     void checkFormatSupport(const ref<Texture> pInput, uint32_t mipLevel, uint32_t arraySlice) const;
 
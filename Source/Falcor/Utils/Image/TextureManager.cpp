@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureManager.h"
+#include "BakedTexture.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
@@ -194,7 +195,8 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
     Bitmap::ImportFlags importFlags,
     const AssetResolver* assetResolver,
     size_t* loadedTextureCount,
-    const Object* owner
+    const Object* owner,
+    bool deferConstant
 )
 {
     if (path.string().find("<UDIM>") != std::string::npos)
@@ -259,6 +261,16 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         return handle;
     }
 
+    // Prefer the baked variant of the texture if it is up to date. Baked textures always have a full mip chain.
+    if (paths.size() == 1 && generateMipLevels && importFlags == Bitmap::ImportFlags::None && BakedTexture::isEnabled())
+    {
+        if (auto bakedPath = BakedTexture::find(paths[0]))
+        {
+            logDebug("Using baked texture '{}' for '{}'.", *bakedPath, paths[0]);
+            paths[0] = std::move(*bakedPath);
+        }
+    }
+
     std::unique_lock<std::mutex> lock(mMutex);
     const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags, importFlags);
 
@@ -295,7 +307,9 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
 
         // Function called by the async texture loader when loading finishes.
         // It's called by a worker thread so needs to acquire the mutex before changing any state.
-        auto callback = [=](ref<Texture> pTexture)
+        auto callback = [=](ref<Texture> pTexture,
+                            const std::optional<TextureAnalyzer::Result>& analysis,
+                            std::optional<DecodedTexture>&& constantTexture)
         {
             std::unique_lock<std::mutex> lock(mMutex);
 
@@ -303,6 +317,9 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
             auto& desc = getDesc(handle);
             desc.state = TextureState::Loaded;
             desc.pTexture = pTexture;
+            desc.analysis = analysis;
+            if (constantTexture)
+                desc.pDeferred = std::make_shared<const DeferredTexture>(DeferredTexture{std::move(*constantTexture), bindFlags});
 
             // Add to texture-to-handle map.
             if (pTexture)
@@ -315,34 +332,24 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         // Issue load request to texture loader.
         if (paths.size() > 1)
         {
-            mAsyncTextureLoader.loadMippedFromFiles(paths, loadAsSRGB, bindFlags, importFlags, callback);
+            mAsyncTextureLoader.loadMippedFromFiles(paths, loadAsSRGB, bindFlags, importFlags, callback, deferConstant);
         }
         else
         {
-            mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback);
+            mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback, deferConstant);
         }
 #else
         // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
-        {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags, importFlags);
-        }
-        else
-        {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
-        }
-
-        // Add new texture desc.
-        TextureDesc desc = {TextureState::Loaded, pTexture};
+        TextureDesc desc = loadDesc(textureKey, deferConstant);
+        desc.state = TextureState::Loaded;
         handle = addDesc(desc);
 
         // Add to key-to-handle map.
         mKeyToHandle[textureKey] = handle;
 
         // Add to texture-to-handle map.
-        if (pTexture)
-            mTextureToHandle[pTexture.get()] = handle;
+        if (desc.pTexture)
+            mTextureToHandle[desc.pTexture.get()] = handle;
 
         mCondition.notify_all();
 #endif
@@ -418,19 +425,10 @@ void TextureManager::endDeferredLoading()
         {
             const auto& job = jobs[i];
             auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
-            {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
-            }
-            else
-            {
-                desc.pTexture =
-                    Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
-            }
+            logDebug("Loading {}texture from '{}'", job.key.fullPaths.size() > 1 ? "mipped " : "", job.key.fullPaths[0]);
+            TextureDesc loaded = loadDesc(job.key, false);
+            desc.pTexture = std::move(loaded.pTexture);
+            desc.analysis = loaded.analysis;
             if (texturesLoaded.fetch_add(1) % 10 == 9)
             {
                 logDebug("Flush");
@@ -539,6 +537,29 @@ void TextureManager::removeTextures(const Object* object)
         logInfo("Texture manager: Removed {} textures.", handles.size());
 }
 
+ref<Texture> TextureManager::getTexture(const CpuTextureHandle& handle)
+{
+    if (!handle)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    FALCOR_CHECK(!handle.isUdim(), "Can't lookup texture from handle to UDIM texture. Resolve UDIM first.");
+    FALCOR_CHECK(handle && handle.getID() < mTextureDescs.size(), "Invalid texture handle.");
+    auto& desc = getDesc(handle);
+
+    // Create the constant texture whose creation was deferred during loading.
+    if (desc.pDeferred)
+    {
+        FALCOR_ASSERT(!desc.pTexture);
+        desc.pTexture = Texture::createFromDecoded(mpDevice, desc.pDeferred->decoded, desc.pDeferred->bindFlags);
+        desc.pDeferred.reset();
+        if (desc.pTexture)
+            mTextureToHandle[desc.pTexture.get()] = handle;
+    }
+
+    return desc.pTexture;
+}
+
 TextureManager::TextureDesc TextureManager::getTextureDesc(const CpuTextureHandle& handle) const
 {
     if (!handle)
@@ -550,6 +571,17 @@ TextureManager::TextureDesc TextureManager::getTextureDesc(const CpuTextureHandl
     return mTextureDescs[handle.getID()];
 }
 
+std::optional<TextureAnalyzer::Result> TextureManager::getTextureAnalysis(const Texture* pTexture) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (auto it = mTextureToHandle.find(pTexture); it != mTextureToHandle.end())
+    {
+        FALCOR_ASSERT(!it->second.isUdim() && it->second.getID() < mTextureDescs.size());
+        return mTextureDescs[it->second.getID()].analysis;
+    }
+    return {};
+}
+
 size_t TextureManager::getTextureDescCount() const
 {
     std::lock_guard<std::mutex> lock(mMutex);
@@ -631,6 +663,8 @@ TextureManager::Stats TextureManager::getStats() const
     TextureManager::Stats s;
     for (const auto& t : mTextureDescs)
     {
+        if (t.pDeferred)
+            s.textureDeferredCount++;
         if (!t.pTexture)
             continue;
         uint64_t texelCount = t.pTexture->getTexelCount();
@@ -645,6 +679,30 @@ TextureManager::Stats TextureManager::getStats() const
     return s;
 }
 
+TextureManager::TextureDesc TextureManager::loadDesc(const TextureKey& key, bool deferConstant) const
+{
+    // Decode and analyze the texels on the CPU, then create the texture unless it's constant and its creation is deferred.
+    std::optional<DecodedTexture> decoded;
+    if (key.fullPaths.size() == 1)
+        decoded = DecodedTexture::decodeFromFile(key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.importFlags);
+    else
+        decoded = DecodedTexture::decodeMippedFromFiles(key.fullPaths, key.loadAsSRGB, key.importFlags);
+
+    TextureDesc desc;
+    if (!decoded)
+        return desc;
+
+    if (decoded->pBitmap)
+        desc.analysis = TextureAnalyzer::analyzeBitmap(*decoded->pBitmap, decoded->format);
+
+    if (deferConstant && desc.analysis && desc.analysis->isConstant(TextureChannelFlags::RGBA) && decoded->makeConstant())
+        desc.pDeferred = std::make_shared<const DeferredTexture>(DeferredTexture{std::move(*decoded), key.bindFlags});
+    else
+        desc.pTexture = Texture::createFromDecoded(mpDevice, *decoded, key.bindFlags);
+
+    return desc;
+}
+
 TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc)
 {
     CpuTextureHandle handle;
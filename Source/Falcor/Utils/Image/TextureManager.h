@@ -39,6 +39,7 @@
 #include <set>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 namespace Falcor
@@ -73,6 +74,7 @@ public:
         uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
         uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
         uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t textureDeferredCount = 0;     ///< Number of constant textures whose creation is deferred. Not included above.
     };
 
     /**
@@ -129,11 +131,20 @@ public:
         bool mIsUdim{false};
     };
 
+    /// Texture of constant value whose creation is deferred until it is requested with getTexture().
+    struct DeferredTexture
+    {
+        DecodedTexture decoded; ///< Decoded texture holding a single texel (see DecodedTexture::makeConstant()).
+        ResourceBindFlags bindFlags = ResourceBindFlags::None;
+    };
+
     /// Struct describing a managed texture.
     struct TextureDesc
     {
-        TextureState state = TextureState::Invalid; ///< Current state of the texture.
-        ref<Texture> pTexture;                      ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        TextureState state = TextureState::Invalid;      ///< Current state of the texture.
+        ref<Texture> pTexture;                           ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        std::optional<TextureAnalyzer::Result> analysis; ///< Result of analyzing the texels on the CPU during loading, if available.
+        std::shared_ptr<const DeferredTexture> pDeferred; ///< Constant texture not yet created, or nullptr.
 
         bool isValid() const { return state != TextureState::Invalid; }
     };
@@ -161,6 +172,7 @@ public:
      * This will add the texture to the set of managed textures. The function returns a handle immediately.
      * If asynchronous loading is requested, the texture data will not be available until loading completes.
      * The returned handle is valid for the entire lifetime of the texture, until removeTexture() is called.
+     * If mips are requested and an up-to-date baked variant of the file exists (see BakedTexture), it is loaded instead.
      * @param[in] path File path of the texture. This can be a full path or a relative path from a data directory.
      * @param[in] generateMipLevels Whether the full mip-chain should be generated.
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
@@ -169,6 +181,10 @@ public:
      * @param[in] importFlags Optional flags for the file import.
      * @param[in] assetResolver Optional asset resolver for resolving file paths.
      * @param[out] loadedTextureCount Optionally can provided the number of actually loaded textures (2+ can happen with UDIMs)
+     * @param[in] owner Optional object owning the texture (see removeTextures()).
+     * @param[in] deferConstant Defer creating the texture if the CPU analysis finds it has a constant value. The texture desc then holds
+     *            the texel in 'pDeferred' and the texture is created on the first call to getTexture().
+     *            Ignored for UDIM textures and between beginDeferredLoading() and endDeferredLoading().
      * @return Unique handle to the texture, or an invalid handle if the texture can't be found.
      */
     CpuTextureHandle loadTexture(
@@ -180,7 +196,8 @@ public:
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
         const AssetResolver* assetResolver = nullptr,
         size_t* loadedTextureCount = nullptr,
-        const Object* owner = nullptr
+        const Object* owner = nullptr,
+        bool deferConstant = false
     );
 
     /**
@@ -220,12 +237,13 @@ public:
     /**
      * Get a loaded texture. Call getTextureDesc() for more info.
      * This function handles non-UDIM textures. If UDIMs are expected, supply UDIM ID or uv coordinate.
+     * A constant texture whose creation was deferred during loading is created by this call.
      * @param[in] handle Texture handle.
      * @return Texture if loaded, or nullptr if handle doesn't exist or texture isn't yet loaded.
      */
-    ref<Texture> getTexture(const CpuTextureHandle& handle) const { return getTextureDesc(handle).pTexture; }
-    ref<Texture> getTexture(const CpuTextureHandle& handle, const float2& uv) const { return getTextureDesc(handle, uv).pTexture; }
-    ref<Texture> getTexture(const CpuTextureHandle& handle, const uint32_t udimID) const { return getTextureDesc(handle, udimID).pTexture; }
+    ref<Texture> getTexture(const CpuTextureHandle& handle);
+    ref<Texture> getTexture(const CpuTextureHandle& handle, const float2& uv) { return getTexture(resolveUdimTexture(handle, uv)); }
+    ref<Texture> getTexture(const CpuTextureHandle& handle, const uint32_t udimID) { return getTexture(resolveUdimTexture(handle, udimID)); }
 
     /**
      * Get a texture desc.
@@ -243,6 +261,14 @@ public:
         return getTextureDesc(resolveUdimTexture(handle, udimID));
     }
 
+    /**
+     * Get the result of the CPU analysis of a managed texture.
+     * The analysis is done while textures are loaded from file, if the texture's format supports it.
+     * @param[in] pTexture The texture.
+     * @return The analysis result, or an empty optional if the texture is not managed or was not analyzed.
+     */
+    std::optional<TextureAnalyzer::Result> getTextureAnalysis(const Texture* pTexture) const;
+
     /**
      * Get list of UDIM IDs for a texture.
      * If the texture is not using UDIMs, an empty list is returned.
@@ -339,6 +365,7 @@ private:
         }
     };
 
+    TextureDesc loadDesc(const TextureKey& key, bool deferConstant) const;
     CpuTextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const CpuTextureHandle& handle);
     void registerOwner(const CpuTextureHandle& handle, const Object* owner);
@@ -27,12 +27,34 @@
  **************************************************************************/
 
 /**
- * Most of this code is derived from the GLM library at https://github.com/g-truc/glm
+ * The scalar code is derived from the GLM library at https://github.com/g-truc/glm
  *
  * License: https://github.com/g-truc/glm/blob/master/copying.txt
+ *
+ * The SSE2 code follows the branchless conversions by Fabian Giesen at https://gist.github.com/rygorous/2156668
  */
 
 #include "Float16.h"
+#include "Core/Error.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#if FALCOR_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define FLOAT16_USE_SIMD 1
+#else
+#define FLOAT16_USE_SIMD 0
+#endif
+
+// The F16C code is compiled for AVX/F16C regardless of the target architecture and only called if the CPU supports it.
+#if FLOAT16_USE_SIMD && (FALCOR_GCC || FALCOR_CLANG)
+#define FLOAT16_TARGET_F16C __attribute__((target("avx,f16c")))
+#else
+#define FLOAT16_TARGET_F16C
+#endif
 
 namespace Falcor
 {
@@ -99,10 +121,14 @@ uint16_t float32ToFloat16(float value)
         // We convert f to a denormalized half.
         //
 
-        m = (m | 0x00800000) >> (1 - e);
+        m = m | 0x00800000;
+        int shift = 14 - e;
+        int remainder = m & ((1 << shift) - 1);
+        int halfway = 1 << (shift - 1);
+        m >>= shift;
 
         //
-        // Round to nearest, round "0.5" up.
+        // Round to nearest, ties to even.
         //
         // Rounding may cause the significand to overflow and make
         // our number normalized.  Because of the way a half's bits
@@ -110,14 +136,14 @@ uint16_t float32ToFloat16(float value)
         // the code below will handle it correctly.
         //
 
-        if (m & 0x00001000)
-            m += 0x00002000;
+        if (remainder > halfway || (remainder == halfway && (m & 1)))
+            m += 1;
 
         //
         // Assemble the half from s, e (zero) and m.
         //
 
-        return uint16_t(s | (m >> 13));
+        return uint16_t(s | m);
     }
     else if (e == 0xff - (127 - 15))
     {
@@ -133,17 +159,14 @@ uint16_t float32ToFloat16(float value)
         else
         {
             //
-            // F is a NAN; we produce a half NAN that preserves
+            // F is a NAN; we produce a quiet half NAN that preserves
             // the sign bit and the 10 leftmost bits of the
-            // significand of f, with one exception: If the 10
-            // leftmost bits are all zero, the NAN would turn
-            // into an infinity, so we have to set at least one
-            // bit in the significand.
+            // significand of f. This matches the F16C instructions.
             //
 
             m >>= 13;
 
-            return uint16_t(s | 0x7c00 | m | (m == 0));
+            return uint16_t(s | 0x7e00 | m);
         }
     }
     else
@@ -154,18 +177,15 @@ uint16_t float32ToFloat16(float value)
         //
 
         //
-        // Round to nearest, round "0.5" up
+        // Round to nearest, ties to even
         //
 
-        if (m & 0x00001000)
-        {
-            m += 0x00002000;
+        m += 0x00000fff + ((m >> 13) & 1);
 
-            if (m & 0x00800000)
-            {
-                m = 0;  // overflow in significand,
-                e += 1; // adjust exponent
-            }
+        if (m & 0x00800000)
+        {
+            m = 0;  // overflow in significand,
+            e += 1; // adjust exponent
         }
 
         //
@@ -236,11 +256,11 @@ float float16ToFloat32(uint16_t value)
         else
         {
             //
-            // Nan -- preserve sign and significand bits
+            // Nan -- preserve sign and significand bits and make it quiet (matches the F16C instructions)
             //
 
             uif32 result;
-            result.i = static_cast<unsigned int>((s << 31) | 0x7f800000 | (m << 13));
+            result.i = static_cast<unsigned int>((s << 31) | 0x7fc00000 | (m << 13));
             return result.f;
         }
     }
@@ -261,5 +281,209 @@ float float16ToFloat32(uint16_t value)
     return result.f;
 }
 
+namespace
+{
+void float32ToFloat16Scalar(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = float32ToFloat16(pSrc[i]);
+}
+
+void float16ToFloat32Scalar(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = float16ToFloat32(pSrc[i]);
+}
+
+#if FLOAT16_USE_SIMD
+
+bool isF16CSupported()
+{
+    // F16C requires AVX, which in turn requires the OS to save the YMM registers.
+    uint32_t ecx = 0;
+#if FALCOR_MSVC
+    int regs[4];
+    __cpuid(regs, 1);
+    ecx = uint32_t(regs[2]);
+#else
+    uint32_t eax, ebx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+#endif
+    const uint32_t kOSXSAVE = 1u << 27;
+    const uint32_t kAVX = 1u << 28;
+    const uint32_t kF16C = 1u << 29;
+    if ((ecx & (kOSXSAVE | kAVX | kF16C)) != (kOSXSAVE | kAVX | kF16C))
+        return false;
+
+#if FALCOR_MSVC
+    uint64_t xcr0 = _xgetbv(0);
+#else
+    uint32_t xcr0Low, xcr0High;
+    __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    uint64_t xcr0 = xcr0Low;
+#endif
+    return (xcr0 & 0x6) == 0x6;
+}
+
+/// Converts 4 float32 values (as bits) to float16, returned in the low 16 bits of each lane.
+__m128i float32ToFloat16SSE2(__m128i u)
+{
+    const __m128i signMask = _mm_set1_epi32(int(0x80000000));
+    const __m128i f32Infinity = _mm_set1_epi32(255 << 23);
+    const __m128i f16Overflow = _mm_set1_epi32(((127 + 16) << 23) - 1); // Values above always overflow to infinity.
+    const __m128i f16MinNormal = _mm_set1_epi32(113 << 23);
+    const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i biasAndRound = _mm_set1_epi32(((15 - 127) << 23) + 0xfff);
+    const __m128i one = _mm_set1_epi32(1);
+
+    __m128i sign = _mm_and_si128(u, signMask);
+    __m128i a = _mm_xor_si128(u, sign);
+
+    // Normalized: re-bias the exponent and round the significand to nearest even.
+    __m128i mantOdd = _mm_and_si128(_mm_srli_epi32(a, 13), one);
+    __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(a, biasAndRound), mantOdd), 13);
+
+    // Denormalized: let the floating-point adder do the shift and rounding.
+    __m128 denormF = _mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(denormMagic));
+    __m128i denorm = _mm_sub_epi32(_mm_castps_si128(denormF), denormMagic);
+
+    // Infinity/overflow, or quiet NaN preserving the leftmost significand bits.
+    __m128i isNan = _mm_cmpgt_epi32(a, f32Infinity);
+    __m128i nan = _mm_or_si128(_mm_set1_epi32(0x7e00), _mm_and_si128(_mm_srli_epi32(a, 13), _mm_set1_epi32(0x3ff)));
+    __m128i special = _mm_or_si128(_mm_and_si128(isNan, nan), _mm_andnot_si128(isNan, _mm_set1_epi32(0x7c00)));
+
+    __m128i isDenorm = _mm_cmplt_epi32(a, f16MinNormal);
+    __m128i isSpecial = _mm_cmpgt_epi32(a, f16Overflow);
+    __m128i result = _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+    result = _mm_or_si128(_mm_and_si128(isSpecial, special), _mm_andnot_si128(isSpecial, result));
+
+    return _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+}
+
+/// Converts 4 float16 values given in the low 16 bits of each lane to float32 bits.
+__m128i float16ToFloat32SSE2(__m128i h)
+{
+    const __m128i shiftedExp = _mm_set1_epi32(0x7c00 << 13);
+    const __m128i magic = _mm_set1_epi32(113 << 23);
+
+    __m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+    __m128i exp = _mm_and_si128(o, shiftedExp);
+    o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+
+    // Infinity/NaN: extra exponent adjustment, NaNs are made quiet.
+    __m128i isInfNan = _mm_cmpeq_epi32(exp, shiftedExp);
+    __m128i isNan = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(0x3ff)), _mm_setzero_si128()), isInfNan);
+    o = _mm_add_epi32(o, _mm_and_si128(isInfNan, _mm_set1_epi32((128 - 16) << 23)));
+    o = _mm_or_si128(o, _mm_and_si128(isNan, _mm_set1_epi32(0x00400000)));
+
+    // Zero/denormalized: renormalize using the floating-point unit.
+    __m128i isDenorm = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+    __m128 denormF = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(magic));
+    o = _mm_or_si128(_mm_and_si128(isDenorm, _mm_castps_si128(denormF)), _mm_andnot_si128(isDenorm, o));
+
+    return _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+}
+
+/// Packs the low 16 bits of the lanes of two vectors into one vector.
+__m128i pack16(__m128i lo, __m128i hi)
+{
+    // Sign extend so that the signed saturation of packs leaves the bits unchanged.
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+
+size_t float32ToFloat16SSE2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = float32ToFloat16SSE2(_mm_castps_si128(_mm_loadu_ps(pSrc + i)));
+        __m128i hi = float32ToFloat16SSE2(_mm_castps_si128(_mm_loadu_ps(pSrc + i + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), pack16(lo, hi));
+    }
+    return i;
+}
+
+size_t float16ToFloat32SSE2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm_storeu_ps(pDst + i, _mm_castsi128_ps(float16ToFloat32SSE2(_mm_unpacklo_epi16(h, zero))));
+        _mm_storeu_ps(pDst + i + 4, _mm_castsi128_ps(float16ToFloat32SSE2(_mm_unpackhi_epi16(h, zero))));
+    }
+    return i;
+}
+
+FLOAT16_TARGET_F16C size_t float32ToFloat16F16C(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(pSrc + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), h);
+    }
+    return i;
+}
+
+FLOAT16_TARGET_F16C size_t float16ToFloat32F16C(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm256_storeu_ps(pDst + i, _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+
+#endif // FLOAT16_USE_SIMD
+} // namespace
+
+Float16Conversion getFloat16Conversion()
+{
+#if FLOAT16_USE_SIMD
+    static const Float16Conversion conversion = isF16CSupported() ? Float16Conversion::F16C : Float16Conversion::SSE2;
+    return conversion;
+#else
+    return Float16Conversion::Scalar;
+#endif
+}
+
+void float32ToFloat16(fstd::span<const float> src, fstd::span<uint16_t> dst, Float16Conversion conversion)
+{
+    FALCOR_CHECK(src.size() == dst.size(), "Source and destination must have the same size.");
+    FALCOR_CHECK(conversion <= getFloat16Conversion(), "Float16 conversion is not supported by the CPU.");
+
+    // The SIMD paths convert multiples of 8 values, the remaining values are converted by the scalar code.
+    size_t converted = 0;
+#if FLOAT16_USE_SIMD
+    if (conversion == Float16Conversion::F16C)
+        converted = float32ToFloat16F16C(src.data(), dst.data(), src.size());
+    else if (conversion == Float16Conversion::SSE2)
+        converted = float32ToFloat16SSE2(src.data(), dst.data(), src.size());
+#endif
+    float32ToFloat16Scalar(src.data() + converted, dst.data() + converted, src.size() - converted);
+}
+
+void float16ToFloat32(fstd::span<const uint16_t> src, fstd::span<float> dst, Float16Conversion conversion)
+{
+    FALCOR_CHECK(src.size() == dst.size(), "Source and destination must have the same size.");
+    FALCOR_CHECK(conversion <= getFloat16Conversion(), "Float16 conversion is not supported by the CPU.");
+
+    size_t converted = 0;
+#if FLOAT16_USE_SIMD
+    if (conversion == Float16Conversion::F16C)
+        converted = float16ToFloat32F16C(src.data(), dst.data(), src.size());
+    else if (conversion == Float16Conversion::SSE2)
+        converted = float16ToFloat32SSE2(src.data(), dst.data(), src.size());
+#endif
+    float16ToFloat32Scalar(src.data() + converted, dst.data() + converted, src.size() - converted);
+}
+
 } // namespace math
 } // namespace Falcor
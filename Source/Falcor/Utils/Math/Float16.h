@@ -29,6 +29,8 @@
 
 #include "Core/Macros.h"
 
+#include <fstd/span.h> // TODO C++20: Replace with <span>
+
 #include <cstdint>
 #include <limits>
 
@@ -37,9 +39,48 @@ namespace Falcor
 namespace math
 {
 
+/// Convert a float32 value to float16 using round-to-nearest-even.
 FALCOR_API uint16_t float32ToFloat16(float value);
+/// Convert a float16 value to float32.
 FALCOR_API float float16ToFloat32(uint16_t value);
 
+/// Implementations of the bulk conversion functions, ordered from slowest to fastest.
+enum class Float16Conversion
+{
+    Scalar, ///< Portable scalar code.
+    SSE2,   ///< SSE2 integer code converting 8 values at a time.
+    F16C,   ///< F16C conversion instructions (requires AVX) converting 8 values at a time.
+};
+
+/// Returns the fastest bulk conversion implementation supported by the CPU. Detected once at runtime.
+FALCOR_API Float16Conversion getFloat16Conversion();
+
+/**
+ * Convert an array of float32 values to float16 using round-to-nearest-even.
+ * The results are bit-identical to float32ToFloat16() for all inputs, regardless of the implementation.
+ * @param[in] src Source values.
+ * @param[out] dst Destination values. Must have the same size as src.
+ * @param[in] conversion Implementation to use. Must be supported by the CPU.
+ */
+FALCOR_API void float32ToFloat16(
+    fstd::span<const float> src,
+    fstd::span<uint16_t> dst,
+    Float16Conversion conversion = getFloat16Conversion()
+);
+
+/**
+ * Convert an array of float16 values to float32.
+ * The results are bit-identical to float16ToFloat32() for all inputs, regardless of the implementation.
+ * @param[in] src Source values.
+ * @param[out] dst Destination values. Must have the same size as src.
+ * @param[in] conversion Implementation to use. Must be supported by the CPU.
+ */
+FALCOR_API void float16ToFloat32(
+    fstd::span<const uint16_t> src,
+    fstd::span<float> dst,
+    Float16Conversion conversion = getFloat16Conversion()
+);
+
 struct float16_t
 {
     float16_t() = default;
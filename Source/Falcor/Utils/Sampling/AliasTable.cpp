@@ -53,8 +53,8 @@ AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt1
 
     std::uniform_int_distribution<uint32_t> rngDist;
 
-    mpWeights =
-        pDevice->createStructuredBuffer(sizeof(float), mCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, weights.data());
+    // Keep a copy of the original weights. The weights vector is modified during construction.
+    mWeights = weights;
 
     // Our working set / intermediate buffers (underweight & overweight); initialize to "invalid"
     std::vector<uint32_t> lowIdx(mCount, 0xFFFFFFFFu);
@@ -80,7 +80,8 @@ AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt1
     }
 
     // Create alias table entries by merging above- and below-average samples
-    std::vector<AliasTable::Item> items(mCount);
+    std::vector<AliasTable::Item>& items = mItems;
+    items.resize(mCount);
     for (uint32_t i = 0; i < mCount; ++i)
     {
         // Usual case:  We have an above-average and below-average sample we can combine into one alias table entry
@@ -133,13 +134,24 @@ AliasTable::AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt1
     // correct location in the alias table.
 
     // Stash the alias table in our GPU buffer
-    mpItems = pDevice->createStructuredBuffer(
-        sizeof(AliasTable::Item), mCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, items.data()
-    );
+    if (pDevice)
+    {
+        mpItems = pDevice->createStructuredBuffer(
+            sizeof(AliasTable::Item), mCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, items.data()
+        );
+        mpWeights = pDevice->createStructuredBuffer(
+            sizeof(float), mCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, mWeights.data()
+        );
+
+        // The CPU copies are only needed for tables without a device. Free them, as tables can be large (e.g., env maps).
+        mItems = {};
+        mWeights = {};
+    }
 }
 
 void AliasTable::bindShaderData(const ShaderVar& var) const
 {
+    FALCOR_CHECK(mpItems && mpWeights, "Alias table was created without a device and can't be bound to shaders.");
     var["items"] = mpItems;
     var["weights"] = mpWeights;
     var["count"] = mCount;
@@ -27,10 +27,14 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include "Core/Error.h"
 #include "Core/API/Buffer.h"
 #include "Core/Program/ShaderVar.h"
+#include "Utils/Math/Vector.h"
+#include <algorithm>
 #include <memory>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -43,7 +47,8 @@ public:
     /**
      * Create an alias table.
      * The weights don't need to be normalized to sum up to 1.
-     * @param[in] pDevice GPU device.
+     * @param[in] pDevice GPU device. If nullptr, the table is only created on the CPU and can't be bound to shaders.
+     * Otherwise the table is uploaded to the GPU and no CPU copy is kept, so the CPU sampling functions are not available.
      * @param[in] weights The weights we'd like to sample each entry proportional to.
      * @param[in] rng The random number generator to use when creating the table.
      */
@@ -55,6 +60,47 @@ public:
      */
     void bindShaderData(const ShaderVar& var) const;
 
+    /**
+     * Sample from the table proportional to the weights.
+     * This matches AliasTable::sample() in AliasTable.slang bit for bit. Only available if hasCpuData() is true.
+     * @param[in] index Uniform random index in [0..count).
+     * @param[in] rnd Uniform random number in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(uint32_t index, float rnd) const
+    {
+        FALCOR_ASSERT(index < mItems.size());
+        const Item& item = mItems[index];
+        return rnd >= item.threshold ? item.indexA : item.indexB;
+    }
+
+    /**
+     * Sample from the table proportional to the weights. Only available if hasCpuData() is true.
+     * @param[in] rnd Two uniform random number in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(float2 rnd) const
+    {
+        uint32_t index = std::min(mCount - 1, (uint32_t)(rnd.x * mCount));
+        return sample(index, rnd.y);
+    }
+
+    /**
+     * Get the original weight at a given index. Only available if hasCpuData() is true.
+     * @param[in] index Table index.
+     * @return Returns the original weight.
+     */
+    float getWeight(uint32_t index) const
+    {
+        FALCOR_ASSERT(index < mWeights.size());
+        return mWeights[index];
+    }
+
+    /**
+     * Check if the table is kept on the CPU. This is the case for tables created without a device.
+     */
+    bool hasCpuData() const { return !mItems.empty(); }
+
     /**
      * Get the number of weights in the table.
      */
@@ -75,9 +121,11 @@ private:
         uint32_t _pad;
     };
 
-    uint32_t mCount;       ///< Number of items in the alias table.
-    double mWeightSum;     ///< Total weight of all elements used to create the alias table.
-    ref<Buffer> mpItems;   ///< Buffer containing table items.
-    ref<Buffer> mpWeights; ///< Buffer containing item weights.
+    uint32_t mCount;            ///< Number of items in the alias table.
+    double mWeightSum;          ///< Total weight of all elements used to create the alias table.
+    std::vector<Item> mItems;   ///< Table items (CPU copy, only kept without a device).
+    std::vector<float> mWeights; ///< Original item weights (CPU copy, only kept without a device).
+    ref<Buffer> mpItems;        ///< Buffer containing table items.
+    ref<Buffer> mpWeights;      ///< Buffer containing item weights.
 };
 } // namespace Falcor
@@ -0,0 +1,287 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ScratchArena.h"
+#include "Core/Error.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace Falcor
+{
+namespace
+{
+// Blocks are aligned to cache lines so that arenas of different threads never share a cache line.
+const size_t kBlockAlignment = 64;
+
+std::atomic<bool> sEnabled{true};
+
+struct GlobalStats
+{
+    std::atomic<uint64_t> allocationCount{0};
+    std::atomic<uint64_t> heapAllocationCount{0};
+    std::atomic<uint64_t> bytesAllocated{0};
+    std::atomic<uint64_t> scopeCount{0};
+};
+
+GlobalStats& getGlobalStatsStorage()
+{
+    static GlobalStats stats;
+    return stats;
+}
+} // namespace
+
+ScratchArena::Stats& ScratchArena::Stats::operator+=(const Stats& other)
+{
+    allocationCount += other.allocationCount;
+    heapAllocationCount += other.heapAllocationCount;
+    bytesAllocated += other.bytesAllocated;
+    scopeCount += other.scopeCount;
+    return *this;
+}
+
+ScratchArena::Stats& ScratchArena::Stats::operator-=(const Stats& other)
+{
+    allocationCount -= other.allocationCount;
+    heapAllocationCount -= other.heapAllocationCount;
+    bytesAllocated -= other.bytesAllocated;
+    scopeCount -= other.scopeCount;
+    return *this;
+}
+
+ScratchArena::Scope::Scope(ScratchArena& arena) : mArena(arena)
+{
+    mArena.beginScope(mBlockIndex, mOffset);
+}
+
+ScratchArena::Scope::~Scope()
+{
+    mArena.endScope(mBlockIndex, mOffset);
+}
+
+ScratchArena::ScratchArena(size_t blockSize, bool useHeap) : mBlockSize(std::max(blockSize, kBlockAlignment)), mForceHeap(useHeap)
+{
+    mUseHeap = mForceHeap || !isEnabled();
+}
+
+ScratchArena::~ScratchArena()
+{
+    releaseBlocks();
+}
+
+void* ScratchArena::allocate(size_t byteSize, size_t alignment)
+{
+    FALCOR_ASSERT(mScopeDepth > 0, "Scratch allocations must be made inside a scope.");
+    FALCOR_ASSERT(isPowerOf2(alignment));
+
+    mStats.allocationCount++;
+    mStats.bytesAllocated += byteSize;
+    mPendingStats.allocationCount++;
+    mPendingStats.bytesAllocated += byteSize;
+
+    if (mUseHeap)
+    {
+        mStats.heapAllocationCount++;
+        mPendingStats.heapAllocationCount++;
+        return ::operator new(byteSize, std::align_val_t(alignment));
+    }
+
+    // Find the first block from the current one that has room for the allocation.
+    // If there is none, allocate a new block. Block sizes grow geometrically to bound the number of blocks.
+    while (true)
+    {
+        if (mBlockIndex == mBlocks.size()) allocateBlock(byteSize + alignment);
+
+        const Block& block = mBlocks[mBlockIndex];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.pData);
+        const size_t offset = align_to<uintptr_t>(alignment, base + mOffset) - base;
+        if (offset + byteSize <= block.size)
+        {
+            mOffset = offset + byteSize;
+            return block.pData + offset;
+        }
+        mBlockIndex++;
+        mOffset = 0;
+    }
+}
+
+void ScratchArena::deallocate(void* ptr, size_t byteSize, size_t alignment)
+{
+    if (ptr == nullptr) return;
+
+    if (mUseHeap)
+    {
+        ::operator delete(ptr, std::align_val_t(alignment));
+        return;
+    }
+
+    // Reclaim the memory if this was the most recent allocation.
+    if (mBlockIndex < mBlocks.size())
+    {
+        const Block& block = mBlocks[mBlockIndex];
+        uint8_t* pData = static_cast<uint8_t*>(ptr);
+        if (pData >= block.pData && pData + byteSize == block.pData + mOffset)
+        {
+            mOffset = pData - block.pData;
+        }
+    }
+}
+
+size_t ScratchArena::getCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto& block : mBlocks)
+        capacity += block.size;
+    return capacity;
+}
+
+size_t ScratchArena::getUsedBytes() const
+{
+    size_t used = mOffset;
+    for (size_t i = 0; i < mBlockIndex && i < mBlocks.size(); ++i)
+        used += mBlocks[i].size;
+    return used;
+}
+
+ScratchArena& ScratchArena::getThreadLocal()
+{
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+ScratchArena::Stats ScratchArena::getGlobalStats()
+{
+    const GlobalStats& global = getGlobalStatsStorage();
+    Stats stats;
+    stats.allocationCount = global.allocationCount.load(std::memory_order_relaxed);
+    stats.heapAllocationCount = global.heapAllocationCount.load(std::memory_order_relaxed);
+    stats.bytesAllocated = global.bytesAllocated.load(std::memory_order_relaxed);
+    stats.scopeCount = global.scopeCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ScratchArena::resetGlobalStats()
+{
+    GlobalStats& global = getGlobalStatsStorage();
+    global.allocationCount = 0;
+    global.heapAllocationCount = 0;
+    global.bytesAllocated = 0;
+    global.scopeCount = 0;
+}
+
+void ScratchArena::setEnabled(bool enabled)
+{
+    sEnabled = enabled;
+}
+
+bool ScratchArena::isEnabled()
+{
+    return sEnabled;
+}
+
+void ScratchArena::beginScope(size_t& blockIndex, size_t& offset)
+{
+    if (mScopeDepth == 0)
+    {
+        FALCOR_ASSERT(mBlockIndex == 0 && mOffset == 0);
+        mUseHeap = mForceHeap || !isEnabled();
+    }
+    mScopeDepth++;
+
+    blockIndex = mBlockIndex;
+    offset = mOffset;
+}
+
+void ScratchArena::endScope(size_t blockIndex, size_t offset)
+{
+    FALCOR_ASSERT(mScopeDepth > 0);
+    mScopeDepth--;
+
+    mBlockIndex = blockIndex;
+    mOffset = offset;
+
+    if (mScopeDepth == 0)
+    {
+        FALCOR_ASSERT(mBlockIndex == 0 && mOffset == 0);
+        if (getCapacity() > mMaxRetainedCapacity)
+            releaseBlocks();
+        else
+            coalesceBlocks();
+
+        // Publish the statistics once per outermost scope to avoid contention between threads.
+        mStats.scopeCount++;
+        mPendingStats.scopeCount++;
+        GlobalStats& global = getGlobalStatsStorage();
+        global.allocationCount.fetch_add(mPendingStats.allocationCount, std::memory_order_relaxed);
+        global.heapAllocationCount.fetch_add(mPendingStats.heapAllocationCount, std::memory_order_relaxed);
+        global.bytesAllocated.fetch_add(mPendingStats.bytesAllocated, std::memory_order_relaxed);
+        global.scopeCount.fetch_add(mPendingStats.scopeCount, std::memory_order_relaxed);
+        mPendingStats = {};
+    }
+}
+
+void ScratchArena::trim(size_t maxCapacity)
+{
+    FALCOR_CHECK(mScopeDepth == 0, "Can't trim a scratch arena while a scope is open.");
+    if (getCapacity() > maxCapacity) releaseBlocks();
+}
+
+void ScratchArena::coalesceBlocks()
+{
+    // Replace multiple blocks by a single block that fits the peak usage, so the next scope doesn't need to grow.
+    if (mBlocks.size() <= 1) return;
+
+    size_t capacity = getCapacity();
+    releaseBlocks();
+    allocateBlock(capacity);
+}
+
+void ScratchArena::allocateBlock(size_t minSize)
+{
+    size_t size = std::max(mBlocks.empty() ? mBlockSize : mBlocks.back().size * 2, minSize);
+    size = align_to(kBlockAlignment, size);
+
+    Block block;
+    block.pData = static_cast<uint8_t*>(::operator new(size, std::align_val_t(kBlockAlignment)));
+    block.size = size;
+    mBlocks.push_back(block);
+
+    mStats.heapAllocationCount++;
+    mPendingStats.heapAllocationCount++;
+}
+
+void ScratchArena::releaseBlocks()
+{
+    for (auto& block : mBlocks)
+        ::operator delete(block.pData, std::align_val_t(kBlockAlignment));
+    mBlocks.clear();
+    mBlockIndex = 0;
+    mOffset = 0;
+}
+
+} // namespace Falcor
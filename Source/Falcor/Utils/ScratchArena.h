@@ -0,0 +1,234 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Monotonic arena for short-lived temporary allocations on the CPU.
+ *
+ * Memory is handed out linearly from a list of blocks and is released all at once
+ * when the outermost Scope is closed. When a scope ends and more than one block was
+ * needed, the blocks are coalesced into a single block large enough for the peak
+ * usage. After warm-up, a workload of similarly sized tasks therefore runs without
+ * touching the system allocator. To avoid pinning the memory of a rare large task,
+ * blocks exceeding the maximum retained capacity are released instead of coalesced,
+ * and trim() can be called to give back the memory once a workload is done.
+ *
+ * Each thread has its own arena (see getThreadLocal()), so no synchronization is needed.
+ * Typical usage is to open a Scope per task and allocate containers through ScratchVector:
+ *
+ *     ScratchArena::Scope scratch;
+ *     ScratchVector<uint32_t> indices(count, scratch.getArena());
+ *
+ * Allocations must be made inside a scope. Containers allocated from the arena must be
+ * destroyed before their scope is closed, and must not grow inside a nested scope.
+ *
+ * The arena can be disabled globally with setEnabled(false), or per arena when it is
+ * created. Allocations are then forwarded to the system allocator, which is useful
+ * for comparing performance.
+ */
+class FALCOR_API ScratchArena
+{
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+    static constexpr size_t kDefaultMaxRetainedCapacity = 16 * 1024 * 1024;
+
+    /// Allocation statistics.
+    struct Stats
+    {
+        uint64_t allocationCount = 0;     ///< Number of allocations served by the arena.
+        uint64_t heapAllocationCount = 0; ///< Number of allocations that went to the system allocator (new blocks or disabled arena).
+        uint64_t bytesAllocated = 0;      ///< Total number of bytes requested.
+        uint64_t scopeCount = 0;          ///< Number of outermost scopes that have been closed.
+
+        Stats& operator+=(const Stats& other);
+        Stats& operator-=(const Stats& other);
+    };
+
+    /**
+     * Marks the start of a group of temporary allocations.
+     * All allocations made while the scope is open are released when it is destroyed.
+     * Scopes can be nested.
+     */
+    class FALCOR_API Scope
+    {
+    public:
+        Scope(ScratchArena& arena = getThreadLocal());
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ScratchArena& getArena() const { return mArena; }
+
+    private:
+        ScratchArena& mArena;
+        size_t mBlockIndex;
+        size_t mOffset;
+    };
+
+    /**
+     * Create an arena.
+     * @param[in] blockSize Size in bytes of the first block. Memory is only allocated on first use.
+     * @param[in] useHeap If true, all allocations are forwarded to the system allocator regardless of setEnabled().
+     */
+    explicit ScratchArena(size_t blockSize = kDefaultBlockSize, bool useHeap = false);
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * Allocate memory from the arena.
+     * @param[in] byteSize Size in bytes.
+     * @param[in] alignment Alignment in bytes. Must be a power of two.
+     * @return Pointer to the allocated memory.
+     */
+    void* allocate(size_t byteSize, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Release memory allocated with allocate().
+     * Only the most recent allocation is actually reclaimed, other calls are no-ops until the scope ends.
+     */
+    void deallocate(void* ptr, size_t byteSize, size_t alignment = alignof(std::max_align_t));
+
+    /// Returns the total size in bytes of the memory blocks owned by the arena.
+    size_t getCapacity() const;
+
+    /// Returns the number of bytes currently in use, including alignment padding.
+    size_t getUsedBytes() const;
+
+    /// Returns the statistics accumulated by this arena.
+    const Stats& getStats() const { return mStats; }
+
+    /**
+     * Set the maximum capacity kept after the outermost scope is closed.
+     * If more memory was needed, the blocks are released instead of coalesced.
+     */
+    void setMaxRetainedCapacity(size_t maxCapacity) { mMaxRetainedCapacity = maxCapacity; }
+
+    /// Returns the maximum capacity kept after the outermost scope is closed.
+    size_t getMaxRetainedCapacity() const { return mMaxRetainedCapacity; }
+
+    /**
+     * Release the memory blocks if their total size exceeds the given capacity.
+     * Must not be called while a scope is open.
+     * @param[in] maxCapacity Capacity in bytes that may be kept.
+     */
+    void trim(size_t maxCapacity = 0);
+
+    /// Returns the arena of the calling thread.
+    static ScratchArena& getThreadLocal();
+
+    /// Returns the statistics of all arenas, accumulated when their outermost scopes are closed.
+    static Stats getGlobalStats();
+
+    /// Resets the global statistics.
+    static void resetGlobalStats();
+
+    /**
+     * Enable or disable the use of arenas globally.
+     * The setting takes effect the next time an outermost scope is opened.
+     */
+    static void setEnabled(bool enabled);
+
+    /// Returns true if arenas are enabled.
+    static bool isEnabled();
+
+private:
+    struct Block
+    {
+        uint8_t* pData = nullptr;
+        size_t size = 0;
+    };
+
+    void beginScope(size_t& blockIndex, size_t& offset);
+    void endScope(size_t blockIndex, size_t offset);
+    void coalesceBlocks();
+    void allocateBlock(size_t minSize);
+    void releaseBlocks();
+
+    size_t mBlockSize;
+    std::vector<Block> mBlocks;
+    size_t mBlockIndex = 0; ///< Index of the block allocations are currently served from.
+    size_t mOffset = 0;     ///< Offset in bytes of the first free byte in the current block.
+    size_t mMaxRetainedCapacity = kDefaultMaxRetainedCapacity;
+    uint32_t mScopeDepth = 0;
+    bool mForceHeap = false; ///< True if the arena was created to always use the system allocator.
+    bool mUseHeap = false;  ///< True if allocations are forwarded to the system allocator (latched when the outermost scope opens).
+
+    Stats mStats;
+    Stats mPendingStats;    ///< Statistics not yet added to the global statistics.
+};
+
+/**
+ * Standard library allocator drawing memory from a ScratchArena.
+ */
+template<typename T>
+class ScratchAllocator
+{
+public:
+    using value_type = T;
+
+    ScratchAllocator(ScratchArena& arena) noexcept : mpArena(&arena) {}
+
+    template<typename U>
+    ScratchAllocator(const ScratchAllocator<U>& other) noexcept : mpArena(other.getArena())
+    {}
+
+    T* allocate(size_t count) { return static_cast<T*>(mpArena->allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T* ptr, size_t count) noexcept { mpArena->deallocate(ptr, count * sizeof(T), alignof(T)); }
+
+    ScratchArena* getArena() const noexcept { return mpArena; }
+
+    template<typename U>
+    bool operator==(const ScratchAllocator<U>& other) const noexcept
+    {
+        return mpArena == other.getArena();
+    }
+
+    template<typename U>
+    bool operator!=(const ScratchAllocator<U>& other) const noexcept
+    {
+        return mpArena != other.getArena();
+    }
+
+private:
+    ScratchArena* mpArena;
+};
+
+/// Vector allocated from a ScratchArena.
+template<typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+} // namespace Falcor
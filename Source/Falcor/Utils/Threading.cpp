@@ -42,6 +42,7 @@ struct ThreadingData
 
 static std::mutex sThreadingInitMutex;
 static uint32_t sThreadingInitCount = 0;
+static std::vector<std::function<void()>> sShutdownCallbacks;
 
 void Threading::start(uint32_t threadCount)
 {
@@ -59,6 +60,8 @@ void Threading::shutdown()
     uint32_t count = sThreadingInitCount--;
     if (count == 1)
     {
+        for (auto& func : sShutdownCallbacks)
+            func();
         for (auto& t : gData.threads)
             if (t.joinable())
                 t.join();
@@ -68,6 +71,12 @@ void Threading::shutdown()
         FALCOR_THROW("Threading::stop() called more times than Threading::start().");
 }
 
+void Threading::registerShutdownCallback(std::function<void()> func)
+{
+    std::lock_guard<std::mutex> lock(sThreadingInitMutex);
+    sShutdownCallbacks.push_back(std::move(func));
+}
+
 Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
 {
     FALCOR_ASSERT(gData.initialized);
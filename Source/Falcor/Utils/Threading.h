@@ -75,6 +75,13 @@ public:
      */
     static void shutdown();
 
+    /**
+     * Registers a function that is called when the thread pool is shut down, before its threads are joined.
+     * This is used to flush work that runs in the background, such as writing scene cache files, before the application exits.
+     * @param[in] func Function to call.
+     */
+    static void registerShutdownCallback(std::function<void()> func);
+
     /**
      * Returns the maximum number of concurrent threads supported by the hardware
      */
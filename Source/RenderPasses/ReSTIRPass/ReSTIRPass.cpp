@@ -302,6 +302,18 @@ bool ReSTIRPass::renderRenderingUI(Gui::Widgets& widget)
 
         dirty |= group.dropdown("Light tile screen size", kLightTileScreenSize, reinterpret_cast<uint32_t&>(mReSTIRParams.lightTileScreenSize));
         group.tooltip("The size of screen tile in pixels which form a group accessing the same light tile.");
+
+        dirty |= group.dropdown("Light tile update mode", mReSTIRParams.lightTileUpdateMode);
+        group.tooltip("EveryFrame regenerates all light tiles each frame.\nIncremental keeps the light tiles across frames, refreshes a few tiles per frame and rebuilds all tiles when the lighting changes.");
+
+        if (mReSTIRParams.lightTileUpdateMode == LightTileUpdateMode::Incremental)
+        {
+            dirty |= group.var("Refreshed tiles per frame", mReSTIRParams.lightTileRefreshCount, 0u, kMaxLightTileCount);
+            group.tooltip("The number of light tiles regenerated each frame. If zero, light tiles are only rebuilt when the lighting changes.");
+        }
+
+        dirty |= group.dropdown("Light tile sampling", mReSTIRParams.lightTileSampling);
+        group.tooltip("Independent draws each light tile sample with independent random numbers.\nStratified distributes the alias table lookups of each light type evenly over the tile.");
     }
 
     if (auto group = widget.group("Initial resampling", false))
@@ -413,10 +425,25 @@ void ReSTIRPass::createLightTiles(RenderContext* pRenderContext)
 {
     FALCOR_PROFILE(pRenderContext, "createLightTilesPass");
 
+    // Select the range of light tiles to regenerate. Invalid tiles are always rebuilt completely.
+    uint32_t tileOffset = 0;
+    uint32_t tileUpdateCount = mReSTIRParams.lightTileCount;
+    if (mReSTIRParams.lightTileUpdateMode == LightTileUpdateMode::Incremental && mLightTilesValid)
+    {
+        tileOffset = mLightTileRefreshOffset;
+        tileUpdateCount = std::min(mReSTIRParams.lightTileRefreshCount, mReSTIRParams.lightTileCount);
+    }
+    if (tileUpdateCount == 0) return;
+
+    mLightTileRefreshOffset = (tileOffset + tileUpdateCount) % mReSTIRParams.lightTileCount;
+    mLightTilesValid = true;
+
     auto var = mpCreateLightTiles->getRootVar()["CB"]["gCreateLightTilesPass"];
 
     var["gLightTiles"] = mpLightTiles;
     var["gFrameCount"] = mFrameCount;
+    var["gTileOffset"] = tileOffset;
+    var["gTileUpdateCount"] = tileUpdateCount;
 
     if (mpEmissiveGeometryAliasTable) mpEmissiveGeometryAliasTable->bindShaderData(var["gLightSampler"]["emissiveGeometryAliasTable"]);
     if (mpAnalyticLightsAliasTable) mpAnalyticLightsAliasTable->bindShaderData(var["gLightSampler"]["analyticLightsAliasTable"]);
@@ -428,7 +455,7 @@ void ReSTIRPass::createLightTiles(RenderContext* pRenderContext)
 
     mpScene->bindShaderData(mpCreateLightTiles->getRootVar()["gScene"]);
 
-    mpCreateLightTiles->execute(pRenderContext, uint3(mReSTIRParams.lightTileSize, mReSTIRParams.lightTileCount, 1));
+    mpCreateLightTiles->execute(pRenderContext, uint3(mReSTIRParams.lightTileSize, tileUpdateCount, 1));
 }
 
 void ReSTIRPass::loadSurfaceDataPass(RenderContext* pRenderContext, const RenderData& renderData)
@@ -546,6 +573,7 @@ void ReSTIRPass::spatialReusePass(RenderContext* pRenderContext, const RenderDat
 
         var["gFrameDim"] = mFrameDim;
         var["gFrameCount"] = mFrameCount;
+        var["gIteration"] = uint32_t(iteration);
 
         var["gSurfaceData"] = mpSurfaceData;
         var["gNormalDepth"] = mpNormalDepth;
@@ -775,6 +803,9 @@ void ReSTIRPass::updatePrograms()
     mpCreateDirectLightSamplesPass->setVars(nullptr);
     mpShadePass->setVars(nullptr);
 
+    // The light tile layout depends on the defines, so cached light tiles have to be rebuilt.
+    mLightTilesValid = false;
+
     mVarsChanged = true;
     mRecompile = false;
 }
@@ -818,6 +849,7 @@ void ReSTIRPass::prepareResources(RenderContext* pRenderContext, const RenderDat
     if (!mpLightTiles || mpLightTiles->getElementCount() < elementCount)
     {
         mpLightTiles = mpDevice->createStructuredBuffer(sizeof(uint4) * 2, elementCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr, false);
+        mLightTilesValid = false;
     }
 
     if (!mpDirectLightSamples || mpDirectLightSamples->getElementCount() < pixelCount)
@@ -856,6 +888,15 @@ bool ReSTIRPass::prepareLighting(RenderContext* pRenderContext)
         mRecompile = true;
     }
 
+    // Light tiles store light positions, emission and PDFs. Cached light tiles are stale if any of these change.
+    const auto kLightTileUpdateFlags = Scene::UpdateFlags::LightsMoved | Scene::UpdateFlags::LightIntensityChanged | Scene::UpdateFlags::LightPropertiesChanged |
+        Scene::UpdateFlags::LightCollectionChanged | Scene::UpdateFlags::LightCountChanged | Scene::UpdateFlags::EnvMapPropertiesChanged |
+        Scene::UpdateFlags::EmissiveMaterialsChanged;
+    if (is_set(mpScene->getUpdates(), kLightTileUpdateFlags))
+    {
+        mLightTilesValid = false;
+    }
+
     if (is_set(mpScene->getUpdates(), Scene::UpdateFlags::EnvMapChanged))
     {
         mpEnvironmentAliasTable = nullptr;
@@ -1074,6 +1115,7 @@ void ReSTIRPass::resetLighting()
     mpEmissiveGeometryAliasTable = nullptr;
     mpEmissiveSampler = nullptr;
     mpEnvMapSampler = nullptr;
+    mLightTilesValid = false;
     mRecompile = true;
     mClearReservoirs = true;  // Clear reservoir history when lighting setup changes
 }
@@ -1128,6 +1170,7 @@ bool ReSTIRPass::beginFrame(RenderContext* pRenderContext, const RenderData& ren
 
     // Update the env map and emissive sampler to the current frame.
     bool lightingChanged = prepareLighting(pRenderContext);
+    if (lightingChanged) mLightTilesValid = false;
 
     // Update refresh flag if changes that affect the output have occured.
     auto& dict = renderData.getDictionary();
@@ -1229,6 +1272,7 @@ DefineList ReSTIRPass::StaticParams::getDefines(const ReSTIRPass& owner) const
     defines.add("LIGHT_TILE_SIZE", std::to_string(owner.mReSTIRParams.lightTileSize));
     defines.add("LIGHT_TILE_COUNT", std::to_string(owner.mReSTIRParams.lightTileCount));
     defines.add("LIGHT_TILE_SCREEN_SIZE", std::to_string(owner.mReSTIRParams.lightTileScreenSize));
+    defines.add("LIGHT_TILE_SAMPLING", std::to_string(uint32_t(owner.mReSTIRParams.lightTileSampling)));
 
     uint32_t totalCandidateCount = owner.mReSTIRParams.emissiveLightCandidateCount + owner.mReSTIRParams.envLightCandidateCount + owner.mReSTIRParams.analyticLightCandidateCount;
     float portionOfEmissiveCandidates = float(owner.mReSTIRParams.emissiveLightCandidateCount) / float(totalCandidateCount);
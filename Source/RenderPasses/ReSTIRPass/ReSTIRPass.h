@@ -32,6 +32,8 @@
 #include "Rendering/Lights/EnvMapSampler.h"
 #include "Utils/Sampling/AliasTable.h"
 #include "RenderGraph/RenderPassHelpers.h"
+#include "Core/ReservoirData.slang"
+#include "DirectIllumination/LightTileData.slang"
 
 using namespace Falcor;
 
@@ -72,13 +74,7 @@ public:
         ReSTIRGI,
     };
 
-    enum class BiasCorrection
-    {
-        Off,
-        Naive,
-        MIS,
-        RayTraced,
-    };
+    using BiasCorrection = ReSTIRBiasCorrection;
 
 private:
 
@@ -153,6 +149,9 @@ private:
         uint32_t    lightTileScreenSize = 8;                    ///< Screen size of the light tiles in pixels.
         uint32_t    lightTileSize = 1024;                       ///< Total number of light samples in each light tile.
         uint32_t    lightTileCount = 128;                       ///< Total number of light tiles.
+        LightTileUpdateMode lightTileUpdateMode = LightTileUpdateMode::EveryFrame; ///< When the light tiles are regenerated.
+        uint32_t    lightTileRefreshCount = 16;                 ///< Number of light tiles refreshed per frame in incremental mode. If zero, tiles are only rebuilt on lighting changes.
+        LightTileSampling lightTileSampling = LightTileSampling::Independent; ///< How the light tile samples are drawn from the alias tables.
 
         bool        testInitialSampleVisibility = true;         ///< If true, initial samples' visibility is tested.
         uint32_t    emissiveLightCandidateCount = 24;    ///< Number of candidate samples for emissive lights.
@@ -218,6 +217,8 @@ private:
     bool                            mRecompile = false;         ///< Set to true when program specialization has changed.
     bool                            mVarsChanged = true;        ///< This is set to true whenever the program vars have changed and resources need to be rebound.
     bool                            mClearReservoirs = false;   ///< Set to true when reservoir history should be cleared due to lighting changes.
+    bool                            mLightTilesValid = false;   ///< True if the light tiles hold samples of the current lighting and configuration.
+    uint32_t                        mLightTileRefreshOffset = 0; ///< Index of the next light tile to refresh in incremental mode.
 
     // Textures and buffer
     ref<Buffer> mpReservoirs;                     ///< Pointer to the buffer for reservoirs.
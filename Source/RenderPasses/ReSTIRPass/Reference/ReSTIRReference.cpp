@@ -0,0 +1,997 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ReSTIRReference.h"
+#include "Core/Error.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/FormatConversion.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Color/ColorHelpers.slang"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+namespace Falcor
+{
+namespace
+{
+const float kMinCosTheta = 1e-6f; // Same as IBSDF.slang.
+
+/// Same as blockCipherTEA() in HashUtils.slang, returns the first component.
+uint32_t blockCipherTEA(uint32_t v0, uint32_t v1)
+{
+    uint32_t sum = 0;
+    const uint32_t delta = 0x9e3779b9;
+    const uint32_t k[4] = {0xa341316c, 0xc8013ea4, 0xad90777d, 0x7e95761e};
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        sum += delta;
+        v0 += ((v1 << 4) + k[0]) ^ (v1 + sum) ^ ((v1 >> 5) + k[1]);
+        v1 += ((v0 << 4) + k[2]) ^ (v0 + sum) ^ ((v0 >> 5) + k[3]);
+    }
+    return v0;
+}
+
+// Random number streams of the reuse passes, see Utilities.slang.
+const uint32_t kTemporalReuseStream = 1;
+const uint32_t kSpatialReuseStream = 2; // Two streams per spatial iteration, the second one for the neighbor positions.
+
+uint32_t getReuseSampleNumber(uint32_t frameCount, uint32_t stream)
+{
+    return blockCipherTEA(frameCount, stream);
+}
+
+/**
+ * CPU version of TinyUniformSampleGenerator.
+ * Produces the same sequence as the shader for the same pixel and sample number.
+ */
+class TinyUniformSampleGenerator
+{
+public:
+    explicit TinyUniformSampleGenerator(uint32_t seed) : mState(seed) {}
+
+    TinyUniformSampleGenerator(uint2 pixel, uint32_t sampleNumber) : mState(blockCipherTEA(interleave32(pixel), sampleNumber)) {}
+
+    uint32_t next()
+    {
+        // LCG with the parameters from "Numerical Recipes", see LCG.slang.
+        mState = 1664525u * mState + 1013904223u;
+        return mState;
+    }
+
+    float next1D()
+    {
+        // Use upper 24 bits and divide by 2^24 to get a number u in [0,1), see SampleGeneratorInterface.slang.
+        return (next() >> 8) * 0x1p-24f;
+    }
+
+    float2 next2D()
+    {
+        float2 sample;
+        sample.x = next1D();
+        sample.y = next1D();
+        return sample;
+    }
+
+private:
+    static uint32_t interleave32(uint2 v)
+    {
+        auto spread = [](uint32_t x)
+        {
+            x &= 0x0000ffff;
+            x = (x | (x << 8)) & 0x00FF00FF;
+            x = (x | (x << 4)) & 0x0F0F0F0F;
+            x = (x | (x << 2)) & 0x33333333;
+            x = (x | (x << 1)) & 0x55555555;
+            return x;
+        };
+        return spread(v.x) | (spread(v.y) << 1);
+    }
+
+    uint32_t mState;
+};
+
+using Reservoir = ReSTIRReference::Reservoir;
+using LightSample = ReSTIRReference::LightSample;
+using MinimalLightSample = ReSTIRReference::MinimalLightSample;
+
+bool updateReservoir(
+    Reservoir& reservoir,
+    const MinimalLightSample& lightSample,
+    float targetPDF,
+    float sourcePDF,
+    TinyUniformSampleGenerator& sg
+)
+{
+    float weight = targetPDF / sourcePDF;
+    reservoir.weightSum += weight;
+    reservoir.M += 1u;
+    bool isSelected = sg.next1D() * reservoir.weightSum < weight;
+    if (isSelected)
+    {
+        reservoir.sample = lightSample;
+        reservoir.W = targetPDF;
+    }
+    return isSelected;
+}
+
+bool mergeReservoir(Reservoir& reservoir, const Reservoir& other, float targetPDF, TinyUniformSampleGenerator& sg)
+{
+    float weight = targetPDF * other.W * other.M;
+    reservoir.weightSum += weight;
+    reservoir.M += other.M;
+    bool isSelected = sg.next1D() * reservoir.weightSum < weight;
+    if (isSelected)
+    {
+        reservoir.sample = other.sample;
+        reservoir.W = targetPDF;
+    }
+    return isSelected;
+}
+
+float evalNdfGGX(float alpha, float cosTheta)
+{
+    float a2 = alpha * alpha;
+    float d = ((cosTheta * a2 - cosTheta) * cosTheta + 1);
+    return a2 / (d * d * float(M_PI));
+}
+
+float evalLambdaGGX(float alphaSqr, float cosTheta)
+{
+    if (cosTheta <= 0)
+        return 0;
+    float cosThetaSqr = cosTheta * cosTheta;
+    float tanThetaSqr = std::max(1 - cosThetaSqr, 0.f) / cosThetaSqr;
+    return 0.5f * (-1 + std::sqrt(1 + alphaSqr * tanThetaSqr));
+}
+
+float evalMaskingSmithGGXSeparable(float alpha, float cosThetaI, float cosThetaO)
+{
+    float alphaSqr = alpha * alpha;
+    float lambdaI = evalLambdaGGX(alphaSqr, cosThetaI);
+    float lambdaO = evalLambdaGGX(alphaSqr, cosThetaO);
+    return 1 / ((1 + lambdaI) * (1 + lambdaO));
+}
+
+float evalFresnelSchlick(float f0, float f90, float cosTheta)
+{
+    return f0 + (f90 - f0) * std::pow(std::max(1 - cosTheta, 0.f), 5.f);
+}
+
+bool isValidNeighbor(float3 norm, float3 neighborNorm, float depth, float neighborDepth, float normalThreshold, float depthThreshold)
+{
+    return (dot(norm, neighborNorm) >= normalThreshold) && std::abs(depth - neighborDepth) <= depthThreshold * std::max(depth, neighborDepth);
+}
+
+/// Mirrors getRandomNeighborPixel() in Utilities.slang. Returns false if the neighbor is outside the frame.
+bool getRandomNeighborPixel(uint2 pixel, uint2 frameDim, float radius, TinyUniformSampleGenerator& sg, uint2& neighborPixel)
+{
+    float rho = radius * std::sqrt(sg.next1D());
+    float theta = 2.0f * float(M_PI) * sg.next1D();
+    float x = std::round(pixel.x + rho * std::cos(theta));
+    float y = std::round(pixel.y + rho * std::sin(theta));
+    if (x < 0.f || y < 0.f || x >= frameDim.x || y >= frameDim.y)
+        return false;
+    neighborPixel = uint2(uint32_t(x), uint32_t(y));
+    return true;
+}
+
+uint32_t getBufferIndex(uint2 pixel, uint2 frameDim)
+{
+    return pixel.y * frameDim.x + pixel.x;
+}
+
+/// Run a per-pixel function over the frame, in parallel over rows.
+template<typename Func>
+void forEachPixel(uint2 frameDim, Func func)
+{
+    NumericRange<uint32_t> rows(0, frameDim.y);
+    std::for_each(
+        std::execution::par_unseq,
+        rows.begin(),
+        rows.end(),
+        [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < frameDim.x; x++)
+                func(uint2(x, y), y * frameDim.x + x);
+        }
+    );
+}
+} // namespace
+
+void ReSTIRReference::SurfaceBuffer::resize(uint2 dim)
+{
+    frameDim = dim;
+    size_t pixelCount = size_t(dim.x) * dim.y;
+    position.resize(pixelCount);
+    normal.resize(pixelCount);
+    diffuseWeight.resize(pixelCount);
+    specularWeight.resize(pixelCount);
+    specularRoughness.resize(pixelCount);
+    depth.resize(pixelCount, -FLT_MAX);
+}
+
+ReSTIRReference::MinimalLightSample ReSTIRReference::MinimalLightSample::create(Type type, uint32_t index, float2 position)
+{
+    MinimalLightSample lightSample;
+    lightSample.typeIndex = uint32_t(type) | (index & kLightSampleIndexMask);
+    lightSample.position = position.x + position.y > 1.f ? 1.f - position : position;
+    return lightSample;
+}
+
+ReSTIRReference::MinimalLightSample ReSTIRReference::MinimalLightSample::unpack(const PackedMinimalLightSample& packed)
+{
+    MinimalLightSample lightSample;
+    lightSample.typeIndex = packed.typeIndex;
+    lightSample.position = unpackSnorm2x16(packed.position);
+    return lightSample;
+}
+
+PackedMinimalLightSample ReSTIRReference::MinimalLightSample::pack() const
+{
+    PackedMinimalLightSample packed;
+    packed.typeIndex = typeIndex;
+    packed.position = packSnorm2x16(position);
+    return packed;
+}
+
+ReSTIRReference::Reservoir ReSTIRReference::Reservoir::unpack(const PackedReservoir& packed)
+{
+    Reservoir reservoir;
+    reservoir.sample = MinimalLightSample::unpack(packed.packedLightSample);
+    reservoir.W = asfloat(packed.W);
+    reservoir.M = packed.M;
+    if (std::isinf(reservoir.W) || std::isnan(reservoir.W))
+    {
+        reservoir.W = 0.f;
+        reservoir.M = 0u;
+    }
+    return reservoir;
+}
+
+PackedReservoir ReSTIRReference::Reservoir::pack() const
+{
+    PackedReservoir packed;
+    packed.packedLightSample = sample.pack();
+    packed.W = asuint(W);
+    packed.M = M;
+    return packed;
+}
+
+ReSTIRReference::ReSTIRReference(
+    const Params& params,
+    std::vector<EmissiveTriangle> triangles,
+    std::vector<PointLight> pointLights,
+    uint32_t seed
+)
+    : mParams(params), mTriangles(std::move(triangles)), mPointLights(std::move(pointLights))
+{
+    FALCOR_CHECK(mParams.lightTileSize > 0 && mParams.lightTileCount > 0, "Light tiles must not be empty.");
+    FALCOR_CHECK(
+        mParams.emissiveLightCandidateCount + mParams.analyticLightCandidateCount > 0, "At least one light candidate must be requested."
+    );
+
+    std::mt19937 rng(seed);
+
+    // Build the alias tables with the same weights as ReSTIRPass, but on the CPU only.
+    if (!mTriangles.empty())
+    {
+        std::vector<float> weights(mTriangles.size());
+        for (size_t i = 0; i < weights.size(); ++i)
+            weights[i] = luminance(mTriangles[i].averageRadiance) * mTriangles[i].area;
+        mpEmissiveGeometryAliasTable = std::make_unique<AliasTable>(nullptr, std::move(weights), rng);
+    }
+    if (!mPointLights.empty())
+    {
+        std::vector<float> weights(mPointLights.size());
+        for (size_t i = 0; i < weights.size(); ++i)
+            weights[i] = luminance(mPointLights[i].intensity);
+        mpAnalyticLightsAliasTable = std::make_unique<AliasTable>(nullptr, std::move(weights), rng);
+    }
+
+    // Split the light tiles between the light types. This uses the same arithmetic as ReSTIRPass::StaticParams::getDefines().
+    uint32_t totalCandidateCount = mParams.emissiveLightCandidateCount + mParams.analyticLightCandidateCount;
+    float portionOfEmissiveCandidates = float(mParams.emissiveLightCandidateCount) / float(totalCandidateCount);
+    mLightTileSampleCounts.x = uint32_t(mParams.lightTileSize * portionOfEmissiveCandidates);
+    mLightTileSampleCounts.y = 0;
+    mLightTileSampleCounts.z = mParams.lightTileSize - mLightTileSampleCounts.x;
+
+    FALCOR_CHECK(
+        mParams.emissiveLightCandidateCount == 0 || mpEmissiveGeometryAliasTable, "Emissive light candidates requested without emissive triangles."
+    );
+    FALCOR_CHECK(mParams.analyticLightCandidateCount == 0 || mpAnalyticLightsAliasTable, "Analytic light candidates requested without point lights.");
+}
+
+ReSTIRReference::LightSample ReSTIRReference::getLightSample(const MinimalLightSample& minLightSample) const
+{
+    LightSample lightSample;
+    lightSample.minLightSample = minLightSample;
+
+    const float tileSize = float(mParams.lightTileSize);
+    const uint32_t index = minLightSample.getIndex();
+
+    switch (minLightSample.getType())
+    {
+    case MinimalLightSample::Type::EmissiveGeometry:
+    {
+        const EmissiveTriangle& triangle = mTriangles[index];
+        const float2 position = minLightSample.position;
+        const float3 barycentrics = float3(1.f - position.x - position.y, position.x, position.y);
+        lightSample.lightType = LightSample::Type::AreaLight;
+        lightSample.posDir = triangle.posW[0] * barycentrics.x + triangle.posW[1] * barycentrics.y + triangle.posW[2] * barycentrics.z;
+        lightSample.normal = triangle.normal;
+        lightSample.Le = luminance(triangle.averageRadiance);
+        lightSample.pdf =
+            (float(mLightTileSampleCounts.x) / tileSize) * lightSample.Le / float(mpEmissiveGeometryAliasTable->getWeightSum());
+        break;
+    }
+    case MinimalLightSample::Type::Analytic:
+    {
+        const PointLight& light = mPointLights[index];
+        lightSample.lightType = LightSample::Type::PointLight;
+        lightSample.posDir = light.posW;
+        // Matches getAnalyticLightSample() in LightSampling.slang.
+        lightSample.normal = -lightSample.posDir;
+        lightSample.Le = luminance(light.intensity);
+        lightSample.pdf =
+            (float(mLightTileSampleCounts.z) / tileSize) * lightSample.Le / float(mpAnalyticLightsAliasTable->getWeightSum());
+        break;
+    }
+    default:
+        FALCOR_UNREACHABLE();
+    }
+
+    return lightSample;
+}
+
+float ReSTIRReference::evalTargetPDF(const SurfaceBuffer& surface, uint32_t index, const LightSample& lightSample) const
+{
+    const float3 position = surface.position[index];
+    const float3 normal = surface.normal[index];
+    const float3 wo = normalize(surface.cameraPosition - position);
+
+    float3 wi;
+    float geometryFactor = 1.f;
+    if (lightSample.lightType == LightSample::Type::DistantLight)
+    {
+        wi = lightSample.posDir;
+    }
+    else
+    {
+        const float3 pointToLightVec = lightSample.posDir - position;
+        const float distSq = dot(pointToLightVec, pointToLightVec);
+        wi = pointToLightVec / std::sqrt(distSq);
+        geometryFactor = std::max(0.f, dot(-wi, lightSample.normal)) / distSq;
+    }
+
+    // Evaluate the BRDF, see SurfaceData::evalBRDF().
+    float wiDotN = std::clamp(dot(wi, normal), 0.f, 1.f);
+    if (wiDotN <= 0.f)
+        return 0.f;
+    float woDotN = std::clamp(dot(wo, normal), 0.f, 1.f);
+    float3 H = normalize(wi + wo);
+    float NDotH = std::clamp(dot(normal, H), 0.f, 1.f);
+    float wiDotH = std::clamp(dot(wi, H), 0.f, 1.f);
+
+    const float diffuseWeight = surface.diffuseWeight[index];
+    const float specularWeight = surface.specularWeight[index];
+    const float alpha = surface.specularRoughness[index] * surface.specularRoughness[index];
+    float D = evalNdfGGX(alpha, NDotH);
+    float G = evalMaskingSmithGGXSeparable(alpha, woDotN, wiDotN);
+    float F = specularWeight < 1e-8f ? 0.f : evalFresnelSchlick(specularWeight, 1.f, wiDotH) / specularWeight;
+
+    float diffuse = float(M_1_PI) * wiDotN;
+    float specular = std::max(0.f, D * G * F * 0.25f / woDotN);
+
+    float weightSum = diffuseWeight + specularWeight;
+    float diffuseSpecularMix = weightSum < 1e-7f ? 1.f : diffuseWeight / weightSum;
+    float brdfWeight = specular + (diffuse - specular) * diffuseSpecularMix;
+
+    return lightSample.Le * brdfWeight * geometryFactor;
+}
+
+void ReSTIRReference::updateLightTiles(uint32_t frameCount, uint32_t tileOffset, uint32_t tileCount)
+{
+    FALCOR_CHECK(tileCount <= mParams.lightTileCount, "Can't update more than {} light tiles.", mParams.lightTileCount);
+    mLightTiles.resize(size_t(mParams.lightTileCount) * mParams.lightTileSize);
+
+    NumericRange<uint32_t> range(0, tileCount * mParams.lightTileSize);
+    std::for_each(
+        std::execution::par_unseq,
+        range.begin(),
+        range.end(),
+        [&](uint32_t threadIndex)
+        {
+            const uint32_t tileIndex = (tileOffset + threadIndex / mParams.lightTileSize) % mParams.lightTileCount;
+            const uint32_t inTileSampleIndex = threadIndex % mParams.lightTileSize;
+            const uint32_t bufferIndex = tileIndex * mParams.lightTileSize + inTileSampleIndex;
+
+            // The shader passes the scalar buffer index as seed, which is splatted to a uint2.
+            TinyUniformSampleGenerator sg(uint2(bufferIndex), frameCount);
+
+            const AliasTable* pAliasTable = nullptr;
+            MinimalLightSample::Type type = MinimalLightSample::Type::EmissiveGeometry;
+            uint32_t typeSampleIndex = inTileSampleIndex;
+            uint32_t typeSampleCount = mLightTileSampleCounts.x;
+            if (inTileSampleIndex < mLightTileSampleCounts.x)
+            {
+                pAliasTable = mpEmissiveGeometryAliasTable.get();
+            }
+            else if (inTileSampleIndex >= mLightTileSampleCounts.x + mLightTileSampleCounts.y)
+            {
+                pAliasTable = mpAnalyticLightsAliasTable.get();
+                type = MinimalLightSample::Type::Analytic;
+                typeSampleIndex = inTileSampleIndex - mLightTileSampleCounts.x - mLightTileSampleCounts.y;
+                typeSampleCount = mLightTileSampleCounts.z;
+            }
+
+            if (!pAliasTable)
+            {
+                mLightTiles[bufferIndex] = {};
+                return;
+            }
+
+            // Random numbers for the alias table, see CreateLightTilesPass::getAliasRandom().
+            float2 aliasRandom;
+            if (mParams.lightTileSampling == LightTileSampling::Stratified)
+            {
+                TinyUniformSampleGenerator tileSg(uint2(tileIndex, ~tileIndex), frameCount);
+                float2 shift = tileSg.next2D();
+                float2 lattice = float2(float(typeSampleIndex) / float(typeSampleCount), float(typeSampleIndex) * kLightTileLatticeGenerator);
+                sg.next2D();
+                aliasRandom = lattice + shift;
+                aliasRandom -= floor(aliasRandom);
+            }
+            else
+            {
+                aliasRandom.x = sg.next1D();
+                aliasRandom.y = sg.next1D();
+            }
+            float2 positionRandom = sg.next2D();
+
+            uint32_t index = pAliasTable->sample(aliasRandom);
+            LightSample lightSample = getLightSample(MinimalLightSample::create(type, index, positionRandom));
+
+            // The tiles store packed light samples, so the position is quantized while posDir is kept at full precision.
+            lightSample.minLightSample = MinimalLightSample::unpack(lightSample.minLightSample.pack());
+            mLightTiles[bufferIndex] = lightSample;
+        }
+    );
+}
+
+ReSTIRReference::LightTileStatistics ReSTIRReference::evalLightTileStatistics(MinimalLightSample::Type type) const
+{
+    FALCOR_CHECK(!mLightTiles.empty(), "Light tiles have not been created.");
+
+    const AliasTable* pAliasTable = nullptr;
+    uint32_t typeOffset = 0;
+    uint32_t typeSampleCount = 0;
+    switch (type)
+    {
+    case MinimalLightSample::Type::EmissiveGeometry:
+        pAliasTable = mpEmissiveGeometryAliasTable.get();
+        typeSampleCount = mLightTileSampleCounts.x;
+        break;
+    case MinimalLightSample::Type::Analytic:
+        pAliasTable = mpAnalyticLightsAliasTable.get();
+        typeOffset = mLightTileSampleCounts.x + mLightTileSampleCounts.y;
+        typeSampleCount = mLightTileSampleCounts.z;
+        break;
+    default:
+        FALCOR_THROW("Unsupported light type.");
+    }
+
+    LightTileStatistics stats;
+    if (!pAliasTable || typeSampleCount == 0)
+        return stats;
+
+    const uint32_t lightCount = pAliasTable->getCount();
+    std::vector<uint32_t> histogram(lightCount, 0);
+    std::vector<uint32_t> tileHistogram(lightCount);
+    for (uint32_t lightIndex = 0; lightIndex < lightCount; lightIndex++)
+        stats.lightCount += pAliasTable->getWeight(lightIndex) > 0.f ? 1 : 0;
+
+    for (uint32_t tileIndex = 0; tileIndex < mParams.lightTileCount; tileIndex++)
+    {
+        std::fill(tileHistogram.begin(), tileHistogram.end(), 0);
+        for (uint32_t i = 0; i < typeSampleCount; i++)
+        {
+            const LightSample& lightSample = mLightTiles[tileIndex * mParams.lightTileSize + typeOffset + i];
+            uint32_t lightIndex = lightSample.minLightSample.getIndex();
+            tileHistogram[lightIndex]++;
+            histogram[lightIndex]++;
+        }
+
+        uint32_t coveredLightCount = 0;
+        for (uint32_t lightIndex = 0; lightIndex < lightCount; lightIndex++)
+            coveredLightCount += tileHistogram[lightIndex] > 0 ? 1 : 0;
+        stats.coverage += stats.lightCount > 0 ? double(coveredLightCount) / stats.lightCount : 0.0;
+    }
+    stats.coverage /= mParams.lightTileCount;
+    stats.sampleCount = typeSampleCount * mParams.lightTileCount;
+
+    for (uint32_t lightIndex = 0; lightIndex < lightCount; lightIndex++)
+    {
+        double expected = pAliasTable->getWeight(lightIndex) / pAliasTable->getWeightSum();
+        double frequency = double(histogram[lightIndex]) / stats.sampleCount;
+        stats.pdfError += 0.5 * std::abs(frequency - expected);
+        if (expected > 0.0)
+            stats.maxPdfError = std::max(stats.maxPdfError, std::abs(frequency - expected) / expected);
+    }
+
+    return stats;
+}
+
+void ReSTIRReference::generateInitialCandidates(const SurfaceBuffer& surface, uint32_t frameCount, std::vector<PackedReservoir>& reservoirs) const
+{
+    FALCOR_CHECK(!mLightTiles.empty(), "Light tiles have not been created.");
+    reservoirs.resize(surface.getPixelCount());
+
+    auto sampleFromTile = [&](uint32_t index, uint32_t tileOffset, uint32_t tileSampleCount, uint32_t candidateCount, TinyUniformSampleGenerator& sg
+                          )
+    {
+        Reservoir reservoir;
+        uint32_t step = (tileSampleCount + candidateCount - 1) / candidateCount;
+        uint32_t inTileOffset = std::min(uint32_t(sg.next1D() * step), step - 1);
+        for (uint32_t i = 0; i < candidateCount; i++)
+        {
+            const LightSample& lightSample = mLightTiles[tileOffset + (inTileOffset + i * step) % tileSampleCount];
+
+            const float3 direction = lightSample.lightType == LightSample::Type::DistantLight
+                                         ? lightSample.posDir
+                                         : normalize(lightSample.posDir - surface.position[index]);
+            if (dot(surface.normal[index], direction) < kMinCosTheta)
+            {
+                reservoir.M += 1;
+                continue;
+            }
+
+            float targetPDF = evalTargetPDF(surface, index, lightSample);
+            updateReservoir(reservoir, lightSample.minLightSample, targetPDF, lightSample.pdf, sg);
+        }
+        return reservoir;
+    };
+
+    forEachPixel(
+        surface.frameDim,
+        [&](uint2 pixel, uint32_t index)
+        {
+            Reservoir outputReservoir;
+
+            if (surface.isValid(index))
+            {
+                // All pixels in the same screen tile use the same light tile.
+                TinyUniformSampleGenerator tileSg(pixel / mParams.lightTileScreenSize, frameCount);
+                uint32_t tileIndex = uint32_t(tileSg.next1D() * mParams.lightTileCount);
+
+                TinyUniformSampleGenerator sg(pixel, frameCount);
+
+                auto addLightType = [&](uint32_t tileOffset, uint32_t tileSampleCount, uint32_t candidateCount)
+                {
+                    if (candidateCount == 0)
+                        return;
+                    Reservoir reservoir = sampleFromTile(index, tileOffset, tileSampleCount, candidateCount, sg);
+                    float localTargetPDF = reservoir.W;
+                    reservoir.W = reservoir.W > 0.f ? (reservoir.weightSum / reservoir.M) / reservoir.W : 0.f;
+                    mergeReservoir(outputReservoir, reservoir, localTargetPDF, sg);
+                };
+
+                uint32_t lightTileOffset = tileIndex * mParams.lightTileSize;
+                addLightType(lightTileOffset, mLightTileSampleCounts.x, mParams.emissiveLightCandidateCount);
+                addLightType(
+                    lightTileOffset + mLightTileSampleCounts.x + mLightTileSampleCounts.y,
+                    mLightTileSampleCounts.z,
+                    mParams.analyticLightCandidateCount
+                );
+
+                // All samples are visible, see TEST_INITIAL_SAMPLE_VISIBILITY in InitialSampling.slang.
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum / outputReservoir.M) / outputReservoir.W : 0.f;
+                outputReservoir.M = 1;
+            }
+
+            reservoirs[index] = outputReservoir.pack();
+        }
+    );
+}
+
+void ReSTIRReference::temporalReuse(
+    const SurfaceBuffer& surface,
+    const SurfaceBuffer& prevSurface,
+    uint32_t frameCount,
+    const std::vector<PackedReservoir>& prevReservoirs,
+    std::vector<PackedReservoir>& reservoirs
+) const
+{
+    FALCOR_CHECK(all(surface.frameDim == prevSurface.frameDim), "Frame dimensions of the current and previous frame must match.");
+    const uint2 frameDim = surface.frameDim;
+    const ReSTIRBiasCorrection biasCorrection = mParams.biasCorrection;
+
+    forEachPixel(
+        frameDim,
+        [&](uint2 pixel, uint32_t index)
+        {
+            if (!surface.isValid(index))
+                return;
+
+            TinyUniformSampleGenerator sg(pixel, getReuseSampleNumber(frameCount, kTemporalReuseStream));
+
+            Reservoir currentReservoir = Reservoir::unpack(reservoirs[index]);
+            uint32_t historyLimit = mParams.temporalHistoryLength * currentReservoir.M;
+
+            // Reproject the pixel position.
+            float2 motion = surface.motionVectors.empty() ? float2(0.f) : surface.motionVectors[index];
+            float2 jitter = sg.next2D();
+            float2 reprojPos = float2(pixel) + motion * float2(frameDim) + jitter;
+            if (reprojPos.x < 0.f || reprojPos.y < 0.f)
+                return;
+            uint2 prevPixel = uint2(uint32_t(reprojPos.x), uint32_t(reprojPos.y));
+            if (prevPixel.x >= frameDim.x || prevPixel.y >= frameDim.y)
+                return;
+
+            uint32_t prevIndex = getBufferIndex(prevPixel, frameDim);
+            if (!prevSurface.isValid(prevIndex))
+                return;
+            if (!isValidNeighbor(
+                    surface.normal[index],
+                    prevSurface.normal[prevIndex],
+                    surface.depth[index],
+                    prevSurface.depth[prevIndex],
+                    mParams.normalThreshold,
+                    mParams.depthThreshold
+                ))
+                return;
+
+            Reservoir prevReservoir = Reservoir::unpack(prevReservoirs[prevIndex]);
+            prevReservoir.M = std::min(historyLimit, prevReservoir.M);
+
+            Reservoir outputReservoir;
+
+            LightSample currLightSample = getLightSample(currentReservoir.sample);
+            float currReservoirTargetPDF = currentReservoir.W > 0.f ? evalTargetPDF(surface, index, currLightSample) : 0.f;
+            mergeReservoir(outputReservoir, currentReservoir, currReservoirTargetPDF, sg);
+
+            LightSample prevLightSample = getLightSample(prevReservoir.sample);
+            float prevReservoirTargetPDF = prevReservoir.sample.isValid() ? evalTargetPDF(surface, index, prevLightSample) : 0.f;
+            bool neighborContributed = mergeReservoir(outputReservoir, prevReservoir, prevReservoirTargetPDF, sg);
+
+            if (biasCorrection == ReSTIRBiasCorrection::Off)
+            {
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum / outputReservoir.M) / outputReservoir.W : 0.f;
+            }
+            else if (biasCorrection == ReSTIRBiasCorrection::Naive)
+            {
+                uint32_t Z = 0u;
+                LightSample outputLightSample = getLightSample(outputReservoir.sample);
+                if (outputReservoir.sample.isValid() && evalTargetPDF(surface, index, outputLightSample) > 0.f)
+                    Z += currentReservoir.M;
+                if (outputReservoir.sample.isValid() && evalTargetPDF(prevSurface, prevIndex, outputLightSample) > 0.f)
+                    Z += prevReservoir.M;
+                float m = Z > 0 ? 1.f / Z : 0.f;
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum * m) / outputReservoir.W : 0.f;
+            }
+            else
+            {
+                // MIS and RayTraced are identical here as all samples are visible.
+                float pSum = 0.f;
+                float currPixelTargetPDF = 0.f;
+                float prevPixelTargetPDF = 0.f;
+                if (outputReservoir.sample.isValid())
+                {
+                    LightSample outputLightSample = getLightSample(outputReservoir.sample);
+                    currPixelTargetPDF = evalTargetPDF(surface, index, outputLightSample);
+                    prevPixelTargetPDF = evalTargetPDF(prevSurface, prevIndex, outputLightSample);
+                }
+                pSum += currPixelTargetPDF * currentReservoir.M;
+                pSum += prevPixelTargetPDF * prevReservoir.M;
+                float m = pSum > 0.f ? ((neighborContributed ? prevPixelTargetPDF : currPixelTargetPDF) / pSum) : 0.f;
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum * m) / outputReservoir.W : 0.f;
+            }
+
+            reservoirs[index] = outputReservoir.pack();
+        }
+    );
+}
+
+void ReSTIRReference::spatialReuse(
+    const SurfaceBuffer& surface,
+    uint32_t frameCount,
+    uint32_t iteration,
+    const std::vector<PackedReservoir>& reservoirs,
+    std::vector<PackedReservoir>& outReservoirs
+) const
+{
+    FALCOR_CHECK(&reservoirs != &outReservoirs, "Spatial reuse can't run in place.");
+    const uint2 frameDim = surface.frameDim;
+    const uint32_t sampleCount = mParams.spatialReuseSampleCount;
+    const ReSTIRBiasCorrection biasCorrection = mParams.biasCorrection;
+    FALCOR_CHECK(sampleCount <= 32, "Spatial reuse supports at most 32 neighbors.");
+
+    outReservoirs.resize(reservoirs.size());
+
+    forEachPixel(
+        frameDim,
+        [&](uint2 pixel, uint32_t index)
+        {
+            // Invalid pixels keep their reservoir. The shader leaves the output untouched instead.
+            outReservoirs[index] = reservoirs[index];
+            if (!surface.isValid(index))
+                return;
+
+            const uint32_t stream = kSpatialReuseStream + 2 * iteration;
+            TinyUniformSampleGenerator sg(pixel, getReuseSampleNumber(frameCount, stream));
+            Reservoir currentReservoir = Reservoir::unpack(reservoirs[index]);
+            Reservoir outputReservoir;
+
+            float currReservoirTargetPDF = currentReservoir.sample.isValid() ? evalTargetPDF(surface, index, getLightSample(currentReservoir.sample)) : 0.f;
+            mergeReservoir(outputReservoir, currentReservoir, currReservoirTargetPDF, sg);
+
+            // The neighbor positions are drawn from their own stream, so they can be replayed when computing the MIS weights
+            // and are not correlated with the selection.
+            TinyUniformSampleGenerator sg1(pixel, getReuseSampleNumber(frameCount, stream + 1));
+            TinyUniformSampleGenerator sg2 = sg1;
+            TinyUniformSampleGenerator& neighborSg = biasCorrection == ReSTIRBiasCorrection::Off ? sg : sg1;
+
+            uint32_t validNeighborFlags = 0;
+            int selectedSample = -1;
+            for (uint32_t i = 0; i < sampleCount; i++)
+            {
+                uint2 neighborPixel;
+                if (!getRandomNeighborPixel(pixel, frameDim, mParams.spatialReuseSampleRadius, neighborSg, neighborPixel))
+                    continue;
+
+                uint32_t neighborIndex = getBufferIndex(neighborPixel, frameDim);
+                Reservoir neighborReservoir = Reservoir::unpack(reservoirs[neighborIndex]);
+                if (neighborReservoir.M == 0)
+                    continue;
+                if (!surface.isValid(neighborIndex))
+                    continue;
+                if (!isValidNeighbor(
+                        surface.normal[index],
+                        surface.normal[neighborIndex],
+                        surface.depth[index],
+                        surface.depth[neighborIndex],
+                        mParams.normalThreshold,
+                        mParams.depthThreshold
+                    ))
+                    continue;
+
+                float neighborReservoirTargetPDF =
+                    neighborReservoir.sample.isValid() ? evalTargetPDF(surface, index, getLightSample(neighborReservoir.sample)) : 0.f;
+                if (mergeReservoir(outputReservoir, neighborReservoir, neighborReservoirTargetPDF, sg))
+                    selectedSample = int(i);
+
+                validNeighborFlags |= (1u << i);
+            }
+
+            if (biasCorrection == ReSTIRBiasCorrection::Off)
+            {
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum / outputReservoir.M) / outputReservoir.W : 0.f;
+            }
+            else if (biasCorrection == ReSTIRBiasCorrection::Naive)
+            {
+                uint32_t Z = 0u;
+                LightSample outputLightSample = getLightSample(outputReservoir.sample);
+                if (outputReservoir.W > 0.f)
+                    Z += currentReservoir.M;
+                for (uint32_t i = 0; i < sampleCount; i++)
+                {
+                    // Replay the neighbor selection. Positions are drawn for all neighbors to stay in sync with sg1.
+                    uint2 neighborPixel;
+                    bool inside = getRandomNeighborPixel(pixel, frameDim, mParams.spatialReuseSampleRadius, sg2, neighborPixel);
+                    if (!inside || !(validNeighborFlags & (1u << i)))
+                        continue;
+
+                    uint32_t neighborIndex = getBufferIndex(neighborPixel, frameDim);
+                    if (outputReservoir.sample.isValid() && evalTargetPDF(surface, neighborIndex, outputLightSample) > 0.f)
+                        Z += Reservoir::unpack(reservoirs[neighborIndex]).M;
+                }
+                float m = Z > 0 ? 1.f / float(Z) : 0.f;
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum * m) / outputReservoir.W : 0.f;
+            }
+            else
+            {
+                // MIS and RayTraced are identical here as all samples are visible.
+                float pSum = outputReservoir.W * currentReservoir.M;
+                float pStar = selectedSample == -1 ? outputReservoir.W : 0.f;
+                LightSample outputLightSample = getLightSample(outputReservoir.sample);
+                for (uint32_t i = 0; i < sampleCount; i++)
+                {
+                    uint2 neighborPixel;
+                    bool inside = getRandomNeighborPixel(pixel, frameDim, mParams.spatialReuseSampleRadius, sg2, neighborPixel);
+                    if (!inside || !(validNeighborFlags & (1u << i)))
+                        continue;
+
+                    uint32_t neighborIndex = getBufferIndex(neighborPixel, frameDim);
+                    float neighborPixelTargetPDF =
+                        outputReservoir.sample.isValid() ? evalTargetPDF(surface, neighborIndex, outputLightSample) : 0.f;
+                    pSum += neighborPixelTargetPDF * Reservoir::unpack(reservoirs[neighborIndex]).M;
+                    if (selectedSample == int(i))
+                        pStar = neighborPixelTargetPDF;
+                }
+                float m = pSum > 0.f ? pStar / pSum : 0.f;
+                outputReservoir.W = outputReservoir.W > 0.f ? (outputReservoir.weightSum * m) / outputReservoir.W : 0.f;
+            }
+
+            outReservoirs[index] = outputReservoir.pack();
+        }
+    );
+}
+
+void ReSTIRReference::executeFrame(
+    const SurfaceBuffer& surface,
+    const SurfaceBuffer* prevSurface,
+    uint32_t frameCount,
+    std::vector<PackedReservoir>& reservoirs
+)
+{
+    std::vector<PackedReservoir> prevReservoirs;
+    if (prevSurface)
+        prevReservoirs = std::move(reservoirs);
+
+    createLightTiles(frameCount);
+    generateInitialCandidates(surface, frameCount, reservoirs);
+
+    if (prevSurface && prevReservoirs.size() == reservoirs.size())
+        temporalReuse(surface, *prevSurface, frameCount, prevReservoirs, reservoirs);
+
+    std::vector<PackedReservoir> tmpReservoirs;
+    for (uint32_t iteration = 0; iteration < mParams.spatialIterationCount; iteration++)
+    {
+        spatialReuse(surface, frameCount, iteration, reservoirs, tmpReservoirs);
+        std::swap(reservoirs, tmpReservoirs);
+    }
+}
+
+void ReSTIRReference::evalEstimate(const SurfaceBuffer& surface, const std::vector<PackedReservoir>& reservoirs, std::vector<float>& estimate)
+    const
+{
+    estimate.resize(surface.getPixelCount());
+    forEachPixel(
+        surface.frameDim,
+        [&](uint2 pixel, uint32_t index)
+        {
+            Reservoir reservoir = Reservoir::unpack(reservoirs[index]);
+            estimate[index] = surface.isValid(index) && reservoir.sample.isValid() && reservoir.W > 0.f
+                                  ? evalTargetPDF(surface, index, getLightSample(reservoir.sample)) * reservoir.W
+                                  : 0.f;
+        }
+    );
+}
+
+void ReSTIRReference::evalReference(const SurfaceBuffer& surface, uint32_t samplesPerTriangleDim, std::vector<float>& reference) const
+{
+    FALCOR_CHECK(samplesPerTriangleDim > 0, "Reference needs at least one sample per triangle.");
+    reference.resize(surface.getPixelCount());
+
+    const uint32_t samplesPerTriangle = samplesPerTriangleDim * samplesPerTriangleDim;
+    forEachPixel(
+        surface.frameDim,
+        [&](uint2 pixel, uint32_t index)
+        {
+            if (!surface.isValid(index))
+            {
+                reference[index] = 0.f;
+                return;
+            }
+
+            double sum = 0.0;
+
+            // Integrate the target function over the triangle area using stratified samples.
+            for (uint32_t t = 0; t < (uint32_t)mTriangles.size(); t++)
+            {
+                double triangleSum = 0.0;
+                for (uint32_t s = 0; s < samplesPerTriangle; s++)
+                {
+                    float2 u = (float2(float(s % samplesPerTriangleDim), float(s / samplesPerTriangleDim)) + 0.5f) / float(samplesPerTriangleDim);
+                    LightSample lightSample = getLightSample(MinimalLightSample::create(MinimalLightSample::Type::EmissiveGeometry, t, u));
+                    triangleSum += evalTargetPDF(surface, index, lightSample);
+                }
+                sum += triangleSum * mTriangles[t].area / samplesPerTriangle;
+            }
+
+            for (uint32_t l = 0; l < (uint32_t)mPointLights.size(); l++)
+            {
+                LightSample lightSample = getLightSample(MinimalLightSample::create(MinimalLightSample::Type::Analytic, l, float2(0.f)));
+                sum += evalTargetPDF(surface, index, lightSample);
+            }
+
+            reference[index] = float(sum);
+        }
+    );
+}
+
+ReSTIRReference::Statistics ReSTIRReference::evalStatistics(
+    const SurfaceBuffer& surface,
+    uint32_t frameCount,
+    bool useTemporalReuse,
+    uint32_t samplesPerTriangleDim
+)
+{
+    FALCOR_CHECK(frameCount > 1, "At least two frames are needed to estimate the standard error.");
+
+    Statistics stats;
+    stats.frameCount = frameCount;
+
+    std::vector<float> reference;
+    evalReference(surface, samplesPerTriangleDim, reference);
+
+    const uint32_t pixelCount = surface.getPixelCount();
+    std::vector<double> accumulated(pixelCount, 0.0);
+    std::vector<double> frameSums(frameCount, 0.0);
+    std::vector<PackedReservoir> reservoirs;
+    std::vector<float> estimate;
+
+    double resamplingTime = 0.0;
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        executeFrame(surface, useTemporalReuse && frame > 0 ? &surface : nullptr, frame, reservoirs);
+        resamplingTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        evalEstimate(surface, reservoirs, estimate);
+        for (uint32_t i = 0; i < pixelCount; i++)
+        {
+            accumulated[i] += estimate[i];
+            frameSums[frame] += estimate[i];
+        }
+    }
+
+    uint32_t validPixelCount = 0;
+    for (uint32_t i = 0; i < pixelCount; i++)
+    {
+        if (!surface.isValid(i))
+            continue;
+        double mean = accumulated[i] / frameCount;
+        stats.referenceSum += reference[i];
+        stats.estimateSum += mean;
+        if (reference[i] > 0.f)
+        {
+            stats.meanRelativeError += std::abs(mean - reference[i]) / reference[i];
+            validPixelCount++;
+        }
+    }
+    if (validPixelCount > 0)
+        stats.meanRelativeError /= validPixelCount;
+
+    if (stats.referenceSum > 0.0)
+    {
+        stats.relativeBias = (stats.estimateSum - stats.referenceSum) / stats.referenceSum;
+
+        // Frames are treated as independent. With temporal reuse they are correlated and the error is underestimated.
+        double variance = 0.0;
+        for (double frameSum : frameSums)
+            variance += (frameSum - stats.estimateSum) * (frameSum - stats.estimateSum);
+        variance /= (frameCount - 1);
+        stats.standardError = std::sqrt(variance / frameCount) / stats.referenceSum;
+    }
+
+    stats.pixelsPerSecond = resamplingTime > 0.0 ? double(pixelCount) * frameCount / (resamplingTime * 1e-3) : 0.0;
+
+    return stats;
+}
+} // namespace Falcor
@@ -0,0 +1,313 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ReSTIRPass/Core/ReservoirData.slang"
+#include "ReSTIRPass/DirectIllumination/LightTileData.slang"
+#include "Utils/Math/Vector.h"
+#include "Utils/Sampling/AliasTable.h"
+
+#include <cfloat>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU reference implementation of the ReSTIR DI reservoir resampling.
+ *
+ * This mirrors the GPU passes of ReSTIRPass (light tile creation, initial candidate generation,
+ * temporal reuse and spatial reuse) on CPU-provided surface and light data. Reservoirs are stored
+ * in the PackedReservoir format shared with the shaders. Pixels are processed in parallel row by row,
+ * with all per-pixel surface attributes stored in structure-of-arrays layout.
+ *
+ * The reference is meant for offline validation of the bias correction modes and of parameter changes.
+ * It differs from the GPU passes in the following ways:
+ * - There is no acceleration structure, all light samples are treated as visible.
+ *   BiasCorrection::RayTraced is therefore equivalent to BiasCorrection::MIS.
+ * - Only emissive triangles and point lights are supported, there is no environment light.
+ * - Ray origins are not offset and normals/depths are not quantized.
+ * - Checkerboarding is not supported.
+ */
+class ReSTIRReference
+{
+public:
+    /// Subset of ReSTIRPass::ReSTIRParams that affects the resampling. Defaults match the pass.
+    struct Params
+    {
+        uint32_t lightTileScreenSize = 8;               ///< Screen size of the light tiles in pixels.
+        uint32_t lightTileSize = 1024;                  ///< Total number of light samples in each light tile.
+        uint32_t lightTileCount = 128;                  ///< Total number of light tiles.
+        LightTileSampling lightTileSampling = LightTileSampling::Independent; ///< How the light tile samples are drawn from the alias tables.
+
+        uint32_t emissiveLightCandidateCount = 24;      ///< Number of candidate samples for emissive lights.
+        uint32_t analyticLightCandidateCount = 1;       ///< Number of candidate samples for analytic lights.
+
+        ReSTIRBiasCorrection biasCorrection = ReSTIRBiasCorrection::Off; ///< Bias correction method used.
+        float normalThreshold = 0.9f;                   ///< Threshold for normal comparison.
+        float depthThreshold = 0.1f;                    ///< Threshold for depth comparison.
+
+        uint32_t spatialIterationCount = 1;             ///< Number of spatial resampling iterations.
+        uint32_t spatialReuseSampleCount = 5;           ///< Number of neighbor samples considered for resampling.
+        float spatialReuseSampleRadius = 50.f;          ///< Radius within which to reuse samples.
+
+        uint32_t temporalHistoryLength = 20;            ///< Length of the temporal history for resampling.
+    };
+
+    /// Emissive triangle light. The sampling weight is luminance(averageRadiance) * area, as in ReSTIRPass.
+    struct EmissiveTriangle
+    {
+        float3 posW[3];
+        float3 normal;
+        float area = 0.f;
+        float3 averageRadiance;
+    };
+
+    /// Analytic point light.
+    struct PointLight
+    {
+        float3 posW;
+        float3 intensity;
+    };
+
+    /**
+     * Surface data of a frame in structure-of-arrays layout.
+     * This holds the same attributes as SurfaceData in SurfaceData.slang. Invalid pixels have depth set to -FLT_MAX.
+     */
+    struct SurfaceBuffer
+    {
+        uint2 frameDim = uint2(0);
+        float3 cameraPosition = float3(0.f);
+        std::vector<float3> position;
+        std::vector<float3> normal;
+        std::vector<float> diffuseWeight;
+        std::vector<float> specularWeight;
+        std::vector<float> specularRoughness;
+        std::vector<float> depth;
+        std::vector<float2> motionVectors; ///< Screen-space motion vectors. Optional, no motion is assumed if empty.
+
+        void resize(uint2 dim);
+        uint32_t getPixelCount() const { return frameDim.x * frameDim.y; }
+        bool isValid(uint32_t index) const { return depth[index] != -FLT_MAX; }
+    };
+
+    /// Minimal light sample, mirrors MinimalLightSample in LightSampling.slang.
+    struct MinimalLightSample
+    {
+        enum class Type : uint32_t
+        {
+            EmissiveGeometry = (0u << kLightSampleTypeOffset),
+            Environment = (1u << kLightSampleTypeOffset),
+            Analytic = (2u << kLightSampleTypeOffset),
+        };
+
+        uint32_t typeIndex = kInvalidLightSample;
+        float2 position = float2(0.f);
+
+        static MinimalLightSample create(Type type, uint32_t index, float2 position);
+        static MinimalLightSample unpack(const PackedMinimalLightSample& packed);
+        PackedMinimalLightSample pack() const;
+
+        bool isValid() const { return typeIndex != kInvalidLightSample; }
+        Type getType() const { return Type(typeIndex & kLightSampleTypeMask); }
+        uint32_t getIndex() const { return typeIndex & kLightSampleIndexMask; }
+    };
+
+    /// Full light sample, mirrors LightSample in LightSampling.slang.
+    struct LightSample
+    {
+        enum class Type
+        {
+            AreaLight,
+            DistantLight,
+            PointLight,
+        };
+
+        MinimalLightSample minLightSample;
+        Type lightType = Type::AreaLight;
+        float3 posDir = float3(0.f);
+        float3 normal = float3(0.f);
+        float pdf = 0.f;
+        float Le = 0.f;
+    };
+
+    /// Reservoir, mirrors Reservoir in Reservoir.slang.
+    struct Reservoir
+    {
+        MinimalLightSample sample;
+        float weightSum = 0.f;
+        float W = 0.f;
+        uint32_t M = 0;
+
+        static Reservoir unpack(const PackedReservoir& packed);
+        PackedReservoir pack() const;
+    };
+
+    /// Unbiasedness statistics of the ReSTIR estimate against the brute-force reference.
+    struct Statistics
+    {
+        uint32_t frameCount = 0;        ///< Number of independent frames that were averaged.
+        double referenceSum = 0.0;      ///< Sum of the reference over all valid pixels.
+        double estimateSum = 0.0;       ///< Sum of the frame-averaged estimate over all valid pixels.
+        double relativeBias = 0.0;      ///< (estimateSum - referenceSum) / referenceSum.
+        double standardError = 0.0;     ///< Standard error of relativeBias estimated from the per-frame sums.
+        double meanRelativeError = 0.0; ///< Mean per-pixel relative error of the frame-averaged estimate.
+        double pixelsPerSecond = 0.0;   ///< Throughput of the resampling passes (excluding the reference).
+
+        /// Bias expressed in multiples of the standard error.
+        double getZScore() const { return standardError > 0.0 ? relativeBias / standardError : 0.0; }
+    };
+
+    /// Statistics of the light samples of one light type over all light tiles.
+    struct LightTileStatistics
+    {
+        uint32_t sampleCount = 0;       ///< Number of light samples of this type over all tiles.
+        uint32_t lightCount = 0;        ///< Number of lights with non-zero weight.
+        double coverage = 0.0;          ///< Average over tiles of the fraction of lights with non-zero weight that are sampled at least once.
+        double pdfError = 0.0;          ///< Total variation distance between the sampled light frequencies and the alias table distribution.
+        double maxPdfError = 0.0;       ///< Largest relative error of the sampled frequency of a single light.
+    };
+
+    /**
+     * Create the reference.
+     * @param[in] params Resampling parameters.
+     * @param[in] triangles Emissive triangles.
+     * @param[in] pointLights Analytic point lights.
+     * @param[in] seed Seed for the alias table construction.
+     */
+    ReSTIRReference(const Params& params, std::vector<EmissiveTriangle> triangles, std::vector<PointLight> pointLights, uint32_t seed = 0);
+
+    const Params& getParams() const { return mParams; }
+
+    /**
+     * Get the number of emissive, environment and analytic samples in each light tile.
+     * This uses the same arithmetic as ReSTIRPass::StaticParams::getDefines().
+     */
+    uint3 getLightTileSampleCounts() const { return mLightTileSampleCounts; }
+
+    /**
+     * Fill all light tiles for a given frame. Mirrors LightTiling.slang.
+     */
+    void createLightTiles(uint32_t frameCount) { updateLightTiles(frameCount, 0, mParams.lightTileCount); }
+
+    /**
+     * Regenerate a range of light tiles for a given frame, as done by ReSTIRPass in incremental update mode.
+     * @param[in] frameCount Frame count used to seed the samples.
+     * @param[in] tileOffset Index of the first tile to update. The range wraps around at the tile count.
+     * @param[in] tileCount Number of tiles to update.
+     */
+    void updateLightTiles(uint32_t frameCount, uint32_t tileOffset, uint32_t tileCount);
+
+    /**
+     * Evaluate how well the current light tiles represent the alias table distributions.
+     * @param[in] type Light type to evaluate (EmissiveGeometry or Analytic).
+     */
+    LightTileStatistics evalLightTileStatistics(MinimalLightSample::Type type) const;
+
+    /**
+     * Get the light tiles created by createLightTiles() and updateLightTiles().
+     */
+    const std::vector<LightSample>& getLightTiles() const { return mLightTiles; }
+
+    /**
+     * Generate the initial candidates for all pixels. Mirrors InitialSampling.slang.
+     * createLightTiles() must have been called for the same frame.
+     */
+    void generateInitialCandidates(const SurfaceBuffer& surface, uint32_t frameCount, std::vector<PackedReservoir>& reservoirs) const;
+
+    /**
+     * Combine the current reservoirs with the reservoirs of the previous frame. Mirrors TemporalReuse.slang.
+     */
+    void temporalReuse(
+        const SurfaceBuffer& surface,
+        const SurfaceBuffer& prevSurface,
+        uint32_t frameCount,
+        const std::vector<PackedReservoir>& prevReservoirs,
+        std::vector<PackedReservoir>& reservoirs
+    ) const;
+
+    /**
+     * Run a single spatial reuse iteration. Mirrors SpatialReuse.slang.
+     * @param[in] iteration Index of the spatial reuse iteration. Each iteration uses its own random numbers.
+     */
+    void spatialReuse(
+        const SurfaceBuffer& surface,
+        uint32_t frameCount,
+        uint32_t iteration,
+        const std::vector<PackedReservoir>& reservoirs,
+        std::vector<PackedReservoir>& outReservoirs
+    ) const;
+
+    /**
+     * Run a full frame: light tiles, initial candidates and the reuse passes enabled by the parameters.
+     * @param[in] prevSurface Surface data of the previous frame, or nullptr to disable temporal reuse.
+     * @param[in,out] reservoirs On input the reservoirs of the previous frame (ignored without temporal reuse), on output the final reservoirs.
+     */
+    void executeFrame(const SurfaceBuffer& surface, const SurfaceBuffer* prevSurface, uint32_t frameCount, std::vector<PackedReservoir>& reservoirs);
+
+    /**
+     * Evaluate the per-pixel estimate targetPDF(y) * W of the reservoirs.
+     * The target PDF is the luminance of the integrand, so this is an estimate of the luminance of the reflected direct light.
+     */
+    void evalEstimate(const SurfaceBuffer& surface, const std::vector<PackedReservoir>& reservoirs, std::vector<float>& estimate) const;
+
+    /**
+     * Evaluate the per-pixel brute-force reference of the integral estimated by evalEstimate().
+     * @param[in] samplesPerTriangleDim Each triangle is integrated with a stratified grid of samplesPerTriangleDim^2 samples.
+     */
+    void evalReference(const SurfaceBuffer& surface, uint32_t samplesPerTriangleDim, std::vector<float>& reference) const;
+
+    /**
+     * Run a number of frames on a static surface and compare the frame-averaged estimate to the brute-force reference.
+     * @param[in] frameCount Number of frames to run.
+     * @param[in] useTemporalReuse If true, reservoirs are carried over between frames.
+     * @param[in] samplesPerTriangleDim Stratification of the reference, see evalReference().
+     */
+    Statistics evalStatistics(const SurfaceBuffer& surface, uint32_t frameCount, bool useTemporalReuse, uint32_t samplesPerTriangleDim = 16);
+
+    /**
+     * Get the light sample for a minimal light sample. Mirrors LightSampler::getLightSample().
+     */
+    LightSample getLightSample(const MinimalLightSample& minLightSample) const;
+
+    /**
+     * Evaluate the target PDF of a light sample at a surface. Mirrors SurfaceData::evalTargetPDF().
+     */
+    float evalTargetPDF(const SurfaceBuffer& surface, uint32_t index, const LightSample& lightSample) const;
+
+private:
+    Params mParams;
+    std::vector<EmissiveTriangle> mTriangles;
+    std::vector<PointLight> mPointLights;
+    std::unique_ptr<AliasTable> mpEmissiveGeometryAliasTable;
+    std::unique_ptr<AliasTable> mpAnalyticLightsAliasTable;
+
+    uint3 mLightTileSampleCounts = uint3(0);
+    std::vector<LightSample> mLightTiles;
+};
+} // namespace Falcor
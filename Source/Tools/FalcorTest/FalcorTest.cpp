@@ -58,6 +58,19 @@ int runMain(int argc, char** argv)
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag enableAftermathFlag(parser, "", "Enable Aftermath GPU crash dump.", {"enable-aftermath"});
+    args::Flag benchmarkFlag(parser, "", "Run the benchmarks instead of the unit tests.", {'b', "benchmark"});
+    args::ValueFlag<uint32_t> benchmarkRepetitionsFlag(
+        parser, "N", "Number of measured benchmark repetitions (default: 10).", {"benchmark-repetitions"}
+    );
+    args::ValueFlag<uint32_t> benchmarkWarmupFlag(parser, "N", "Number of benchmark warmup runs (default: 1).", {"benchmark-warmup"});
+    args::ValueFlag<double> benchmarkMinTimeFlag(
+        parser, "ms", "Minimum time of a benchmark repetition in milliseconds (default: 10).", {"benchmark-min-time"}
+    );
+    args::ValueFlag<std::string> benchmarkReportFlag(parser, "path", "Benchmark JSON report output file.", {"benchmark-report"});
+    args::ValueFlag<std::string> benchmarkBaselineFlag(parser, "path", "Benchmark JSON report to compare against.", {"benchmark-baseline"});
+    args::ValueFlag<double> benchmarkThresholdFlag(
+        parser, "percent", "Maximum allowed regression of the median time over the baseline (default: 10).", {"benchmark-threshold"}
+    );
 
     args::CompletionFlag completionFlag(parser, {"complete"});
 
@@ -130,6 +143,21 @@ int runMain(int argc, char** argv)
     if (repeatFlag)
         options.repeat = args::get(repeatFlag);
 
+    if (benchmarkFlag)
+        options.benchmarks = true;
+    if (benchmarkRepetitionsFlag)
+        options.benchmarkOptions.repetitions = args::get(benchmarkRepetitionsFlag);
+    if (benchmarkWarmupFlag)
+        options.benchmarkOptions.warmupRepetitions = args::get(benchmarkWarmupFlag);
+    if (benchmarkMinTimeFlag)
+        options.benchmarkOptions.minRepetitionTimeMS = args::get(benchmarkMinTimeFlag);
+    if (benchmarkReportFlag)
+        options.benchmarkOptions.jsonReportPath = args::get(benchmarkReportFlag);
+    if (benchmarkBaselineFlag)
+        options.benchmarkOptions.baselinePath = args::get(benchmarkBaselineFlag);
+    if (benchmarkThresholdFlag)
+        options.benchmarkOptions.regressionThreshold = args::get(benchmarkThresholdFlag) / 100.0;
+
     if (listTestSuites || listTestCases || listTags)
     {
         std::vector<unittest::Test> tests = unittest::enumerateTests();
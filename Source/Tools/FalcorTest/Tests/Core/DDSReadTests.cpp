@@ -60,6 +60,8 @@ void testDDS(GPUUnitTestContext& ctx, const std::string& testName, ResourceForma
     if (expectLoadFailure)
     {
         EXPECT(pDDSTex == nullptr);
+        // Loading through the generic path reports the failure instead of throwing.
+        EXPECT(Texture::createFromFile(pDevice, ddsPath, false, false) == nullptr);
     }
     else
     {
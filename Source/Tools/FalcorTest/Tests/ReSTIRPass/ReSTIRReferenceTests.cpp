@@ -0,0 +1,328 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "ReSTIRPass/Reference/ReSTIRReference.h"
+
+namespace Falcor
+{
+namespace
+{
+using Reference = ReSTIRReference;
+
+/// Create a floor seen from above, lit by a few emissive quads and point lights. A border of pixels is invalid (background).
+Reference::SurfaceBuffer createSurface(uint2 frameDim)
+{
+    Reference::SurfaceBuffer surface;
+    surface.resize(frameDim);
+    surface.cameraPosition = float3(0.f, 5.f, 0.f);
+
+    for (uint32_t y = 0; y < frameDim.y; y++)
+    {
+        for (uint32_t x = 0; x < frameDim.x; x++)
+        {
+            uint32_t i = y * frameDim.x + x;
+            if (x < 2 || y < 2)
+                continue;
+            float2 uv = (float2(float(x), float(y)) + 0.5f) / float2(frameDim);
+            float3 position = float3(uv.x * 8.f - 4.f, 0.f, uv.y * 8.f - 4.f);
+            surface.position[i] = position;
+            surface.normal[i] = float3(0.f, 1.f, 0.f);
+            surface.diffuseWeight[i] = 0.5f + 0.3f * uv.x;
+            surface.specularWeight[i] = 0.04f;
+            surface.specularRoughness[i] = 0.3f + 0.5f * uv.y;
+            surface.depth[i] = length(position - surface.cameraPosition);
+        }
+    }
+    return surface;
+}
+
+Reference createReference(const Reference::Params& params)
+{
+    std::vector<Reference::EmissiveTriangle> triangles;
+    auto addQuad = [&](float3 center, float size, float3 radiance)
+    {
+        float3 p[4] = {
+            center + float3(-size, 0.f, -size),
+            center + float3(size, 0.f, -size),
+            center + float3(size, 0.f, size),
+            center + float3(-size, 0.f, size),
+        };
+        for (uint32_t t = 0; t < 2; t++)
+        {
+            Reference::EmissiveTriangle triangle;
+            triangle.posW[0] = p[0];
+            triangle.posW[1] = p[t + 1];
+            triangle.posW[2] = p[t + 2];
+            triangle.normal = float3(0.f, -1.f, 0.f);
+            triangle.area = 2.f * size * size;
+            triangle.averageRadiance = radiance;
+            triangles.push_back(triangle);
+        }
+    };
+    addQuad(float3(-2.f, 2.f, -1.f), 0.5f, float3(10.f));
+    addQuad(float3(1.f, 3.f, 2.f), 1.f, float3(2.f, 4.f, 8.f));
+    addQuad(float3(2.f, 1.5f, -2.f), 0.25f, float3(40.f, 20.f, 10.f));
+
+    std::vector<Reference::PointLight> pointLights = {
+        {float3(0.f, 2.f, 0.f), float3(5.f)},
+        {float3(-3.f, 1.f, 3.f), float3(2.f, 1.f, 1.f)},
+    };
+
+    return Reference(params, std::move(triangles), std::move(pointLights), 1234);
+}
+
+Reference::Params createParams(ReSTIRBiasCorrection biasCorrection, uint32_t spatialIterationCount)
+{
+    Reference::Params params;
+    params.lightTileSize = 256;
+    params.lightTileCount = 16;
+    params.emissiveLightCandidateCount = 8;
+    params.analyticLightCandidateCount = 2;
+    params.biasCorrection = biasCorrection;
+    params.spatialIterationCount = spatialIterationCount;
+    params.spatialReuseSampleRadius = 8.f;
+    return params;
+}
+
+/// Create a reference with many emissive triangles of varying power, to evaluate the light tile distribution.
+Reference createManyLightsReference(LightTileSampling lightTileSampling)
+{
+    Reference::Params params = createParams(ReSTIRBiasCorrection::Off, 0);
+    params.lightTileSampling = lightTileSampling;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    std::vector<Reference::EmissiveTriangle> triangles(64);
+    for (auto& triangle : triangles)
+    {
+        float3 center = float3(dist(rng) * 8.f - 4.f, 2.f + dist(rng), dist(rng) * 8.f - 4.f);
+        triangle.posW[0] = center;
+        triangle.posW[1] = center + float3(0.2f, 0.f, 0.f);
+        triangle.posW[2] = center + float3(0.f, 0.f, 0.2f);
+        triangle.normal = float3(0.f, -1.f, 0.f);
+        triangle.area = 0.02f;
+        triangle.averageRadiance = float3(1.f + 20.f * dist(rng));
+    }
+    std::vector<Reference::PointLight> pointLights = {{float3(0.f, 2.f, 0.f), float3(5.f)}};
+
+    return Reference(params, std::move(triangles), std::move(pointLights), 1234);
+}
+
+const uint2 kFrameDim = uint2(48, 32);
+} // namespace
+
+CPU_TEST(ReSTIRReference_ReservoirPacking)
+{
+    Reference::Reservoir reservoir;
+    reservoir.sample = Reference::MinimalLightSample::create(Reference::MinimalLightSample::Type::Analytic, 17, float2(0.25f, 0.5f));
+    reservoir.W = 3.5f;
+    reservoir.M = 7;
+
+    Reference::Reservoir unpacked = Reference::Reservoir::unpack(reservoir.pack());
+    EXPECT(unpacked.sample.getType() == Reference::MinimalLightSample::Type::Analytic);
+    EXPECT_EQ(unpacked.sample.getIndex(), 17u);
+    EXPECT_LE(std::abs(unpacked.sample.position.x - 0.25f), 1e-4f);
+    EXPECT_LE(std::abs(unpacked.sample.position.y - 0.5f), 1e-4f);
+    EXPECT_EQ(unpacked.W, 3.5f);
+    EXPECT_EQ(unpacked.M, 7u);
+
+    // Reservoirs with invalid weights are discarded.
+    reservoir.W = std::numeric_limits<float>::infinity();
+    unpacked = Reference::Reservoir::unpack(reservoir.pack());
+    EXPECT_EQ(unpacked.W, 0.f);
+    EXPECT_EQ(unpacked.M, 0u);
+}
+
+CPU_TEST(ReSTIRReference_LightTiles)
+{
+    Reference reference = createReference(createParams(ReSTIRBiasCorrection::Off, 0));
+    const Reference::Params& params = reference.getParams();
+
+    // Same split as ReSTIRPass: 8 of 10 candidates are emissive.
+    uint3 counts = reference.getLightTileSampleCounts();
+    EXPECT_EQ(counts.x, 204u);
+    EXPECT_EQ(counts.y, 0u);
+    EXPECT_EQ(counts.x + counts.y + counts.z, params.lightTileSize);
+
+    reference.createLightTiles(3);
+    const auto& tiles = reference.getLightTiles();
+    ASSERT_EQ(tiles.size(), size_t(params.lightTileSize) * params.lightTileCount);
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        uint32_t inTileIndex = uint32_t(i % params.lightTileSize);
+        auto expectedType =
+            inTileIndex < counts.x ? Reference::MinimalLightSample::Type::EmissiveGeometry : Reference::MinimalLightSample::Type::Analytic;
+        EXPECT(tiles[i].minLightSample.getType() == expectedType);
+        EXPECT_GT(tiles[i].pdf, 0.f);
+    }
+}
+
+CPU_TEST(ReSTIRReference_LightTileSampling)
+{
+    Reference independent = createManyLightsReference(LightTileSampling::Independent);
+    Reference stratified = createManyLightsReference(LightTileSampling::Stratified);
+
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        independent.createLightTiles(frame);
+        stratified.createLightTiles(frame);
+
+        auto independentStats = independent.evalLightTileStatistics(Reference::MinimalLightSample::Type::EmissiveGeometry);
+        auto stratifiedStats = stratified.evalLightTileStatistics(Reference::MinimalLightSample::Type::EmissiveGeometry);
+        EXPECT_EQ(independentStats.lightCount, 64u);
+        EXPECT_EQ(independentStats.sampleCount, stratifiedStats.sampleCount);
+
+        // Both sample the alias table distribution, the stratified tiles do so more evenly.
+        EXPECT_LT(independentStats.pdfError, 0.1);
+        EXPECT_LT(stratifiedStats.pdfError, 0.04);
+        EXPECT_LE(stratifiedStats.pdfError, independentStats.pdfError) << "frame=" << frame;
+        EXPECT_GE(stratifiedStats.coverage, independentStats.coverage) << "frame=" << frame;
+    }
+}
+
+CPU_TEST(ReSTIRReference_IncrementalLightTiles)
+{
+    Reference reference = createReference(createParams(ReSTIRBiasCorrection::Off, 0));
+    const Reference::Params& params = reference.getParams();
+
+    reference.createLightTiles(0);
+    auto tiles0 = reference.getLightTiles();
+    reference.createLightTiles(1);
+    auto tiles1 = reference.getLightTiles();
+
+    // Refresh four tiles, wrapping around at the end of the tile buffer.
+    reference.createLightTiles(0);
+    const uint32_t tileOffset = params.lightTileCount - 2;
+    reference.updateLightTiles(1, tileOffset, 4);
+    const auto& tiles = reference.getLightTiles();
+
+    for (uint32_t tileIndex = 0; tileIndex < params.lightTileCount; tileIndex++)
+    {
+        bool updated = tileIndex >= tileOffset || tileIndex < 2;
+        const auto& expected = updated ? tiles1 : tiles0;
+        for (uint32_t i = 0; i < params.lightTileSize; i++)
+        {
+            uint32_t bufferIndex = tileIndex * params.lightTileSize + i;
+            EXPECT_EQ(tiles[bufferIndex].minLightSample.typeIndex, expected[bufferIndex].minLightSample.typeIndex);
+            EXPECT_EQ(tiles[bufferIndex].pdf, expected[bufferIndex].pdf);
+        }
+    }
+}
+
+CPU_TEST(ReSTIRReference_Deterministic)
+{
+    Reference::SurfaceBuffer surface = createSurface(kFrameDim);
+    Reference reference = createReference(createParams(ReSTIRBiasCorrection::MIS, 1));
+
+    std::vector<PackedReservoir> reservoirs[2];
+    for (uint32_t run = 0; run < 2; run++)
+    {
+        reference.executeFrame(surface, nullptr, 0, reservoirs[run]);
+        reference.executeFrame(surface, &surface, 1, reservoirs[run]);
+    }
+
+    ASSERT_EQ(reservoirs[0].size(), reservoirs[1].size());
+    for (size_t i = 0; i < reservoirs[0].size(); i++)
+    {
+        EXPECT_EQ(reservoirs[0][i].packedLightSample.typeIndex, reservoirs[1][i].packedLightSample.typeIndex);
+        EXPECT_EQ(reservoirs[0][i].packedLightSample.position, reservoirs[1][i].packedLightSample.position);
+        EXPECT_EQ(reservoirs[0][i].W, reservoirs[1][i].W);
+        EXPECT_EQ(reservoirs[0][i].M, reservoirs[1][i].M);
+    }
+}
+
+CPU_TEST(ReSTIRReference_Unbiased)
+{
+    Reference::SurfaceBuffer surface = createSurface(kFrameDim);
+
+    struct Config
+    {
+        ReSTIRBiasCorrection biasCorrection;
+        uint32_t spatialIterationCount;
+        bool useTemporalReuse;
+        uint32_t frameCount;
+        double maxRelativeBias;
+    };
+    // The surface is static, so the reused reservoirs have the same target function as the current pixel,
+    // and RIS with spatial reuse is unbiased regardless of the bias correction mode.
+    // With temporal reuse, the frames are strongly correlated and the estimate converges slowly. The spatiotemporal
+    // case therefore only catches gross bias, e.g., from reusing the random numbers of the previous passes.
+    const Config configs[] = {
+        {ReSTIRBiasCorrection::Off, 0, false, 64, 0.02},
+        {ReSTIRBiasCorrection::Naive, 1, false, 64, 0.02},
+        {ReSTIRBiasCorrection::MIS, 2, false, 64, 0.02},
+        {ReSTIRBiasCorrection::Off, 0, true, 64, 0.02},
+        {ReSTIRBiasCorrection::Naive, 0, true, 64, 0.02},
+        {ReSTIRBiasCorrection::MIS, 0, true, 64, 0.02},
+        {ReSTIRBiasCorrection::MIS, 2, true, 256, 0.1},
+    };
+
+    for (const auto& config : configs)
+    {
+        Reference reference = createReference(createParams(config.biasCorrection, config.spatialIterationCount));
+        Reference::Statistics stats = reference.evalStatistics(surface, config.frameCount, config.useTemporalReuse, 8);
+        EXPECT_GT(stats.referenceSum, 0.0);
+        EXPECT_LT(std::abs(stats.relativeBias), config.maxRelativeBias)
+            << "biasCorrection=" << enumToString(config.biasCorrection) << " spatialIterations=" << config.spatialIterationCount
+            << " temporal=" << config.useTemporalReuse;
+
+        // Frames are correlated with temporal reuse, so the standard error is underestimated and only checked without it.
+        if (!config.useTemporalReuse)
+        {
+            EXPECT_LT(std::abs(stats.getZScore()), 4.0) << "biasCorrection=" << enumToString(config.biasCorrection)
+                                                        << " relativeBias=" << stats.relativeBias;
+        }
+    }
+}
+
+void benchmarkFrame(CPUBenchmarkContext& ctx, ReSTIRBiasCorrection biasCorrection)
+{
+    Reference::SurfaceBuffer surface = createSurface(uint2(256, 256));
+    Reference reference = createReference(createParams(biasCorrection, 1));
+    std::vector<PackedReservoir> reservoirs;
+    uint32_t frameCount = 0;
+
+    ctx.setItemsPerIteration(surface.getPixelCount());
+    ctx.measure([&]() { reference.executeFrame(surface, &surface, frameCount++, reservoirs); });
+}
+
+CPU_BENCHMARK(ReSTIRReference_FrameBiasCorrectionOff)
+{
+    benchmarkFrame(ctx, ReSTIRBiasCorrection::Off);
+}
+
+CPU_BENCHMARK(ReSTIRReference_FrameBiasCorrectionNaive)
+{
+    benchmarkFrame(ctx, ReSTIRBiasCorrection::Naive);
+}
+
+CPU_BENCHMARK(ReSTIRReference_FrameBiasCorrectionMIS)
+{
+    benchmarkFrame(ctx, ReSTIRBiasCorrection::MIS);
+}
+} // namespace Falcor
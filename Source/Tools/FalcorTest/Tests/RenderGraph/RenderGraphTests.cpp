@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/RenderGraph.h"
+
+namespace Falcor
+{
+namespace
+{
+/// Pass with an optional input and an output of configurable format, counting how often it is compiled.
+class CountingPass : public RenderPass
+{
+public:
+    FALCOR_PLUGIN_CLASS(CountingPass, "CountingPass", "Test pass counting compilations.");
+
+    CountingPass(ref<Device> pDevice) : RenderPass(pDevice) {}
+
+    RenderPassReflection reflect(const CompileData& compileData) override
+    {
+        RenderPassReflection r;
+        r.addInput("src", "Input").flags(RenderPassReflection::Field::Flags::Optional);
+        r.addOutput("dst", "Output").format(mFormat);
+        return r;
+    }
+
+    void compile(RenderContext* pRenderContext, const CompileData& compileData) override { compileCount++; }
+
+    void execute(RenderContext* pRenderContext, const RenderData& renderData) override {}
+
+    /// Change a setting that doesn't affect the reflection.
+    void touch() { requestRecompile(); }
+
+    void setFormat(ResourceFormat format)
+    {
+        mFormat = format;
+        requestRecompile();
+    }
+
+    uint32_t compileCount = 0;
+
+private:
+    ResourceFormat mFormat = ResourceFormat::RGBA32Float;
+};
+} // namespace
+
+GPU_TEST(RenderGraph_IncrementalRecompile)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    // Graph with two independent chains A -> B -> C and D.
+    ref<RenderGraph> pGraph = RenderGraph::create(pDevice, "IncrementalRecompile");
+    ref<CountingPass> pass[4];
+    const char* names[4] = {"A", "B", "C", "D"};
+    for (size_t i = 0; i < 4; i++)
+    {
+        pass[i] = make_ref<CountingPass>(pDevice);
+        pGraph->addPass(pass[i], names[i]);
+    }
+    pGraph->addEdge("A.dst", "B.src");
+    pGraph->addEdge("B.dst", "C.src");
+    pGraph->markOutput("C.dst");
+    pGraph->markOutput("D.dst");
+
+    ref<Fbo> pTargetFbo = Fbo::create2D(pDevice, 16, 16, ResourceFormat::RGBA8Unorm);
+    pGraph->onResize(pTargetFbo.get());
+
+    auto getCompileCounts = [&]()
+    {
+        std::vector<uint32_t> counts;
+        for (const auto& p : pass)
+            counts.push_back(p->compileCount);
+        return counts;
+    };
+
+    // Full compilation.
+    ASSERT(pGraph->compile(pRenderContext));
+    auto stats = pGraph->getCompileStats();
+    EXPECT(!stats.incremental);
+    EXPECT_EQ(stats.passCount, 4);
+    EXPECT_EQ(stats.compiledPassCount, 4);
+    EXPECT_EQ(stats.resourceCount, 4); // A.dst/B.src, B.dst/C.src, C.dst and D.dst
+    EXPECT_EQ(stats.allocatedResourceCount, stats.resourceCount);
+    EXPECT(getCompileCounts() == std::vector<uint32_t>({1, 1, 1, 1}));
+
+    ref<Resource> pOutputC = pGraph->getOutput("C.dst");
+    ref<Resource> pOutputD = pGraph->getOutput("D.dst");
+
+    // A change that keeps the reflection only recompiles the pass itself and keeps all resources.
+    pass[3]->touch();
+    ASSERT(pGraph->compile(pRenderContext));
+    stats = pGraph->getCompileStats();
+    EXPECT(stats.incremental);
+    EXPECT_EQ(stats.compiledPassCount, 1);
+    EXPECT_EQ(stats.allocatedResourceCount, 0);
+    EXPECT(getCompileCounts() == std::vector<uint32_t>({1, 1, 1, 2}));
+    EXPECT(pGraph->getOutput("C.dst") == pOutputC);
+    EXPECT(pGraph->getOutput("D.dst") == pOutputD);
+
+    // A reflection change recompiles the connected passes and only reallocates the changed resource.
+    pass[0]->setFormat(ResourceFormat::RGBA16Float);
+    ASSERT(pGraph->compile(pRenderContext));
+    stats = pGraph->getCompileStats();
+    EXPECT(stats.incremental);
+    EXPECT_EQ(stats.compiledPassCount, 2);
+    EXPECT_EQ(stats.allocatedResourceCount, 1);
+    EXPECT(getCompileCounts() == std::vector<uint32_t>({2, 2, 1, 2}));
+    EXPECT(pGraph->getOutput("C.dst") == pOutputC);
+    EXPECT(pGraph->getOutput("D.dst") == pOutputD);
+
+    // Changing the graph triggers a full compilation.
+    pGraph->unmarkOutput("D.dst");
+    ASSERT(pGraph->compile(pRenderContext));
+    stats = pGraph->getCompileStats();
+    EXPECT(!stats.incremental);
+    EXPECT_EQ(stats.passCount, 3);
+    EXPECT(getCompileCounts() == std::vector<uint32_t>({3, 3, 2, 2}));
+}
+} // namespace Falcor
@@ -66,6 +66,9 @@ void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> spec
     EXPECT_EQ(aliasTable.getCount(), weights.size());
     EXPECT_EQ(aliasTable.getWeightSum(), weightSum);
 
+    // Tables created with a device don't keep a CPU copy.
+    EXPECT(!aliasTable.hasCpuData());
+
     // Test sampling the alias table.
     {
         const uint32_t samplesPerWeight = 10000;
@@ -146,4 +149,64 @@ GPU_TEST(AliasTable)
     testAliasTable(ctx, 100);
     testAliasTable(ctx, 1000);
 }
+
+CPU_TEST(AliasTableCpu)
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+
+    const uint32_t N = 100;
+    std::vector<float> weights(N);
+    for (auto& weight : weights)
+        weight = uniform(rng);
+    weights[7] = 0.f;
+
+    double weightSum = 0.0;
+    for (const auto& weight : weights)
+        weightSum += weight;
+
+    // Tables created without a device keep the CPU copy for sampling on the CPU.
+    AliasTable aliasTable(nullptr, weights, rng);
+    EXPECT(aliasTable.hasCpuData());
+    EXPECT_EQ(aliasTable.getCount(), N);
+    for (uint32_t i = 0; i < N; ++i)
+        EXPECT_EQ(aliasTable.getWeight(i), weights[i]);
+
+    // Verify the histogram of the CPU sampling using a chi-square test.
+    const uint32_t samplesPerWeight = 10000;
+    std::vector<double> obsFrequencies(N, 0.0);
+    for (uint32_t i = 0; i < N * samplesPerWeight; ++i)
+    {
+        uint32_t item = aliasTable.sample(float2(uniform(rng), uniform(rng)));
+        EXPECT(item < N);
+        obsFrequencies[item] += 1.0;
+    }
+    EXPECT_EQ(obsFrequencies[7], 0.0);
+
+    std::vector<double> expFrequencies(N);
+    for (uint32_t i = 0; i < N; ++i)
+        expFrequencies[i] = (weights[i] / weightSum) * N * samplesPerWeight;
+
+    const auto& [success, report] = hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), N * samplesPerWeight, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+}
+
+CPU_BENCHMARK(AliasTable_Create)
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    std::vector<float> weights(1 << 20);
+    std::generate(weights.begin(), weights.end(), [&]() { return uniform(rng); });
+
+    ctx.setItemsPerIteration(weights.size());
+    ctx.measure(
+        [&]()
+        {
+            AliasTable aliasTable(nullptr, weights, rng);
+            doNotOptimize(aliasTable);
+        }
+    );
+}
 } // namespace Falcor
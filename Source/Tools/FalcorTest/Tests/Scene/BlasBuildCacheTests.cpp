@@ -0,0 +1,220 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasBuildCache.h"
+#include "Scene/SceneCache.h"
+
+namespace Falcor
+{
+namespace
+{
+BlasBuildRecord makeTriangleRecord(uint32_t triangleCount, bool compaction)
+{
+    BlasGeometryRecord geometry;
+    geometry.type = RtGeometryType::Triangles;
+    geometry.vertexCount = triangleCount * 3;
+    geometry.indexCount = triangleCount * 3;
+    geometry.indexFormat = ResourceFormat::R32Uint;
+
+    BlasBuildRecord record;
+    record.geometries.push_back(geometry);
+    record.buildFlags = compaction ? RtAccelerationStructureBuildFlags::AllowCompaction : RtAccelerationStructureBuildFlags::None;
+    return record;
+}
+
+BlasBuildRecord makeAABBRecord(uint64_t aabbCount)
+{
+    BlasGeometryRecord geometry;
+    geometry.type = RtGeometryType::ProcedurePrimitives;
+    geometry.aabbCount = aabbCount;
+
+    BlasBuildRecord record;
+    record.geometries.push_back(geometry);
+    return record;
+}
+
+void setSizes(BlasBuildRecord& record, uint64_t result, uint64_t scratch, uint64_t final)
+{
+    record.prebuildInfo = {result, scratch, 0};
+    record.finalByteSize = final;
+}
+} // namespace
+
+CPU_TEST(BlasBuildCache_Records)
+{
+    BlasBuildRecord a = makeTriangleRecord(100, true);
+    EXPECT_EQ(a.getPrimitiveCount(), 100);
+    EXPECT(!a.hasSizes());
+
+    // Non-indexed triangles are counted from the vertices.
+    a.geometries[0].indexCount = 0;
+    EXPECT_EQ(a.getPrimitiveCount(), 100);
+
+    a.geometries.push_back(makeAABBRecord(7).geometries[0]);
+    EXPECT_EQ(a.getPrimitiveCount(), 107);
+
+    // Sizes don't affect the input comparison.
+    BlasBuildRecord b = a;
+    setSizes(b, 1000, 500, 800);
+    EXPECT(b.hasSizes());
+    EXPECT(a.hasSameInputs(b));
+    EXPECT(a != b);
+
+    b.geometries[1].aabbCount = 8;
+    EXPECT(!a.hasSameInputs(b));
+
+    // Build sizes are padded and the scratch covers updates.
+    b.prebuildInfo = {1000, 300, 600};
+    BlasBuildSize size = getBlasBuildSize(b);
+    EXPECT_EQ(size.resultByteSize, 1024);
+    EXPECT_EQ(size.scratchByteSize, 768);
+}
+
+CPU_TEST(BlasBuildCache_Estimator)
+{
+    BlasSizeEstimator estimator;
+
+    // Estimates grow with the primitive count and are aligned.
+    BlasBuildRecord small = makeTriangleRecord(1000, true);
+    BlasBuildRecord large = makeTriangleRecord(100000, true);
+    BlasBuildSize smallSize = estimator.estimateBuildSize(small);
+    BlasBuildSize largeSize = estimator.estimateBuildSize(large);
+    EXPECT_LT(smallSize.resultByteSize, largeSize.resultByteSize);
+    EXPECT_LT(smallSize.scratchByteSize, largeSize.scratchByteSize);
+    EXPECT_EQ(largeSize.resultByteSize % kAccelerationStructureByteAlignment, 0);
+    EXPECT_LE(estimator.estimateFinalSize(large), largeSize.resultByteSize);
+
+    // Without compaction the final size is the result size.
+    BlasBuildRecord uncompacted = makeTriangleRecord(100000, false);
+    EXPECT_EQ(estimator.estimateFinalSize(uncompacted), estimator.estimateBuildSize(uncompacted).resultByteSize);
+
+    // Calibrate with observed sizes of 40 B result, 20 B scratch and 10 B compacted per triangle.
+    std::vector<BlasBuildRecord> observed;
+    for (uint32_t count : {100000u, 200000u})
+    {
+        BlasBuildRecord record = makeTriangleRecord(count, true);
+        setSizes(record, 4096 + 40ull * count, 4096 + 20ull * count, 4096 + 10ull * count);
+        observed.push_back(record);
+    }
+    estimator.calibrate(observed);
+
+    BlasBuildRecord query = makeTriangleRecord(300000, true);
+    BlasBuildSize querySize = estimator.estimateBuildSize(query);
+    EXPECT_GE(querySize.resultByteSize, 4096 + 40ull * 300000);
+    EXPECT_LT(querySize.resultByteSize, 4096 + 41ull * 300000);
+    EXPECT_GE(querySize.scratchByteSize, 4096 + 20ull * 300000);
+    EXPECT_LT(querySize.scratchByteSize, 4096 + 21ull * 300000);
+    EXPECT_GE(estimator.estimateFinalSize(query), 4096 + 10ull * 300000);
+    EXPECT_LT(estimator.estimateFinalSize(query), 4096 + 11ull * 300000);
+
+    // AABB rates are not affected by triangle records.
+    BlasSizeEstimator defaultEstimator;
+    BlasBuildRecord aabbs = makeAABBRecord(50000);
+    EXPECT_EQ(estimator.estimateBuildSize(aabbs).resultByteSize, defaultEstimator.estimateBuildSize(aabbs).resultByteSize);
+}
+
+CPU_TEST(BlasBuildCache_MemoryReport)
+{
+    const uint64_t kMB = 1ull << 20;
+
+    BlasBuildCache cache;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        BlasBuildRecord record = makeTriangleRecord(100000, true);
+        setSizes(record, 64 * kMB, 32 * kMB, 16 * kMB);
+        cache.blases.push_back(record);
+    }
+    cache.blases.push_back(makeTriangleRecord(100000, true));
+
+    BlasMemoryReport report = computeBlasMemoryReport(cache, 256 * kMB);
+    EXPECT_EQ(report.blasCount, 9);
+    EXPECT_EQ(report.estimatedBlasCount, 1);
+    EXPECT_EQ(report.primitiveCount, 900000);
+    EXPECT_GE(report.groupCount, 4);
+
+    // The estimate for the last BLAS is calibrated on the others.
+    EXPECT_GE(report.finalByteSize, 9 * 16 * kMB);
+    EXPECT_LT(report.finalByteSize, 9 * 16 * kMB + kMB);
+
+    // Every BLAS fits the budget, so no group exceeds it.
+    EXPECT_GE(report.buildByteSize, 96 * kMB);
+    EXPECT_LE(report.buildByteSize, 256 * kMB);
+
+    // An empty cache gives an empty report.
+    BlasMemoryReport empty = computeBlasMemoryReport(BlasBuildCache{});
+    EXPECT_EQ(empty.blasCount, 0);
+    EXPECT_EQ(empty.groupCount, 0);
+    EXPECT_EQ(empty.buildByteSize, 0);
+}
+
+CPU_TEST(BlasBuildCache_File)
+{
+    const std::filesystem::path prevDirectory = SceneCache::getCacheDirectory();
+    const std::filesystem::path directory = getTempFilePath();
+    SceneCache::setCacheDirectory(directory);
+
+    SceneCache::Key key;
+    for (size_t i = 0; i < key.size(); i++)
+        key[i] = (uint8_t)i;
+
+    BlasBuildCache cache;
+    cache.deviceName = "TestDevice";
+    for (uint32_t i = 1; i <= 3; i++)
+    {
+        BlasBuildRecord record = makeTriangleRecord(i * 100, true);
+        setSizes(record, i * 1000, i * 500, i * 800);
+        cache.blases.push_back(record);
+    }
+    cache.blases.push_back(makeAABBRecord(7));
+
+    // Round trip, overwriting an existing file.
+    SceneCache::writeBlasBuildCache(BlasBuildCache{}, key);
+    SceneCache::writeBlasBuildCache(cache, key);
+    auto readCache = SceneCache::readBlasBuildCache(key);
+    ASSERT(readCache.has_value());
+    EXPECT(*readCache == cache);
+
+    // The final file is left in the directory next to the cache index, no temporary files.
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        EXPECT(entry.path().extension() != ".tmp") << entry.path();
+        if (entry.path().extension() == ".blas")
+            files.push_back(entry.path());
+    }
+    ASSERT_EQ(files.size(), 1);
+
+    // Truncated files are ignored.
+    const auto fileSize = std::filesystem::file_size(files[0]);
+    std::filesystem::resize_file(files[0], fileSize - 8);
+    EXPECT(!SceneCache::readBlasBuildCache(key).has_value());
+
+    SceneCache::setCacheDirectory(prevDirectory);
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
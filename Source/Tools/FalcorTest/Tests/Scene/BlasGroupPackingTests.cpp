@@ -0,0 +1,155 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasGroupPacking.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint64_t kMB = 1ull << 20;
+const uint64_t kMaxGroupByteSize = 512 * kMB;
+
+// Verify that each BLAS is in exactly one group, in increasing order within the group.
+void checkGroups(CPUUnitTestContext& ctx, const std::vector<BlasBuildSize>& sizes, const std::vector<std::vector<uint32_t>>& groups)
+{
+    std::vector<uint32_t> count(sizes.size(), 0);
+    for (const auto& group : groups)
+    {
+        EXPECT(!group.empty());
+        EXPECT(std::is_sorted(group.begin(), group.end()));
+        for (uint32_t blasId : group)
+        {
+            ASSERT_LT(blasId, sizes.size());
+            count[blasId]++;
+        }
+    }
+    for (size_t i = 0; i < sizes.size(); i++) EXPECT_EQ(count[i], 1) << "i = " << i;
+}
+
+std::vector<BlasBuildSize> generateSizes(std::mt19937& rng, uint32_t count, uint64_t largeSize, float largeFraction)
+{
+    // Mix of many small BLASes and a few large ones. Scratch sizes vary relative to the result sizes.
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    std::vector<BlasBuildSize> sizes(count);
+    for (auto& size : sizes)
+    {
+        uint64_t base = u(rng) < largeFraction ? (uint64_t)(largeSize * (0.25f + 0.75f * u(rng))) : (uint64_t)(kMB * (0.01f + 4.f * u(rng)));
+        size.resultByteSize = std::max<uint64_t>(256, base & ~255ull);
+        size.scratchByteSize = std::max<uint64_t>(256, (uint64_t)(base * (0.1f + 0.9f * u(rng))) & ~255ull);
+    }
+    return sizes;
+}
+} // namespace
+
+CPU_TEST(BlasGroupPacking_Basic)
+{
+    // Empty input.
+    EXPECT(computeBlasGroupPacking({}, kMaxGroupByteSize, BlasGroupPacking::FirstFitDecreasing).empty());
+
+    // Everything fits in one group.
+    std::vector<BlasBuildSize> sizes = {{kMB, kMB}, {2 * kMB, kMB}, {kMB, 3 * kMB}};
+    auto groups = computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::FirstFitDecreasing);
+    ASSERT_EQ(groups.size(), 1);
+    EXPECT(groups[0] == std::vector<uint32_t>({0, 1, 2}));
+
+    // Sequential packing starts a new group whenever the next BLAS doesn't fit.
+    // First-fit decreasing fills the gaps left by the large BLASes with the small ones.
+    sizes = {{225 * kMB, 75 * kMB}, {225 * kMB, 75 * kMB}, {150 * kMB, 50 * kMB}, {150 * kMB, 50 * kMB}};
+    auto sequential = computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::Sequential);
+    auto ffd = computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::FirstFitDecreasing);
+    checkGroups(ctx, sizes, sequential);
+    checkGroups(ctx, sizes, ffd);
+    EXPECT_EQ(sequential.size(), 3);
+    EXPECT_EQ(ffd.size(), 2);
+
+    // A BLAS larger than the budget is placed in its own group.
+    sizes = {{kMB, kMB}, {1024 * kMB, 256 * kMB}, {kMB, kMB}};
+    groups = computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::FirstFitDecreasing);
+    checkGroups(ctx, sizes, groups);
+    ASSERT_EQ(groups.size(), 2);
+    EXPECT(groups[0] == std::vector<uint32_t>({0, 2}));
+    EXPECT(groups[1] == std::vector<uint32_t>({1}));
+}
+
+CPU_TEST(BlasGroupPacking_Synthetic)
+{
+    struct Distribution
+    {
+        const char* name;
+        uint32_t count;
+        uint64_t largeSize;
+        float largeFraction;
+    };
+    const Distribution distributions[] = {
+        {"small", 20000, 0, 0.f},
+        {"mixed", 5000, 256 * kMB, 0.02f},
+        {"large", 200, 400 * kMB, 0.3f},
+    };
+
+    std::mt19937 rng(42);
+    for (const auto& dist : distributions)
+    {
+        auto sizes = generateSizes(rng, dist.count, dist.largeSize, dist.largeFraction);
+
+        auto sequential = computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::Sequential);
+        auto ffd = computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::FirstFitDecreasing);
+        checkGroups(ctx, sizes, sequential);
+        checkGroups(ctx, sizes, ffd);
+
+        // The packing is deterministic.
+        EXPECT(ffd == computeBlasGroupPacking(sizes, kMaxGroupByteSize, BlasGroupPacking::FirstFitDecreasing)) << dist.name;
+
+        auto sequentialStats = computeBlasGroupPackingStats(sizes, sequential);
+        auto ffdStats = computeBlasGroupPackingStats(sizes, ffd);
+
+        // Peak memory stays within the budget unless a single BLAS exceeds it.
+        uint64_t maxResult = 0, maxScratch = 0;
+        for (const auto& size : sizes)
+        {
+            maxResult = std::max(maxResult, size.resultByteSize);
+            maxScratch = std::max(maxScratch, size.scratchByteSize);
+        }
+        EXPECT_LE(ffdStats.getPeakByteSize(), std::max(kMaxGroupByteSize, maxResult + maxScratch)) << dist.name;
+        EXPECT_LE(ffdStats.maxScratchByteSize, sequentialStats.maxScratchByteSize) << dist.name;
+        EXPECT_LE(ffdStats.getPeakByteSize(), sequentialStats.getPeakByteSize()) << dist.name;
+
+        logInfo(
+            "BLAS group packing '{}': sequential {} groups, {} MB peak ({} MB scratch); first-fit decreasing {} groups, {} MB peak ({} MB scratch).",
+            dist.name,
+            sequentialStats.groupCount,
+            sequentialStats.getPeakByteSize() / kMB,
+            sequentialStats.maxScratchByteSize / kMB,
+            ffdStats.groupCount,
+            ffdStats.getPeakByteSize() / kMB,
+            ffdStats.maxScratchByteSize / kMB
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,557 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Curves/CurveTessellation.h"
+#include "Utils/Math/CubicSpline.h"
+#include "Utils/Math/MathHelpers.h"
+#include "Utils/Math/Quaternion.h"
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct Groom
+{
+    std::vector<uint32_t> vertexCounts;
+    std::vector<float3> points;
+    std::vector<float> widths;
+    std::vector<float2> UVs;
+
+    uint32_t getStrandCount() const { return (uint32_t)vertexCounts.size(); }
+};
+
+Groom createGroom(uint32_t strandCount, uint32_t minVertexCount, uint32_t maxVertexCount)
+{
+    std::mt19937 rng(strandCount);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    Groom groom;
+    groom.vertexCounts.resize(strandCount);
+    for (auto& vertexCount : groom.vertexCounts)
+    {
+        vertexCount = minVertexCount + rng() % (maxVertexCount - minVertexCount + 1);
+
+        // Strands grow upwards from a random root. Some control points are duplicated, which the tessellation removes.
+        float3 p(u(rng), 0.f, u(rng));
+        for (uint32_t j = 0; j < vertexCount; j++)
+        {
+            if (j == 1 || (j > 1 && rng() % 8 != 0)) p += float3(0.05f * (u(rng) - 0.5f), 0.05f + 0.05f * u(rng), 0.05f * (u(rng) - 0.5f));
+            groom.points.push_back(p);
+            groom.widths.push_back(0.01f * (1.f - (float)j / vertexCount) + 0.001f);
+            groom.UVs.push_back(float2(u(rng), (float)j / (vertexCount - 1)));
+        }
+    }
+    return groom;
+}
+
+template<typename T>
+bool isEqual(const fast_vector<T>& a, const fast_vector<T>& b, size_t offset = 0)
+{
+    return offset + b.size() <= a.size() && (b.empty() || std::memcmp(a.data() + offset, b.data(), b.size() * sizeof(T)) == 0);
+}
+
+const float4x4 kTransform = float4x4({
+    2.f, 0.f, 0.f, 1.f,
+    0.f, 2.f, 0.f, 0.f,
+    0.f, 0.f, 2.f, -1.f,
+    0.f, 0.f, 0.f, 1.f
+});
+
+/**
+ * Serial curve tessellation as implemented before strands were tessellated in parallel.
+ * It is kept as the reference for the output of CurveTessellation. The only change is the
+ * frame update at the second-to-last control point, which read an uninitialized vector.
+ */
+namespace reference
+{
+const float kMeshCompensationScale = 1.11f;
+
+struct StrandArrays
+{
+    fast_vector<float3> controlPoints;
+    fast_vector<float> widths;
+    fast_vector<float2> UVs;
+    uint32_t vertexCount = 0;
+};
+
+struct SplineCache
+{
+    CubicSpline<float3> optSplinePoints;
+    CubicSpline<float> optSplineWidths;
+    CubicSpline<float2> optSplineUVs;
+    CubicSpline<float3> splinePoints;
+    CubicSpline<float> splineWidths;
+    CubicSpline<float2> splineUVs;
+};
+
+float4 transformSphere(const float4x4& xform, const float4& sphere)
+{
+    float scale = std::sqrt(xform[0][0] * xform[0][0] + xform[0][1] * xform[0][1] + xform[0][2] * xform[0][2]);
+    return float4(transformPoint(xform, sphere.xyz()), sphere.w * scale);
+}
+
+float sanitizeWidth(float w)
+{
+    return std::max(w, (float)std::numeric_limits<float16_t>::min());
+}
+
+void optimizeStrandGeometry(
+    SplineCache& splineCache,
+    const float3* controlPoints,
+    const float* widths,
+    const float2* UVs,
+    StrandArrays& strandArrays,
+    StrandArrays& optimizedStrandArrays,
+    uint32_t pointOffset,
+    uint32_t subdivPerSegment,
+    uint32_t keepOneEveryXVerticesPerStrand,
+    float widthScale
+)
+{
+    strandArrays.controlPoints.clear();
+    strandArrays.UVs.clear();
+    strandArrays.widths.clear();
+
+    for (uint32_t j = 0; j < strandArrays.vertexCount - 1; j++)
+    {
+        if (any(controlPoints[pointOffset + j] != controlPoints[pointOffset + j + 1]))
+        {
+            strandArrays.controlPoints.push_back(controlPoints[pointOffset + j]);
+            strandArrays.widths.push_back(widths[pointOffset + j]);
+            if (UVs)
+                strandArrays.UVs.push_back(UVs[pointOffset + j]);
+        }
+    }
+    strandArrays.controlPoints.push_back(controlPoints[pointOffset + strandArrays.vertexCount - 1]);
+    strandArrays.widths.push_back(widths[pointOffset + strandArrays.vertexCount - 1]);
+    if (UVs)
+        strandArrays.UVs.push_back(UVs[pointOffset + strandArrays.vertexCount - 1]);
+
+    optimizedStrandArrays.vertexCount = static_cast<uint32_t>(strandArrays.controlPoints.size());
+    const uint32_t n = optimizedStrandArrays.vertexCount;
+
+    const auto& splinePoints = splineCache.optSplinePoints.setup(strandArrays.controlPoints.data(), n);
+    const auto& splineWidths = splineCache.optSplineWidths.setup(strandArrays.widths.data(), n);
+
+    uint32_t tmpCount = 0;
+    for (uint32_t j = 0; j < n - 1; j++)
+    {
+        for (uint32_t k = 0; k < subdivPerSegment; k++)
+        {
+            if (tmpCount++ % keepOneEveryXVerticesPerStrand == 0)
+            {
+                float t = (float)k / (float)subdivPerSegment;
+                optimizedStrandArrays.controlPoints.push_back(splinePoints.interpolate(j, t));
+                optimizedStrandArrays.widths.push_back(sanitizeWidth(kMeshCompensationScale * widthScale * splineWidths.interpolate(j, t)));
+            }
+        }
+    }
+    optimizedStrandArrays.controlPoints.push_back(splinePoints.interpolate(n - 2, 1.f));
+    optimizedStrandArrays.widths.push_back(sanitizeWidth(kMeshCompensationScale * widthScale * splineWidths.interpolate(n - 2, 1.f)));
+
+    if (UVs)
+    {
+        const auto& splineUVs = splineCache.optSplineUVs.setup(strandArrays.UVs.data(), n);
+        tmpCount = 0;
+        for (uint32_t j = 0; j < n - 1; j++)
+        {
+            for (uint32_t k = 0; k < subdivPerSegment; k++)
+            {
+                if (tmpCount++ % keepOneEveryXVerticesPerStrand == 0)
+                    optimizedStrandArrays.UVs.push_back(splineUVs.interpolate(j, (float)k / (float)subdivPerSegment));
+            }
+        }
+        optimizedStrandArrays.UVs.push_back(splineUVs.interpolate(n - 2, 1.f));
+    }
+}
+
+void updateCurveFrame(const StrandArrays& strandArrays, float3& fwd, float3& s, float3& t, uint32_t j)
+{
+    const size_t size = strandArrays.controlPoints.size();
+    float3 prevFwd;
+
+    if (j <= 0 || j >= size || size == 2)
+    {
+        prevFwd = fwd;
+    }
+    else if (j == 1)
+    {
+        prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 1]);
+        fwd = normalize(strandArrays.controlPoints[j + 1] - strandArrays.controlPoints[j - 1]);
+    }
+    else if (j < size - 1)
+    {
+        prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 2]);
+        fwd = normalize(strandArrays.controlPoints[j + 1] - strandArrays.controlPoints[j - 1]);
+    }
+    else
+    {
+        prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 2]);
+        fwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 1]);
+    }
+
+    quatf rotQuat = math::quatFromRotationBetweenVectors(prevFwd, fwd);
+    s = mul(rotQuat, s);
+    t = normalize(cross(fwd, s));
+    s = normalize(cross(t, fwd));
+}
+
+CurveTessellation::SweptSphereResult convertToLinearSweptSphere(
+    uint32_t strandCount,
+    const uint32_t* vertexCountsPerStrand,
+    const float3* controlPoints,
+    const float* widths,
+    const float2* UVs,
+    uint32_t subdivPerSegment,
+    uint32_t keepOneEveryXStrands,
+    uint32_t keepOneEveryXVerticesPerStrand,
+    float widthScale,
+    const float4x4& xform
+)
+{
+    CurveTessellation::SweptSphereResult result;
+    result.degree = 1;
+
+    uint32_t pointOffset = 0;
+    StrandArrays strandArrays;
+    StrandArrays optimizedStrandArrays;
+    SplineCache splineCache;
+    for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+    {
+        optimizedStrandArrays = {};
+        strandArrays.vertexCount = vertexCountsPerStrand[i];
+        optimizeStrandGeometry(
+            splineCache, controlPoints, widths, UVs, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment,
+            keepOneEveryXVerticesPerStrand, widthScale
+        );
+        const uint32_t n = optimizedStrandArrays.vertexCount;
+
+        const auto& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), n);
+        const auto& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), n);
+
+        auto addPoint = [&](uint32_t j, float t)
+        {
+            float4 sph = transformSphere(
+                xform, float4(splinePoints.interpolate(j, t), sanitizeWidth(splineWidths.interpolate(j, t) * 0.5f * widthScale))
+            );
+            result.points.push_back(sph.xyz());
+            result.radius.push_back(sph.w);
+        };
+
+        uint32_t tmpCount = 0;
+        for (uint32_t j = 0; j < n - 1; j++)
+        {
+            for (uint32_t k = 0; k < subdivPerSegment; k++)
+            {
+                if (tmpCount++ % keepOneEveryXVerticesPerStrand == 0)
+                {
+                    result.indices.push_back((uint32_t)result.points.size());
+                    addPoint(j, (float)k / (float)subdivPerSegment);
+                }
+            }
+        }
+        addPoint(n - 2, 1.f);
+
+        if (UVs)
+        {
+            const auto& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), n);
+            tmpCount = 0;
+            for (uint32_t j = 0; j < n - 1; j++)
+            {
+                for (uint32_t k = 0; k < subdivPerSegment; k++)
+                {
+                    if (tmpCount++ % keepOneEveryXVerticesPerStrand == 0)
+                        result.texCrds.push_back(splineUVs.interpolate(j, (float)k / (float)subdivPerSegment));
+                }
+            }
+            result.texCrds.push_back(splineUVs.interpolate(n - 2, 1.f));
+        }
+
+        for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++)
+            pointOffset += vertexCountsPerStrand[j];
+    }
+
+    return result;
+}
+
+CurveTessellation::MeshResult convertToPolytube(
+    uint32_t strandCount,
+    const uint32_t* vertexCountsPerStrand,
+    const float3* controlPoints,
+    const float* widths,
+    const float2* UVs,
+    uint32_t subdivPerSegment,
+    uint32_t keepOneEveryXStrands,
+    uint32_t keepOneEveryXVerticesPerStrand,
+    float widthScale,
+    uint32_t pointCountPerCrossSection
+)
+{
+    CurveTessellation::MeshResult result;
+
+    uint32_t pointOffset = 0;
+    uint32_t meshVertexOffset = 0;
+    StrandArrays strandArrays;
+    StrandArrays optimizedStrandArrays;
+    SplineCache splineCache;
+    for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+    {
+        optimizedStrandArrays = {};
+        strandArrays.vertexCount = vertexCountsPerStrand[i];
+        optimizeStrandGeometry(
+            splineCache, controlPoints, widths, UVs, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment,
+            keepOneEveryXVerticesPerStrand, widthScale
+        );
+        for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++)
+            pointOffset += vertexCountsPerStrand[j];
+
+        float3 fwd, s, t;
+        fwd = normalize(optimizedStrandArrays.controlPoints[1] - optimizedStrandArrays.controlPoints[0]);
+        buildFrame(fwd, s, t);
+
+        const uint32_t pointCount = (uint32_t)optimizedStrandArrays.controlPoints.size();
+        for (uint32_t j = 0; j < pointCount; j++)
+        {
+            updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
+
+            for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
+            {
+                float phi = (float)k / (float)pointCountPerCrossSection * (float)M_PI * 2.f;
+                float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
+                float curveRadius = 0.5f * optimizedStrandArrays.widths[j];
+                result.vertices.push_back(optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal);
+                result.normals.push_back(vNormal);
+                result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
+                result.radii.push_back(curveRadius);
+                if (UVs)
+                    result.texCrds.push_back(optimizedStrandArrays.UVs[j]);
+            }
+
+            if (j < pointCount - 1)
+            {
+                const uint32_t base = meshVertexOffset + j * pointCountPerCrossSection;
+                for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
+                {
+                    const uint32_t next = (k + 1) % pointCountPerCrossSection;
+                    result.faceVertexCounts.push_back(3);
+                    result.faceVertexIndices.push_back(base + k);
+                    result.faceVertexIndices.push_back(base + next);
+                    result.faceVertexIndices.push_back(base + pointCountPerCrossSection + next);
+
+                    result.faceVertexCounts.push_back(3);
+                    result.faceVertexIndices.push_back(base + k);
+                    result.faceVertexIndices.push_back(base + pointCountPerCrossSection + next);
+                    result.faceVertexIndices.push_back(base + pointCountPerCrossSection + k);
+                }
+            }
+        }
+
+        meshVertexOffset += pointCountPerCrossSection * pointCount;
+    }
+
+    return result;
+}
+} // namespace reference
+} // namespace
+
+CPU_TEST(CurveTessellation_SweptSphereMatchesPerStrand)
+{
+    // Strands are tessellated independently, so tessellating all strands at once must give
+    // the same result as concatenating the results of tessellating each strand on its own.
+    Groom groom = createGroom(500, 2, 12);
+
+    for (uint32_t keepOneEveryXVertices : {1, 3})
+    {
+        auto result = CurveTessellation::convertToLinearSweptSphere(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 1, 4, 1, keepOneEveryXVertices, 1.f, kTransform);
+        EXPECT_EQ(result.degree, 1);
+        EXPECT_EQ(result.texCrds.size(), result.points.size());
+        EXPECT_EQ(result.radius.size(), result.points.size());
+
+        size_t inputOffset = 0;
+        size_t pointOffset = 0;
+        size_t indexOffset = 0;
+        for (uint32_t i = 0; i < groom.getStrandCount(); i++)
+        {
+            auto strand = CurveTessellation::convertToLinearSweptSphere(1, &groom.vertexCounts[i], &groom.points[inputOffset], &groom.widths[inputOffset], &groom.UVs[inputOffset], 1, 4, 1, keepOneEveryXVertices, 1.f, kTransform);
+            EXPECT(isEqual(result.points, strand.points, pointOffset)) << "strand " << i;
+            EXPECT(isEqual(result.radius, strand.radius, pointOffset)) << "strand " << i;
+            EXPECT(isEqual(result.texCrds, strand.texCrds, pointOffset)) << "strand " << i;
+            for (size_t j = 0; j < strand.indices.size(); j++)
+            {
+                EXPECT_EQ(result.indices[indexOffset + j], strand.indices[j] + pointOffset) << "strand " << i;
+            }
+
+            inputOffset += groom.vertexCounts[i];
+            pointOffset += strand.points.size();
+            indexOffset += strand.indices.size();
+        }
+        EXPECT_EQ(pointOffset, result.points.size());
+        EXPECT_EQ(indexOffset, result.indices.size());
+    }
+
+    // Without texture coordinates, no texture coordinates are output.
+    auto result = CurveTessellation::convertToLinearSweptSphere(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), nullptr, 1, 4, 3, 1, 1.f, kTransform);
+    EXPECT(result.texCrds.empty());
+    EXPECT_GT(result.points.size(), 0);
+}
+
+CPU_TEST(CurveTessellation_PolytubeMatchesPerStrand)
+{
+    Groom groom = createGroom(500, 2, 12);
+    const uint32_t pointCountPerCrossSection = 4;
+
+    auto result = CurveTessellation::convertToPolytube(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 4, 1, 2, 1.f, pointCountPerCrossSection);
+    EXPECT_EQ(result.faceVertexIndices.size(), 3 * result.faceVertexCounts.size());
+
+    size_t inputOffset = 0;
+    size_t vertexOffset = 0;
+    size_t faceOffset = 0;
+    for (uint32_t i = 0; i < groom.getStrandCount(); i++)
+    {
+        auto strand = CurveTessellation::convertToPolytube(1, &groom.vertexCounts[i], &groom.points[inputOffset], &groom.widths[inputOffset], &groom.UVs[inputOffset], 4, 1, 2, 1.f, pointCountPerCrossSection);
+        EXPECT(isEqual(result.vertices, strand.vertices, vertexOffset)) << "strand " << i;
+        EXPECT(isEqual(result.normals, strand.normals, vertexOffset)) << "strand " << i;
+        EXPECT(isEqual(result.tangents, strand.tangents, vertexOffset)) << "strand " << i;
+        EXPECT(isEqual(result.texCrds, strand.texCrds, vertexOffset)) << "strand " << i;
+        EXPECT(isEqual(result.radii, strand.radii, vertexOffset)) << "strand " << i;
+        EXPECT(isEqual(result.faceVertexCounts, strand.faceVertexCounts, faceOffset)) << "strand " << i;
+        for (size_t j = 0; j < strand.faceVertexIndices.size(); j++)
+        {
+            EXPECT_EQ(result.faceVertexIndices[3 * faceOffset + j], strand.faceVertexIndices[j] + vertexOffset) << "strand " << i;
+        }
+
+        inputOffset += groom.vertexCounts[i];
+        vertexOffset += strand.vertices.size();
+        faceOffset += strand.faceVertexCounts.size();
+    }
+    EXPECT_EQ(vertexOffset, result.vertices.size());
+    EXPECT_EQ(faceOffset, result.faceVertexCounts.size());
+}
+
+CPU_TEST(CurveTessellation_SweptSphereMatchesReference)
+{
+    Groom groom = createGroom(2000, 2, 16);
+
+    for (uint32_t keepOneEveryXStrands : {1, 3})
+    {
+        for (uint32_t keepOneEveryXVertices : {1, 2})
+        {
+            auto result = CurveTessellation::convertToLinearSweptSphere(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 1, 4, keepOneEveryXStrands, keepOneEveryXVertices, 1.5f, kTransform);
+            auto expected = reference::convertToLinearSweptSphere(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 4, keepOneEveryXStrands, keepOneEveryXVertices, 1.5f, kTransform);
+
+            ASSERT_EQ(result.points.size(), expected.points.size());
+            ASSERT_EQ(result.indices.size(), expected.indices.size());
+            EXPECT(isEqual(result.points, expected.points));
+            EXPECT(isEqual(result.radius, expected.radius));
+            EXPECT(isEqual(result.texCrds, expected.texCrds));
+            EXPECT(isEqual(result.indices, expected.indices));
+        }
+    }
+}
+
+CPU_TEST(CurveTessellation_PolytubeMatchesReference)
+{
+    Groom groom = createGroom(2000, 2, 16);
+
+    for (uint32_t keepOneEveryXStrands : {1, 3})
+    {
+        for (uint32_t keepOneEveryXVertices : {1, 2})
+        {
+            auto result = CurveTessellation::convertToPolytube(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 4, keepOneEveryXStrands, keepOneEveryXVertices, 1.5f, 4);
+            auto expected = reference::convertToPolytube(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 4, keepOneEveryXStrands, keepOneEveryXVertices, 1.5f, 4);
+
+            ASSERT_EQ(result.vertices.size(), expected.vertices.size());
+            ASSERT_EQ(result.faceVertexIndices.size(), expected.faceVertexIndices.size());
+            EXPECT(isEqual(result.vertices, expected.vertices));
+            EXPECT(isEqual(result.normals, expected.normals));
+            EXPECT(isEqual(result.tangents, expected.tangents));
+            EXPECT(isEqual(result.texCrds, expected.texCrds));
+            EXPECT(isEqual(result.radii, expected.radii));
+            EXPECT(isEqual(result.faceVertexCounts, expected.faceVertexCounts));
+            EXPECT(isEqual(result.faceVertexIndices, expected.faceVertexIndices));
+        }
+    }
+}
+
+namespace
+{
+const uint32_t kBenchmarkStrandCount = 50000;
+
+void benchmarkSweptSpheres(CPUBenchmarkContext& ctx, bool useReference)
+{
+    Groom groom = createGroom(kBenchmarkStrandCount, 8, 24);
+    ctx.setItemsPerIteration(groom.getStrandCount());
+    ctx.measure(
+        [&]()
+        {
+            auto result = useReference
+                              ? reference::convertToLinearSweptSphere(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 2, 1, 1, 1.f, kTransform)
+                              : CurveTessellation::convertToLinearSweptSphere(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 1, 2, 1, 1, 1.f, kTransform);
+            doNotOptimize(result.points.data());
+        }
+    );
+}
+
+void benchmarkPolytubes(CPUBenchmarkContext& ctx, bool useReference)
+{
+    Groom groom = createGroom(kBenchmarkStrandCount, 8, 24);
+    ctx.setItemsPerIteration(groom.getStrandCount());
+    ctx.measure(
+        [&]()
+        {
+            auto result = useReference
+                              ? reference::convertToPolytube(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 2, 1, 1, 1.f, 4)
+                              : CurveTessellation::convertToPolytube(groom.getStrandCount(), groom.vertexCounts.data(), groom.points.data(), groom.widths.data(), groom.UVs.data(), 2, 1, 1, 1.f, 4);
+            doNotOptimize(result.vertices.data());
+        }
+    );
+}
+} // namespace
+
+CPU_BENCHMARK(CurveTessellation_SweptSpheres)
+{
+    benchmarkSweptSpheres(ctx, false);
+}
+
+CPU_BENCHMARK(CurveTessellation_SweptSpheresReference)
+{
+    benchmarkSweptSpheres(ctx, true);
+}
+
+CPU_BENCHMARK(CurveTessellation_Polytubes)
+{
+    benchmarkPolytubes(ctx, false);
+}
+
+CPU_BENCHMARK(CurveTessellation_PolytubesReference)
+{
+    benchmarkPolytubes(ctx, true);
+}
+} // namespace Falcor
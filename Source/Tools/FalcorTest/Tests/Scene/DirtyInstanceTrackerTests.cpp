@@ -0,0 +1,161 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/DirtyInstanceTracker.h"
+#include <random>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+using Range = DirtyInstanceTracker::Range;
+
+void checkRanges(CPUUnitTestContext& ctx, const std::vector<Range>& ranges, const std::vector<Range>& expected)
+{
+    ASSERT_EQ(ranges.size(), expected.size());
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        EXPECT_EQ(ranges[i].offset, expected[i].offset) << "i = " << i;
+        EXPECT_EQ(ranges[i].count, expected[i].count) << "i = " << i;
+    }
+}
+} // namespace
+
+CPU_TEST(DirtyInstanceTracker_Coalesce)
+{
+    checkRanges(ctx, DirtyInstanceTracker::coalesce({}), {});
+    checkRanges(ctx, DirtyInstanceTracker::coalesce({5}), {{5, 1}});
+    checkRanges(ctx, DirtyInstanceTracker::coalesce({0, 1, 2, 4, 5, 9}), {{0, 3}, {4, 2}, {9, 1}});
+    checkRanges(ctx, DirtyInstanceTracker::coalesce({0, 1, 1, 2}), {{0, 3}});
+
+    // Ranges separated by small gaps are merged.
+    checkRanges(ctx, DirtyInstanceTracker::coalesce({0, 1, 2, 4, 5, 9}, 1), {{0, 6}, {9, 1}});
+    checkRanges(ctx, DirtyInstanceTracker::coalesce({0, 1, 2, 4, 5, 9}, 3), {{0, 10}});
+}
+
+CPU_TEST(DirtyInstanceTracker_MarkDirty)
+{
+    DirtyInstanceTracker tracker;
+    tracker.resize(100);
+    EXPECT_EQ(tracker.getInstanceCount(), 100);
+    EXPECT(tracker.empty());
+
+    // Instances are reported once and in sorted order regardless of the marking order.
+    EXPECT(tracker.markDirty(42));
+    EXPECT(tracker.markDirty(7));
+    EXPECT(tracker.markDirty(8));
+    EXPECT(!tracker.markDirty(42));
+    EXPECT_EQ(tracker.getDirtyCount(), 3);
+    EXPECT(tracker.isDirty(7));
+    EXPECT(!tracker.isDirty(9));
+
+    std::vector<uint32_t> expected = {7, 8, 42};
+    EXPECT(tracker.getDirtyInstances() == expected);
+    checkRanges(ctx, tracker.getDirtyRanges(), {{7, 2}, {42, 1}});
+
+    tracker.clear();
+    EXPECT(tracker.empty());
+    EXPECT(!tracker.isDirty(7));
+    EXPECT(!tracker.isDirty(42));
+
+    tracker.markAllDirty();
+    EXPECT_EQ(tracker.getDirtyCount(), 100);
+    checkRanges(ctx, tracker.getDirtyRanges(), {{0, 100}});
+}
+
+CPU_TEST(DirtyInstanceTracker_MarkChangedMatrices)
+{
+    // Instances 0-5 reference matrices 3, 1, 3, 0, 4, 3. Matrix 2 is unreferenced.
+    DirtyInstanceTracker tracker;
+    tracker.setInstanceMatrices(5, {3, 1, 3, 0, 4, 3});
+    EXPECT_EQ(tracker.getInstanceCount(), 6);
+
+    // Only referenced matrices are queried.
+    std::set<uint32_t> queried;
+    uint32_t count = tracker.markChangedMatrices([&](uint32_t matrixID) { queried.insert(matrixID); return matrixID == 3; });
+    EXPECT(queried == std::set<uint32_t>({0, 1, 3, 4}));
+    EXPECT_EQ(count, 3);
+    EXPECT(tracker.getDirtyInstances() == std::vector<uint32_t>({0, 2, 5}));
+
+    // Instances that are already dirty are not counted again.
+    count = tracker.markChangedMatrices([](uint32_t matrixID) { return matrixID == 3 || matrixID == 0; });
+    EXPECT_EQ(count, 1);
+    EXPECT(tracker.getDirtyInstances() == std::vector<uint32_t>({0, 2, 3, 5}));
+
+    tracker.clear();
+    count = tracker.markChangedMatrices([](uint32_t) { return false; });
+    EXPECT_EQ(count, 0);
+    EXPECT(tracker.empty());
+}
+
+CPU_TEST(DirtyInstanceTracker_Random)
+{
+    // Compare against a brute-force scan over all instances.
+    const uint32_t instanceCount = 5000;
+    const uint32_t matrixCount = 300;
+
+    std::mt19937 rng(1);
+    std::vector<uint32_t> instanceMatrixIDs(instanceCount);
+    for (auto& id : instanceMatrixIDs) id = rng() % matrixCount;
+
+    DirtyInstanceTracker tracker;
+    tracker.setInstanceMatrices(matrixCount, instanceMatrixIDs);
+
+    for (uint32_t frame = 0; frame < 10; frame++)
+    {
+        // Change a varying fraction of the matrices, from a few to all of them.
+        std::vector<bool> changed(matrixCount);
+        uint32_t changedCount = frame == 9 ? matrixCount : 1u << frame;
+        for (uint32_t i = 0; i < changedCount; i++) changed[frame == 9 ? i : rng() % matrixCount] = true;
+
+        tracker.markChangedMatrices([&](uint32_t matrixID) { return changed[matrixID]; });
+
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            if (changed[instanceMatrixIDs[i]]) expected.push_back(i);
+        }
+
+        EXPECT(tracker.getDirtyInstances() == expected) << "frame = " << frame;
+        EXPECT_EQ(tracker.getDirtyCount(), expected.size()) << "frame = " << frame;
+
+        // The ranges cover exactly the dirty instances.
+        uint32_t covered = 0;
+        for (const auto& range : tracker.getDirtyRanges())
+        {
+            for (uint32_t i = range.offset; i < range.offset + range.count; i++) EXPECT(tracker.isDirty(i)) << "i = " << i;
+            covered += range.count;
+        }
+        EXPECT_EQ(covered, expected.size()) << "frame = " << frame;
+
+        tracker.clear();
+        EXPECT(tracker.empty());
+    }
+}
+} // namespace Falcor
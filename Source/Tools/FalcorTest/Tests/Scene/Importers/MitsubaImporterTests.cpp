@@ -0,0 +1,458 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Utils/Settings/Settings.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+struct SerializedShape
+{
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCoords;
+    std::vector<uint32_t> indices;
+    std::string name;
+    bool doublePrecision = false;
+};
+
+template<typename T>
+void append(std::vector<uint8_t>& data, T value)
+{
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&value);
+    data.insert(data.end(), pBytes, pBytes + sizeof(T));
+}
+
+/// Wrap data in a zlib stream made of uncompressed (stored) deflate blocks.
+std::vector<uint8_t> zlibStore(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> stream = {0x78, 0x01};
+    size_t offset = 0;
+    do
+    {
+        const uint16_t len = (uint16_t)std::min<size_t>(data.size() - offset, 0xffff);
+        const bool final = offset + len == data.size();
+        stream.push_back(final ? 1 : 0);
+        append<uint16_t>(stream, len);
+        append<uint16_t>(stream, ~len);
+        stream.insert(stream.end(), data.begin() + offset, data.begin() + offset + len);
+        offset += len;
+    } while (offset < data.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    const uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        stream.push_back((uint8_t)(adler >> shift));
+    return stream;
+}
+
+/// Encode the uncompressed data of a shape.
+std::vector<uint8_t> encodeShape(const SerializedShape& shape, uint16_t version)
+{
+    std::vector<uint8_t> data;
+    uint32_t flags = shape.doublePrecision ? 0x2000 : 0x1000;
+    flags |= shape.normals.empty() ? 0 : 0x0001;
+    flags |= shape.texCoords.empty() ? 0 : 0x0002;
+    append(data, flags);
+    if (version == 4)
+        data.insert(data.end(), shape.name.c_str(), shape.name.c_str() + shape.name.size() + 1);
+    append<uint64_t>(data, shape.positions.size());
+    append<uint64_t>(data, shape.indices.size() / 3);
+
+    auto appendScalars = [&](const float* pValues, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (shape.doublePrecision)
+                append<double>(data, pValues[i]);
+            else
+                append<float>(data, pValues[i]);
+        }
+    };
+    appendScalars(&shape.positions.data()->x, shape.positions.size() * 3);
+    appendScalars(shape.normals.empty() ? nullptr : &shape.normals.data()->x, shape.normals.size() * 3);
+    appendScalars(shape.texCoords.empty() ? nullptr : &shape.texCoords.data()->x, shape.texCoords.size() * 2);
+    for (uint32_t index : shape.indices)
+        append(data, index);
+    return data;
+}
+
+/// Build a serialized file from the zlib streams of its shapes.
+std::vector<uint8_t> buildSerializedFile(const std::vector<std::vector<uint8_t>>& streams, uint16_t version)
+{
+    std::vector<uint8_t> file;
+    std::vector<uint64_t> offsets;
+
+    for (const auto& stream : streams)
+    {
+        offsets.push_back(file.size());
+        append<uint16_t>(file, 0x041C);
+        append<uint16_t>(file, version);
+        file.insert(file.end(), stream.begin(), stream.end());
+    }
+
+    for (uint64_t offset : offsets)
+    {
+        if (version == 3)
+            append<uint32_t>(file, (uint32_t)offset);
+        else
+            append<uint64_t>(file, offset);
+    }
+    append<uint32_t>(file, (uint32_t)streams.size());
+    return file;
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+{
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+void writeSerializedFile(const std::filesystem::path& path, const std::vector<SerializedShape>& shapes, uint16_t version)
+{
+    std::vector<std::vector<uint8_t>> streams;
+    for (const auto& shape : shapes)
+        streams.push_back(zlibStore(encodeShape(shape, version)));
+    writeFile(path, buildSerializedFile(streams, version));
+}
+
+void writeScene(const std::filesystem::path& path, const std::string& serializedFilename, const std::vector<std::pair<uint32_t, bool>>& shapes)
+{
+    std::ofstream file(path);
+    file << "<scene version=\"3.0.0\">\n";
+    for (const auto& [shapeIndex, faceNormals] : shapes)
+    {
+        file << "    <shape type=\"serialized\">\n";
+        file << "        <string name=\"filename\" value=\"" << serializedFilename << "\"/>\n";
+        file << "        <integer name=\"shape_index\" value=\"" << shapeIndex << "\"/>\n";
+        file << "        <boolean name=\"face_normals\" value=\"" << (faceNormals ? "true" : "false") << "\"/>\n";
+        file << "    </shape>\n";
+    }
+    file << "</scene>\n";
+}
+
+std::vector<SerializedShape> createShapes()
+{
+    // Quad with normals and texture coordinates in single precision.
+    SerializedShape quad;
+    quad.name = "quad";
+    quad.positions = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    quad.normals = {{0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1}};
+    quad.texCoords = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    quad.indices = {0, 1, 2, 0, 2, 3};
+
+    // Tetrahedron without normals in double precision.
+    SerializedShape tetrahedron;
+    tetrahedron.name = "tetrahedron";
+    tetrahedron.positions = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    tetrahedron.indices = {0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3};
+    tetrahedron.doublePrecision = true;
+
+    return {quad, tetrahedron};
+}
+
+struct MeshVertices
+{
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+};
+
+/// Read back the vertices of a mesh from the scene's vertex buffer.
+MeshVertices readMeshVertices(GPUUnitTestContext& ctx, const ref<Scene>& pScene, MeshID meshID)
+{
+    const auto& meshDesc = pScene->getMesh(meshID);
+    ctx.createProgram("Tests/Scene/Importers/MitsubaImporterTests.cs.slang", "readVertices", pScene->getSceneDefines());
+    pScene->bindShaderData(ctx["gScene"]);
+    ctx.allocateStructuredBuffer("positions", meshDesc.vertexCount);
+    ctx.allocateStructuredBuffer("normals", meshDesc.vertexCount);
+    ctx.allocateStructuredBuffer("texCrds", meshDesc.vertexCount);
+    ctx["CB"]["vbOffset"] = meshDesc.vbOffset;
+    ctx["CB"]["vertexCount"] = meshDesc.vertexCount;
+    ctx.runProgram(meshDesc.vertexCount);
+    return {ctx.readBuffer<float3>("positions"), ctx.readBuffer<float3>("normals"), ctx.readBuffer<float2>("texCrds")};
+}
+
+/// Returns the (triangle count, vertex count) of all meshes, sorted.
+std::vector<std::pair<uint32_t, uint32_t>> getMeshSizes(const ref<Scene>& pScene)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> sizes;
+    for (uint32_t i = 0; i < pScene->getMeshCount(); ++i)
+    {
+        const auto& meshDesc = pScene->getMesh(MeshID(i));
+        sizes.emplace_back(meshDesc.getTriangleCount(), meshDesc.vertexCount);
+    }
+    std::sort(sizes.begin(), sizes.end());
+    return sizes;
+}
+} // namespace
+
+GPU_TEST(MitsubaImporterSerialized)
+{
+    PluginManager::instance().loadPluginByName("MitsubaImporter");
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path serializedPath = dir / "FalcorTest_MitsubaImporterSerialized.serialized";
+    const std::filesystem::path scenePath = dir / "FalcorTest_MitsubaImporterSerialized.xml";
+
+    for (uint16_t version : {3, 4})
+    {
+        writeSerializedFile(serializedPath, createShapes(), version);
+        writeScene(scenePath, serializedPath.filename().string(), {{0, false}, {1, false}, {1, true}});
+
+        ref<Scene> pScene = SceneBuilder(ctx.getDevice(), scenePath, Settings()).getScene();
+        ASSERT(pScene);
+        ASSERT_EQ(pScene->getMeshCount(), 3u);
+
+        // The tetrahedron with face normals has separate vertices per triangle.
+        const auto sizes = getMeshSizes(pScene);
+        EXPECT(sizes[0] == std::make_pair(2u, 4u));
+        EXPECT(sizes[1] == std::make_pair(4u, 4u));
+        EXPECT(sizes[2] == std::make_pair(4u, 12u));
+    }
+
+    // Out of range shape index.
+    writeScene(scenePath, serializedPath.filename().string(), {{2, false}});
+    EXPECT_THROW(SceneBuilder(ctx.getDevice(), scenePath, Settings()));
+
+    std::filesystem::remove(serializedPath);
+    std::filesystem::remove(scenePath);
+}
+
+GPU_TEST(MitsubaImporterSerializedVertexData)
+{
+    PluginManager::instance().loadPluginByName("MitsubaImporter");
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path serializedPath = dir / "FalcorTest_MitsubaImporterSerializedVertexData.serialized";
+    const std::filesystem::path scenePath = dir / "FalcorTest_MitsubaImporterSerializedVertexData.xml";
+
+    const auto shapes = createShapes();
+    const SerializedShape& quad = shapes[0];
+    const SerializedShape& tetrahedron = shapes[1];
+
+    // The tetrahedron has no stored normals. The generated area-weighted normal of the corner at the origin points away from the
+    // three axis-aligned faces, the other corners have the normal of the axis they lie on.
+    const float3 tetrahedronNormals[] = {normalize(float3(-1.f)), {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    writeSerializedFile(serializedPath, shapes, 4);
+    writeScene(scenePath, serializedPath.filename().string(), {{0, false}, {1, false}});
+
+    ref<Scene> pScene = SceneBuilder(ctx.getDevice(), scenePath, Settings()).getScene();
+    ASSERT(pScene);
+    ASSERT_EQ(pScene->getMeshCount(), 2u);
+
+    for (uint32_t meshIndex = 0; meshIndex < 2; ++meshIndex)
+    {
+        const MeshID meshID(meshIndex);
+        const bool isQuad = pScene->getMesh(meshID).getTriangleCount() == 2;
+        const SerializedShape& shape = isQuad ? quad : tetrahedron;
+        const MeshVertices vertices = readMeshVertices(ctx, pScene, meshID);
+        ASSERT_EQ(vertices.positions.size(), shape.positions.size());
+
+        // The scene builder may reorder vertices, so they are matched by position.
+        for (size_t i = 0; i < shape.positions.size(); ++i)
+        {
+            auto it = std::find_if(
+                vertices.positions.begin(), vertices.positions.end(), [&](const float3& p) { return all(p == shape.positions[i]); }
+            );
+            ASSERT(it != vertices.positions.end()) << "vertex " << i;
+            const size_t j = it - vertices.positions.begin();
+
+            const float3 expectedNormal = isQuad ? quad.normals[i] : tetrahedronNormals[i];
+            const float2 expectedTexCrd = isQuad ? quad.texCoords[i] : float2(0.f);
+            EXPECT_LE(length(vertices.normals[j] - expectedNormal), 1e-3f) << "vertex " << i;
+            EXPECT_EQ(vertices.texCrds[j], expectedTexCrd) << "vertex " << i;
+        }
+    }
+
+    std::filesystem::remove(serializedPath);
+    std::filesystem::remove(scenePath);
+}
+
+GPU_TEST(MitsubaImporterSerializedCorrupt)
+{
+    PluginManager::instance().loadPluginByName("MitsubaImporter");
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path serializedPath = dir / "FalcorTest_MitsubaImporterSerializedCorrupt.serialized";
+    const std::filesystem::path scenePath = dir / "FalcorTest_MitsubaImporterSerializedCorrupt.xml";
+    writeScene(scenePath, serializedPath.filename().string(), {{0, false}});
+
+    // Version 3 has no shape name, so the vertex count is stored right after the flags.
+    const uint16_t version = 3;
+    const size_t kVertexCountOffset = 4;
+    const std::vector<uint8_t> data = encodeShape(createShapes()[0], version);
+    const std::vector<uint8_t> file = buildSerializedFile({zlibStore(data)}, version);
+
+    auto expectThrow = [&](const std::string& name, const std::vector<uint8_t>& corruptFile)
+    {
+        writeFile(serializedPath, corruptFile);
+        bool thrown = false;
+        try
+        {
+            SceneBuilder(ctx.getDevice(), scenePath, Settings());
+        }
+        catch (const std::exception&)
+        {
+            thrown = true;
+        }
+        EXPECT(thrown) << name;
+    };
+
+    // Sanity check that the unmodified file loads.
+    writeFile(serializedPath, file);
+    EXPECT(SceneBuilder(ctx.getDevice(), scenePath, Settings()).getScene() != nullptr);
+
+    // File truncated to less than a shape header.
+    expectThrow("too small", std::vector<uint8_t>(file.begin(), file.begin() + 3));
+
+    // File truncated in the shape dictionary.
+    expectThrow("truncated dictionary", std::vector<uint8_t>(file.begin(), file.end() - 2));
+
+    // Wrong format identifier.
+    {
+        auto corrupt = file;
+        corrupt[0] ^= 0xff;
+        expectThrow("format identifier", corrupt);
+    }
+
+    // Shape count larger than the dictionary.
+    {
+        auto corrupt = file;
+        const uint32_t shapeCount = 1000;
+        std::memcpy(corrupt.data() + corrupt.size() - 4, &shapeCount, 4);
+        expectThrow("shape count", corrupt);
+    }
+
+    // Shape offset past the dictionary.
+    {
+        auto corrupt = file;
+        const uint32_t offset = (uint32_t)corrupt.size();
+        std::memcpy(corrupt.data() + corrupt.size() - 8, &offset, 4);
+        expectThrow("shape offset", corrupt);
+    }
+
+    // Truncated zlib stream.
+    {
+        auto stream = zlibStore(data);
+        stream.resize(stream.size() / 2);
+        expectThrow("truncated stream", buildSerializedFile({stream}, version));
+    }
+
+    // Complete zlib stream with truncated shape data.
+    expectThrow("truncated data", buildSerializedFile({zlibStore(std::vector<uint8_t>(data.begin(), data.end() - 8))}, version));
+
+    // Vertex count larger than the shape data.
+    for (uint64_t vertexCount : {uint64_t(1000), uint64_t(1) << 40})
+    {
+        auto corruptData = data;
+        std::memcpy(corruptData.data() + kVertexCountOffset, &vertexCount, sizeof(vertexCount));
+        expectThrow(fmt::format("vertex count {}", vertexCount), buildSerializedFile({zlibStore(corruptData)}, version));
+    }
+
+    // Vertex index out of range.
+    {
+        auto corruptData = data;
+        const uint32_t index = 4;
+        std::memcpy(corruptData.data() + corruptData.size() - 4, &index, 4);
+        expectThrow("vertex index", buildSerializedFile({zlibStore(corruptData)}, version));
+    }
+
+    // Both precision flags set.
+    {
+        auto corruptData = data;
+        corruptData[1] |= 0x30;
+        expectThrow("precision flags", buildSerializedFile({zlibStore(corruptData)}, version));
+    }
+
+    std::filesystem::remove(serializedPath);
+    std::filesystem::remove(scenePath);
+}
+
+GPU_TEST(MitsubaImporterShapeGroup)
+{
+    PluginManager::instance().loadPluginByName("MitsubaImporter");
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path serializedPath = dir / "FalcorTest_MitsubaImporterShapeGroup.serialized";
+    const std::filesystem::path scenePath = dir / "FalcorTest_MitsubaImporterShapeGroup.xml";
+    writeSerializedFile(serializedPath, createShapes(), 4);
+
+    auto serializedShape = [&](const std::string& id)
+    {
+        return fmt::format(
+            "<shape type=\"serialized\" id=\"{}\"><string name=\"filename\" value=\"{}\"/></shape>\n",
+            id,
+            serializedPath.filename().string()
+        );
+    };
+
+    // A shape group instanced twice, and two shapes sharing the same serialized data.
+    {
+        std::ofstream file(scenePath);
+        file << "<scene version=\"3.0.0\">\n";
+        file << "<shape type=\"shapegroup\" id=\"group\">\n" << serializedShape("groupQuad") << "</shape>\n";
+        file << "<shape type=\"instance\" id=\"instance0\"><ref id=\"group\"/></shape>\n";
+        file << "<shape type=\"instance\" id=\"instance1\"><ref id=\"group\"/>";
+        file << "<transform name=\"to_world\"><translate x=\"2\"/></transform></shape>\n";
+        file << serializedShape("quadA") << serializedShape("quadB");
+        file << "</scene>\n";
+    }
+
+    ref<Scene> pScene = SceneBuilder(ctx.getDevice(), scenePath, Settings()).getScene();
+    ASSERT(pScene);
+
+    // The shape group mesh is added once. Each mesh keeps the name of its own shape.
+    ASSERT_EQ(pScene->getMeshCount(), 3u);
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < pScene->getMeshCount(); ++i)
+        names.push_back(pScene->getMeshName(i));
+    std::sort(names.begin(), names.end());
+    EXPECT(names == std::vector<std::string>({"groupQuad", "quadA", "quadB"}));
+
+    std::vector<uint32_t> instanceCounts(pScene->getMeshCount(), 0);
+    for (uint32_t i = 0; i < pScene->getGeometryInstanceCount(); ++i)
+        instanceCounts[pScene->getGeometryInstance(i).geometryID]++;
+    std::sort(instanceCounts.begin(), instanceCounts.end());
+    EXPECT(instanceCounts == std::vector<uint32_t>({1, 1, 2}));
+
+    std::filesystem::remove(serializedPath);
+    std::filesystem::remove(scenePath);
+}
+} // namespace Falcor
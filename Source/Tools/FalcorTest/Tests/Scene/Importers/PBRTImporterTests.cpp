@@ -0,0 +1,502 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Utils/Settings/Settings.h"
+#include "PBRTImporter/LoopSubdivide.h"
+#include <fstd/span.h> // TODO C++20: Replace with <span>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace Falcor
+{
+namespace
+{
+struct ControlMesh
+{
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+};
+
+/// Icosahedron (closed mesh with 12 vertices, 30 edges and 20 faces).
+ControlMesh createIcosahedron()
+{
+    const float t = (1.f + std::sqrt(5.f)) / 2.f;
+    ControlMesh mesh;
+    mesh.positions = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1},
+    };
+    mesh.indices = {
+        0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+        3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+    };
+    return mesh;
+}
+
+/// Octahedron with vertices on the unit axes (closed mesh with 6 vertices and 8 faces).
+ControlMesh createOctahedron()
+{
+    ControlMesh mesh;
+    mesh.positions = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    mesh.indices = {0, 2, 4, 2, 1, 4, 1, 3, 4, 3, 0, 4, 2, 0, 5, 1, 2, 5, 3, 1, 5, 0, 3, 5};
+    return mesh;
+}
+
+/// 2x2 quad grid with a height field (open mesh with boundary and corner vertices).
+ControlMesh createGrid()
+{
+    const float heights[9] = {0.f, 0.5f, 0.f, 0.5f, 1.f, 0.25f, 0.f, 0.25f, 0.f};
+    ControlMesh mesh;
+    for (uint32_t y = 0; y < 3; y++)
+        for (uint32_t x = 0; x < 3; x++)
+            mesh.positions.push_back(float3(float(x), float(y), heights[y * 3 + x]));
+
+    for (uint32_t y = 0; y < 2; y++)
+    {
+        for (uint32_t x = 0; x < 2; x++)
+        {
+            uint32_t i = y * 3 + x;
+            mesh.indices.insert(mesh.indices.end(), {i, i + 1, i + 3, i + 1, i + 4, i + 3});
+        }
+    }
+    return mesh;
+}
+
+/// Regular grid with a bumpy height field (open mesh with boundary).
+ControlMesh createGrid(uint32_t size)
+{
+    ControlMesh mesh;
+    for (uint32_t y = 0; y <= size; y++)
+        for (uint32_t x = 0; x <= size; x++)
+            mesh.positions.push_back(float3(float(x), float(y), std::sin(0.7f * x) * std::cos(0.3f * y)));
+
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i = y * (size + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {i, i + 1, i + size + 1, i + 1, i + size + 2, i + size + 1});
+        }
+    }
+    return mesh;
+}
+
+/// Reference output of one and two levels of subdivision, generated with the previous (serial) implementation.
+const float3 kOctahedronLevel1Positions[] = {
+    {0.5f, 0.f, 0.f},
+    {-0.5f, 0.f, 0.f},
+    {0.f, 0.5f, 0.f},
+    {0.f, -0.5f, 0.f},
+    {0.f, 0.f, 0.5f},
+    {0.f, 0.f, -0.5f},
+    {0.302083343f, 0.302083343f, 0.f},
+    {0.f, 0.302083343f, 0.302083343f},
+    {0.302083343f, 0.f, 0.302083343f},
+    {-0.302083343f, 0.302083343f, 0.f},
+    {-0.302083343f, 0.f, 0.302083343f},
+    {-0.302083343f, -0.302083343f, 0.f},
+    {0.f, -0.302083343f, 0.302083343f},
+    {0.302083343f, -0.302083343f, 0.f},
+    {0.302083343f, 0.f, -0.302083343f},
+    {0.f, 0.302083343f, -0.302083343f},
+    {-0.302083343f, 0.f, -0.302083343f},
+    {0.f, -0.302083343f, -0.302083343f},
+};
+
+const uint32_t kOctahedronLevel1Indices[] = {
+    0, 6,  8,  6,  2, 7,  8,  7,  4, 6,  7,  8,  2, 9,  7,  9,  1, 10, 7,  10, 4, 9,  10, 7,
+    1, 11, 10, 11, 3, 12, 10, 12, 4, 11, 12, 10, 3, 13, 12, 13, 0, 8,  12, 8,  4, 13, 8,  12,
+    2, 6,  15, 6,  0, 14, 15, 14, 5, 6,  14, 15, 1, 9,  16, 9,  2, 15, 16, 15, 5, 9,  15, 16,
+    3, 11, 17, 11, 1, 16, 17, 16, 5, 11, 16, 17, 0, 13, 14, 13, 3, 17, 14, 17, 5, 13, 17, 14,
+};
+
+const float3 kGridLevel1Positions[] = {
+    {0.175000012f, 0.175000012f, 0.174999997f},
+    {1.f, 0.f, 0.325000018f},
+    {1.82500005f, 0.175000012f, 0.131250009f},
+    {0.f, 1.f, 0.325000018f},
+    {1.f, 1.f, 0.625f},
+    {2.f, 1.f, 0.162500009f},
+    {0.175000012f, 1.82499993f, 0.131250009f},
+    {1.f, 2.f, 0.162500009f},
+    {1.82499993f, 1.82500005f, 0.0874999985f},
+    {0.524999976f, 0.0250000004f, 0.25f},
+    {0.5f, 0.5f, 0.458333373f},
+    {0.0250000004f, 0.525000036f, 0.25f},
+    {1.f, 0.5f, 0.557291687f},
+    {0.5f, 1.f, 0.557291627f},
+    {1.47500014f, 0.0250000004f, 0.243750006f},
+    {1.48958325f, 0.510416687f, 0.427083343f},
+    {1.97500002f, 0.524999976f, 0.131250009f},
+    {1.49999988f, 1.f, 0.442708313f},
+    {0.510416687f, 1.48958337f, 0.427083343f},
+    {0.0250000004f, 1.47500002f, 0.243750006f},
+    {1.f, 1.50000012f, 0.442708313f},
+    {0.525000036f, 1.97500002f, 0.131249994f},
+    {1.49999988f, 1.5f, 0.291666657f},
+    {1.97500002f, 1.47500014f, 0.125f},
+    {1.47500002f, 1.97500002f, 0.125f},
+};
+
+const uint32_t kGridLevel1Indices[] = {
+    0, 9,  11, 9,  1, 10, 11, 10, 3, 9,  10, 11, 1, 12, 10, 12, 4, 13, 10, 13, 3, 12, 13, 10,
+    1, 14, 12, 14, 2, 15, 12, 15, 4, 14, 15, 12, 2, 16, 15, 16, 5, 17, 15, 17, 4, 16, 17, 15,
+    3, 13, 19, 13, 4, 18, 19, 18, 6, 13, 18, 19, 4, 20, 18, 20, 7, 21, 18, 21, 6, 20, 21, 18,
+    4, 17, 20, 17, 5, 22, 20, 22, 7, 17, 22, 20, 5, 23, 22, 23, 8, 24, 22, 24, 7, 23, 24, 22,
+};
+
+const float3 kOctahedronLevel2Positions[] = {
+    {0.5f, 0.f, 0.f},
+    {-0.5f, 0.f, 0.f},
+    {0.f, 0.5f, 0.f},
+    {0.f, -0.5f, 0.f},
+    {0.f, 0.f, 0.5f},
+    {0.f, 0.f, -0.5f},
+    {0.302083343f, 0.302083343f, 0.f},
+    {0.f, 0.302083343f, 0.302083343f},
+    {0.302083343f, 0.f, 0.302083343f},
+    {-0.302083343f, 0.302083343f, 0.f},
+    {-0.302083343f, 0.f, 0.302083343f},
+    {-0.302083343f, -0.302083343f, 0.f},
+    {0.f, -0.302083343f, 0.302083343f},
+    {0.302083343f, -0.302083343f, 0.f},
+    {0.302083343f, 0.f, -0.302083343f},
+    {0.f, 0.302083343f, -0.302083343f},
+    {-0.302083343f, 0.f, -0.302083343f},
+    {0.f, -0.302083343f, -0.302083343f},
+    {0.443359375f, 0.128255218f, 0.f},
+    {0.342447907f, 0.177734375f, 0.177734375f},
+    {0.443359375f, 0.f, 0.128255218f},
+    {0.128255218f, 0.443359375f, 0.f},
+    {0.f, 0.443359375f, 0.128255218f},
+    {0.177734375f, 0.342447907f, 0.177734375f},
+    {0.177734375f, 0.177734375f, 0.342447907f},
+    {0.f, 0.128255218f, 0.443359375f},
+    {0.128255218f, 0.f, 0.443359375f},
+    {-0.128255218f, 0.443359375f, 0.f},
+    {-0.177734375f, 0.342447907f, 0.177734375f},
+    {-0.443359375f, 0.128255218f, 0.f},
+    {-0.443359375f, 0.f, 0.128255218f},
+    {-0.342447907f, 0.177734375f, 0.177734375f},
+    {-0.177734375f, 0.177734375f, 0.342447907f},
+    {-0.128255218f, 0.f, 0.443359375f},
+    {-0.443359375f, -0.128255218f, 0.f},
+    {-0.342447907f, -0.177734375f, 0.177734375f},
+    {-0.128255218f, -0.443359375f, 0.f},
+    {0.f, -0.443359375f, 0.128255218f},
+    {-0.177734375f, -0.342447907f, 0.177734375f},
+    {-0.177734375f, -0.177734375f, 0.342447907f},
+    {0.f, -0.128255218f, 0.443359375f},
+    {0.128255218f, -0.443359375f, 0.f},
+    {0.177734375f, -0.342447907f, 0.177734375f},
+    {0.443359375f, -0.128255218f, 0.f},
+    {0.342447907f, -0.177734375f, 0.177734375f},
+    {0.177734375f, -0.177734375f, 0.342447907f},
+    {0.177734375f, 0.342447907f, -0.177734375f},
+    {0.f, 0.443359375f, -0.128255218f},
+    {0.443359375f, 0.f, -0.128255218f},
+    {0.342447907f, 0.177734375f, -0.177734375f},
+    {0.177734375f, 0.177734375f, -0.342447907f},
+    {0.128255218f, 0.f, -0.443359375f},
+    {0.f, 0.128255218f, -0.443359375f},
+    {-0.342447907f, 0.177734375f, -0.177734375f},
+    {-0.443359375f, 0.f, -0.128255218f},
+    {-0.177734375f, 0.342447907f, -0.177734375f},
+    {-0.177734375f, 0.177734375f, -0.342447907f},
+    {-0.128255218f, 0.f, -0.443359375f},
+    {-0.177734375f, -0.342447907f, -0.177734375f},
+    {0.f, -0.443359375f, -0.128255218f},
+    {-0.342447907f, -0.177734375f, -0.177734375f},
+    {-0.177734375f, -0.177734375f, -0.342447907f},
+    {0.f, -0.128255218f, -0.443359375f},
+    {0.342447907f, -0.177734375f, -0.177734375f},
+    {0.177734375f, -0.342447907f, -0.177734375f},
+    {0.177734375f, -0.177734375f, -0.342447907f},
+};
+
+const uint32_t kOctahedronLevel2Indices[] = {
+    0,  18, 20, 18, 6,  19, 20, 19, 8,  18, 19, 20, 6,  21, 23, 21, 2,  22, 23, 22, 7,  21, 22, 23,
+    8,  24, 26, 24, 7,  25, 26, 25, 4,  24, 25, 26, 6,  23, 19, 23, 7,  24, 19, 24, 8,  23, 24, 19,
+    2,  27, 22, 27, 9,  28, 22, 28, 7,  27, 28, 22, 9,  29, 31, 29, 1,  30, 31, 30, 10, 29, 30, 31,
+    7,  32, 25, 32, 10, 33, 25, 33, 4,  32, 33, 25, 9,  31, 28, 31, 10, 32, 28, 32, 7,  31, 32, 28,
+    1,  34, 30, 34, 11, 35, 30, 35, 10, 34, 35, 30, 11, 36, 38, 36, 3,  37, 38, 37, 12, 36, 37, 38,
+    10, 39, 33, 39, 12, 40, 33, 40, 4,  39, 40, 33, 11, 38, 35, 38, 12, 39, 35, 39, 10, 38, 39, 35,
+    3,  41, 37, 41, 13, 42, 37, 42, 12, 41, 42, 37, 13, 43, 44, 43, 0,  20, 44, 20, 8,  43, 20, 44,
+    12, 45, 40, 45, 8,  26, 40, 26, 4,  45, 26, 40, 13, 44, 42, 44, 8,  45, 42, 45, 12, 44, 45, 42,
+    2,  21, 47, 21, 6,  46, 47, 46, 15, 21, 46, 47, 6,  18, 49, 18, 0,  48, 49, 48, 14, 18, 48, 49,
+    15, 50, 52, 50, 14, 51, 52, 51, 5,  50, 51, 52, 6,  49, 46, 49, 14, 50, 46, 50, 15, 49, 50, 46,
+    1,  29, 54, 29, 9,  53, 54, 53, 16, 29, 53, 54, 9,  27, 55, 27, 2,  47, 55, 47, 15, 27, 47, 55,
+    16, 56, 57, 56, 15, 52, 57, 52, 5,  56, 52, 57, 9,  55, 53, 55, 15, 56, 53, 56, 16, 55, 56, 53,
+    3,  36, 59, 36, 11, 58, 59, 58, 17, 36, 58, 59, 11, 34, 60, 34, 1,  54, 60, 54, 16, 34, 54, 60,
+    17, 61, 62, 61, 16, 57, 62, 57, 5,  61, 57, 62, 11, 60, 58, 60, 16, 61, 58, 61, 17, 60, 61, 58,
+    0,  43, 48, 43, 13, 63, 48, 63, 14, 43, 63, 48, 13, 41, 64, 41, 3,  59, 64, 59, 17, 41, 59, 64,
+    14, 65, 51, 65, 17, 62, 51, 62, 5,  65, 62, 51, 13, 64, 63, 64, 17, 65, 63, 65, 14, 64, 65, 63,
+};
+
+const float3 kGridLevel2Positions[] = {
+    {0.168750003f, 0.168750003f, 0.168749988f},
+    {1.f, 0.f, 0.331250012f},
+    {1.83125007f, 0.168750003f, 0.126562506f},
+    {0.f, 1.f, 0.331250012f},
+    {1.f, 1.f, 0.625f},
+    {2.f, 1.f, 0.165625006f},
+    {0.168750003f, 1.83125007f, 0.126562491f},
+    {1.f, 2.f, 0.165625006f},
+    {1.83125007f, 1.83125007f, 0.084374994f},
+    {0.521875024f, 0.0218750015f, 0.25f},
+    {0.5f, 0.5f, 0.458333313f},
+    {0.0218750015f, 0.521875024f, 0.25f},
+    {1.f, 0.5f, 0.557291687f},
+    {0.5f, 1.f, 0.557291687f},
+    {1.4781251f, 0.0218750015f, 0.244531259f},
+    {1.48958337f, 0.510416687f, 0.427083343f},
+    {1.9781251f, 0.521875024f, 0.130468756f},
+    {1.50000012f, 1.f, 0.442708343f},
+    {0.510416687f, 1.48958325f, 0.427083373f},
+    {0.0218750015f, 1.47812498f, 0.244531259f},
+    {1.f, 1.5f, 0.442708343f},
+    {0.521875024f, 1.9781251f, 0.130468756f},
+    {1.50000012f, 1.5f, 0.291666687f},
+    {1.9781251f, 1.4781251f, 0.125f},
+    {1.47812498f, 1.9781251f, 0.125f},
+    {0.321875006f, 0.071875006f, 0.193750009f},
+    {0.270833313f, 0.270833373f, 0.265625f},
+    {0.0718749985f, 0.321875006f, 0.193750009f},
+    {0.753125012f, 0.00312500005f, 0.306250006f},
+    {0.74999994f, 0.25f, 0.427083343f},
+    {0.502604127f, 0.252604187f, 0.354166687f},
+    {0.252604187f, 0.502604127f, 0.354166657f},
+    {0.25f, 0.75f, 0.427083313f},
+    {0.00312500005f, 0.753125012f, 0.306250006f},
+    {1.f, 0.25f, 0.455078125f},
+    {0.74999994f, 0.5f, 0.533203125f},
+    {1.f, 0.75000006f, 0.620442688f},
+    {0.74999994f, 1.f, 0.620442748f},
+    {0.75000006f, 0.74999994f, 0.604166687f},
+    {0.5f, 0.75000006f, 0.533203125f},
+    {0.25f, 1.f, 0.455078125f},
+    {1.24687505f, 0.00312500005f, 0.305468738f},
+    {1.24739575f, 0.252604187f, 0.424479157f},
+    {1.67812502f, 0.0718749985f, 0.17578125f},
+    {1.69986987f, 0.300130218f, 0.253255188f},
+    {1.48111975f, 0.268880218f, 0.352864623f},
+    {1.24804699f, 0.501953125f, 0.518229187f},
+    {1.24934888f, 0.750651002f, 0.568359375f},
+    {1.92812502f, 0.321875006f, 0.114843756f},
+    {1.73111999f, 0.518880248f, 0.291666687f},
+    {1.99687505f, 0.753125012f, 0.153906241f},
+    {1.75f, 1.f, 0.302734375f},
+    {1.74739587f, 0.752604127f, 0.309895813f},
+    {1.49804688f, 0.751953125f, 0.45703128f},
+    {1.25f, 1.f, 0.559244812f},
+    {0.252604187f, 1.24739599f, 0.424479187f},
+    {0.00312500005f, 1.24687505f, 0.305468738f},
+    {0.750651002f, 1.249349f, 0.568359435f},
+    {0.501953125f, 1.24804688f, 0.518229127f},
+    {0.268880218f, 1.48111975f, 0.352864593f},
+    {0.300130188f, 1.69986987f, 0.253255188f},
+    {0.071875006f, 1.67812502f, 0.17578125f},
+    {1.f, 1.25f, 0.559244812f},
+    {0.751953125f, 1.49804688f, 0.45703128f},
+    {1.f, 1.75f, 0.302734375f},
+    {0.753125012f, 1.99687505f, 0.153906256f},
+    {0.752604187f, 1.74739587f, 0.309895873f},
+    {0.518880188f, 1.73111999f, 0.291666657f},
+    {0.321875006f, 1.92812502f, 0.114843756f},
+    {1.24999988f, 1.25000012f, 0.489583373f},
+    {1.75f, 1.25000012f, 0.260416657f},
+    {1.5f, 1.24999988f, 0.380859405f},
+    {1.25000012f, 1.5f, 0.380859375f},
+    {1.24999988f, 1.75f, 0.260416657f},
+    {1.99687505f, 1.24687505f, 0.153125003f},
+    {1.74739587f, 1.49739575f, 0.200520828f},
+    {1.92812502f, 1.67812502f, 0.0968750045f},
+    {1.67812502f, 1.92812502f, 0.0968750045f},
+    {1.72916675f, 1.72916675f, 0.140625f},
+    {1.49739587f, 1.74739587f, 0.200520828f},
+    {1.24687505f, 1.99687505f, 0.153125003f},
+};
+
+const uint32_t kGridLevel2Indices[] = {
+    0,  25, 27, 25, 9,  26, 27, 26, 11, 25, 26, 27, 9,  28, 30, 28, 1,  29, 30, 29, 10, 28, 29, 30,
+    11, 31, 33, 31, 10, 32, 33, 32, 3,  31, 32, 33, 9,  30, 26, 30, 10, 31, 26, 31, 11, 30, 31, 26,
+    1,  34, 29, 34, 12, 35, 29, 35, 10, 34, 35, 29, 12, 36, 38, 36, 4,  37, 38, 37, 13, 36, 37, 38,
+    10, 39, 32, 39, 13, 40, 32, 40, 3,  39, 40, 32, 12, 38, 35, 38, 13, 39, 35, 39, 10, 38, 39, 35,
+    1,  41, 34, 41, 14, 42, 34, 42, 12, 41, 42, 34, 14, 43, 45, 43, 2,  44, 45, 44, 15, 43, 44, 45,
+    12, 46, 36, 46, 15, 47, 36, 47, 4,  46, 47, 36, 14, 45, 42, 45, 15, 46, 42, 46, 12, 45, 46, 42,
+    2,  48, 44, 48, 16, 49, 44, 49, 15, 48, 49, 44, 16, 50, 52, 50, 5,  51, 52, 51, 17, 50, 51, 52,
+    15, 53, 47, 53, 17, 54, 47, 54, 4,  53, 54, 47, 16, 52, 49, 52, 17, 53, 49, 53, 15, 52, 53, 49,
+    3,  40, 56, 40, 13, 55, 56, 55, 19, 40, 55, 56, 13, 37, 58, 37, 4,  57, 58, 57, 18, 37, 57, 58,
+    19, 59, 61, 59, 18, 60, 61, 60, 6,  59, 60, 61, 13, 58, 55, 58, 18, 59, 55, 59, 19, 58, 59, 55,
+    4,  62, 57, 62, 20, 63, 57, 63, 18, 62, 63, 57, 20, 64, 66, 64, 7,  65, 66, 65, 21, 64, 65, 66,
+    18, 67, 60, 67, 21, 68, 60, 68, 6,  67, 68, 60, 20, 66, 63, 66, 21, 67, 63, 67, 18, 66, 67, 63,
+    4,  54, 62, 54, 17, 69, 62, 69, 20, 54, 69, 62, 17, 51, 71, 51, 5,  70, 71, 70, 22, 51, 70, 71,
+    20, 72, 64, 72, 22, 73, 64, 73, 7,  72, 73, 64, 17, 71, 69, 71, 22, 72, 69, 72, 20, 71, 72, 69,
+    5,  74, 70, 74, 23, 75, 70, 75, 22, 74, 75, 70, 23, 76, 78, 76, 8,  77, 78, 77, 24, 76, 77, 78,
+    22, 79, 73, 79, 24, 80, 73, 80, 7,  79, 80, 73, 23, 78, 75, 78, 24, 79, 75, 79, 22, 78, 79, 75,
+};
+
+void writeLoopSubdivScene(const std::filesystem::path& path, const ControlMesh& mesh, uint32_t levels)
+{
+    std::ofstream file(path);
+    file << "LookAt 0 0 10  0 0 0  0 1 0\n";
+    file << "Camera \"perspective\" \"float fov\" [45]\n";
+    file << "WorldBegin\n";
+    file << "Shape \"loopsubdiv\" \"integer levels\" [" << levels << "]\n";
+    file << "    \"integer indices\" [";
+    for (uint32_t index : mesh.indices)
+        file << " " << index;
+    file << " ]\n    \"point3 P\" [";
+    for (const float3& p : mesh.positions)
+        file << " " << p.x << " " << p.y << " " << p.z;
+    file << " ]\n";
+}
+
+/// Subdivide a 128x128 grid (32K triangles) and report the number of output triangles per second.
+void benchmarkLoopSubdivide(CPUBenchmarkContext& ctx, uint32_t levels)
+{
+    const ControlMesh mesh = createGrid(128);
+    const size_t triangleCount = (mesh.indices.size() / 3) << (2 * levels);
+
+    ctx.setItemsPerIteration(triangleCount);
+    ctx.measure(
+        [&]()
+        {
+            auto result = pbrt::loopSubdivide(levels, mesh.positions, mesh.indices);
+            doNotOptimize(result.indices.data());
+        }
+    );
+}
+
+ref<Scene> importScene(const ref<Device>& pDevice, const std::filesystem::path& path)
+{
+    SceneBuilder builder(pDevice, path, Settings());
+    return builder.getScene();
+}
+} // namespace
+
+GPU_TEST(PBRTImporterLoopSubdiv)
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorTest_PBRTImporterLoopSubdiv.pbrt";
+    const ControlMesh mesh = createIcosahedron();
+
+    for (uint32_t levels = 0; levels <= 3; levels++)
+    {
+        writeLoopSubdivScene(path, mesh, levels);
+        ref<Scene> pScene = importScene(ctx.getDevice(), path);
+        ASSERT_EQ(pScene->getMeshCount(), 1u);
+
+        // Each level splits every face into four and adds one vertex per edge: V = 2 + 10 * 4^L and F = 20 * 4^L.
+        const uint32_t scale = 1u << (2 * levels);
+        const auto& meshDesc = pScene->getMesh(MeshID(0));
+        EXPECT_EQ(meshDesc.getTriangleCount(), 20 * scale);
+        EXPECT_EQ(meshDesc.vertexCount, 2 + 10 * scale);
+    }
+
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(PBRTImporterLoopSubdivGolden)
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+
+    struct TestCase
+    {
+        ControlMesh mesh;
+        uint32_t levels;
+        fstd::span<const float3> positions;
+        fstd::span<const uint32_t> indices;
+    };
+    const TestCase testCases[] = {
+        {createOctahedron(), 1, kOctahedronLevel1Positions, kOctahedronLevel1Indices},
+        {createGrid(), 1, kGridLevel1Positions, kGridLevel1Indices},
+        {createOctahedron(), 2, kOctahedronLevel2Positions, kOctahedronLevel2Indices},
+        {createGrid(), 2, kGridLevel2Positions, kGridLevel2Indices},
+    };
+
+    ref<Device> pDevice = ctx.getDevice();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorTest_PBRTImporterLoopSubdivGolden.pbrt";
+
+    for (const auto& testCase : testCases)
+    {
+        writeLoopSubdivScene(path, testCase.mesh, testCase.levels);
+        ref<Scene> pScene = importScene(pDevice, path);
+        ASSERT_EQ(pScene->getMeshCount(), 1u);
+
+        const auto& meshDesc = pScene->getMesh(MeshID(0));
+        const uint32_t triangleCount = (uint32_t)testCase.indices.size() / 3;
+        ASSERT_EQ(meshDesc.getTriangleCount(), triangleCount);
+        ASSERT_EQ(meshDesc.vertexCount, (uint32_t)testCase.positions.size());
+
+        std::map<std::string, ref<Buffer>> buffers;
+        buffers["triangleIndices"] = pDevice->createStructuredBuffer(sizeof(uint3), triangleCount);
+        buffers["positions"] = pDevice->createStructuredBuffer(sizeof(float3), meshDesc.vertexCount);
+        buffers["texcrds"] = pDevice->createStructuredBuffer(sizeof(float3), meshDesc.vertexCount);
+        pScene->getMeshVerticesAndIndices(MeshID(0), buffers);
+
+        const std::vector<uint3> triangles = buffers["triangleIndices"]->getElements<uint3>();
+        const std::vector<float3> positions = buffers["positions"]->getElements<float3>();
+
+        // The scene builder may renumber vertices, but keeps the triangle order and the corner order within each triangle.
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                const float3 expected = testCase.positions[testCase.indices[i * 3 + j]];
+                const float3 actual = positions[triangles[i][j]];
+                for (uint32_t k = 0; k < 3; k++)
+                    EXPECT_LE(std::abs(actual[k] - expected[k]), 1e-6f)
+                        << "levels " << testCase.levels << " triangle " << i << " corner " << j;
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_BENCHMARK(LoopSubdivide_Level1)
+{
+    benchmarkLoopSubdivide(ctx, 1);
+}
+
+CPU_BENCHMARK(LoopSubdivide_Level2)
+{
+    benchmarkLoopSubdivide(ctx, 2);
+}
+
+CPU_BENCHMARK(LoopSubdivide_Level3)
+{
+    benchmarkLoopSubdivide(ctx, 3);
+}
+} // namespace Falcor
@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Utils/Settings/Settings.h"
+#include <fstream>
+#include <sstream>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMeshCount = 32;
+const uint32_t kMaterialCount = 4;
+
+/// Generate a stage with meshes split into two GeomSubsets each, bound to a small set of shared materials.
+std::string generateStage()
+{
+    std::ostringstream ss;
+    ss << "#usda 1.0\n(\n    metersPerUnit = 1\n    upAxis = \"Y\"\n)\n\n";
+    ss << "def Xform \"World\"\n{\n";
+
+    for (uint32_t m = 0; m < kMaterialCount; m++)
+    {
+        ss << "    def Material \"Material" << m << "\"\n    {\n";
+        ss << "        token outputs:surface.connect = </World/Material" << m << "/Surface.outputs:surface>\n";
+        ss << "        def Shader \"Surface\"\n        {\n";
+        ss << "            uniform token info:id = \"UsdPreviewSurface\"\n";
+        ss << "            color3f inputs:diffuseColor = (" << (m + 1) / float(kMaterialCount) << ", 0.5, 0.5)\n";
+        ss << "            token outputs:surface\n";
+        ss << "        }\n    }\n";
+    }
+
+    for (uint32_t i = 0; i < kMeshCount; i++)
+    {
+        // Two quads next to each other, offset per mesh.
+        float z = float(i);
+        ss << "    def Mesh \"Mesh" << i << "\" (prepend apiSchemas = [\"MaterialBindingAPI\"])\n    {\n";
+        ss << "        int[] faceVertexCounts = [4, 4]\n";
+        ss << "        int[] faceVertexIndices = [0, 1, 4, 3, 1, 2, 5, 4]\n";
+        ss << "        point3f[] points = [(0, 0, " << z << "), (1, 0, " << z << "), (2, 0, " << z << "), (0, 1, " << z << "), (1, 1, " << z
+           << "), (2, 1, " << z << ")]\n";
+        ss << "        uniform token subdivisionScheme = \"none\"\n";
+        const char* subsetNames[] = {"Left", "Right"};
+        for (uint32_t s = 0; s < 2; s++)
+        {
+            ss << "        def GeomSubset \"" << subsetNames[s] << "\" (prepend apiSchemas = [\"MaterialBindingAPI\"])\n        {\n";
+            ss << "            uniform token elementType = \"face\"\n";
+            ss << "            uniform token familyName = \"materialBind\"\n";
+            ss << "            int[] indices = [" << s << "]\n";
+            ss << "            rel material:binding = </World/Material" << (i + s) % kMaterialCount << ">\n";
+            ss << "        }\n";
+        }
+        ss << "    }\n";
+    }
+
+    ss << "}\n";
+    return ss.str();
+}
+
+struct ImportResult
+{
+    std::vector<std::string> meshNames;
+    std::vector<uint32_t> meshTriangleCounts;
+    std::vector<std::string> meshMaterialNames;
+};
+
+ImportResult importStage(const ref<Device>& pDevice, const std::filesystem::path& path)
+{
+    SceneBuilder builder(pDevice, path, Settings(), SceneBuilder::Flags::DontMergeMaterials);
+    ref<Scene> pScene = builder.getScene();
+
+    ImportResult result;
+    for (uint32_t meshID = 0; meshID < pScene->getMeshCount(); meshID++)
+    {
+        const auto& meshDesc = pScene->getMesh(MeshID(meshID));
+        result.meshNames.push_back(pScene->getMeshName(meshID));
+        result.meshTriangleCounts.push_back(meshDesc.getTriangleCount());
+        result.meshMaterialNames.push_back(pScene->getMaterial(MaterialID(meshDesc.materialID))->getName());
+    }
+    return result;
+}
+} // namespace
+
+GPU_TEST(USDImporterDeterministicImport)
+{
+    PluginManager::instance().loadPluginByName("USDImporter");
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "FalcorTest_USDImporterDeterministicImport.usda";
+    {
+        std::ofstream file(path);
+        file << generateStage();
+    }
+
+    // Meshes are converted in parallel but registered in traversal order, so repeated imports must match.
+    ImportResult first = importStage(ctx.getDevice(), path);
+    ImportResult second = importStage(ctx.getDevice(), path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(first.meshNames.size(), size_t(kMeshCount * 2));
+    ASSERT_EQ(second.meshNames.size(), first.meshNames.size());
+    for (size_t i = 0; i < first.meshNames.size(); i++)
+    {
+        // Each subset becomes a separate mesh, in stage order.
+        std::string expectedName = fmt::format("/World/Mesh{}/{}", i / 2, i % 2 == 0 ? "Left" : "Right");
+        EXPECT_EQ(first.meshNames[i], expectedName);
+        EXPECT_EQ(first.meshTriangleCounts[i], 2u);
+        EXPECT_EQ(first.meshMaterialNames[i], fmt::format("/World/Material{}", (i / 2 + i % 2) % kMaterialCount));
+
+        EXPECT_EQ(second.meshNames[i], first.meshNames[i]);
+        EXPECT_EQ(second.meshTriangleCounts[i], first.meshTriangleCounts[i]);
+        EXPECT_EQ(second.meshMaterialNames[i], first.meshMaterialNames[i]);
+    }
+}
+} // namespace Falcor
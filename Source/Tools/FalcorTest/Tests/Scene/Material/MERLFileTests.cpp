@@ -27,11 +27,30 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Core/AssetResolver.h"
+#include "Core/Platform/OS.h"
 #include "Scene/Material/MERLFile.h"
+#include "Scene/Material/MERLMaterial.h"
 #include "Scene/Material/MERLMaterialData.slang"
+#include "Scene/Material/MeasuredBRDFCache.h"
+#include <cmath>
+#include <fstream>
+#include <limits>
 
 namespace Falcor
 {
+namespace
+{
+const int kDims[3] = {90, 90, 180};
+const size_t kSampleCount = 90 * 90 * 180;
+
+void writeMERLFile(const std::filesystem::path& path, const std::vector<double>& data)
+{
+    std::ofstream ofs(path, std::ios_base::binary);
+    ofs.write(reinterpret_cast<const char*>(kDims), sizeof(kDims));
+    ofs.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(double));
+}
+} // namespace
+
 GPU_TEST(MERLFile)
 {
     // TODO: This is not ideal, we should only access files in the runtime directory.
@@ -57,4 +76,102 @@ GPU_TEST(MERLFile)
         EXPECT_EQ(v.z, expected.z);
     }
 }
+
+CPU_TEST(MERLFile_SharedData)
+{
+    std::vector<double> data(3 * kSampleCount);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = double(i % 3000);
+    data[0] = -1.0;
+    data[kSampleCount + 1] = std::numeric_limits<double>::infinity();
+    data[2 * kSampleCount + 2] = std::numeric_limits<double>::quiet_NaN();
+
+    // Write two copies of the same BRDF.
+    const std::filesystem::path path = getTempFilePath();
+    const std::filesystem::path copyPath = getTempFilePath();
+    writeMERLFile(path, data);
+    writeMERLFile(copyPath, data);
+
+    {
+        MERLFile merlFile(path);
+        MERLFile sameFile(path);
+        MERLFile copyFile(copyPath);
+
+        // All instances share the decoded data as the files have identical content.
+        EXPECT(merlFile.getSharedData() != nullptr);
+        EXPECT(merlFile.getSharedData() == sameFile.getSharedData());
+        EXPECT(merlFile.getSharedData() == copyFile.getSharedData());
+        EXPECT(copyFile.getDesc().path == copyPath);
+
+        const auto& samples = merlFile.getData();
+        ASSERT_EQ(samples.size(), kSampleCount);
+
+        // Negative values are clamped, inf and NaN samples are set to zero.
+        EXPECT_EQ(samples[0].x, 0.f);
+        EXPECT_EQ(samples[0].y, float(data[kSampleCount] * (1.15 / 1500.0)));
+        EXPECT(all(samples[1] == float3(0.f)));
+        EXPECT(all(samples[2] == float3(0.f)));
+
+        for (size_t i = 3; i < kSampleCount; i += 997)
+        {
+            EXPECT_EQ(samples[i].x, float(data[i] * (1.0 / 1500.0)));
+            EXPECT_EQ(samples[i].y, float(data[i + kSampleCount] * (1.15 / 1500.0)));
+            EXPECT_EQ(samples[i].z, float(data[i + 2 * kSampleCount] * (1.66 / 1500.0)));
+        }
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(copyPath);
+}
+
+GPU_TEST(MERLMaterial_SharesBRDFData)
+{
+    std::vector<double> data(3 * kSampleCount, 1500.0);
+    const std::filesystem::path path = getTempFilePath();
+    const std::filesystem::path copyPath = getTempFilePath();
+    writeMERLFile(path, data);
+    writeMERLFile(copyPath, data);
+
+    // The material keeps its GPU copy of the BRDF but not the decoded data.
+    std::weak_ptr<const MERLFile::SharedData> pSharedData;
+    ref<MERLMaterial> pMaterial;
+    {
+        MERLFile merlFile(path);
+        pSharedData = merlFile.getSharedData();
+        pMaterial = make_ref<MERLMaterial>(ctx.getDevice(), merlFile);
+    }
+    ASSERT(pMaterial != nullptr);
+    EXPECT(pMaterial->getBRDFData() != nullptr);
+    EXPECT(pSharedData.expired());
+
+    // A material using an identical file shares the GPU buffer. The BRDF data isn't loaded again,
+    // so creating the material succeeds even though the file is removed after reading its header.
+    MERLFile copyFile;
+    ASSERT(copyFile.loadBRDF(copyPath, false));
+    EXPECT(copyFile.getSharedData() == nullptr);
+    std::filesystem::remove(copyPath);
+
+    ref<MERLMaterial> pCopyMaterial = make_ref<MERLMaterial>(ctx.getDevice(), copyFile);
+    EXPECT(pCopyMaterial->getBRDFData() == pMaterial->getBRDFData());
+    EXPECT(pSharedData.expired());
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(MeasuredBRDFCache_ComputeKey)
+{
+    // Use more than one hashing chunk.
+    std::vector<uint8_t> data(3 * 1024 * 1024 + 17);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = uint8_t(i * 7);
+
+    const auto key = MeasuredBRDFCache::computeKey(data.data(), data.size());
+    EXPECT(key == MeasuredBRDFCache::computeKey(data.data(), data.size()));
+
+    // Changing a single byte or the size changes the key.
+    data[2 * 1024 * 1024 + 5] ^= 1;
+    EXPECT(key != MeasuredBRDFCache::computeKey(data.data(), data.size()));
+    data[2 * 1024 * 1024 + 5] ^= 1;
+    EXPECT(key != MeasuredBRDFCache::computeKey(data.data(), data.size() - 1));
+}
 } // namespace Falcor
@@ -0,0 +1,356 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/Material/ClothMaterial.h"
+#include "Scene/Material/HairMaterial.h"
+#include "Scene/Material/MERLMaterial.h"
+#include "Scene/Material/MERLMixMaterial.h"
+#include "Scene/Material/MaterialTextureLoader.h"
+#include "Scene/Material/MeasuredBRDFCache.h"
+#include "Scene/Material/RGLMaterial.h"
+#include "Scene/Material/PBRT/PBRTDiffuseMaterial.h"
+#include "Scene/Scene.h"
+#include "Rendering/Materials/RGLAcquisition.h"
+#include "Core/AssetResolver.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMaterialCount = 2000;
+
+/// Linear search over the unique materials, as removeDuplicateMaterials() did before materials were hashed.
+std::vector<MaterialID> findDuplicatesReference(const std::vector<ref<Material>>& materials)
+{
+    std::vector<ref<Material>> uniqueMaterials;
+    std::vector<MaterialID> idMap(materials.size());
+
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&](const auto& m) { return m->isEqual(materials[i]); });
+        if (it == uniqueMaterials.end())
+        {
+            idMap[i] = MaterialID{uniqueMaterials.size()};
+            uniqueMaterials.push_back(materials[i]);
+        }
+        else
+        {
+            idMap[i] = MaterialID{(size_t)std::distance(uniqueMaterials.begin(), it)};
+        }
+    }
+
+    return idMap;
+}
+
+/// Create a set of materials where parameters are drawn from small sets of values, so that many materials are duplicates.
+std::vector<ref<Material>> createMaterials(ref<Device> pDevice)
+{
+    const std::filesystem::path merlPath = getProjectDirectory() / "media/test_scenes/materials/data/gray-lambert.binary";
+    const bool hasMERL = std::filesystem::exists(merlPath);
+
+    std::vector<ref<Texture>> textures = {
+        nullptr,
+        pDevice->createTexture2D(1, 1, ResourceFormat::RGBA8Unorm, 1, 1),
+        pDevice->createTexture2D(1, 1, ResourceFormat::RGBA8Unorm, 1, 1),
+    };
+
+    // Include signed zeros, which compare equal but have different bit patterns.
+    const float values[] = {0.f, -0.f, 0.5f};
+
+    std::mt19937 rng(0);
+    auto pick = [&](uint32_t count) { return std::uniform_int_distribution<uint32_t>(0, count - 1)(rng); };
+    auto pickValue = [&]() { return values[pick(3)]; };
+
+    std::vector<ref<Material>> materials;
+    for (uint32_t i = 0; i < kMaterialCount; i++)
+    {
+        const std::string name = "Material" + std::to_string(i);
+        ref<Material> pMaterial;
+        const uint32_t type = pick(hasMERL ? 6 : 4);
+
+        if (type < 4)
+        {
+            ref<BasicMaterial> pBasicMaterial;
+            switch (type)
+            {
+            case 0:
+            {
+                auto pStandard = StandardMaterial::create(pDevice, name);
+                pStandard->setRoughness(pickValue());
+                pStandard->setEmissiveColor(float3(pickValue()));
+                pBasicMaterial = pStandard;
+                break;
+            }
+            case 1:
+                pBasicMaterial = ClothMaterial::create(pDevice, name);
+                break;
+            case 2:
+                pBasicMaterial = HairMaterial::create(pDevice, name);
+                break;
+            default:
+                pBasicMaterial = PBRTDiffuseMaterial::create(pDevice, name);
+                break;
+            }
+            pBasicMaterial->setBaseColor(float4(pickValue(), 0.25f, pickValue(), 1.f));
+            if (auto pTexture = textures[pick((uint32_t)textures.size())])
+                pBasicMaterial->setBaseColorTexture(pTexture);
+            pMaterial = pBasicMaterial;
+        }
+        else if (type == 4)
+        {
+            pMaterial = MERLMaterial::create(pDevice, name, merlPath);
+        }
+        else
+        {
+            std::vector<std::filesystem::path> paths(1 + pick(2), merlPath);
+            pMaterial = MERLMixMaterial::create(pDevice, name, paths);
+        }
+
+        pMaterial->setDoubleSided(pick(2) == 0);
+        Transform transform;
+        transform.setTranslation(float3(pickValue(), 0.f, 0.f));
+        pMaterial->setTextureTransform(transform);
+
+        materials.push_back(pMaterial);
+    }
+
+    return materials;
+}
+
+/// Write an RGL file measured from a diffuse standard material to the given path.
+void writeRGLFile(GPUUnitTestContext& ctx, const std::filesystem::path& path)
+{
+    ref<StandardMaterial> pMaterial = StandardMaterial::create(ctx.getDevice(), "RGLSource");
+    pMaterial->setBaseColor(float4(0.5f, 0.5f, 0.5f, 1.f));
+    pMaterial->setRoughness(1.f);
+
+    Scene::SceneData sceneData;
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(ctx.getDevice());
+    MaterialID materialID = sceneData.pMaterials->addMaterial(pMaterial);
+    ref<Scene> pScene = Scene::create(ctx.getDevice(), std::move(sceneData));
+    pScene->update(ctx.getRenderContext(), 0.0);
+
+    RGLAcquisition acquisition(ctx.getDevice(), pScene);
+    acquisition.acquireIsotropic(ctx.getRenderContext(), materialID);
+
+    std::ofstream file(path, std::ios::binary);
+    acquisition.toRGLFile().saveFile(file);
+}
+} // namespace
+
+GPU_TEST(MaterialHashConsistentWithIsEqual)
+{
+    auto materials = createMaterials(ctx.getDevice());
+
+    size_t equalCount = 0;
+    for (size_t i = 0; i < 200; i++)
+    {
+        for (size_t j = 0; j < materials.size(); j++)
+        {
+            if (materials[i]->isEqual(materials[j]))
+            {
+                EXPECT_EQ(materials[i]->hash(), materials[j]->hash()) << "materials " << i << " and " << j;
+                equalCount++;
+            }
+        }
+    }
+    EXPECT_GT(equalCount, 200);
+}
+
+GPU_TEST(MaterialSystemRemoveDuplicateMaterials)
+{
+    auto materials = createMaterials(ctx.getDevice());
+    std::vector<MaterialID> expectedIdMap = findDuplicatesReference(materials);
+
+    MaterialSystem materialSystem(ctx.getDevice());
+    for (const auto& pMaterial : materials)
+        materialSystem.addMaterial(pMaterial);
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materialSystem.removeDuplicateMaterials(idMap);
+
+    ASSERT_EQ(idMap.size(), expectedIdMap.size());
+    for (size_t i = 0; i < idMap.size(); i++)
+        EXPECT_EQ(idMap[i].get(), expectedIdMap[i].get()) << "material " << i;
+
+    const size_t uniqueCount = std::max_element(expectedIdMap.begin(), expectedIdMap.end())->get() + 1;
+    EXPECT_EQ(removed, materials.size() - uniqueCount);
+    EXPECT_EQ((size_t)materialSystem.getMaterialCount(), uniqueCount);
+    EXPECT_GT(removed, 0);
+}
+
+GPU_TEST(MaterialHashRGL)
+{
+    // Write two files with identical content. RGL materials compare by path, so they are not duplicates.
+    const std::filesystem::path path = getTempFilePath();
+    const std::filesystem::path otherPath = getTempFilePath();
+    writeRGLFile(ctx, path);
+    std::filesystem::copy_file(path, otherPath, std::filesystem::copy_options::overwrite_existing);
+
+    std::vector<ref<Material>> materials = {
+        RGLMaterial::create(ctx.getDevice(), "RGL0", path),
+        RGLMaterial::create(ctx.getDevice(), "RGL1", path),
+        RGLMaterial::create(ctx.getDevice(), "RGL2", otherPath),
+        RGLMaterial::create(ctx.getDevice(), "RGL3", path),
+    };
+    materials[3]->setDoubleSided(!materials[0]->isDoubleSided());
+
+    EXPECT(materials[0]->isEqual(materials[1]));
+    EXPECT_EQ(materials[0]->hash(), materials[1]->hash());
+    EXPECT(!materials[0]->isEqual(materials[2]));
+    EXPECT(!materials[0]->isEqual(materials[3]));
+
+    MaterialSystem materialSystem(ctx.getDevice());
+    for (const auto& pMaterial : materials)
+        materialSystem.addMaterial(pMaterial);
+
+    std::vector<MaterialID> idMap;
+    EXPECT_EQ(materialSystem.removeDuplicateMaterials(idMap), 1);
+    std::vector<MaterialID> expectedIdMap = findDuplicatesReference(materials);
+    ASSERT_EQ(idMap.size(), expectedIdMap.size());
+    for (size_t i = 0; i < idMap.size(); i++)
+        EXPECT_EQ(idMap[i].get(), expectedIdMap[i].get()) << "material " << i;
+    EXPECT_EQ(idMap[1].get(), 0);
+
+    materials.clear();
+    std::filesystem::remove(path);
+    std::filesystem::remove(otherPath);
+}
+
+GPU_TEST(MaterialTextureLoaderConstantTextures)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Write an image where all texels have the same value.
+    const uint32_t size = 8;
+    const uint8_t texel[4] = {63, 127, 191, 255};
+    std::vector<uint8_t> data(size * size * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = texel[i % 4];
+    std::filesystem::path path = getTempFilePath();
+    path += ".png";
+    Bitmap::saveImage(path, size, size, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data());
+
+    MaterialSystem materialSystem(pDevice);
+    TextureManager& textureManager = materialSystem.getTextureManager();
+    auto pOptimized = StandardMaterial::create(pDevice, "Optimized");
+    auto pUnoptimized = StandardMaterial::create(pDevice, "Unoptimized");
+
+    {
+        MaterialTextureLoader loader(textureManager, false, true);
+        loader.loadTexture(pOptimized, Material::TextureSlot::BaseColor, path);
+        loader.loadTexture(pOptimized, Material::TextureSlot::Emissive, path);
+        loader.loadTexture(pOptimized, Material::TextureSlot::Normal, path);
+    }
+
+    // Base color and emissive textures are replaced by material parameters and never created.
+    // The normal map can't be replaced and is created on assignment.
+    const float4 value = float4(texel[0], texel[1], texel[2], texel[3]) / 255.f;
+    EXPECT(pOptimized->getBaseColorTexture() == nullptr);
+    EXPECT(pOptimized->getEmissiveTexture() == nullptr);
+    EXPECT(pOptimized->getNormalMap() != nullptr);
+    const float4 baseColor = pOptimized->getBaseColor();
+    const float3 emissive = pOptimized->getEmissiveColor();
+    for (int i = 0; i < 4; i++)
+        EXPECT_LE(std::abs(baseColor[i] - value[i]), 1e-3f) << "channel " << i;
+    for (int i = 0; i < 3; i++)
+        EXPECT_LE(std::abs(emissive[i] - value[i]), 1e-3f) << "channel " << i;
+    EXPECT_EQ(textureManager.getStats().textureCount, 1);
+
+    {
+        MaterialTextureLoader loader(textureManager, false, false);
+        loader.loadTexture(pUnoptimized, Material::TextureSlot::BaseColor, path);
+    }
+
+    // Without optimization the constant texture is created and assigned.
+    EXPECT(pUnoptimized->getBaseColorTexture() != nullptr);
+    EXPECT(pUnoptimized->getBaseColorTexture() == pOptimized->getNormalMap());
+
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(RGLMaterialSharedCache)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const std::filesystem::path path = getTempFilePath();
+    const std::filesystem::path copyPath = getTempFilePath();
+    const std::filesystem::path corruptPath = getTempFilePath();
+    writeRGLFile(ctx, path);
+    std::filesystem::copy_file(path, copyPath, std::filesystem::copy_options::overwrite_existing);
+
+    // The persisted albedo lookup table is identified by the content key of the file.
+    MeasuredBRDFCache::Key key;
+    {
+        MemoryMappedFile file(path);
+        ASSERT(file.isOpen());
+        key = MeasuredBRDFCache::getKey(path, file.getData(), file.getSize());
+    }
+    const std::filesystem::path lutPath = MeasuredBRDFCache::getAlbedoLUTPath(key);
+    std::filesystem::remove(lutPath);
+
+    // The first material computes the table and persists it.
+    auto pMaterial = RGLMaterial::create(pDevice, "RGL", path);
+    EXPECT(pMaterial->getAlbedoLUT() != nullptr);
+    std::vector<float4> lut;
+    EXPECT(MeasuredBRDFCache::loadAlbedoLUT(lutPath, RGLMaterialData::kAlbedoLUTSize, lut));
+
+    // A material loaded from a copy of the file uses the persisted table instead of computing it.
+    // Overwrite the table with a marker value to tell the two apart.
+    const float4 marker(0.25f, 0.5f, 0.75f, 1.f);
+    MeasuredBRDFCache::saveAlbedoLUT(lutPath, std::vector<float4>(RGLMaterialData::kAlbedoLUTSize, marker));
+    auto pCopy = RGLMaterial::create(pDevice, "RGLCopy", copyPath);
+    ASSERT(pCopy->getAlbedoLUT() != nullptr);
+
+    std::vector<uint8_t> texels = ctx.getRenderContext()->readTextureSubresource(pCopy->getAlbedoLUT().get(), 0);
+    ASSERT_EQ(texels.size(), RGLMaterialData::kAlbedoLUTSize * sizeof(float4));
+    const float4* pTexels = reinterpret_cast<const float4*>(texels.data());
+    for (uint32_t i = 0; i < RGLMaterialData::kAlbedoLUTSize; i++)
+        EXPECT(all(pTexels[i] == marker)) << "entry " << i;
+
+    // Truncated and corrupt files fail to load.
+    std::filesystem::resize_file(copyPath, std::filesystem::file_size(copyPath) / 2);
+    EXPECT_THROW(RGLMaterial::create(pDevice, "RGLTruncated", copyPath));
+    {
+        std::ofstream file(corruptPath, std::ios::binary);
+        file << "not an RGL file";
+    }
+    EXPECT_THROW(RGLMaterial::create(pDevice, "RGLCorrupt", corruptPath));
+
+    std::filesystem::remove(lutPath);
+    std::filesystem::remove(path);
+    std::filesystem::remove(copyPath);
+    std::filesystem::remove(corruptPath);
+}
+} // namespace Falcor
@@ -0,0 +1,160 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialTextureBaker.h"
+#include "Utils/Image/BakedTexture.h"
+#include "Core/Platform/OS.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+using Mode = ImageIO::CompressionMode;
+using Slot = Material::TextureSlot;
+using Status = MaterialTextureBaker::Status;
+
+std::filesystem::path writeImage(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> data(width * height * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)i;
+
+    std::filesystem::path path = getTempFilePath();
+    path += ".png";
+    Bitmap::saveImage(
+        path, width, height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data()
+    );
+    return path;
+}
+
+MaterialTextureBaker::Job createJob(const std::filesystem::path& sourcePath, Slot slot)
+{
+    MaterialTextureBaker::Job job;
+    job.sourcePath = sourcePath;
+    job.bakedPath = BakedTexture::getBakedPath(sourcePath);
+    job.slot = slot;
+    return job;
+}
+} // namespace
+
+CPU_TEST(MaterialTextureBaker_SelectCompressionMode)
+{
+    // Slot modes for 8-bit RGBA images.
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::BaseColor, ResourceFormat::RGBA8Unorm) == Mode::BC7);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Specular, ResourceFormat::RGBA8Unorm) == Mode::BC7);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Emissive, ResourceFormat::BGRA8Unorm) == Mode::BC7);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Transmission, ResourceFormat::RGBA8Unorm) == Mode::BC7);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Normal, ResourceFormat::RGBA8Unorm) == Mode::BC5);
+
+    // The bitmap format overrides the slot mode.
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::BaseColor, ResourceFormat::RGBA32Float) == Mode::BC6);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Normal, ResourceFormat::RGBA16Float) == Mode::BC6);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Specular, ResourceFormat::R8Unorm) == Mode::BC4);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::BaseColor, ResourceFormat::RG8Unorm) == Mode::BC5);
+
+    // Displacement and index maps are never compressed, whatever their format.
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Displacement, ResourceFormat::RGBA8Unorm) == Mode::None);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Displacement, ResourceFormat::R8Unorm) == Mode::None);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Displacement, ResourceFormat::RG8Unorm) == Mode::None);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Displacement, ResourceFormat::R32Float) == Mode::None);
+    EXPECT(MaterialTextureBaker::selectCompressionMode(Slot::Index, ResourceFormat::R8Unorm) == Mode::None);
+}
+
+CPU_TEST(MaterialTextureBaker_Manifest)
+{
+    const std::filesystem::path colorPath = writeImage(16, 16);
+    const std::filesystem::path displacementPath = writeImage(16, 16);
+    const std::filesystem::path oddSizePath = writeImage(6, 6);
+    const std::filesystem::path upToDatePath = writeImage(8, 8);
+    std::filesystem::path missingPath = getTempFilePath();
+    missingPath += ".png";
+
+    // Create an up-to-date baked texture. Its content is not inspected.
+    const std::filesystem::path upToDateBakedPath = BakedTexture::getBakedPath(upToDatePath);
+    std::ofstream(upToDateBakedPath) << "x";
+    std::filesystem::last_write_time(upToDateBakedPath, std::filesystem::last_write_time(upToDatePath) + std::chrono::seconds(10));
+
+    std::vector<MaterialTextureBaker::Job> jobs = {
+        createJob(colorPath, Slot::BaseColor),
+        createJob(displacementPath, Slot::Displacement),
+        createJob(oddSizePath, Slot::BaseColor),
+        createJob(upToDatePath, Slot::Normal),
+        createJob(missingPath, Slot::Specular),
+        createJob(getRuntimeDirectory() / "data/tests/BC1Unorm.dds", Slot::BaseColor),
+    };
+    for (auto& job : jobs)
+        MaterialTextureBaker::runJob(job, false, true /* dryRun */);
+
+    EXPECT(jobs[0].status == Status::Baked);
+    EXPECT(jobs[0].mode == Mode::BC7);
+    EXPECT_EQ(jobs[0].width, 16);
+    EXPECT_EQ(jobs[0].height, 16);
+    EXPECT(jobs[1].status == Status::Baked);
+    EXPECT(jobs[1].mode == Mode::None);
+    EXPECT(jobs[2].status == Status::Skipped);
+    EXPECT(jobs[3].status == Status::UpToDate);
+    EXPECT(jobs[4].status == Status::Failed);
+    EXPECT(jobs[5].status == Status::Skipped);
+
+    // A dry run does not write baked textures.
+    EXPECT(!std::filesystem::exists(jobs[0].bakedPath));
+
+    // Forcing ignores the up-to-date baked texture.
+    MaterialTextureBaker::Job forcedJob = createJob(upToDatePath, Slot::Normal);
+    MaterialTextureBaker::runJob(forcedJob, true, true);
+    EXPECT(forcedJob.status == Status::Baked);
+    EXPECT(forcedJob.mode == Mode::BC5);
+
+    std::filesystem::path manifestPath = getTempFilePath();
+    manifestPath += ".json";
+    MaterialTextureBaker::writeManifest(manifestPath, "scene.pyscene", jobs);
+
+    nlohmann::json manifest = nlohmann::json::parse(std::ifstream(manifestPath));
+    EXPECT_EQ(manifest["scene"].get<std::string>(), "scene.pyscene");
+    ASSERT_EQ(manifest["textures"].size(), jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        const auto& texture = manifest["textures"][i];
+        EXPECT_EQ(texture["source"].get<std::string>(), jobs[i].sourcePath.string());
+        EXPECT_EQ(texture["baked"].get<std::string>(), jobs[i].bakedPath.string());
+        EXPECT_EQ(texture["slot"].get<std::string>(), to_string(jobs[i].slot));
+        EXPECT_EQ(texture["mode"].get<std::string>(), to_string(jobs[i].mode));
+        EXPECT_EQ(texture["status"].get<std::string>(), to_string(jobs[i].status));
+        EXPECT_EQ(texture["width"].get<uint32_t>(), jobs[i].width);
+    }
+    EXPECT_EQ(manifest["textures"][0]["mode"].get<std::string>(), "BC7");
+    EXPECT_EQ(manifest["textures"][1]["status"].get<std::string>(), "baked");
+    EXPECT_EQ(manifest["textures"][3]["status"].get<std::string>(), "up-to-date");
+
+    for (const auto& path : {colorPath, displacementPath, oddSizePath, upToDatePath, upToDateBakedPath, manifestPath})
+        std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,249 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/SDFs/SparseVoxelSet/SDFSVS.h"
+#include "Utils/ScratchArena.h"
+#include "Utils/Settings/Settings.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <nlohmann/json.hpp>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kSmallMeshCount = 20000;
+const uint32_t kSDFGridWidth = 32;
+const uint32_t kSplitGridSize = 8;
+const size_t kSplitMaxTrianglesPerBLAS = 500;
+
+/// Vertex attributes of a small mesh, stored in the layout expected by SceneBuilder::Mesh.
+struct MeshData
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+
+    SceneBuilder::Mesh getMesh(const ref<Material>& pMaterial) const
+    {
+        SceneBuilder::Mesh mesh;
+        mesh.name = "SmallMesh";
+        mesh.faceCount = (uint32_t)(indices.size() / 3);
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+        mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.texCrds = {texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        return mesh;
+    }
+};
+
+MeshData createSmallMesh(float3 offset = float3(0.f))
+{
+    ref<TriangleMesh> pSphere = TriangleMesh::createSphere(0.5f, 8, 4);
+    MeshData data;
+    data.indices = pSphere->getIndices();
+    for (const auto& v : pSphere->getVertices())
+    {
+        data.positions.push_back(v.position + offset);
+        data.normals.push_back(v.normal);
+        data.texCrds.push_back(v.texCoord);
+    }
+    return data;
+}
+
+/// Process all meshes with the given scratch arena and return the elapsed time in ms.
+double processMeshes(
+    const SceneBuilder& builder,
+    const SceneBuilder::Mesh& mesh,
+    ScratchArena& arena,
+    std::vector<SceneBuilder::ProcessedMesh>& processedMeshes
+)
+{
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    for (auto& processedMesh : processedMeshes)
+        processedMesh = builder.processMesh(mesh, nullptr, nullptr, &arena);
+    return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+}
+} // namespace
+
+GPU_TEST(SceneBuilderManySmallMeshes)
+{
+    SceneBuilder builder(ctx.getDevice(), Settings(), SceneBuilder::Flags::None);
+    ref<Material> pMaterial = StandardMaterial::create(ctx.getDevice(), "Material");
+
+    MeshData meshData = createSmallMesh();
+    SceneBuilder::Mesh mesh = meshData.getMesh(pMaterial);
+
+    std::vector<SceneBuilder::ProcessedMesh> heapMeshes(kSmallMeshCount);
+    std::vector<SceneBuilder::ProcessedMesh> arenaMeshes(kSmallMeshCount);
+
+    // Process the meshes with an arena forwarding to the system allocator, then with a regular arena.
+    // Dedicated arenas are used so that the statistics are not affected by other tests running in parallel.
+    ScratchArena heapArena(ScratchArena::kDefaultBlockSize, true);
+    double heapTime = processMeshes(builder, mesh, heapArena, heapMeshes);
+    const ScratchArena::Stats& heapStats = heapArena.getStats();
+
+    ScratchArena arena;
+    double arenaTime = processMeshes(builder, mesh, arena, arenaMeshes);
+    const ScratchArena::Stats& arenaStats = arena.getStats();
+
+    // The timings are only reported, as they depend on the machine and the load of other tests.
+    logInfo(
+        "Processed {} meshes: system allocator {:.1f} ms ({} allocations), scratch arena {:.1f} ms ({} allocations).",
+        kSmallMeshCount,
+        heapTime,
+        heapStats.heapAllocationCount,
+        arenaTime,
+        arenaStats.heapAllocationCount
+    );
+
+    // Every temporary allocation goes to the heap in heap mode, and only a few blocks are needed otherwise.
+    EXPECT_EQ(heapStats.scopeCount, kSmallMeshCount);
+    EXPECT_EQ(heapStats.heapAllocationCount, heapStats.allocationCount);
+    EXPECT_EQ(arenaStats.scopeCount, kSmallMeshCount);
+    EXPECT_EQ(arenaStats.allocationCount, heapStats.allocationCount);
+    EXPECT_LT(arenaStats.heapAllocationCount * 100, arenaStats.allocationCount);
+
+    // The result must not depend on the allocator.
+    for (uint32_t i = 0; i < kSmallMeshCount; i++)
+    {
+        const auto& a = heapMeshes[i];
+        const auto& b = arenaMeshes[i];
+        ASSERT_EQ(a.indexData, b.indexData);
+        ASSERT_EQ(a.staticData.size(), b.staticData.size());
+        for (size_t j = 0; j < a.staticData.size(); j++)
+        {
+            EXPECT(all(a.staticData[j].position == b.staticData[j].position));
+            EXPECT(all(a.staticData[j].tangent == b.staticData[j].tangent));
+        }
+    }
+}
+
+GPU_TEST(SceneBuilderSplitMeshGroups)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "Material");
+
+    // Create a grid of small static meshes, which all end up in the same mesh group.
+    std::vector<MeshData> meshData;
+    for (uint32_t y = 0; y < kSplitGridSize; y++)
+        for (uint32_t x = 0; x < kSplitGridSize; x++)
+            meshData.push_back(createSmallMesh(float3(2.f * x, 2.f * y, 0.f)));
+    const size_t meshCount = meshData.size();
+    const size_t triangleCount = meshCount * meshData[0].indices.size() / 3;
+    ASSERT_GT(triangleCount, kSplitMaxTrianglesPerBLAS);
+
+    for (const char* strategy : {"Simple", "Median", "SAH"})
+    {
+        Settings settings;
+        settings.addOptions(nlohmann::json{
+            {"SceneBuilder:meshGroupSplitStrategy", strategy},
+            {"SceneBuilder:maxTrianglesPerBLAS", kSplitMaxTrianglesPerBLAS},
+        });
+        SceneBuilder builder(pDevice, settings, SceneBuilder::Flags::None);
+
+        SceneBuilder::Node node;
+        node.name = "Root";
+        NodeID nodeID = builder.addNode(node);
+        for (const auto& data : meshData)
+            builder.addMeshInstance(nodeID, builder.addMesh(data.getMesh(pMaterial)));
+
+        ref<Scene> pScene = builder.getScene();
+        ASSERT(pScene != nullptr);
+
+        // The group is split into BLASes under the limit, and no mesh is lost or split.
+        const auto& stats = builder.getMeshGroupSplitStats();
+        EXPECT_EQ(stats.splitGroupCount, 1) << strategy;
+        EXPECT_GE(stats.blasCount, div_round_up(triangleCount, kSplitMaxTrianglesPerBLAS)) << strategy;
+        EXPECT_LE(stats.maxTriangleCount, kSplitMaxTrianglesPerBLAS) << strategy;
+        EXPECT_EQ(stats.meshCount, meshCount) << strategy;
+        EXPECT_EQ(pScene->getMeshCount(), meshCount) << strategy;
+    }
+}
+
+GPU_TEST(SceneBuilderRemoveDuplicateSDFGrids)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    if (!pDevice->isShaderModelSupported(ShaderModel::SM6_5)) ctx.skip("SDF grids require Shader Model 6.5");
+
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "Material");
+
+    // Grids A and B have identical content, grid C differs.
+    auto createGrid = [&](uint32_t seed)
+    {
+        ref<SDFSVS> pSDFGrid = SDFSVS::create(pDevice);
+        pSDFGrid->generateCheeseValues(kSDFGridWidth, seed);
+        return pSDFGrid;
+    };
+    ref<SDFGrid> pGridA = createGrid(1);
+    ref<SDFGrid> pGridB = createGrid(1);
+    ref<SDFGrid> pGridC = createGrid(2);
+
+    EXPECT(pGridA->isContentEqual(*pGridB));
+    EXPECT_EQ(pGridA->getContentHash(), pGridB->getContentHash());
+    EXPECT(!pGridA->isContentEqual(*pGridC));
+    EXPECT_NE(pGridA->getContentHash(), pGridC->getContentHash());
+
+    auto buildScene = [&](bool mergeByContent)
+    {
+        Settings settings;
+        settings.addOptions(nlohmann::json{{"SceneBuilder:mergeSDFGridsByContent", mergeByContent}});
+        SceneBuilder builder(pDevice, settings, SceneBuilder::Flags::None);
+
+        // Grid A is added twice, which is always merged.
+        for (const ref<SDFGrid>& pGrid : {pGridA, pGridC, pGridB, pGridA})
+        {
+            SdfDescID descID = builder.addSDFGrid(pGrid, pMaterial);
+            SceneBuilder::Node node;
+            node.name = "SDFGridNode";
+            builder.addSDFGridInstance(builder.addNode(node), descID);
+        }
+        return builder.getScene();
+    };
+
+    ref<Scene> pMerged = buildScene(true);
+    ASSERT_EQ(pMerged->getSDFGridDescCount(), 4);
+    EXPECT_EQ(pMerged->getSDFGridCount(), 2);
+    EXPECT(pMerged->getSDFGrid(SdfGridID(0)) == pGridA);
+    EXPECT(pMerged->getSDFGrid(SdfGridID(1)) == pGridC);
+    EXPECT(pMerged->getSDFGrid(SdfGridID(2)) == pGridA);
+    EXPECT(pMerged->getSDFGrid(SdfGridID(3)) == pGridA);
+
+    ref<Scene> pUnmerged = buildScene(false);
+    ASSERT_EQ(pUnmerged->getSDFGridDescCount(), 4);
+    EXPECT_EQ(pUnmerged->getSDFGridCount(), 3);
+    EXPECT(pUnmerged->getSDFGrid(SdfGridID(2)) == pGridB);
+    EXPECT(pUnmerged->getSDFGrid(SdfGridID(3)) == pGridA);
+}
+} // namespace Falcor
@@ -0,0 +1,252 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCacheFile.h"
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kVersion = 1;
+
+std::vector<char> createData(size_t size, uint32_t seed)
+{
+    // Mix of runs and random bytes, so chunks compress but not trivially.
+    std::mt19937 rng(seed);
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = (i / 64) % 2 ? (char)(i / 4096) : (char)rng();
+    return data;
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<char>& data, BS::thread_pool& threadPool)
+{
+    SceneCacheFile::Writer writer(path, kVersion, threadPool);
+    std::ostream os(&writer);
+    // Write in pieces of varying size to exercise chunk boundaries.
+    for (size_t offset = 0, i = 0; offset < data.size(); i++)
+    {
+        const size_t size = std::min<size_t>(data.size() - offset, 1 + (i * 7919) % 100000);
+        os.write(data.data() + offset, size);
+        offset += size;
+    }
+    os.flush();
+    writer.finish();
+}
+
+std::vector<char> readBytes(const std::filesystem::path& path)
+{
+    std::ifstream fs(path, std::ios_base::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+}
+
+void writeBytes(const std::filesystem::path& path, const std::vector<char>& bytes)
+{
+    std::ofstream fs(path, std::ios_base::binary);
+    fs.write(bytes.data(), bytes.size());
+}
+
+std::vector<std::filesystem::path> listFiles(const std::filesystem::path& directory)
+{
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+        files.push_back(entry.path().filename());
+    std::sort(files.begin(), files.end());
+    return files;
+}
+} // namespace
+
+CPU_TEST(SceneCacheFile_RoundTrip)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    const std::filesystem::path path = directory / "cache";
+    BS::thread_pool threadPool(4);
+
+    const size_t kChunkSize = SceneCacheFile::kChunkSize;
+    for (size_t size : {size_t(0), size_t(1), kChunkSize - 1, kChunkSize, kChunkSize + 1, 5 * kChunkSize + 12345})
+    {
+        const std::vector<char> data = createData(size, (uint32_t)size);
+        writeFile(path, data, threadPool);
+        EXPECT(SceneCacheFile::hasValidHeader(path, kVersion));
+        EXPECT(!SceneCacheFile::hasValidHeader(path, kVersion + 1));
+        EXPECT(SceneCacheFile::read(path, kVersion) == data) << "size = " << size;
+    }
+
+    // Single bytes written through the stream end up in the same chunks.
+    {
+        const std::vector<char> data = createData(kChunkSize + 100, 1);
+        SceneCacheFile::Writer writer(path, kVersion, threadPool);
+        std::ostream os(&writer);
+        for (char c : data)
+            os.put(c);
+        writer.finish();
+        EXPECT_EQ(writer.getChunkCount(), 2);
+        EXPECT(SceneCacheFile::read(path, kVersion) == data);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(SceneCacheFile_AtomicRename)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    const std::filesystem::path path = directory / "cache";
+    BS::thread_pool threadPool(4);
+
+    const std::vector<char> oldData = createData(1000, 1);
+    writeFile(path, oldData, threadPool);
+
+    // Until the writer is finished, the data goes to a temporary file and the existing file is unchanged.
+    const std::vector<char> newData = createData(3 * SceneCacheFile::kChunkSize, 2);
+    {
+        SceneCacheFile::Writer writer(path, kVersion, threadPool);
+        std::ostream os(&writer);
+        os.write(newData.data(), newData.size());
+        EXPECT(std::filesystem::exists(writer.getTempPath()));
+        EXPECT(writer.getTempPath().parent_path() == directory);
+        EXPECT(SceneCacheFile::read(path, kVersion) == oldData);
+
+        writer.finish();
+        EXPECT(!std::filesystem::exists(writer.getTempPath()));
+    }
+    EXPECT(SceneCacheFile::read(path, kVersion) == newData);
+
+    // Only the file and its lock file are left.
+    std::vector<std::filesystem::path> expectedFiles = {"cache", "cache.lock"};
+    EXPECT(listFiles(directory) == expectedFiles);
+
+    // A writer that is not finished removes its temporary file and leaves the existing file unchanged.
+    {
+        SceneCacheFile::Writer writer(path, kVersion, threadPool);
+        std::ostream os(&writer);
+        os.write(oldData.data(), oldData.size());
+        os.write(newData.data(), newData.size());
+    }
+    EXPECT(listFiles(directory) == expectedFiles);
+    EXPECT(SceneCacheFile::read(path, kVersion) == newData);
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(SceneCacheFile_Corrupt)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    const std::filesystem::path path = directory / "cache";
+    const std::filesystem::path corruptPath = directory / "corrupt";
+    BS::thread_pool threadPool(4);
+
+    EXPECT_THROW(SceneCacheFile::read(directory / "missing", kVersion));
+    EXPECT(!SceneCacheFile::hasValidHeader(directory / "missing", kVersion));
+
+    const std::vector<char> data = createData(2 * SceneCacheFile::kChunkSize + 1000, 3);
+    writeFile(path, data, threadPool);
+    const std::vector<char> bytes = readBytes(path);
+
+    // Layout: 12 B header, then per chunk 16 B info and the compressed data, then a 16 B terminator and the 8 B total size.
+    const size_t kHeaderSize = 12;
+    const size_t kInfoSize = 16;
+    auto getChunkOffset = [&](size_t index)
+    {
+        size_t offset = kHeaderSize;
+        for (size_t i = 0; i < index; i++)
+        {
+            uint32_t compressedSize;
+            std::memcpy(&compressedSize, bytes.data() + offset + 4, sizeof(compressedSize));
+            offset += kInfoSize + compressedSize;
+        }
+        return offset;
+    };
+    ASSERT_EQ(getChunkOffset(3) + kInfoSize + 8, bytes.size());
+
+    auto expectRejected = [&](std::vector<char> corrupt, const std::string& what)
+    {
+        writeBytes(corruptPath, corrupt);
+        bool rejected = false;
+        try
+        {
+            SceneCacheFile::read(corruptPath, kVersion);
+        }
+        catch (const std::exception&)
+        {
+            rejected = true;
+        }
+        EXPECT(rejected) << what;
+    };
+
+    // Truncated anywhere, including right before the terminator.
+    for (size_t size : {size_t(0), size_t(4), kHeaderSize, kHeaderSize + 8, getChunkOffset(1), getChunkOffset(1) + 100, getChunkOffset(3), bytes.size() - 1})
+        expectRejected(std::vector<char>(bytes.begin(), bytes.begin() + size), fmt::format("truncated to {} bytes", size));
+
+    // Trailing garbage.
+    {
+        auto corrupt = bytes;
+        corrupt.push_back(0);
+        expectRejected(corrupt, "trailing byte");
+    }
+
+    // Corrupt header.
+    {
+        auto corrupt = bytes;
+        corrupt[0] ^= 1;
+        expectRejected(corrupt, "magic");
+        EXPECT(!SceneCacheFile::hasValidHeader(corruptPath, kVersion));
+    }
+    EXPECT_THROW(SceneCacheFile::read(path, kVersion + 1));
+
+    // Corrupt chunk data is detected by the checksum.
+    for (size_t chunk = 0; chunk < 3; chunk++)
+    {
+        auto corrupt = bytes;
+        corrupt[getChunkOffset(chunk) + kInfoSize + 10] ^= 0x40;
+        expectRejected(corrupt, fmt::format("data of chunk {}", chunk));
+    }
+
+    // Corrupt chunk infos.
+    auto patch = [&](size_t offset, uint32_t value)
+    {
+        auto corrupt = bytes;
+        std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+        return corrupt;
+    };
+    expectRejected(patch(getChunkOffset(0), 1000), "first chunk smaller than chunk size");
+    expectRejected(patch(getChunkOffset(0), (uint32_t)SceneCacheFile::kChunkSize + 1), "chunk larger than chunk size");
+    expectRejected(patch(getChunkOffset(2), 999), "wrong size of last chunk");
+    expectRejected(patch(getChunkOffset(1) + 4, 0), "empty chunk");
+    expectRejected(patch(getChunkOffset(1) + 4, 0xffffffff), "compressed size out of range");
+    expectRejected(patch(getChunkOffset(1) + 8, 0), "checksum");
+    expectRejected(patch(getChunkOffset(3) + 4, 1), "terminator");
+    expectRejected(patch(getChunkOffset(3) + kInfoSize, 0), "total size");
+
+    // The original file is still valid.
+    EXPECT(SceneCacheFile::read(path, kVersion) == data);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
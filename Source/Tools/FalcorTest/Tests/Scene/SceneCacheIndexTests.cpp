@@ -0,0 +1,260 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include "Scene/SceneCacheIndex.h"
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kVersion = 1;
+const std::vector<std::string> kSidecarExtensions = {".lock", ".build.lock", ".blas"};
+
+std::string getName(uint32_t i)
+{
+    return fmt::format("{:040x}", i);
+}
+
+void writeFile(const std::filesystem::path& path, size_t byteSize)
+{
+    std::ofstream fs(path, std::ios_base::binary);
+    std::vector<char> data(byteSize, 'x');
+    fs.write(data.data(), data.size());
+}
+
+bool hasFiles(const std::filesystem::path& directory, const std::string& name)
+{
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+        if (entry.path().filename().string().rfind(name, 0) == 0)
+            return true;
+    return false;
+}
+} // namespace
+
+CPU_TEST(SceneCacheIndex_LRUEviction)
+{
+    const std::filesystem::path directory = getTempFilePath();
+
+    // Create four entries of 1000 bytes each, touched in order.
+    {
+        SceneCacheIndex index(directory, kVersion, kSidecarExtensions);
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            writeFile(directory / getName(i), 1000);
+            index.touch(getName(i));
+        }
+        EXPECT_EQ(index.getTotalByteSize(), 4000);
+        EXPECT(index.getEntryNames() == std::vector<std::string>({getName(0), getName(1), getName(2), getName(3)}));
+
+        // Using an entry makes it the most recently used.
+        index.touch(getName(0));
+        EXPECT(index.getEntryNames() == std::vector<std::string>({getName(1), getName(2), getName(3), getName(0)}));
+
+        // No eviction within the limit or without a limit.
+        EXPECT_EQ(index.evict(4000).evictionCount, 0);
+        EXPECT_EQ(index.evict(0).evictionCount, 0);
+        index.save();
+    }
+
+    // The order is persistent. The least recently used entries are evicted first, except the one to keep.
+    {
+        SceneCacheIndex index(directory, kVersion, kSidecarExtensions);
+        EXPECT(index.getEntryNames() == std::vector<std::string>({getName(1), getName(2), getName(3), getName(0)}));
+
+        SceneCacheIndex::EvictionStats stats = index.evict(2000, getName(1));
+        EXPECT_EQ(stats.evictionCount, 2);
+        EXPECT_EQ(stats.evictedByteSize, 2000);
+        EXPECT(index.getEntryNames() == std::vector<std::string>({getName(1), getName(0)}));
+        EXPECT(std::filesystem::exists(directory / getName(1)));
+        EXPECT(!std::filesystem::exists(directory / getName(2)));
+        EXPECT(!std::filesystem::exists(directory / getName(3)));
+        index.save();
+    }
+
+    // Entries whose files were removed are dropped when loading.
+    std::filesystem::remove(directory / getName(1));
+    {
+        SceneCacheIndex index(directory, kVersion, kSidecarExtensions);
+        EXPECT(index.getEntryNames() == std::vector<std::string>({getName(0)}));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(SceneCacheIndex_SizeCap)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    SceneCacheIndex index(directory, kVersion, kSidecarExtensions);
+
+    // Sidecar files count toward the size of an entry.
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const auto cachePath = directory / getName(i);
+        writeFile(cachePath, 1000);
+        writeFile(std::filesystem::path(cachePath) += ".blas", 100 * (i + 1));
+        writeFile(std::filesystem::path(cachePath) += ".lock", 0);
+        writeFile(std::filesystem::path(cachePath) += ".build.lock", 0);
+        index.touch(getName(i));
+    }
+    EXPECT_EQ(index.getByteSize(getName(0)), 1100);
+    EXPECT_EQ(index.getByteSize(getName(3)), 1400);
+    EXPECT_EQ(index.getTotalByteSize(), 5000);
+
+    // Entries locked by another user are skipped. The lock files are only locked, not created, if they are missing.
+    LockFile lockFile(directory / (getName(0) + ".lock"));
+    ASSERT(lockFile.tryLock(LockFile::LockType::Shared));
+    LockFile buildLockFile(directory / (getName(1) + ".build.lock"));
+    ASSERT(buildLockFile.tryLock(LockFile::LockType::Exclusive));
+
+    // Evicting entry 2 brings the total size within the cap. Its sidecars are removed with it.
+    SceneCacheIndex::EvictionStats stats = index.evict(3800);
+    EXPECT_EQ(stats.evictionCount, 1);
+    EXPECT_EQ(stats.evictedByteSize, 1300);
+    EXPECT_LE(index.getTotalByteSize(), 3800);
+    EXPECT(!hasFiles(directory, getName(2)));
+    EXPECT(hasFiles(directory, getName(0)));
+    EXPECT(hasFiles(directory, getName(1)));
+
+    // Once unlocked, the remaining entries are evicted down to the cap, except the one to keep.
+    lockFile.close();
+    buildLockFile.close();
+    stats = index.evict(1, getName(3));
+    EXPECT_EQ(stats.evictionCount, 2);
+    EXPECT_EQ(stats.evictedByteSize, 2300);
+    EXPECT(index.getEntryNames() == std::vector<std::string>({getName(3)}));
+    EXPECT(!hasFiles(directory, getName(0)));
+    EXPECT(!hasFiles(directory, getName(1)));
+    EXPECT(std::filesystem::exists(directory / (getName(3) + ".blas")));
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(SceneCacheIndex_Rebuild)
+{
+    const std::filesystem::path directory = getTempFilePath();
+    std::filesystem::create_directories(directory);
+
+    writeFile(directory / getName(0), 1000);
+    writeFile(directory / getName(1), 2000);
+    writeFile(directory / (getName(1) + ".blas"), 500);
+    // Files that are not cache files are ignored.
+    writeFile(directory / "other", 100);
+    writeFile(directory / (getName(2) + ".tmp"), 100);
+
+    auto expectRebuilt = [&](const std::string& what)
+    {
+        SceneCacheIndex index(directory, kVersion, kSidecarExtensions);
+        auto names = index.getEntryNames();
+        std::sort(names.begin(), names.end());
+        EXPECT(names == std::vector<std::string>({getName(0), getName(1)})) << what;
+        EXPECT_EQ(index.getByteSize(getName(0)), 1000) << what;
+        EXPECT_EQ(index.getByteSize(getName(1)), 2500) << what;
+
+        // Rebuilt entries are evicted before entries that have been used.
+        index.touch(getName(0));
+        EXPECT(index.getEntryNames().back() == getName(0)) << what;
+    };
+
+    const auto indexPath = directory / SceneCacheIndex::kIndexFilename;
+    expectRebuilt("missing index");
+
+    const std::string badEntry = fmt::format("{{\"version\": 1, \"entries\": {{\"{}\": 1}}}}", getName(0));
+    for (const std::string& content : {std::string(), std::string("{"), std::string("not json"), std::string("[]"), std::string("{\"version\": 1}"), badEntry})
+    {
+        std::ofstream(indexPath) << content;
+        expectRebuilt(fmt::format("index '{}'", content));
+    }
+
+    // An index written for another version is rebuilt.
+    {
+        SceneCacheIndex index(directory, kVersion + 1, kSidecarExtensions);
+        index.touch(getName(1));
+        index.save();
+    }
+    expectRebuilt("other version");
+
+    std::filesystem::remove_all(directory);
+}
+
+GPU_TEST(SceneCache_Stats)
+{
+    const std::filesystem::path prevDirectory = SceneCache::getCacheDirectory();
+    const uint64_t prevSizeLimit = SceneCache::getSizeLimit();
+    const std::filesystem::path directory = getTempFilePath();
+    SceneCache::setCacheDirectory(directory);
+    SceneCache::setSizeLimit(0);
+    SceneCache::resetStats();
+
+    Scene::SceneData sceneData;
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(ctx.getDevice());
+
+    SceneCache::Key keys[2];
+    for (size_t i = 0; i < 2; i++)
+        keys[i].fill((uint8_t)(i + 1));
+
+    // A lookup without a cache is a miss and grants the build lock.
+    SceneCache::BuildLock buildLock;
+    EXPECT(!SceneCache::findCache(keys[0], buildLock));
+    EXPECT(buildLock != nullptr);
+    SceneCache::writeCache(sceneData, keys[0], std::move(buildLock));
+    SceneCache::writeBlasBuildCache(BlasBuildCache{}, keys[0]);
+
+    // Lookups wait for pending writes, so the cache is found.
+    EXPECT(SceneCache::findCache(keys[0], buildLock));
+    EXPECT(buildLock == nullptr);
+
+    SceneCache::Stats stats = SceneCache::getStats();
+    EXPECT_EQ(stats.hitCount, 1);
+    EXPECT_EQ(stats.missCount, 1);
+    EXPECT_EQ(stats.evictionCount, 0);
+
+    // Writing a second cache with a size limit of one byte evicts the first one along with its sidecar files.
+    SceneCache::setSizeLimit(1);
+    EXPECT(!SceneCache::findCache(keys[1], buildLock));
+    SceneCache::writeCache(sceneData, keys[1], std::move(buildLock));
+    SceneCache::waitForPendingWrites();
+
+    stats = SceneCache::getStats();
+    EXPECT_EQ(stats.hitCount, 1);
+    EXPECT_EQ(stats.missCount, 2);
+    EXPECT_EQ(stats.evictionCount, 1);
+    EXPECT_GT(stats.evictedByteSize, 0);
+    EXPECT(!hasFiles(directory, SHA1::toString(keys[0])));
+    EXPECT(SceneCache::hasValidCache(keys[1]));
+
+    SceneCache::resetStats();
+    stats = SceneCache::getStats();
+    EXPECT_EQ(stats.hitCount + stats.missCount + stats.evictionCount + stats.evictedByteSize, 0);
+
+    SceneCache::setCacheDirectory(prevDirectory);
+    SceneCache::setSizeLimit(prevSizeLimit);
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
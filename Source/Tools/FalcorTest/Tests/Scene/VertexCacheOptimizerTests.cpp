@@ -0,0 +1,315 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/VertexCacheOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Creates a regular grid of size x size quads with the triangles in random order.
+void makeShuffledGrid(uint32_t size, std::vector<uint32_t>& indices, std::vector<float3>& positions)
+{
+    positions.clear();
+    for (uint32_t y = 0; y <= size; y++)
+        for (uint32_t x = 0; x <= size; x++)
+            positions.push_back(float3((float)x, (float)y, 0.f));
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t v0 = y * (size + 1) + x;
+            uint32_t v1 = v0 + 1;
+            uint32_t v2 = v0 + size + 1;
+            uint32_t v3 = v2 + 1;
+            triangles.push_back({v0, v1, v2});
+            triangles.push_back({v2, v1, v3});
+        }
+    }
+    std::mt19937 rng(1);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    indices.clear();
+    for (const auto& t : triangles)
+        indices.insert(indices.end(), t.begin(), t.end());
+}
+
+/// Returns the triangles with their vertices rotated so that the smallest index is first, preserving the winding.
+std::vector<std::array<uint32_t, 3>> getSortedTriangles(const std::vector<uint32_t>& indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> t = {indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+/// Vertex data of a mesh, in the layout used by optimizeVertexOrder().
+struct MeshVertexData
+{
+    std::vector<uint32_t> indexData;
+    uint32_t indexCount = 0;
+    bool use16BitIndices = false;
+    std::vector<StaticVertexData> staticData;
+    std::vector<SkinningVertexData> skinningData;
+    std::vector<std::vector<PackedStaticVertexData>> keyframes;
+
+    uint32_t getIndex(uint32_t i) const
+    {
+        return use16BitIndices ? reinterpret_cast<const uint16_t*>(indexData.data())[i] : indexData[i];
+    }
+};
+
+/// Creates a shuffled grid mesh, optionally with skinning data or vertex animation keyframes.
+MeshVertexData makeMesh(bool use16BitIndices, bool skinned, bool keyframed)
+{
+    const uint32_t size = 16;
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    makeShuffledGrid(size, indices, positions);
+
+    MeshVertexData mesh;
+    mesh.indexCount = (uint32_t)indices.size();
+    mesh.use16BitIndices = use16BitIndices;
+    if (use16BitIndices)
+    {
+        mesh.indexData.resize((indices.size() + 1) / 2, 0);
+        uint16_t* pIndices = reinterpret_cast<uint16_t*>(mesh.indexData.data());
+        for (size_t i = 0; i < indices.size(); i++)
+            pIndices[i] = (uint16_t)indices[i];
+    }
+    else
+    {
+        mesh.indexData = indices;
+    }
+
+    for (uint32_t v = 0; v < positions.size(); v++)
+    {
+        StaticVertexData vertex = {};
+        vertex.position = positions[v];
+        vertex.normal = float3(0.f, 0.f, 1.f);
+        vertex.texCrd = float2(positions[v].x, positions[v].y) / (float)size;
+        mesh.staticData.push_back(vertex);
+
+        if (skinned)
+        {
+            SkinningVertexData s = {};
+            s.boneID = uint4(v % 5, v % 7, 0, 0);
+            s.boneWeight = float4(0.25f + 0.001f * v, 0.75f - 0.001f * v, 0.f, 0.f);
+            s.staticIndex = v;
+            mesh.skinningData.push_back(s);
+        }
+    }
+
+    if (keyframed)
+    {
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            std::vector<PackedStaticVertexData> vertexData(positions.size());
+            for (uint32_t v = 0; v < positions.size(); v++)
+            {
+                StaticVertexData vertex = mesh.staticData[v];
+                vertex.position += float3(0.f, 0.f, (k + 1) * positions[v].x);
+                vertexData[v].pack(vertex);
+            }
+            mesh.keyframes.push_back(vertexData);
+        }
+    }
+    return mesh;
+}
+
+/// Returns the attributes of the vertices of each triangle, including the skinning data, the skinned static vertex and the keyframes.
+/// The vertices are rotated to start with the smallest attributes, preserving the winding, and the triangles are sorted,
+/// so that meshes can be compared independently of the triangle and vertex order.
+std::vector<std::vector<float>> getTriangleAttributes(const MeshVertexData& mesh)
+{
+    std::vector<std::vector<float>> triangles;
+    for (uint32_t t = 0; t < mesh.indexCount / 3; t++)
+    {
+        std::array<std::vector<float>, 3> corners;
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            const uint32_t v = mesh.getIndex(3 * t + k);
+            const StaticVertexData& vertex = mesh.staticData[v];
+            auto& c = corners[k];
+            c = {vertex.position.x, vertex.position.y, vertex.position.z, vertex.texCrd.x, vertex.texCrd.y};
+            if (!mesh.skinningData.empty())
+            {
+                const SkinningVertexData& s = mesh.skinningData[v];
+                const float3 staticPosition = mesh.staticData[s.staticIndex].position;
+                c.insert(c.end(), {(float)s.boneID.x, (float)s.boneID.y, s.boneWeight.x, s.boneWeight.y, staticPosition.x, staticPosition.y, staticPosition.z});
+            }
+            for (const auto& keyframe : mesh.keyframes)
+                c.insert(c.end(), {keyframe[v].position.x, keyframe[v].position.y, keyframe[v].position.z});
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+        std::vector<float> triangle;
+        for (const auto& c : corners)
+            triangle.insert(triangle.end(), c.begin(), c.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+CPU_TEST(VertexCacheOptimizer_Stats)
+{
+    // A single quad loads 4 vertices for 2 triangles.
+    std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+    VertexCacheStats stats = computeVertexCacheStats(indices, 4);
+    EXPECT_EQ(stats.triangleCount, 2);
+    EXPECT_EQ(stats.vertexCount, 4);
+    EXPECT_EQ(stats.cacheMissCount, 4);
+    EXPECT_EQ(stats.getACMR(), 2.0);
+    EXPECT_EQ(stats.getATVR(), 1.0);
+
+    // With a cache of 3 entries, vertex 0 is evicted before it is used again.
+    indices = {0, 1, 2, 3, 4, 5, 0, 4, 5};
+    stats = computeVertexCacheStats(indices, 6, 3);
+    EXPECT_EQ(stats.cacheMissCount, 7);
+}
+
+CPU_TEST(VertexCacheOptimizer_Optimize)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    makeShuffledGrid(64, indices, positions);
+    const uint32_t vertexCount = (uint32_t)positions.size();
+    const auto originalTriangles = getSortedTriangles(indices);
+
+    VertexCacheStats before = computeVertexCacheStats(indices, vertexCount);
+    optimizeVertexCache(indices, vertexCount);
+    VertexCacheStats after = computeVertexCacheStats(indices, vertexCount);
+
+    // The triangles and their winding are preserved.
+    EXPECT(getSortedTriangles(indices) == originalTriangles);
+
+    // A shuffled grid loads almost every vertex for every triangle, an optimized one less than one vertex per triangle.
+    EXPECT_GT(before.getACMR(), 2.5);
+    EXPECT_LT(after.getACMR(), 0.8);
+    EXPECT_LT(after.getATVR(), 1.6);
+
+    // Overdraw optimization keeps the cache efficiency within the threshold.
+    optimizeOverdraw(indices, positions, 1.05f);
+    EXPECT(getSortedTriangles(indices) == originalTriangles);
+    EXPECT_LE(computeVertexCacheStats(indices, vertexCount).getACMR(), after.getACMR() * 1.05 + 1e-9);
+}
+
+CPU_TEST(VertexCacheOptimizer_HighValence)
+{
+    // A triangle fan in random order, where the center vertex is used by every triangle.
+    const uint32_t triangleCount = 50000;
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t i = 0; i < triangleCount; i++)
+        triangles.push_back({0, i + 1, (i + 1) % triangleCount + 1});
+    std::mt19937 rng(2);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    std::vector<uint32_t> indices;
+    for (const auto& t : triangles)
+        indices.insert(indices.end(), t.begin(), t.end());
+    const uint32_t vertexCount = triangleCount + 1;
+    const auto originalTriangles = getSortedTriangles(indices);
+
+    VertexCacheStats before = computeVertexCacheStats(indices, vertexCount);
+    optimizeVertexCache(indices, vertexCount);
+    VertexCacheStats after = computeVertexCacheStats(indices, vertexCount);
+
+    // The candidate scan is bounded, the fan is still walked along its rim.
+    EXPECT(getSortedTriangles(indices) == originalTriangles);
+    EXPECT_GT(before.getACMR(), 1.9);
+    EXPECT_LT(after.getACMR(), 1.2);
+}
+
+CPU_TEST(VertexCacheOptimizer_MeshVertexOrder)
+{
+    for (bool use16BitIndices : {false, true})
+    {
+        for (bool skinned : {false, true})
+        {
+            MeshVertexData mesh = makeMesh(use16BitIndices, skinned, !skinned);
+            const uint32_t vertexCount = (uint32_t)mesh.staticData.size();
+            const size_t indexDataSize = mesh.indexData.size();
+            const auto trianglesBefore = getTriangleAttributes(mesh);
+
+            VertexOrderStats stats = optimizeVertexOrder(
+                mesh.indexData,
+                mesh.indexCount,
+                mesh.use16BitIndices,
+                mesh.staticData,
+                mesh.skinningData,
+                skinned ? nullptr : &mesh.keyframes
+            );
+
+            // Every triangle references the same vertex data as before, in the original index format.
+            ASSERT_EQ(mesh.indexData.size(), indexDataSize) << "16-bit " << use16BitIndices << " skinned " << skinned;
+            for (uint32_t i = 0; i < mesh.indexCount; i++)
+                ASSERT_LT(mesh.getIndex(i), vertexCount) << "16-bit " << use16BitIndices << " skinned " << skinned;
+            EXPECT(getTriangleAttributes(mesh) == trianglesBefore) << "16-bit " << use16BitIndices << " skinned " << skinned;
+
+            // Skinned vertices still reference their own static vertex.
+            for (uint32_t v = 0; v < mesh.skinningData.size(); v++)
+                EXPECT_EQ(mesh.skinningData[v].staticIndex, v);
+
+            EXPECT_EQ(stats.before.triangleCount, mesh.indexCount / 3);
+            EXPECT_LT(stats.after.getACMR(), stats.before.getACMR());
+        }
+    }
+}
+
+CPU_TEST(VertexCacheOptimizer_VertexFetch)
+{
+    // Vertices are renumbered in order of first use, unused vertices go last.
+    std::vector<uint32_t> indices = {4, 2, 0, 0, 2, 5};
+    auto remap = optimizeVertexFetch(indices, 7);
+    EXPECT(indices == std::vector<uint32_t>({0, 1, 2, 2, 1, 3}));
+    EXPECT(remap == std::vector<uint32_t>({2, 4, 1, 5, 0, 3, 6}));
+
+    // The remap is a permutation for an optimized mesh.
+    std::vector<float3> positions;
+    makeShuffledGrid(16, indices, positions);
+    optimizeVertexCache(indices, (uint32_t)positions.size());
+    remap = optimizeVertexFetch(indices, (uint32_t)positions.size());
+    std::vector<uint32_t> sorted = remap;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint32_t i = 0; i < sorted.size(); i++)
+        EXPECT_EQ(sorted[i], i);
+}
+} // namespace Falcor
@@ -27,7 +27,9 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/CryptoUtils.h"
+#include <algorithm>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -59,4 +61,14 @@ CPU_TEST(SHA1)
         EXPECT(SHA1::compute(str.data(), str.size()) == md);
     }
 }
+
+CPU_BENCHMARK(SHA1_1MB)
+{
+    std::vector<uint8_t> data(1 << 20);
+    std::mt19937 rng;
+    std::generate(data.begin(), data.end(), [&rng]() { return uint8_t(rng()); });
+
+    ctx.setBytesPerIteration(data.size());
+    ctx.measure([&data]() { doNotOptimize(SHA1::compute(data.data(), data.size())); });
+}
 } // namespace Falcor
@@ -28,7 +28,11 @@
 #include "Testing/UnitTest.h"
 #include "Utils/Math/ScalarMath.h"
 #include <fstd/bit.h> // TODO C++20: Replace with <bit>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -153,13 +157,111 @@ CPU_TEST(Float16Scalar)
     }
 
     // Test cast to/from float for all bit patterns.
+    // NaNs keep their payload but are made quiet, matching the F16C instructions.
     for (uint32_t bits = 0; bits < 0x10000; bits++)
     {
-        float16_t expected = fstd::bit_cast<float16_t>((uint16_t)bits);
-        float f = (float)expected;
+        float16_t value = fstd::bit_cast<float16_t>((uint16_t)bits);
+        float f = (float)value;
         float16_t result = (float16_t)f;
 
-        EXPECT_EQ(fstd::bit_cast<uint16_t>(result), fstd::bit_cast<uint16_t>(expected));
+        uint16_t expected = value.isNan() ? uint16_t(bits | 0x0200) : uint16_t(bits);
+        EXPECT_EQ(fstd::bit_cast<uint16_t>(result), expected);
     }
 }
+
+CPU_TEST(Float16BulkConversion)
+{
+    // Test all float16 bit patterns (and a few extra values to exercise the remainder handling).
+    std::vector<uint16_t> halfs(0x10003);
+    for (size_t i = 0; i < halfs.size(); i++)
+        halfs[i] = uint16_t(i);
+
+    // Test floats that are exactly representable, half-way between two float16 values and one ulp around the half-way point.
+    std::vector<float> floats;
+    for (uint32_t bits = 0; bits < 0x10000; bits++)
+    {
+        float value = math::float16ToFloat32(uint16_t(bits));
+        floats.push_back(value);
+        if ((bits & 0x7fff) >= 0x7bff)
+            continue; // Largest finite value, inf and nan.
+
+        float next = math::float16ToFloat32(uint16_t(bits + 1));
+        float halfway = 0.5f * (value + next);
+        floats.push_back(halfway);
+        floats.push_back(std::nextafter(halfway, value));
+        floats.push_back(std::nextafter(halfway, next));
+    }
+    floats.push_back(65520.f); // Rounds to infinity.
+    floats.push_back(std::nextafter(65520.f, 0.f));
+    floats.push_back(1e10f);
+    floats.push_back(std::numeric_limits<float>::denorm_min());
+    floats.push_back(std::numeric_limits<float>::signaling_NaN());
+
+    std::vector<float> expectedFloats(halfs.size());
+    for (size_t i = 0; i < halfs.size(); i++)
+        expectedFloats[i] = math::float16ToFloat32(halfs[i]);
+
+    std::vector<uint16_t> expectedHalfs(floats.size());
+    for (size_t i = 0; i < floats.size(); i++)
+        expectedHalfs[i] = math::float32ToFloat16(floats[i]);
+
+    // Ties round to the even value.
+    for (uint32_t bits = 0; bits < 0x7bff; bits++)
+    {
+        float halfway = 0.5f * (math::float16ToFloat32(uint16_t(bits)) + math::float16ToFloat32(uint16_t(bits + 1)));
+        EXPECT_EQ(math::float32ToFloat16(halfway), (bits & 1) ? bits + 1 : bits) << "bits = " << bits;
+    }
+
+    // All implementations supported by the CPU must produce bit-identical results.
+    for (uint32_t i = 0; i <= (uint32_t)math::getFloat16Conversion(); i++)
+    {
+        math::Float16Conversion conversion = (math::Float16Conversion)i;
+
+        std::vector<float> resultFloats(halfs.size());
+        math::float16ToFloat32(halfs, resultFloats, conversion);
+        for (size_t j = 0; j < halfs.size(); j++)
+            EXPECT_EQ(fstd::bit_cast<uint32_t>(resultFloats[j]), fstd::bit_cast<uint32_t>(expectedFloats[j]))
+                << "conversion = " << i << ", value = " << halfs[j];
+
+        std::vector<uint16_t> resultHalfs(floats.size());
+        math::float32ToFloat16(floats, resultHalfs, conversion);
+        for (size_t j = 0; j < floats.size(); j++)
+            EXPECT_EQ(resultHalfs[j], expectedHalfs[j]) << "conversion = " << i << ", value = " << floats[j];
+    }
+}
+
+CPU_BENCHMARK(Float32ToFloat16Bulk)
+{
+    std::vector<float> src(1 << 20);
+    std::mt19937 r;
+    std::uniform_real_distribution<float> dist(-65504.f, 65504.f);
+    std::generate(src.begin(), src.end(), [&]() { return dist(r); });
+    std::vector<uint16_t> dst(src.size());
+
+    ctx.setItemsPerIteration(src.size());
+    ctx.measure(
+        [&]()
+        {
+            math::float32ToFloat16(src, dst);
+            doNotOptimize(dst[0]);
+        }
+    );
+}
+
+CPU_BENCHMARK(Float16ToFloat32Bulk)
+{
+    std::vector<uint16_t> src(1 << 20);
+    std::mt19937 r;
+    std::generate(src.begin(), src.end(), [&]() { return uint16_t(r() % 0x7c00); });
+    std::vector<float> dst(src.size());
+
+    ctx.setItemsPerIteration(src.size());
+    ctx.measure(
+        [&]()
+        {
+            math::float16ToFloat32(src, dst);
+            doNotOptimize(dst[0]);
+        }
+    );
+}
 } // namespace Falcor
@@ -0,0 +1,193 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncTextureLoader.h"
+#include "Utils/Image/DecodedTexture.h"
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path getTestPath(const std::string& name)
+{
+    return getRuntimeDirectory() / "data/tests" / name;
+}
+} // namespace
+
+CPU_TEST(DecodedTexture_DecodeFromFile)
+{
+    auto decoded = DecodedTexture::decodeFromFile(getTestPath("texture1.png"), true, true);
+    ASSERT(decoded.has_value());
+    ASSERT(decoded->pBitmap != nullptr);
+
+    EXPECT(decoded->type == Resource::Type::Texture2D);
+    EXPECT(decoded->format == linearToSrgbFormat(decoded->pBitmap->getFormat()));
+    EXPECT_EQ(decoded->width, decoded->pBitmap->getWidth());
+    EXPECT_EQ(decoded->height, decoded->pBitmap->getHeight());
+    EXPECT_EQ(decoded->mipLevels, 1);
+    EXPECT(decoded->generateMipLevels);
+    EXPECT(decoded->data.empty());
+    EXPECT(decoded->getData() == decoded->pBitmap->getData());
+    EXPECT_EQ(decoded->getDataSize(), decoded->pBitmap->getSize());
+
+    EXPECT(!DecodedTexture::decodeFromFile(getTestPath("does_not_exist.png"), false, false).has_value());
+}
+
+CPU_TEST(DecodedTexture_DecodeDDS)
+{
+    auto decoded = DecodedTexture::decodeFromFile(getTestPath("BC1Unorm.dds"), false, false);
+    ASSERT(decoded.has_value());
+
+    EXPECT(decoded->format == ResourceFormat::BC1Unorm);
+    EXPECT(decoded->pBitmap == nullptr);
+    EXPECT(!decoded->data.empty());
+    EXPECT_EQ(decoded->getDataSize(), decoded->data.size());
+
+    EXPECT(!DecodedTexture::decodeFromFile(getTestPath("BC7UnormBroken.dds"), false, false).has_value());
+}
+
+CPU_TEST(DecodedTexture_DecodeMipped)
+{
+    std::filesystem::path paths[] = {
+        getTestPath("tiny_mip0.png"),
+        getTestPath("tiny_mip1.png"),
+        getTestPath("tiny_mip2.png"),
+    };
+
+    auto decoded = DecodedTexture::decodeMippedFromFiles(paths, false);
+    ASSERT(decoded.has_value());
+    ASSERT(decoded->pBitmap != nullptr);
+
+    EXPECT_EQ(decoded->width, 4);
+    EXPECT_EQ(decoded->height, 4);
+    EXPECT_EQ(decoded->mipLevels, 3);
+    EXPECT(!decoded->generateMipLevels);
+    EXPECT(decoded->sourcePath == paths[0]);
+
+    // Mips are stored one after the other, starting with mip0.
+    size_t mip0Size = decoded->pBitmap->getSize();
+    EXPECT_EQ(decoded->getDataSize(), mip0Size + mip0Size / 4 + mip0Size / 16);
+    EXPECT(std::memcmp(decoded->getData(), decoded->pBitmap->getData(), mip0Size) == 0);
+
+    // Loading stops at the first mip with the wrong resolution.
+    std::filesystem::path invalidPaths[] = {paths[0], paths[2]};
+    decoded = DecodedTexture::decodeMippedFromFiles(invalidPaths, false);
+    ASSERT(decoded.has_value());
+    EXPECT_EQ(decoded->mipLevels, 1);
+    EXPECT_EQ(decoded->getDataSize(), mip0Size);
+}
+
+CPU_TEST(DecodedTexture_MakeConstant)
+{
+    auto decoded = DecodedTexture::decodeFromFile(getTestPath("texture1.png"), true, false);
+    ASSERT(decoded.has_value());
+    const uint32_t width = decoded->width;
+    const uint32_t height = decoded->height;
+    std::vector<uint8_t> texel(getFormatBytesPerBlock(decoded->format));
+    std::memcpy(texel.data(), decoded->getData(), texel.size());
+
+    // Only the first texel is kept.
+    EXPECT(decoded->makeConstant());
+    EXPECT(decoded->isConstant);
+    EXPECT(decoded->pBitmap == nullptr);
+    EXPECT_EQ(decoded->width, width);
+    EXPECT_EQ(decoded->height, height);
+    ASSERT_EQ(decoded->getDataSize(), texel.size());
+    EXPECT(std::memcmp(decoded->getData(), texel.data(), texel.size()) == 0);
+    EXPECT(decoded->makeConstant());
+
+    // Compressed and mipped textures are not supported.
+    auto dds = DecodedTexture::decodeFromFile(getTestPath("BC1Unorm.dds"), false, false);
+    ASSERT(dds.has_value());
+    EXPECT(!dds->makeConstant());
+    EXPECT(!dds->isConstant);
+
+    std::filesystem::path paths[] = {getTestPath("tiny_mip0.png"), getTestPath("tiny_mip1.png")};
+    auto mipped = DecodedTexture::decodeMippedFromFiles(paths, false);
+    ASSERT(mipped.has_value());
+    EXPECT(!mipped->makeConstant());
+}
+
+GPU_TEST(AsyncTextureLoader_Load)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::vector<std::filesystem::path> paths;
+    for (size_t i = 1; i <= 8; ++i)
+        paths.push_back(getTestPath(fmt::format("texture{}.{}", i, i <= 6 ? "png" : "exr")));
+    paths.push_back(getTestPath("BC1Unorm.dds"));
+    // The last textures fail to load and must be reported as null without stopping the loader threads.
+    const size_t kFailingCount = 2;
+    paths.push_back(getTestPath("BC7UnormBroken.dds"));
+    paths.push_back(getTestPath("does_not_exist.png"));
+
+    // Use a budget of a single byte so that textures are queued for upload one at a time.
+    AsyncTextureLoader loader(pDevice, 4, 1);
+
+    std::atomic<uint32_t> callbackCount{0};
+    std::atomic<uint32_t> analysisCount{0};
+    auto callback = [&](ref<Texture> pTexture, const std::optional<TextureAnalyzer::Result>& analysis, std::optional<DecodedTexture>&&)
+    {
+        callbackCount++;
+        if (analysis)
+            analysisCount++;
+    };
+
+    std::vector<std::future<ref<Texture>>> futures;
+    for (const auto& path : paths)
+        futures.push_back(loader.loadFromFile(path, true, false, ResourceBindFlags::ShaderResource, Bitmap::ImportFlags::None, callback));
+
+    size_t maxSize = 0;
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        ref<Texture> pTexture = futures[i].get();
+        if (i + kFailingCount < futures.size())
+        {
+            ASSERT(pTexture != nullptr);
+            EXPECT(pTexture->getSourcePath() == paths[i]);
+            maxSize = std::max(maxSize, DecodedTexture::decodeFromFile(paths[i], false, false)->getDataSize());
+        }
+        else
+        {
+            EXPECT(pTexture == nullptr);
+        }
+    }
+
+    // The texture callback is called after the promise is fulfilled, so wait for the remaining callbacks.
+    while (callbackCount.load() < paths.size())
+        std::this_thread::yield();
+
+    // The DDS file is not decoded to a bitmap and is not analyzed.
+    EXPECT_EQ(analysisCount.load(), 8);
+
+    AsyncTextureLoader::Stats stats = loader.getStats();
+    EXPECT_EQ(stats.textureCount, paths.size());
+    EXPECT_LE(stats.peakQueuedBytes, maxSize);
+    EXPECT_GT(stats.uploadedBytes, 0);
+}
+} // namespace Falcor
@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/BakedTexture.h"
+#include "Utils/Image/DecodedTexture.h"
+#include "Core/Platform/OS.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+void touch(const std::filesystem::path& path)
+{
+    std::ofstream(path) << "x";
+}
+
+/// Bake a 4x4 black and white checkerboard and return the value of the 1x1 mip.
+uint8_t bakeCheckerboard(CPUUnitTestContext& ctx, bool srgb)
+{
+    std::vector<uint8_t> texels(4 * 4 * 4);
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        uint8_t value = ((i % 4) + (i / 4)) % 2 ? 255 : 0;
+        texels[i * 4 + 0] = texels[i * 4 + 1] = texels[i * 4 + 2] = value;
+        texels[i * 4 + 3] = 255;
+    }
+    auto pBitmap = Bitmap::create(4, 4, ResourceFormat::BGRA8Unorm, texels.data());
+
+    std::filesystem::path bakedPath = getTempFilePath();
+    bakedPath += ".dds";
+    BakedTexture::bake(*pBitmap, bakedPath, ImageIO::CompressionMode::None, srgb);
+    auto decoded = ImageIO::decodeDDS(bakedPath, false);
+    std::filesystem::remove(bakedPath);
+
+    if (!decoded)
+        return 0;
+    EXPECT_EQ(isSrgbFormat(decoded->format), srgb);
+    EXPECT_EQ(decoded->mipLevels, 3);
+    // The last mip is a single BGRA8 texel.
+    return decoded->data[decoded->data.size() - 4];
+}
+} // namespace
+
+CPU_TEST(BakedTexture_GetBakedPath)
+{
+    EXPECT_EQ(BakedTexture::getBakedPath("textures/wood.png"), std::filesystem::path("textures/wood.png.dds"));
+    EXPECT_EQ(BakedTexture::getBakedPath("wood.exr"), std::filesystem::path("wood.exr.dds"));
+}
+
+CPU_TEST(BakedTexture_Find)
+{
+    std::filesystem::path sourcePath = getTempFilePath();
+    sourcePath += ".png";
+    const std::filesystem::path bakedPath = BakedTexture::getBakedPath(sourcePath);
+    touch(sourcePath);
+
+    // No baked texture.
+    EXPECT(!BakedTexture::find(sourcePath).has_value());
+
+    // Baked texture newer than the source.
+    touch(bakedPath);
+    const auto sourceTime = std::filesystem::last_write_time(sourcePath);
+    std::filesystem::last_write_time(bakedPath, sourceTime + std::chrono::seconds(10));
+    auto found = BakedTexture::find(sourcePath);
+    ASSERT(found.has_value());
+    EXPECT_EQ(*found, bakedPath);
+
+    // Baked texture with the same time stamp as the source.
+    std::filesystem::last_write_time(bakedPath, sourceTime);
+    EXPECT(BakedTexture::find(sourcePath).has_value());
+
+    // Source modified after baking.
+    std::filesystem::last_write_time(bakedPath, sourceTime - std::chrono::seconds(10));
+    EXPECT(!BakedTexture::find(sourcePath).has_value());
+
+    // Baked texture without a source.
+    std::filesystem::remove(sourcePath);
+    EXPECT(!BakedTexture::find(sourcePath).has_value());
+
+    std::filesystem::remove(bakedPath);
+}
+
+CPU_TEST(BakedTexture_BakeSrgb)
+{
+    // Mips of linear textures average the stored values, mips of sRGB textures average in linear space (0.5 is 188 in sRGB).
+    EXPECT_LE(std::abs(int(bakeCheckerboard(ctx, false)) - 128), 1);
+    EXPECT_LE(std::abs(int(bakeCheckerboard(ctx, true)) - 188), 1);
+}
+} // namespace Falcor
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/Bitmap.h"
+#include "Utils/Math/Float16.h"
+#include <random>
 
 namespace Falcor
 {
@@ -74,4 +76,70 @@ GPU_TEST(Bitmap_LinearRamp_PNG)
     // Delete the test file.
     std::filesystem::remove(path);
 }
+
+CPU_TEST(Bitmap_ConvertToRGBA32Float)
+{
+    EXPECT(Bitmap::isConvertibleToRGBA32Float(ResourceFormat::RG16Float));
+    EXPECT(Bitmap::isConvertibleToRGBA32Float(ResourceFormat::R32Int));
+    EXPECT(!Bitmap::isConvertibleToRGBA32Float(ResourceFormat::RGBA8Uint));
+    EXPECT(!Bitmap::isConvertibleToRGBA32Float(ResourceFormat::RGBA32Float));
+
+    {
+        const uint16_t data[] = {math::float32ToFloat16(0.5f), math::float32ToFloat16(-2.f)};
+        auto floatData = Bitmap::convertToRGBA32Float(ResourceFormat::RG16Float, 1, 1, data);
+        EXPECT_EQ(floatData.size(), 4);
+        EXPECT_EQ(floatData[0], 0.5f);
+        EXPECT_EQ(floatData[1], -2.f);
+        EXPECT_EQ(floatData[2], 0.f);
+        EXPECT_EQ(floatData[3], 1.f);
+    }
+
+    {
+        const uint16_t data[] = {0, 65535, 0, 65535};
+        auto floatData = Bitmap::convertToRGBA32Float(ResourceFormat::RGBA16Uint, 1, 1, data);
+        EXPECT_EQ(floatData.size(), 4);
+        EXPECT_EQ(floatData[0], 0.f);
+        EXPECT_EQ(floatData[1], 1.f);
+        EXPECT_EQ(floatData[2], 0.f);
+        EXPECT_EQ(floatData[3], 1.f);
+    }
+}
+
+CPU_BENCHMARK(Bitmap_ConvertRGBA16FloatToRGBA32Float)
+{
+    const uint32_t width = 1024;
+    const uint32_t height = 1024;
+    std::vector<uint16_t> data(width * height * 4);
+    std::mt19937 r;
+    std::generate(data.begin(), data.end(), [&]() { return uint16_t(r() % 0x7c00); });
+
+    ctx.setItemsPerIteration(width * height);
+    ctx.setBytesPerIteration(data.size() * sizeof(uint16_t));
+    ctx.measure(
+        [&]()
+        {
+            auto floatData = Bitmap::convertToRGBA32Float(ResourceFormat::RGBA16Float, width, height, data.data());
+            doNotOptimize(floatData[0]);
+        }
+    );
+}
+
+CPU_BENCHMARK(Bitmap_ConvertRG16UintToRGBA32Float)
+{
+    const uint32_t width = 1024;
+    const uint32_t height = 1024;
+    std::vector<uint16_t> data(width * height * 2);
+    std::mt19937 r;
+    std::generate(data.begin(), data.end(), [&]() { return uint16_t(r()); });
+
+    ctx.setItemsPerIteration(width * height);
+    ctx.setBytesPerIteration(data.size() * sizeof(uint16_t));
+    ctx.measure(
+        [&]()
+        {
+            auto floatData = Bitmap::convertToRGBA32Float(ResourceFormat::RG16Uint, width, height, data.data());
+            doNotOptimize(floatData[0]);
+        }
+    );
+}
 } // namespace Falcor
@@ -27,9 +27,31 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureManager.h"
+#include "Utils/Image/BakedTexture.h"
+#include "Core/Platform/OS.h"
+#include <chrono>
 
 namespace Falcor
 {
+namespace
+{
+const uint32_t kImageSize = 16;
+
+std::filesystem::path writeImage(bool constant)
+{
+    std::vector<uint8_t> data(kImageSize * kImageSize * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = constant ? (uint8_t)(64 * (i % 4 + 1) - 1) : (uint8_t)i;
+
+    std::filesystem::path path = getTempFilePath();
+    path += ".png";
+    Bitmap::saveImage(
+        path, kImageSize, kImageSize, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, data.data()
+    );
+    return path;
+}
+} // namespace
+
 GPU_TEST(TextureManager_LoadMips)
 {
     ref<Device> pDevice = ctx.getDevice();
@@ -51,4 +73,122 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_DeferConstant)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const std::filesystem::path constantPath = writeImage(true);
+    const std::filesystem::path varyingPath = writeImage(false);
+
+    {
+        TextureManager textureManager(pDevice, 10);
+        auto constantHandle = textureManager.loadTexture(
+            constantPath, true, false, ResourceBindFlags::ShaderResource, false, Bitmap::ImportFlags::None, nullptr, nullptr, nullptr, true
+        );
+        auto varyingHandle = textureManager.loadTexture(
+            varyingPath, true, false, ResourceBindFlags::ShaderResource, false, Bitmap::ImportFlags::None, nullptr, nullptr, nullptr, true
+        );
+
+        // Only the varying texture is created on load. The constant texture keeps a single texel.
+        auto desc = textureManager.getTextureDesc(constantHandle);
+        EXPECT(desc.state == TextureManager::TextureState::Loaded);
+        EXPECT(desc.pTexture == nullptr);
+        ASSERT(desc.pDeferred != nullptr);
+        ASSERT(desc.analysis.has_value());
+        EXPECT(desc.analysis->isConstant(TextureChannelFlags::RGBA));
+        const DecodedTexture& decoded = desc.pDeferred->decoded;
+        const size_t texelSize = getFormatBytesPerBlock(decoded.format);
+        ASSERT_EQ(decoded.getDataSize(), texelSize);
+        std::vector<uint8_t> texel((const uint8_t*)decoded.getData(), (const uint8_t*)decoded.getData() + texelSize);
+
+        EXPECT(textureManager.getTextureDesc(varyingHandle).pTexture != nullptr);
+        EXPECT(textureManager.getTextureDesc(varyingHandle).pDeferred == nullptr);
+
+        TextureManager::Stats stats = textureManager.getStats();
+        EXPECT_EQ(stats.textureCount, 1);
+        EXPECT_EQ(stats.textureDeferredCount, 1);
+
+        // The constant texture is created at full resolution when it is requested.
+        ref<Texture> pTexture = textureManager.getTexture(constantHandle);
+        ASSERT(pTexture != nullptr);
+        EXPECT_EQ(pTexture->getWidth(), kImageSize);
+        EXPECT_EQ(pTexture->getHeight(), kImageSize);
+        EXPECT_GT(pTexture->getMipCount(), 1);
+        EXPECT(textureManager.getTextureDesc(constantHandle).pDeferred == nullptr);
+        EXPECT(textureManager.getTextureAnalysis(pTexture.get()).has_value());
+        EXPECT(textureManager.getTexture(constantHandle) == pTexture);
+
+        std::vector<uint8_t> texels = pDevice->getRenderContext()->readTextureSubresource(pTexture.get(), 0);
+        ASSERT_EQ(texels.size(), kImageSize * kImageSize * texelSize);
+        for (size_t i = 0; i < texels.size(); i++)
+            EXPECT_EQ(texels[i], texel[i % texelSize]) << "byte " << i;
+
+        stats = textureManager.getStats();
+        EXPECT_EQ(stats.textureCount, 2);
+        EXPECT_EQ(stats.textureDeferredCount, 0);
+    }
+
+    {
+        // Constant textures are created on load unless deferred.
+        TextureManager textureManager(pDevice, 10);
+        auto handle = textureManager.loadTexture(constantPath, true, false, ResourceBindFlags::ShaderResource, false);
+        auto desc = textureManager.getTextureDesc(handle);
+        EXPECT(desc.pTexture != nullptr);
+        EXPECT(desc.pDeferred == nullptr);
+        EXPECT(desc.analysis.has_value());
+    }
+
+    std::filesystem::remove(constantPath);
+    std::filesystem::remove(varyingPath);
+}
+
+GPU_TEST(TextureManager_PreferBaked)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Use an existing DDS file as the baked variant of a PNG.
+    const std::filesystem::path sourcePath = writeImage(false);
+    const std::filesystem::path bakedPath = BakedTexture::getBakedPath(sourcePath);
+    std::filesystem::copy_file(getRuntimeDirectory() / "data/tests/BC1Unorm.dds", bakedPath);
+    const auto sourceTime = std::filesystem::last_write_time(sourcePath);
+    std::filesystem::last_write_time(bakedPath, sourceTime + std::chrono::seconds(10));
+
+    auto loadTexture = [&](bool generateMipLevels)
+    {
+        TextureManager textureManager(pDevice, 10);
+        auto handle = textureManager.loadTexture(sourcePath, generateMipLevels, false, ResourceBindFlags::ShaderResource, false);
+        return textureManager.getTexture(handle);
+    };
+
+    // The baked variant is loaded when mips are requested.
+    ref<Texture> pTexture = loadTexture(true);
+    ASSERT(pTexture != nullptr);
+    EXPECT(pTexture->getFormat() == ResourceFormat::BC1Unorm);
+    EXPECT_EQ(pTexture->getSourcePath(), bakedPath);
+
+    // Baked textures always have mips, so the source is loaded otherwise.
+    pTexture = loadTexture(false);
+    ASSERT(pTexture != nullptr);
+    EXPECT(!isCompressedFormat(pTexture->getFormat()));
+    EXPECT_EQ(pTexture->getSourcePath(), sourcePath);
+
+    // A baked variant older than the source is stale and ignored.
+    std::filesystem::last_write_time(bakedPath, sourceTime - std::chrono::seconds(10));
+    pTexture = loadTexture(true);
+    ASSERT(pTexture != nullptr);
+    EXPECT(!isCompressedFormat(pTexture->getFormat()));
+    EXPECT_EQ(pTexture->getSourcePath(), sourcePath);
+
+    // Loading baked textures can be disabled globally.
+    std::filesystem::last_write_time(bakedPath, sourceTime + std::chrono::seconds(10));
+    BakedTexture::setEnabled(false);
+    pTexture = loadTexture(true);
+    BakedTexture::setEnabled(true);
+    ASSERT(pTexture != nullptr);
+    EXPECT(!isCompressedFormat(pTexture->getFormat()));
+
+    std::filesystem::remove(sourcePath);
+    std::filesystem::remove(bakedPath);
+}
 } // namespace Falcor
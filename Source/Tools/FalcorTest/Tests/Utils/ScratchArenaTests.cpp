@@ -0,0 +1,161 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/ScratchArena.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+CPU_TEST(ScratchArena)
+{
+    ScratchArena arena(1024);
+    EXPECT_EQ(arena.getCapacity(), 0);
+
+    {
+        ScratchArena::Scope scope(arena);
+
+        // Allocations are aligned and packed linearly.
+        void* p0 = arena.allocate(3, 1);
+        void* p1 = arena.allocate(16, 16);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p1) % 16, 0);
+        EXPECT_GE(reinterpret_cast<uint8_t*>(p1), reinterpret_cast<uint8_t*>(p0) + 3);
+        EXPECT_EQ(arena.getCapacity(), 1024);
+
+        // Nested scopes release their allocations on exit.
+        size_t used = arena.getUsedBytes();
+        {
+            ScratchArena::Scope inner(arena);
+            arena.allocate(100);
+            EXPECT_GT(arena.getUsedBytes(), used);
+        }
+        EXPECT_EQ(arena.getUsedBytes(), used);
+
+        // Freeing the most recent allocation reclaims it.
+        void* p2 = arena.allocate(64);
+        arena.deallocate(p2, 64);
+        EXPECT_EQ(arena.getUsedBytes(), used);
+
+        // Allocations larger than the block size add a new block.
+        arena.allocate(4000);
+        EXPECT_GT(arena.getCapacity(), 1024);
+    }
+
+    // The blocks are coalesced into a single block when the outermost scope closes.
+    EXPECT_EQ(arena.getUsedBytes(), 0);
+    size_t capacity = arena.getCapacity();
+    EXPECT_GE(capacity, 5024);
+
+    // The same workload now runs without further heap allocations.
+    uint64_t heapAllocationCount = arena.getStats().heapAllocationCount;
+    {
+        ScratchArena::Scope scope(arena);
+        arena.allocate(3, 1);
+        arena.allocate(16, 16);
+        arena.allocate(4000);
+    }
+    EXPECT_EQ(arena.getStats().heapAllocationCount, heapAllocationCount);
+    EXPECT_EQ(arena.getCapacity(), capacity);
+    EXPECT_EQ(arena.getStats().allocationCount, 8);
+    EXPECT_EQ(arena.getStats().scopeCount, 2);
+}
+
+CPU_TEST(ScratchArenaVector)
+{
+    ScratchArena arena(256);
+    uint64_t heapAllocationCount = 0;
+
+    for (uint32_t iteration = 0; iteration < 4; iteration++)
+    {
+        // Only the first iteration grows the arena.
+        if (iteration == 1) heapAllocationCount = arena.getStats().heapAllocationCount;
+
+        ScratchArena::Scope scope(arena);
+
+        ScratchVector<uint32_t> values(scope.getArena());
+        for (uint32_t i = 0; i < 1000; i++)
+            values.push_back(i);
+
+        ScratchVector<double> sums(values.size(), 0.0, scope.getArena());
+        std::partial_sum(values.begin(), values.end(), sums.begin());
+
+        EXPECT_EQ(values.size(), 1000);
+        EXPECT_EQ(sums.back(), 999.0 * 1000.0 / 2.0);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(sums.data()) % alignof(double), 0);
+    }
+    EXPECT_GT(heapAllocationCount, 0);
+    EXPECT_EQ(arena.getStats().heapAllocationCount, heapAllocationCount);
+}
+
+CPU_TEST(ScratchArenaDisabled)
+{
+    // The arena is created in heap mode so that the global setting used by other tests is not touched.
+    ScratchArena arena(ScratchArena::kDefaultBlockSize, true);
+    {
+        ScratchArena::Scope scope(arena);
+        ScratchVector<uint32_t> values(16, 1u, scope.getArena());
+        EXPECT_EQ(std::accumulate(values.begin(), values.end(), 0u), 16u);
+    }
+    EXPECT_EQ(arena.getCapacity(), 0);
+    EXPECT_EQ(arena.getStats().allocationCount, 1);
+    EXPECT_EQ(arena.getStats().heapAllocationCount, 1);
+}
+
+CPU_TEST(ScratchArenaTrim)
+{
+    ScratchArena arena(1024);
+    arena.setMaxRetainedCapacity(16 * 1024);
+
+    // Peak usage below the maximum retained capacity is kept.
+    {
+        ScratchArena::Scope scope(arena);
+        arena.allocate(8 * 1024);
+    }
+    EXPECT_GE(arena.getCapacity(), 8 * 1024);
+    EXPECT_LE(arena.getCapacity(), 16 * 1024);
+
+    // A larger peak is released when the scope closes.
+    {
+        ScratchArena::Scope scope(arena);
+        arena.allocate(64 * 1024);
+    }
+    EXPECT_EQ(arena.getCapacity(), 0);
+
+    // Trimming releases the blocks if they exceed the given capacity.
+    {
+        ScratchArena::Scope scope(arena);
+        arena.allocate(4 * 1024);
+    }
+    size_t capacity = arena.getCapacity();
+    EXPECT_GT(capacity, 0);
+    arena.trim(capacity);
+    EXPECT_EQ(arena.getCapacity(), capacity);
+    arena.trim();
+    EXPECT_EQ(arena.getCapacity(), 0);
+}
+} // namespace Falcor
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include <random>
 
 namespace Falcor
 {
@@ -118,6 +119,57 @@ const TextureAnalyzer::Result kExpectedResult[] = {
         float4(0.f, 0.f, 0.f, 1 / 256.f),
     },
 };
+
+std::filesystem::path getTestTexturePath(size_t i)
+{
+    return getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+}
+
+void verifyResults(UnitTestContext& ctx, const std::vector<TextureAnalyzer::Result>& result)
+{
+    for (size_t i = 0; i < kNumTests; i++)
+    {
+        EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
+
+        uint32_t rangeFlags = 0;
+        for (int c = 0; c < 4; c++)
+        {
+            bool isConstant = (kExpectedResult[i].mask & (1u << c)) == 0;
+            rangeFlags |= kExpectedResult[i].mask >> (4 + 4 * c);
+
+            EXPECT_EQ(result[i].isConstant(1u << c), isConstant) << " c = " << c;
+            EXPECT_EQ(result[i].minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
+            EXPECT_EQ(result[i].maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+
+            if (isConstant)
+            {
+                EXPECT_EQ(result[i].value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
+            }
+        }
+
+        EXPECT_EQ(result[i].isPos(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isNeg(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0)
+            << "i = " << i;
+    }
+}
+
+template<typename T>
+std::vector<uint8_t> toBytes(const std::vector<T>& texels)
+{
+    std::vector<uint8_t> bytes(texels.size() * sizeof(T));
+    std::memcpy(bytes.data(), texels.data(), bytes.size());
+    return bytes;
+}
+
+TextureAnalyzer::Result analyze(const std::vector<uint8_t>& data, uint32_t width, uint32_t height, ResourceFormat format)
+{
+    return TextureAnalyzer::analyzeTexels(data.data(), width, height, width * getFormatBytesPerBlock(format), format);
+}
 } // namespace
 
 GPU_TEST(TextureAnalyzer)
@@ -130,7 +182,7 @@ GPU_TEST(TextureAnalyzer)
     std::vector<ref<Texture>> textures(kNumTests);
     for (size_t i = 0; i < kNumTests; i++)
     {
-        std::filesystem::path path = getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+        std::filesystem::path path = getTestTexturePath(i);
         textures[i] = Texture::createFromFile(pDevice, path, false, false);
         if (!textures[i])
             FALCOR_THROW("Failed to load {}", path);
@@ -146,47 +198,159 @@ GPU_TEST(TextureAnalyzer)
         textureAnalyzer.analyze(ctx.getRenderContext(), textures[i], 0, 0, pResult, i * kResultSize);
     }
 
-    auto verify = [&ctx](ref<Buffer> pResult)
+    verifyResults(ctx, pResult->getElements<TextureAnalyzer::Result>());
+
+    // Test the array version of the interface.
+    ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
+    textureAnalyzer.analyze(ctx.getRenderContext(), textures, pResult);
+
+    verifyResults(ctx, pResult->getElements<TextureAnalyzer::Result>());
+}
+
+CPU_TEST(TextureAnalyzer_CPU)
+{
+    // Analyze the decoded test images on the CPU. The results should be identical to the GPU analysis.
+    std::vector<TextureAnalyzer::Result> results;
+    for (size_t i = 0; i < kNumTests; i++)
     {
-        // Verify results.
-        std::vector<TextureAnalyzer::Result> result = pResult->getElements<TextureAnalyzer::Result>();
-        for (size_t i = 0; i < kNumTests; i++)
-        {
-            EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
+        std::filesystem::path path = getTestTexturePath(i);
+        auto pBitmap = Bitmap::createFromFile(path, true);
+        if (!pBitmap)
+            FALCOR_THROW("Failed to load {}", path);
 
-            uint32_t rangeFlags = 0;
-            for (int c = 0; c < 4; c++)
-            {
-                bool isConstant = (kExpectedResult[i].mask & (1u << c)) == 0;
-                rangeFlags |= kExpectedResult[i].mask >> (4 + 4 * c);
+        auto result = TextureAnalyzer::analyzeBitmap(*pBitmap, pBitmap->getFormat());
+        ASSERT(result.has_value()) << "i = " << i;
+        results.push_back(*result);
+    }
 
-                EXPECT_EQ(result[i].isConstant(1u << c), isConstant) << " c = " << c;
-                EXPECT_EQ(result[i].minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
-                EXPECT_EQ(result[i].maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+    verifyResults(ctx, results);
+}
 
-                if (isConstant)
-                {
-                    EXPECT_EQ(result[i].value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
-                }
-            }
+CPU_TEST(TextureAnalyzer_CPUFormats)
+{
+    using RangeFlags = TextureAnalyzer::Result::RangeFlags;
 
-            EXPECT_EQ(result[i].isPos(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isNeg(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0)
-                << "i = " << i;
-        }
+    // BGRX: channels are swizzled and the X channel is ignored. The odd width exercises the tail of the row loop.
+    {
+        std::vector<uint8_t> data;
+        for (uint32_t i = 0; i < 5 * 3; i++)
+            data.insert(data.end(), {10, 20, 30, uint8_t(i)});
+        auto result = analyze(data, 5, 3, ResourceFormat::BGRX8Unorm);
+        EXPECT_EQ(result.mask, 0x00011110u);
+        EXPECT(all(result.value == float4(30 / 255.f, 20 / 255.f, 10 / 255.f, 1.f)));
+    }
+
+    // RG8: missing channels read as (0, 0, 0, 1).
+    {
+        std::vector<uint8_t> data(17 * 2 * 2, 255);
+        data[2 * 20 + 1] = 7;
+        auto result = analyze(data, 17, 2, ResourceFormat::RG8Unorm);
+        EXPECT_EQ(result.mask, 0x00010112u);
+        EXPECT(all(result.minValue == float4(1.f, 7 / 255.f, 0.f, 1.f)));
+        EXPECT(all(result.maxValue == float4(1.f, 1.f, 0.f, 1.f)));
+        EXPECT(all(result.value == float4(1.f, 1.f, 0.f, 1.f)));
+    }
+
+    // sRGB: values are converted to linear.
+    {
+        std::vector<uint8_t> data(4 * 4 * 4, 128);
+        auto result = analyze(data, 4, 4, ResourceFormat::RGBA8UnormSrgb);
+        EXPECT(result.isConstant(TextureChannelFlags::RGBA));
+        EXPECT_LT(std::abs(result.value.x - 0.21586f), 1e-5f);
+        EXPECT_EQ(result.value.w, 128 / 255.f);
+    }
+
+    // Snorm: -128 and -127 both map to -1.
+    {
+        std::vector<int8_t> texels = {-127, -128, -127, -128};
+        auto result = analyze(toBytes(texels), 2, 2, ResourceFormat::R8Snorm);
+        EXPECT(result.isConstant(TextureChannelFlags::Red));
+        EXPECT_EQ(result.value.x, -1.f);
+        EXPECT_EQ(result.getRange(TextureChannelFlags::Red), (uint32_t)RangeFlags::Neg);
+    }
+
+    // Half floats: min/max values are clamped to zero.
+    {
+        std::vector<float16_t> texels = {float16_t(-2.f), float16_t(0.f), float16_t(0.5f)};
+        auto result = analyze(toBytes(texels), 3, 1, ResourceFormat::R16Float);
+        EXPECT_EQ(result.mask & 0xf, 0x1u);
+        EXPECT_EQ(result.getRange(TextureChannelFlags::Red), (uint32_t)(RangeFlags::Pos | RangeFlags::Neg));
+        EXPECT_EQ(result.minValue.x, 0.f);
+        EXPECT_EQ(result.maxValue.x, 0.5f);
+    }
+
+    // Inf and NaN: NaNs count as varying but are ignored by min/max.
+    {
+        std::vector<float3> texels = {float3(1.f, 2.f, 3.f), float3(1.f, INFINITY, NAN), float3(1.f, 2.f, 3.f)};
+        auto result = analyze(toBytes(texels), 3, 1, ResourceFormat::RGB32Float);
+        EXPECT_EQ(result.mask, 0x00019516u); // R constant, G inf, B NaN, A missing, all channels positive
+        EXPECT(all(result.minValue == float4(1.f, 2.f, 3.f, 1.f)));
+        EXPECT(all(result.maxValue == float4(1.f, INFINITY, 3.f, 1.f)));
+    }
+
+    // Row pitch larger than the row size.
+    {
+        std::vector<uint8_t> data = {1, 2, 99, 99, 1, 2, 99, 99};
+        auto result = TextureAnalyzer::analyzeTexels(data.data(), 2, 2, 4, ResourceFormat::R8Unorm);
+        EXPECT_EQ(result.mask & 0xf, 0x1u);
+        EXPECT_EQ(result.maxValue.x, 2 / 255.f);
+    }
+
+    // Unsupported formats.
+    EXPECT(!TextureAnalyzer::isCpuFormatSupported(ResourceFormat::BC1Unorm));
+    EXPECT(!TextureAnalyzer::isCpuFormatSupported(ResourceFormat::RGB10A2Unorm));
+    EXPECT(!TextureAnalyzer::isCpuFormatSupported(ResourceFormat::R8Uint));
+    EXPECT(!TextureAnalyzer::isCpuFormatSupported(ResourceFormat::D32Float));
+    EXPECT_THROW(analyze(std::vector<uint8_t>(4), 1, 1, ResourceFormat::RGB10A2Unorm));
+}
+
+GPU_TEST(TextureAnalyzer_CPUMatchesGPU)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    TextureAnalyzer textureAnalyzer(pDevice);
+
+    const uint32_t width = 67;
+    const uint32_t height = 33;
+    const ResourceFormat formats[] = {
+        ResourceFormat::RGBA8Unorm,
+        ResourceFormat::BGRA8Unorm,
+        ResourceFormat::RG8Unorm,
+        ResourceFormat::R8Snorm,
+        ResourceFormat::RGBA16Unorm,
+        ResourceFormat::RGBA16Float,
+        ResourceFormat::R32Float,
+        ResourceFormat::RGBA32Float,
     };
 
-    verify(pResult);
+    std::mt19937 rng;
+    for (ResourceFormat format : formats)
+    {
+        // Fill channels with random bytes, keeping some channels constant. Floats are written as 16-bit integers to avoid NaNs.
+        const uint32_t texelSize = getFormatBytesPerBlock(format);
+        const uint32_t channelSize = texelSize / getFormatChannelCount(format);
+        std::vector<uint8_t> data(width * height * texelSize);
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            size_t channel = (i % texelSize) / channelSize;
+            bool isConstant = channel % 2 == 1;
+            bool isHighByte = getFormatType(format) == FormatType::Float && (i % channelSize) == channelSize - 1;
+            data[i] = isConstant ? 0x3c : isHighByte ? uint8_t(rng() % 0x78) : uint8_t(rng());
+        }
 
-    // Test the array version of the interface.
-    ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
-    textureAnalyzer.analyze(ctx.getRenderContext(), textures, pResult);
+        auto pTexture = pDevice->createTexture2D(width, height, format, 1, 1, data.data());
+        auto pResult = pDevice->createBuffer(kResultSize, ResourceBindFlags::UnorderedAccess);
+        textureAnalyzer.analyze(ctx.getRenderContext(), pTexture, 0, 0, pResult);
+        auto gpuResult = pResult->getElement<TextureAnalyzer::Result>(0);
+        auto cpuResult = analyze(data, width, height, format);
 
-    verify(pResult);
+        EXPECT_EQ(cpuResult.mask, gpuResult.mask) << to_string(format);
+        for (int c = 0; c < 4; c++)
+        {
+            EXPECT_EQ(cpuResult.minValue[c], gpuResult.minValue[c]) << to_string(format) << " c = " << c;
+            EXPECT_EQ(cpuResult.maxValue[c], gpuResult.maxValue[c]) << to_string(format) << " c = " << c;
+            if (gpuResult.isConstant(1u << c))
+                EXPECT_EQ(cpuResult.value[c], gpuResult.value[c]) << to_string(format) << " c = " << c;
+        }
+    }
 }
 } // namespace Falcor
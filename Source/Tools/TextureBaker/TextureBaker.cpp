@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Falcor.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/MaterialTextureBaker.h"
+#include "Utils/Image/BakedTexture.h"
+#include "Utils/Scripting/Scripting.h"
+#include "Utils/Threading.h"
+
+#include <args.hxx>
+#include <BS_thread_pool/BS_thread_pool_light.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Falcor;
+
+FALCOR_EXPORT_D3D12_AGILITY_SDK
+
+int runMain(int argc, char** argv)
+{
+    args::ArgumentParser parser("Bake the textures of a scene to block-compressed DDS files with mips.");
+    parser.helpParams.programName = "TextureBaker";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "N", "Number of worker threads (default: number of cores).", {'j', "threads"});
+    args::Flag forceFlag(parser, "", "Bake all textures, even if the baked texture is up to date.", {'f', "force"});
+    args::Flag dryRunFlag(parser, "", "Only report what would be baked.", {'n', "dry-run"});
+    args::ValueFlag<std::string> manifestFlag(parser, "path", "Manifest output file (default: <scene>.baked.json).", {'m', "manifest"});
+    args::Positional<std::string> sceneFlag(parser, "scene", "Scene file.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    const std::filesystem::path scenePath = args::get(sceneFlag);
+    std::filesystem::path manifestPath = scenePath;
+    manifestPath += ".baked.json";
+    if (manifestFlag)
+        manifestPath = args::get(manifestFlag);
+    const uint32_t threadCount = threadsFlag ? std::max(1u, args::get(threadsFlag)) : std::max(1u, std::thread::hardware_concurrency());
+
+    OSServices::start();
+    Threading::start();
+    Scripting::start();
+    PluginManager::instance().loadAllPlugins();
+
+    // Load the scene with the source textures, not the previously baked ones.
+    BakedTexture::setEnabled(false);
+
+    std::vector<MaterialTextureBaker::Job> jobs;
+    {
+        ref<Device> pDevice = make_ref<Device>(Device::Desc());
+        ref<Scene> pScene = SceneBuilder(pDevice, scenePath, Settings()).getScene();
+        if (!pScene)
+            FALCOR_THROW("Failed to load scene '{}'.", scenePath);
+        jobs = MaterialTextureBaker::collectJobs(*pScene);
+    }
+
+    fmt::print("Baking {} textures using {} threads.\n", jobs.size(), threadCount);
+
+    {
+        BS::thread_pool_light threadPool(threadCount);
+        for (auto& job : jobs)
+            threadPool.push_task(
+                [&job, force = bool(forceFlag), dryRun = bool(dryRunFlag)]() { MaterialTextureBaker::runJob(job, force, dryRun); }
+            );
+        threadPool.wait_for_tasks();
+    }
+
+    std::map<MaterialTextureBaker::Status, size_t> counts;
+    for (const auto& job : jobs)
+    {
+        counts[job.status]++;
+        if (job.status == MaterialTextureBaker::Status::Skipped || job.status == MaterialTextureBaker::Status::Failed)
+            fmt::print("{}: {} ({})\n", to_string(job.status), job.sourcePath, job.message);
+    }
+    fmt::print(
+        "Baked: {}, up-to-date: {}, skipped: {}, failed: {}\n",
+        counts[MaterialTextureBaker::Status::Baked],
+        counts[MaterialTextureBaker::Status::UpToDate],
+        counts[MaterialTextureBaker::Status::Skipped],
+        counts[MaterialTextureBaker::Status::Failed]
+    );
+
+    MaterialTextureBaker::writeManifest(manifestPath, scenePath, jobs);
+    fmt::print("Manifest written to {}\n", manifestPath);
+
+    Scripting::shutdown();
+    Threading::shutdown();
+    OSServices::stop();
+
+    return counts[MaterialTextureBaker::Status::Failed] > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    return catchAndReportAllExceptions([&]() { return runMain(argc, argv); });
+}
@@ -27,16 +27,24 @@
  **************************************************************************/
 #include "MitsubaImporter.h"
 #include "Parser.h"
+#include "Serialized.h"
 #include "Tables.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/NumericRange.h"
 #include "Scene/Material/PBRT/PBRTDiffuseMaterial.h"
 #include "Scene/Material/PBRT/PBRTDielectricMaterial.h"
 #include "Scene/Material/PBRT/PBRTConductorMaterial.h"
 
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <limits>
+#include <map>
+#include <tuple>
 #include <unordered_map>
 
 namespace Falcor
@@ -78,11 +86,39 @@ Transform transformFromMatrix4x4(const float4x4& m)
     return t;
 }
 
+/// Key of a shape loaded from a serialized file (filename, shape index, face normals).
+using SerializedShapeKey = std::tuple<std::string, uint32_t, bool>;
+
+SerializedShapeKey getSerializedShapeKey(const Properties& props)
+{
+    auto shapeIndex = props.getInt("shape_index", 0);
+    if (shapeIndex < 0 || shapeIndex > std::numeric_limits<uint32_t>::max())
+        FALCOR_THROW("Invalid shape index {}.", shapeIndex);
+    return {props.getString("filename"), (uint32_t)shapeIndex, props.getBool("face_normals", false)};
+}
+
+/// Shape preloaded from a serialized file.
+struct PreloadedMesh
+{
+    ref<TriangleMesh> pMesh;
+    bool used = false; ///< True once the mesh has been handed out to a shape.
+};
+
+/// Mesh of a shape group, added to the scene once and instanced by all instances of the group.
+struct ShapeGroupMesh
+{
+    std::string name;
+    MeshID meshID;
+    float4x4 transform;
+};
+
 struct BuilderContext
 {
     SceneBuilder& builder;
     std::unordered_map<std::string, XMLObject>& instances;
     std::unordered_set<std::string> warnings;
+    std::map<SerializedShapeKey, PreloadedMesh> serializedMeshes;              ///< Shapes preloaded from serialized files.
+    std::unordered_map<std::string, std::vector<ShapeGroupMesh>> shapeGroups; ///< Meshes of instanced shape groups, by shape group ID.
 
     void forEachReference(const XMLObject& inst, Class cls, std::function<void(const XMLObject&)> func)
     {
@@ -490,6 +526,31 @@ ShapeInfo buildShape(BuilderContext& ctx, const XMLObject& inst)
             shape.pMesh->setName(inst.id);
         shape.transform = toWorld;
     }
+    else if (inst.type == "serialized")
+    {
+        const auto key = getSerializedShapeKey(props);
+        const auto& [filename, shapeIndex, faceNormals] = key;
+
+        // Shapes of the scene are normally preloaded by loadSerializedShapes().
+        // A preloaded mesh is handed out once. Other shapes using the same data get a copy, as each shape names its own mesh.
+        auto it = ctx.serializedMeshes.find(key);
+        if (it == ctx.serializedMeshes.end())
+        {
+            shape.pMesh = SerializedFile(filename).loadShape(shapeIndex, faceNormals);
+        }
+        else if (!it->second.used)
+        {
+            shape.pMesh = it->second.pMesh;
+            it->second.used = true;
+        }
+        else
+        {
+            const auto& pPreloaded = it->second.pMesh;
+            shape.pMesh = TriangleMesh::create(pPreloaded->getVertices(), pPreloaded->getIndices(), pPreloaded->getFrontFaceCW());
+        }
+        shape.pMesh->setName(inst.id);
+        shape.transform = toWorld;
+    }
     else if (inst.type == "sphere")
     {
         auto center = props.getFloat3("center", float3(0.f));
@@ -723,10 +784,145 @@ EmitterInfo buildEmitter(BuilderContext& ctx, const XMLObject& inst)
     return emitter;
 }
 
+/**
+ * Collect the serialized shapes referenced by an object, including shapes nested in shape groups.
+ * Each shape group is visited once, no matter how many instances reference it.
+ */
+void collectSerializedShapes(
+    BuilderContext& ctx,
+    const XMLObject& inst,
+    std::unordered_set<std::string>& visited,
+    std::vector<SerializedShapeKey>& keys
+)
+{
+    for (const auto& [name, id] : inst.props.getNamedReferences())
+    {
+        const auto& child = ctx.instances[id];
+        if (child.cls != Class::Shape || !visited.insert(id).second)
+            continue;
+
+        if (child.type == "serialized")
+            keys.push_back(getSerializedShapeKey(child.props));
+        else if (child.type == "shapegroup" || child.type == "instance")
+            collectSerializedShapes(ctx, child, visited, keys);
+    }
+}
+
+/**
+ * Load all shapes of the scene that are stored in serialized files.
+ * The shapes are decompressed and decoded in parallel and stored in the builder context.
+ */
+void loadSerializedShapes(BuilderContext& ctx, const XMLObject& inst)
+{
+    FALCOR_ASSERT(inst.cls == Class::Scene);
+
+    std::vector<SerializedShapeKey> keys;
+    std::unordered_set<std::string> visited;
+    collectSerializedShapes(ctx, inst, visited, keys);
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    if (keys.empty())
+        return;
+
+    // Read the shape dictionary of each file once.
+    std::map<std::string, std::unique_ptr<SerializedFile>> files;
+    for (const auto& key : keys)
+    {
+        auto& pFile = files[std::get<0>(key)];
+        if (!pFile)
+            pFile = std::make_unique<SerializedFile>(std::get<0>(key));
+    }
+
+    // Exceptions must not escape the parallel algorithm, so they are stored and rethrown afterwards.
+    std::vector<ref<TriangleMesh>> meshes(keys.size());
+    std::vector<std::exception_ptr> errors(keys.size());
+    auto range = NumericRange<size_t>(0, keys.size());
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](size_t i)
+        {
+            try
+            {
+                const auto& [filename, shapeIndex, faceNormals] = keys[i];
+                meshes[i] = files.at(filename)->loadShape(shapeIndex, faceNormals);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    );
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+        ctx.serializedMeshes.emplace(keys[i], PreloadedMesh{meshes[i]});
+    }
+}
+
+/**
+ * Add an instance of a shape group to the scene.
+ * The meshes of a shape group are added on its first instance and shared by all later instances.
+ */
+void buildInstance(BuilderContext& ctx, const XMLObject& inst)
+{
+    FALCOR_ASSERT(inst.cls == Class::Shape && inst.type == "instance");
+
+    const XMLObject* pGroup = nullptr;
+    for (const auto& [name, id] : inst.props.getNamedReferences())
+    {
+        const auto& child = ctx.instances[id];
+        if (child.cls == Class::Shape && child.type == "shapegroup")
+        {
+            if (pGroup)
+                FALCOR_THROW("Instance can only reference one shape group.");
+            pGroup = &child;
+        }
+    }
+    if (!pGroup)
+        FALCOR_THROW("Instance '{}' does not reference a shape group.", inst.id);
+
+    auto it = ctx.shapeGroups.find(pGroup->id);
+    if (it == ctx.shapeGroups.end())
+    {
+        std::vector<ShapeGroupMesh> meshes;
+        for (const auto& [name, id] : pGroup->props.getNamedReferences())
+        {
+            const auto& child = ctx.instances[id];
+            if (child.cls != Class::Shape)
+                continue;
+            if (child.type == "shapegroup" || child.type == "instance")
+                FALCOR_THROW("Shape group '{}' cannot contain nested shape groups or instances.", pGroup->id);
+
+            auto shape = buildShape(ctx, child);
+            if (shape.pMesh && shape.pMaterial)
+                meshes.push_back({id, ctx.builder.addTriangleMesh(shape.pMesh, shape.pMaterial), shape.transform});
+        }
+        it = ctx.shapeGroups.emplace(pGroup->id, std::move(meshes)).first;
+    }
+
+    SceneBuilder::Node node{inst.id, inst.props.getTransform("to_world", float4x4::identity())};
+    auto instanceNodeID = ctx.builder.addNode(node);
+
+    for (const auto& mesh : it->second)
+    {
+        SceneBuilder::Node meshNode{mesh.name, mesh.transform};
+        meshNode.parent = instanceNodeID;
+        auto nodeID = ctx.builder.addNode(meshNode);
+        ctx.builder.addMeshInstance(nodeID, mesh.meshID);
+    }
+}
+
 void buildScene(BuilderContext& ctx, const XMLObject& inst)
 {
     FALCOR_ASSERT(inst.cls == Class::Scene);
 
+    loadSerializedShapes(ctx, inst);
+
     const auto& props = inst.props;
 
     for (const auto& [name, id] : props.getNamedReferences())
@@ -771,6 +967,15 @@ void buildScene(BuilderContext& ctx, const XMLObject& inst)
 
         case Class::Shape:
         {
+            // Shape groups are only added to the scene through instances.
+            if (child.type == "shapegroup")
+                break;
+            if (child.type == "instance")
+            {
+                buildInstance(ctx, child);
+                break;
+            }
+
             auto shape = buildShape(ctx, child);
 
             if (shape.pMesh && shape.pMaterial)
@@ -0,0 +1,358 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Serialized.h"
+#include "Core/Error.h"
+#include "Utils/Math/Vector.h"
+#include "Utils/StringFormatters.h"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+
+namespace Falcor
+{
+namespace Mitsuba
+{
+namespace
+{
+const uint16_t kFormatIdentifier = 0x041C;
+const uint16_t kMinVersion = 3;
+const uint16_t kMaxVersion = 4;
+const size_t kShapeHeaderSize = 4;
+
+enum ShapeFlags : uint32_t
+{
+    HasNormals = 0x0001,
+    HasTexCoords = 0x0002,
+    HasColors = 0x0008,
+    FaceNormals = 0x0010,
+    SinglePrecision = 0x1000,
+    DoublePrecision = 0x2000,
+};
+
+/// Little-endian reader with bounds checking.
+class Reader
+{
+public:
+    Reader(const std::vector<uint8_t>& data, const std::filesystem::path& path) : mData(data), mPath(path) {}
+
+    template<typename T>
+    T read()
+    {
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    void readBytes(void* pDst, size_t byteSize)
+    {
+        if (byteSize > mData.size() - mOffset)
+            FALCOR_THROW("Unexpected end of shape data in '{}'.", mPath);
+        std::memcpy(pDst, mData.data() + mOffset, byteSize);
+        mOffset += byteSize;
+    }
+
+    void skip(size_t byteSize)
+    {
+        if (byteSize > mData.size() - mOffset)
+            FALCOR_THROW("Unexpected end of shape data in '{}'.", mPath);
+        mOffset += byteSize;
+    }
+
+    std::string readString()
+    {
+        std::string str;
+        while (char c = read<char>())
+            str.push_back(c);
+        return str;
+    }
+
+    size_t getRemaining() const { return mData.size() - mOffset; }
+
+    /// Read an array of float or double vectors and convert them to float.
+    /// The vectors are written to pDst with the given stride in bytes.
+    template<typename VecT>
+    void readVectors(bool doublePrecision, size_t count, uint8_t* pDst, size_t stride)
+    {
+        constexpr size_t kDim = sizeof(VecT) / sizeof(float);
+        const size_t scalarSize = doublePrecision ? sizeof(double) : sizeof(float);
+        if (count > (mData.size() - mOffset) / (kDim * scalarSize))
+            FALCOR_THROW("Unexpected end of shape data in '{}'.", mPath);
+
+        const uint8_t* pSrc = mData.data() + mOffset;
+        for (size_t i = 0; i < count; ++i)
+        {
+            VecT v;
+            for (size_t j = 0; j < kDim; ++j)
+            {
+                if (doublePrecision)
+                {
+                    double d;
+                    std::memcpy(&d, pSrc, sizeof(double));
+                    v[j] = (float)d;
+                }
+                else
+                {
+                    std::memcpy(&v[j], pSrc, sizeof(float));
+                }
+                pSrc += scalarSize;
+            }
+            std::memcpy(pDst + i * stride, &v, sizeof(VecT));
+        }
+        mOffset += count * kDim * scalarSize;
+    }
+
+private:
+    const std::vector<uint8_t>& mData;
+    const std::filesystem::path& mPath;
+    size_t mOffset = 0;
+};
+
+std::vector<uint8_t> inflateStream(const std::vector<uint8_t>& compressed, const std::filesystem::path& path)
+{
+    z_stream zs = {};
+    if (inflateInit(&zs) != Z_OK)
+        FALCOR_THROW("inflateInit failed while decompressing '{}'.", path);
+
+    zs.next_in = const_cast<Bytef*>(compressed.data());
+    zs.avail_in = (uInt)compressed.size();
+
+    // Mesh data typically compresses to less than half its size.
+    std::vector<uint8_t> decompressed(std::max<size_t>(compressed.size() * 4, 1024));
+
+    int ret;
+    do
+    {
+        if (zs.total_out == decompressed.size())
+            decompressed.resize(decompressed.size() * 2);
+        zs.next_out = decompressed.data() + zs.total_out;
+        zs.avail_out = (uInt)std::min<size_t>(decompressed.size() - zs.total_out, std::numeric_limits<uInt>::max());
+        ret = inflate(&zs, Z_NO_FLUSH);
+    } while (ret == Z_OK);
+
+    decompressed.resize(zs.total_out);
+    inflateEnd(&zs);
+
+    if (ret != Z_STREAM_END)
+        FALCOR_THROW("Failed to decompress shape data in '{}' (error: {}).", path, ret);
+
+    return decompressed;
+}
+
+void computeVertexNormals(TriangleMesh::VertexList& vertices, const TriangleMesh::IndexList& indices)
+{
+    for (auto& v : vertices)
+        v.normal = float3(0.f);
+
+    // Accumulate area-weighted face normals.
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        auto& v0 = vertices[indices[i]];
+        auto& v1 = vertices[indices[i + 1]];
+        auto& v2 = vertices[indices[i + 2]];
+        float3 n = cross(v1.position - v0.position, v2.position - v0.position);
+        v0.normal += n;
+        v1.normal += n;
+        v2.normal += n;
+    }
+
+    for (auto& v : vertices)
+    {
+        float len = length(v.normal);
+        v.normal = len > 0.f ? v.normal / len : float3(0.f, 0.f, 1.f);
+    }
+}
+
+void convertToFaceNormals(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+{
+    TriangleMesh::VertexList faceVertices;
+    faceVertices.reserve(indices.size());
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        TriangleMesh::Vertex v[3] = {vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]};
+        float3 n = cross(v[1].position - v[0].position, v[2].position - v[0].position);
+        float len = length(n);
+        n = len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            v[j].normal = n;
+            faceVertices.push_back(v[j]);
+        }
+    }
+
+    vertices = std::move(faceVertices);
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = (uint32_t)i;
+}
+} // namespace
+
+SerializedFile::SerializedFile(const std::filesystem::path& path) : mPath(path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+        FALCOR_THROW("Failed to open serialized file '{}'.", path);
+
+    ifs.seekg(0, std::ios::end);
+    const uint64_t fileSize = (uint64_t)ifs.tellg();
+    if (fileSize < kShapeHeaderSize + sizeof(uint32_t))
+        FALCOR_THROW("Serialized file '{}' is too small.", path);
+
+    // The dictionary format depends on the version of the first shape.
+    uint16_t format = 0;
+    uint16_t version = 0;
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char*>(&format), sizeof(format));
+    ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (format != kFormatIdentifier)
+        FALCOR_THROW("'{}' is not a serialized file.", path);
+    if (version < kMinVersion || version > kMaxVersion)
+        FALCOR_THROW("Serialized file '{}' has unsupported version {}.", path, version);
+
+    uint32_t shapeCount = 0;
+    ifs.seekg(fileSize - sizeof(uint32_t));
+    ifs.read(reinterpret_cast<char*>(&shapeCount), sizeof(shapeCount));
+
+    // Version 3 stores 32-bit offsets, version 4 stores 64-bit offsets.
+    const uint64_t offsetSize = version == 3 ? sizeof(uint32_t) : sizeof(uint64_t);
+    if (shapeCount == 0 || shapeCount > (fileSize - sizeof(uint32_t)) / offsetSize)
+        FALCOR_THROW("Serialized file '{}' has an invalid shape dictionary.", path);
+    const uint64_t dictionaryOffset = fileSize - sizeof(uint32_t) - shapeCount * offsetSize;
+
+    mOffsets.resize(shapeCount + 1);
+    ifs.seekg(dictionaryOffset);
+    for (uint32_t i = 0; i < shapeCount; ++i)
+    {
+        if (version == 3)
+        {
+            uint32_t offset = 0;
+            ifs.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+            mOffsets[i] = offset;
+        }
+        else
+        {
+            ifs.read(reinterpret_cast<char*>(&mOffsets[i]), sizeof(uint64_t));
+        }
+    }
+    mOffsets[shapeCount] = dictionaryOffset;
+
+    if (!ifs)
+        FALCOR_THROW("Failed to read shape dictionary of '{}'.", path);
+
+    for (uint32_t i = 0; i < shapeCount; ++i)
+    {
+        if (mOffsets[i] + kShapeHeaderSize > mOffsets[i + 1])
+            FALCOR_THROW("Serialized file '{}' has an invalid offset for shape {}.", path, i);
+    }
+}
+
+ref<TriangleMesh> SerializedFile::loadShape(uint32_t shapeIndex, bool faceNormals) const
+{
+    if (shapeIndex >= getShapeCount())
+        FALCOR_THROW("Shape index {} is out of range, '{}' contains {} shapes.", shapeIndex, mPath, getShapeCount());
+
+    // Each call uses its own file handle so that shapes can be loaded concurrently.
+    std::ifstream ifs(mPath, std::ios::binary);
+    if (!ifs)
+        FALCOR_THROW("Failed to open serialized file '{}'.", mPath);
+
+    uint16_t format = 0;
+    uint16_t version = 0;
+    ifs.seekg(mOffsets[shapeIndex]);
+    ifs.read(reinterpret_cast<char*>(&format), sizeof(format));
+    ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (format != kFormatIdentifier || version < kMinVersion || version > kMaxVersion)
+        FALCOR_THROW("Shape {} in '{}' has an invalid header.", shapeIndex, mPath);
+
+    std::vector<uint8_t> compressed(mOffsets[shapeIndex + 1] - mOffsets[shapeIndex] - kShapeHeaderSize);
+    ifs.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+    if (!ifs)
+        FALCOR_THROW("Failed to read shape {} from '{}'.", shapeIndex, mPath);
+
+    const std::vector<uint8_t> data = inflateStream(compressed, mPath);
+    compressed = {};
+
+    Reader reader(data, mPath);
+    const uint32_t flags = reader.read<uint32_t>();
+    const std::string name = version == 4 ? reader.readString() : std::string();
+    const uint64_t vertexCount = reader.read<uint64_t>();
+    const uint64_t triangleCount = reader.read<uint64_t>();
+
+    if (vertexCount > std::numeric_limits<uint32_t>::max() || triangleCount > std::numeric_limits<uint32_t>::max() / 3)
+        FALCOR_THROW("Shape {} in '{}' is too large ({} vertices, {} triangles).", shapeIndex, mPath, vertexCount, triangleCount);
+
+    const bool doublePrecision = (flags & DoublePrecision) != 0;
+    if (doublePrecision == ((flags & SinglePrecision) != 0))
+        FALCOR_THROW("Shape {} in '{}' has invalid precision flags ({:#x}).", shapeIndex, mPath, flags);
+
+    // Validate the size before allocating, the counts are untrusted.
+    const size_t scalarSize = doublePrecision ? sizeof(double) : sizeof(float);
+    size_t componentCount = 3;
+    componentCount += (flags & HasNormals) ? 3 : 0;
+    componentCount += (flags & HasTexCoords) ? 2 : 0;
+    componentCount += (flags & HasColors) ? 3 : 0;
+    if (vertexCount * componentCount * scalarSize + triangleCount * 3 * sizeof(uint32_t) > reader.getRemaining())
+        FALCOR_THROW("Shape {} in '{}' is truncated.", shapeIndex, mPath);
+
+    // Decode the attributes straight into the interleaved vertex list.
+    using Vertex = TriangleMesh::Vertex;
+    TriangleMesh::VertexList vertices(vertexCount);
+    uint8_t* pVertices = reinterpret_cast<uint8_t*>(vertices.data());
+    reader.readVectors<float3>(doublePrecision, vertexCount, pVertices + offsetof(Vertex, position), sizeof(Vertex));
+    if (flags & HasNormals)
+        reader.readVectors<float3>(doublePrecision, vertexCount, pVertices + offsetof(Vertex, normal), sizeof(Vertex));
+    if (flags & HasTexCoords)
+        reader.readVectors<float2>(doublePrecision, vertexCount, pVertices + offsetof(Vertex, texCoord), sizeof(Vertex));
+    if (flags & HasColors)
+        reader.skip(vertexCount * 3 * scalarSize);
+
+    TriangleMesh::IndexList indices(triangleCount * 3);
+    reader.readBytes(indices.data(), indices.size() * sizeof(uint32_t));
+    for (uint32_t index : indices)
+    {
+        if (index >= vertexCount)
+            FALCOR_THROW("Shape {} in '{}' has an out of range vertex index {}.", shapeIndex, mPath, index);
+    }
+
+    if (faceNormals || (flags & FaceNormals))
+        convertToFaceNormals(vertices, indices);
+    else if (!(flags & HasNormals))
+        computeVertexNormals(vertices, indices);
+
+    auto pMesh = TriangleMesh::create(std::move(vertices), std::move(indices));
+    pMesh->setName(name);
+    return pMesh;
+}
+
+} // namespace Mitsuba
+
+} // namespace Falcor
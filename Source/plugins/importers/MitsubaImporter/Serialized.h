@@ -0,0 +1,76 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/TriangleMesh.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+namespace Mitsuba
+{
+/**
+ * Reader for Mitsuba's ".serialized" mesh container.
+ *
+ * A serialized file is a sequence of shapes, each stored as a small header followed by a zlib
+ * stream with the shape's vertex and index data. A trailer at the end of the file stores the
+ * offset of each shape, so that shapes can be located and decompressed independently.
+ *
+ * Only the shape dictionary is read when the file is opened. Shapes are loaded on demand,
+ * and loadShape() can be called concurrently from multiple threads.
+ */
+class SerializedFile
+{
+public:
+    /**
+     * Open a serialized file and read its shape dictionary.
+     * Throws an exception if the file cannot be read or is malformed.
+     * @param[in] path File path.
+     */
+    explicit SerializedFile(const std::filesystem::path& path);
+
+    /// Returns the number of shapes in the file.
+    uint32_t getShapeCount() const { return (uint32_t)mOffsets.size() - 1; }
+
+    /**
+     * Load a shape.
+     * Throws an exception if the shape index is out of range or the shape data is malformed.
+     * @param[in] shapeIndex Index of the shape in the file.
+     * @param[in] faceNormals Use face normals instead of the stored or generated vertex normals.
+     * @return Returns the triangle mesh.
+     */
+    ref<TriangleMesh> loadShape(uint32_t shapeIndex, bool faceNormals) const;
+
+private:
+    std::filesystem::path mPath;
+    std::vector<uint64_t> mOffsets; ///< Offsets of the shapes, followed by the offset of the shape dictionary.
+};
+
+} // namespace Mitsuba
+
+} // namespace Falcor
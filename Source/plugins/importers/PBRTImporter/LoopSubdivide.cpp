@@ -33,129 +33,262 @@
 
 #include "LoopSubdivide.h"
 #include "Core/Error.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Timing/CpuTimer.h"
 
 #include <algorithm>
-#include <map>
-#include <memory>
-#include <memory_resource>
-#include <set>
+#include <execution>
+#include <numeric>
 
 #include <cmath>
 
 namespace Falcor::pbrt
 {
 
-struct SDFace;
-struct SDVertex;
-
 #define NEXT(i) (((i) + 1) % 3)
 #define PREV(i) (((i) + 2) % 3)
 
-struct SDVertex
+namespace
 {
-    SDVertex(const float3& p = float3(0.f)) : p(p) {}
-
-    int valence();
-    void oneRing(float3* p);
+const uint32_t kInvalidIndex = uint32_t(-1);
 
-    float3 p;
-    SDFace* startFace = nullptr;
-    SDVertex* child = nullptr;
-    bool regular = false;
-    bool boundary = false;
-};
+// Number of vertices processed per parallel task. Each task reuses one buffer for one-ring positions.
+const uint32_t kVerticesPerTask = 1024;
 
-struct SDFace
+/**
+ * Index-based subdivision mesh for one level of refinement.
+ * Face f has three half-edges 3 * f + k, going from vertex k to vertex NEXT(k) of the face.
+ * For each half-edge we store its start vertex and the face on the other side (kInvalidIndex on the boundary).
+ */
+struct SDMesh
 {
-    SDFace()
+    std::vector<float3> positions;
+    std::vector<uint32_t> startFaces; ///< Per vertex: one of the faces using the vertex (kInvalidIndex if unused).
+    std::vector<uint8_t> regular;     ///< Per vertex: true if the vertex has regular valence.
+    std::vector<uint8_t> boundary;    ///< Per vertex: true if the vertex is on the boundary.
+    std::vector<uint32_t> faceVertices;
+    std::vector<uint32_t> faceNeighbors;
+
+    uint32_t getVertexCount() const { return (uint32_t)positions.size(); }
+    uint32_t getFaceCount() const { return (uint32_t)(faceVertices.size() / 3); }
+
+    void resize(uint32_t vertexCount, uint32_t faceCount)
+    {
+        positions.resize(vertexCount);
+        startFaces.resize(vertexCount, kInvalidIndex);
+        regular.resize(vertexCount);
+        boundary.resize(vertexCount);
+        faceVertices.resize(3 * size_t(faceCount));
+        faceNeighbors.resize(3 * size_t(faceCount), kInvalidIndex);
+    }
+
+    uint32_t vnum(uint32_t face, uint32_t vert) const
     {
         for (uint32_t i = 0; i < 3; ++i)
         {
-            v[i] = nullptr;
-            f[i] = nullptr;
+            if (faceVertices[3 * face + i] == vert)
+                return i;
         }
-        for (uint32_t i = 0; i < 4; ++i)
+        FALCOR_THROW("Basic logic error in SDMesh::vnum().");
+    }
+
+    uint32_t nextFace(uint32_t face, uint32_t vert) const { return faceNeighbors[3 * face + vnum(face, vert)]; }
+    uint32_t prevFace(uint32_t face, uint32_t vert) const { return faceNeighbors[3 * face + PREV(vnum(face, vert))]; }
+    uint32_t nextVert(uint32_t face, uint32_t vert) const { return faceVertices[3 * face + NEXT(vnum(face, vert))]; }
+    uint32_t prevVert(uint32_t face, uint32_t vert) const { return faceVertices[3 * face + PREV(vnum(face, vert))]; }
+    uint32_t otherVert(uint32_t face, uint32_t v0, uint32_t v1) const
+    {
+        for (uint32_t i = 0; i < 3; ++i)
         {
-            children[i] = nullptr;
+            uint32_t v = faceVertices[3 * face + i];
+            if (v != v0 && v != v1)
+                return v;
         }
+        FALCOR_THROW("Basic logic error in SDMesh::otherVert()");
     }
 
-    uint32_t vnum(SDVertex* vert) const
+    uint32_t valence(uint32_t vert) const
     {
-        for (int i = 0; i < 3; ++i)
+        const uint32_t startFace = startFaces[vert];
+        uint32_t f = startFace;
+        if (!boundary[vert])
         {
-            if (v[i] == vert)
-                return i;
+            // Compute valence of interior vertex.
+            uint32_t nf = 1;
+            while ((f = nextFace(f, vert)) != startFace)
+                ++nf;
+            return nf;
+        }
+        else
+        {
+            // Compute valence of boundary vertex.
+            uint32_t nf = 1;
+            while ((f = nextFace(f, vert)) != kInvalidIndex)
+                ++nf;
+            f = startFace;
+            while ((f = prevFace(f, vert)) != kInvalidIndex)
+                ++nf;
+            return nf + 1;
         }
-        FALCOR_THROW("Basic logic error in SDFace::vnum().");
     }
 
-    SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-    SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-    SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-    SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-    SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
+    /// Get the positions of the one-ring vertices. Returns the valence.
+    uint32_t oneRing(uint32_t vert, std::vector<float3>& ring) const
     {
-        for (uint32_t i = 0; i < 3; ++i)
+        ring.clear();
+        if (!boundary[vert])
+        {
+            // Get one-ring vertices for interior vertex.
+            uint32_t face = startFaces[vert];
+            do
+            {
+                ring.push_back(positions[nextVert(face, vert)]);
+                face = nextFace(face, vert);
+            } while (face != startFaces[vert]);
+        }
+        else
         {
-            if (v[i] != v0 && v[i] != v1)
-                return v[i];
+            // Get one-ring vertices for boundary vertex.
+            uint32_t face = startFaces[vert];
+            uint32_t f2;
+            while ((f2 = nextFace(face, vert)) != kInvalidIndex)
+            {
+                face = f2;
+            }
+            ring.push_back(positions[nextVert(face, vert)]);
+            do
+            {
+                ring.push_back(positions[prevVert(face, vert)]);
+                face = prevFace(face, vert);
+            } while (face != kInvalidIndex);
         }
-        FALCOR_THROW("Basic logic error in SDFace::otherVert()");
+        return (uint32_t)ring.size();
     }
 
-    SDVertex* v[3];
-    SDFace* f[3];
-    SDFace* children[4];
-};
-
-struct SDEdge
-{
-    SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
+    float3 weightOneRing(uint32_t vert, float beta, std::vector<float3>& ring) const
     {
-        v[0] = std::min(v0, v1);
-        v[1] = std::max(v0, v1);
-        f[0] = f[1] = nullptr;
-        f0edgeNum = -1;
+        uint32_t valence = oneRing(vert, ring);
+        float3 p = (1 - valence * beta) * positions[vert];
+        for (uint32_t i = 0; i < valence; ++i)
+        {
+            p += beta * ring[i];
+        }
+        return p;
     }
 
-    bool operator<(const SDEdge& e2) const
+    float3 weightBoundary(uint32_t vert, float beta, std::vector<float3>& ring) const
     {
-        if (v[0] == e2.v[0])
-            return v[1] < e2.v[1];
-        return v[0] < e2.v[0];
+        uint32_t valence = oneRing(vert, ring);
+        float3 p = (1 - 2 * beta) * positions[vert];
+        p += beta * ring[0];
+        p += beta * ring[valence - 1];
+        return p;
     }
-
-    SDVertex* v[2];
-    SDFace* f[2];
-    int f0edgeNum;
 };
 
-static float3 weightOneRing(SDVertex* vert, float beta);
-static float3 weightBoundary(SDVertex* vert, float beta);
+/**
+ * Unique edges of a mesh, identified by their (unordered) vertex pair.
+ * Edges are numbered in the order they are first encountered when iterating over the half-edges.
+ */
+struct EdgeTable
+{
+    std::vector<uint32_t> halfEdgeToEdge; ///< Per half-edge: index of its edge.
+    std::vector<uint32_t> edgeToHalfEdge; ///< Per edge: first half-edge using the edge.
+};
 
-inline int SDVertex::valence()
+struct EdgeKey
 {
-    SDFace* f = startFace;
-    if (!boundary)
+    uint64_t vertices; ///< Lower vertex index in the high bits, higher vertex index in the low bits.
+    uint32_t halfEdge;
+
+    bool operator<(const EdgeKey& other) const
     {
-        // Compute valence of interior vertex.
-        int nf = 1;
-        while ((f = f->nextFace(this)) != startFace)
-            ++nf;
-        return nf;
+        return vertices != other.vertices ? vertices < other.vertices : halfEdge < other.halfEdge;
     }
-    else
+};
+
+template<typename T, typename Func>
+void parallelFor(T count, Func func)
+{
+    auto range = NumericRange<T>(0, count);
+    std::for_each(std::execution::par, range.begin(), range.end(), func);
+}
+
+/**
+ * Build the edge table of a mesh by sorting half-edge keys.
+ * If pFaceNeighbors is given, it is filled with face adjacency. Half-edges with the same vertex pair are
+ * paired up in the order they appear, so at most two faces are connected across an edge.
+ */
+EdgeTable buildEdgeTable(const SDMesh& mesh, std::vector<uint32_t>* pFaceNeighbors = nullptr)
+{
+    const uint32_t halfEdgeCount = 3 * mesh.getFaceCount();
+
+    // Sort half-edges by vertex pair, and by half-edge index within each pair.
+    std::vector<EdgeKey> keys(halfEdgeCount);
+    parallelFor(halfEdgeCount, [&](uint32_t he)
     {
-        // Compute valence of boundary vertex
-        int nf = 1;
-        while ((f = f->nextFace(this)) != nullptr)
-            ++nf;
-        f = startFace;
-        while ((f = f->prevFace(this)) != nullptr)
-            ++nf;
-        return nf + 1;
-    }
+        uint32_t face = he / 3;
+        uint64_t v0 = mesh.faceVertices[he];
+        uint64_t v1 = mesh.faceVertices[3 * face + NEXT(he % 3)];
+        keys[he] = {(std::min(v0, v1) << 32) | std::max(v0, v1), he};
+    });
+    std::sort(std::execution::par, keys.begin(), keys.end());
+
+    // Find the first half-edge of each vertex pair.
+    std::vector<uint32_t> firstHalfEdge(halfEdgeCount);
+    parallelFor(halfEdgeCount, [&](uint32_t i)
+    {
+        if (i > 0 && keys[i - 1].vertices == keys[i].vertices)
+            return;
+
+        uint32_t end = i + 1;
+        while (end < halfEdgeCount && keys[end].vertices == keys[i].vertices)
+            ++end;
+
+        for (uint32_t j = i; j < end; ++j)
+            firstHalfEdge[keys[j].halfEdge] = keys[i].halfEdge;
+
+        if (pFaceNeighbors)
+        {
+            for (uint32_t j = i; j + 1 < end; j += 2)
+            {
+                uint32_t he0 = keys[j].halfEdge;
+                uint32_t he1 = keys[j + 1].halfEdge;
+                (*pFaceNeighbors)[he0] = he1 / 3;
+                (*pFaceNeighbors)[he1] = he0 / 3;
+            }
+        }
+    });
+
+    // Number edges in order of their first half-edge.
+    EdgeTable edges;
+    edges.halfEdgeToEdge.resize(halfEdgeCount);
+    std::transform_exclusive_scan(
+        std::execution::par,
+        NumericRange<uint32_t>(0, halfEdgeCount).begin(),
+        NumericRange<uint32_t>(0, halfEdgeCount).end(),
+        edges.halfEdgeToEdge.begin(),
+        0u,
+        std::plus<uint32_t>(),
+        [&](uint32_t he) { return firstHalfEdge[he] == he ? 1u : 0u; }
+    );
+
+    const uint32_t edgeCount = halfEdgeCount > 0 ? edges.halfEdgeToEdge.back() + (firstHalfEdge.back() == halfEdgeCount - 1 ? 1 : 0) : 0;
+    edges.edgeToHalfEdge.resize(edgeCount);
+    parallelFor(halfEdgeCount, [&](uint32_t he)
+    {
+        if (firstHalfEdge[he] == he)
+            edges.edgeToHalfEdge[edges.halfEdgeToEdge[he]] = he;
+    });
+    parallelFor(halfEdgeCount, [&](uint32_t he)
+    {
+        if (firstHalfEdge[he] != he)
+            edges.halfEdgeToEdge[he] = edges.halfEdgeToEdge[firstHalfEdge[he]];
+    });
+
+    return edges;
 }
 
 inline float beta(uint32_t valence)
@@ -171,372 +304,274 @@ inline float loopGamma(uint32_t valence)
     return 1.f / (valence + 3.f / (8.f * beta(valence)));
 }
 
-LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
+/**
+ * Create the base mesh: set up face adjacency and classify vertices.
+ */
+SDMesh createBaseMesh(fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
 {
-    std::vector<SDVertex*> vertices;
-    std::vector<SDFace*> faces;
-
-    // Allocate vertices and faces.
-    std::unique_ptr<SDVertex[]> vertexBuffer = std::make_unique<SDVertex[]>(positions.size());
-    for (size_t i = 0; i < positions.size(); ++i)
-    {
-        vertexBuffer[i] = SDVertex(positions[i]);
-        vertices.push_back(&vertexBuffer[i]);
-    }
-    size_t faceCount = indices.size() / 3;
-    std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-    for (size_t i = 0; i < faceCount; ++i)
-    {
-        faces.push_back(&fs[i]);
-    }
+    const uint32_t vertexCount = (uint32_t)positions.size();
+    const uint32_t faceCount = (uint32_t)(indices.size() / 3);
 
-    // Set face to vertex pointers.
+    SDMesh mesh;
+    mesh.resize(vertexCount, faceCount);
+    std::copy(positions.begin(), positions.end(), mesh.positions.begin());
+    for (uint32_t i = 0; i < 3 * faceCount; ++i)
     {
-        const uint32_t* vp = indices.data();
-        for (size_t i = 0; i < faceCount; ++i, vp += 3)
-        {
-            SDFace* f = faces[i];
-            for (uint32_t j = 0; j < 3; ++j)
-            {
-                SDVertex* v = vertices[vp[j]];
-                f->v[j] = v;
-                v->startFace = f;
-            }
-        }
+        if (indices[i] >= vertexCount)
+            FALCOR_THROW("Vertex index {} is out of range ({} vertices).", indices[i], vertexCount);
+        mesh.faceVertices[i] = indices[i];
+        // The last face using a vertex becomes its start face.
+        mesh.startFaces[indices[i]] = i / 3;
     }
 
-    // Set neighbor pointers in faces.
-    std::set<SDEdge> edges;
-    for (size_t i = 0; i < faceCount; ++i)
-    {
-        SDFace* f = faces[i];
-        for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
-        {
-            // Update neighbor pointer for edgeNum.
-            int v0 = edgeNum, v1 = NEXT(edgeNum);
-            SDEdge e(f->v[v0], f->v[v1]);
-            if (edges.find(e) == edges.end())
-            {
-                // Handle new edge.
-                e.f[0] = f;
-                e.f0edgeNum = edgeNum;
-                edges.insert(e);
-            }
-            else
-            {
-                // Handle previously seen edge.
-                e = *edges.find(e);
-                e.f[0]->f[e.f0edgeNum] = f;
-                f->f[edgeNum] = e.f[0];
-                edges.erase(e);
-            }
-        }
-    }
+    // Set neighbor indices in faces.
+    buildEdgeTable(mesh, &mesh.faceNeighbors);
 
     // Finish vertex initialization.
-    for (size_t i = 0; i < positions.size(); ++i)
+    parallelFor(vertexCount, [&](uint32_t v)
     {
-        SDVertex* v = vertices[i];
-        SDFace* f = v->startFace;
+        if (mesh.startFaces[v] == kInvalidIndex)
+            return;
+
+        uint32_t f = mesh.startFaces[v];
         do
         {
-            f = f->nextFace(v);
-        } while ((f != nullptr) && f != v->startFace);
-        v->boundary = (f == nullptr);
-        if (!v->boundary && v->valence() == 6)
-            v->regular = true;
-        else if (v->boundary && v->valence() == 4)
-            v->regular = true;
-        else
-            v->regular = false;
-    }
+            f = mesh.nextFace(f, v);
+        } while (f != kInvalidIndex && f != mesh.startFaces[v]);
+        mesh.boundary[v] = f == kInvalidIndex;
 
-    // Refine LoopSubdiv into triangles.
-    std::vector<SDFace*> f = faces;
-    std::vector<SDVertex*> v = vertices;
+        uint32_t valence = mesh.valence(v);
+        mesh.regular[v] = mesh.boundary[v] ? valence == 4 : valence == 6;
+    });
 
-    std::pmr::monotonic_buffer_resource buffer;
-    std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-    std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
+    return mesh;
+}
 
-    for (size_t i = 0; i < levels; ++i)
-    {
-        // Update f and v for next level of subdivision.
-        std::vector<SDFace*> newFaces;
-        std::vector<SDVertex*> newVertices;
+/**
+ * Apply one level of Loop subdivision.
+ * The child mesh stores the even vertices (children of the parent's vertices) first, followed by one odd vertex
+ * per edge. Face f is split into the four child faces 4 * f + k, with child 3 in the center.
+ */
+SDMesh subdivide(const SDMesh& mesh)
+{
+    const EdgeTable edges = buildEdgeTable(mesh);
 
-        // Allocate next level of children in mesh tree.
-        for (SDVertex* vertex : v)
-        {
-            vertex->child = vertexAllocator.allocate(1);
-            vertex->child->regular = vertex->regular;
-            vertex->child->boundary = vertex->boundary;
-            newVertices.push_back(vertex->child);
-        }
-        for (SDFace* face : f)
+    const uint32_t vertexCount = mesh.getVertexCount();
+    const uint32_t faceCount = mesh.getFaceCount();
+    const uint32_t edgeCount = (uint32_t)edges.edgeToHalfEdge.size();
+
+    SDMesh child;
+    child.resize(vertexCount + edgeCount, 4 * faceCount);
+
+    // Update vertex positions for even vertices.
+    parallelFor(div_round_up(vertexCount, kVerticesPerTask), [&](uint32_t task)
+    {
+        std::vector<float3> ring;
+        const uint32_t end = std::min(vertexCount, (task + 1) * kVerticesPerTask);
+        for (uint32_t v = task * kVerticesPerTask; v < end; ++v)
         {
-            for (uint32_t k = 0; k < 4; ++k)
+            const uint32_t startFace = mesh.startFaces[v];
+            if (startFace == kInvalidIndex)
             {
-                face->children[k] = faceAllocator.allocate(1);
-                newFaces.push_back(face->children[k]);
+                // Unused vertices are passed through.
+                child.positions[v] = mesh.positions[v];
+                continue;
             }
-        }
 
-        // Update vertex positions and create new edge vertices.
-
-        // Update vertex positions for even vertices.
-        for (SDVertex* vertex : v)
-        {
-            if (!vertex->boundary)
+            if (!mesh.boundary[v])
             {
                 // Apply one-ring rule for even vertex.
-                if (vertex->regular)
-                    vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
+                if (mesh.regular[v])
+                    child.positions[v] = mesh.weightOneRing(v, 1.f / 16.f, ring);
                 else
-                    vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
+                    child.positions[v] = mesh.weightOneRing(v, beta(mesh.valence(v)), ring);
             }
             else
             {
                 // Apply boundary rule for even vertex.
-                vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
+                child.positions[v] = mesh.weightBoundary(v, 1.f / 8.f, ring);
             }
-        }
 
-        // Compute new odd edge vertices.
-        std::map<SDEdge, SDVertex*> edgeVerts;
-        for (SDFace* face : f)
-        {
-            for (uint32_t k = 0; k < 3; ++k)
-            {
-                // Compute odd vertex on kth edge.
-                SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                SDVertex* vert = edgeVerts[edge];
-                if (vert == nullptr)
-                {
-                    // Create and initialize new odd vertex
-                    vert = vertexAllocator.allocate(1);
-                    newVertices.push_back(vert);
-                    vert->regular = true;
-                    vert->boundary = (face->f[k] == nullptr);
-                    vert->startFace = face->children[3];
-
-                    // Apply edge rules to compute new vertex position
-                    if (vert->boundary)
-                    {
-                        vert->p = 0.5f * edge.v[0]->p;
-                        vert->p += 0.5f * edge.v[1]->p;
-                    }
-                    else
-                    {
-                        vert->p = 3.f / 8.f * edge.v[0]->p;
-                        vert->p += 3.f / 8.f * edge.v[1]->p;
-                        vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                        vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                    }
-                    edgeVerts[edge] = vert;
-                }
-            }
+            child.regular[v] = mesh.regular[v];
+            child.boundary[v] = mesh.boundary[v];
+            child.startFaces[v] = 4 * startFace + mesh.vnum(startFace, v);
         }
+    });
 
-        // Update new mesh topology.
-
-        // Update even vertex face pointers.
-        for (SDVertex* vertex : v)
+    // Compute new odd edge vertices.
+    parallelFor(edgeCount, [&](uint32_t e)
+    {
+        const uint32_t he = edges.edgeToHalfEdge[e];
+        const uint32_t face = he / 3;
+        const uint32_t a = mesh.faceVertices[he];
+        const uint32_t b = mesh.faceVertices[3 * face + NEXT(he % 3)];
+        const uint32_t v0 = std::min(a, b);
+        const uint32_t v1 = std::max(a, b);
+        const uint32_t neighbor = mesh.faceNeighbors[he];
+        const uint32_t vert = vertexCount + e;
+
+        child.regular[vert] = true;
+        child.boundary[vert] = neighbor == kInvalidIndex;
+        child.startFaces[vert] = 4 * face + 3;
+
+        // Apply edge rules to compute new vertex position.
+        float3 p;
+        if (child.boundary[vert])
         {
-            int vertNum = vertex->startFace->vnum(vertex);
-            vertex->child->startFace = vertex->startFace->children[vertNum];
+            p = 0.5f * mesh.positions[v0];
+            p += 0.5f * mesh.positions[v1];
         }
-
-        // Update face neighbor pointers.
-        for (SDFace* face : f)
+        else
         {
-            for (uint32_t j = 0; j < 3; ++j)
-            {
-                // Update children f pointers for siblings.
-                face->children[3]->f[j] = face->children[NEXT(j)];
-                face->children[j]->f[NEXT(j)] = face->children[3];
-
-                // Update children f pointers for neighbor children.
-                SDFace* f2 = face->f[j];
-                face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                f2 = face->f[PREV(j)];
-                face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-            }
+            p = 3.f / 8.f * mesh.positions[v0];
+            p += 3.f / 8.f * mesh.positions[v1];
+            p += 1.f / 8.f * mesh.positions[mesh.otherVert(face, v0, v1)];
+            p += 1.f / 8.f * mesh.positions[mesh.otherVert(neighbor, v0, v1)];
         }
+        child.positions[vert] = p;
+    });
+
+    // Update new mesh topology.
+    parallelFor(faceCount, [&](uint32_t face)
+    {
+        const uint32_t* v = &mesh.faceVertices[3 * face];
+        const uint32_t* f = &mesh.faceNeighbors[3 * face];
+        auto childVertices = [&](uint32_t k) { return &child.faceVertices[3 * (4 * face + k)]; };
+        auto childNeighbors = [&](uint32_t k) { return &child.faceNeighbors[3 * (4 * face + k)]; };
 
-        // Update face vertex pointers.
-        for (SDFace* face : f)
+        for (uint32_t j = 0; j < 3; ++j)
         {
-            for (uint32_t j = 0; j < 3; ++j)
-            {
-                // Update child vertex pointer to new even vertex
-                face->children[j]->v[j] = face->v[j]->child;
-
-                // Update child vertex pointer to new odd vertex
-                SDVertex* vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                face->children[j]->v[NEXT(j)] = vert;
-                face->children[NEXT(j)]->v[j] = vert;
-                face->children[3]->v[j] = vert;
-            }
+            // Update children neighbors for siblings.
+            childNeighbors(3)[j] = 4 * face + NEXT(j);
+            childNeighbors(j)[NEXT(j)] = 4 * face + 3;
+
+            // Update children neighbors for neighbor children.
+            uint32_t f2 = f[j];
+            childNeighbors(j)[j] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, v[j]) : kInvalidIndex;
+            f2 = f[PREV(j)];
+            childNeighbors(j)[PREV(j)] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, v[j]) : kInvalidIndex;
+
+            // Update child vertex to new even vertex.
+            childVertices(j)[j] = v[j];
+
+            // Update child vertices to new odd vertex.
+            const uint32_t vert = vertexCount + edges.halfEdgeToEdge[3 * face + j];
+            childVertices(j)[NEXT(j)] = vert;
+            childVertices(NEXT(j))[j] = vert;
+            childVertices(3)[j] = vert;
         }
+    });
 
-        // Prepare for next level of subdivision
-        f = newFaces;
-        v = newVertices;
-    }
+    return child;
+}
 
-    // Push vertices to limit surface.
-    std::vector<float3> pLimit(v.size());
-    for (size_t i = 0; i < v.size(); ++i)
-    {
-        if (v[i]->boundary)
-            pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-        else
-            pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
-    }
-    for (size_t i = 0; i < v.size(); ++i)
+/**
+ * Compute the tangent vectors of a vertex on the limit surface and return their cross product.
+ */
+float3 computeLimitNormal(const SDMesh& mesh, uint32_t vert, std::vector<float3>& pRing)
+{
+    float3 S(0.f);
+    float3 T(0.f);
+    uint32_t valence = mesh.oneRing(vert, pRing);
+    const float3& p = mesh.positions[vert];
+    if (!mesh.boundary[vert])
     {
-        v[i]->p = pLimit[i];
+        // Compute tangents of interior face
+        for (uint32_t j = 0; j < valence; ++j)
+        {
+            S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+            T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+        }
     }
-
-    // Compute vertex tangents on limit surface.
-    std::vector<float3> Ns;
-    Ns.reserve(v.size());
-    std::vector<float3> pRing(16, float3());
-    for (SDVertex* vertex : v)
+    else
     {
-        float3 S(0.f);
-        float3 T(0.f);
-        uint32_t valence = vertex->valence();
-        if (valence > pRing.size())
-            pRing.resize(valence);
-        vertex->oneRing(&pRing[0]);
-        if (!vertex->boundary)
+        // Compute tangents of boundary face
+        S = pRing[valence - 1] - pRing[0];
+        if (valence == 2)
         {
-            // Compute tangents of interior face
-            for (uint32_t j = 0; j < valence; ++j)
-            {
-                S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-                T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-            }
+            T = float3(pRing[0] + pRing[1] - 2.f * p);
         }
-        else
+        else if (valence == 3)
         {
-            // Compute tangents of boundary face
-            S = pRing[valence - 1] - pRing[0];
-            if (valence == 2)
-            {
-                T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
-            }
-            else if (valence == 3)
-            {
-                T = pRing[1] - vertex->p;
-            }
-            else if (valence == 4) // regular
-            {
-                T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
-            }
-            else
-            {
-                float theta = float(M_PI) / float(valence - 1);
-                T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                for (uint32_t k = 1; k < valence - 1; ++k)
-                {
-                    float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                    T += float3(wt * pRing[k]);
-                }
-                T = -T;
-            }
+            T = pRing[1] - p;
         }
-        Ns.push_back(cross(S, T));
-    }
-
-    // Create triangle mesh from subdivision mesh
-    {
-        size_t ntris = f.size();
-        std::vector<uint32_t> verts(3 * ntris);
-        uint32_t* vp = verts.data();
-        uint32_t totVerts = (uint32_t)v.size();
-        std::map<SDVertex*, uint32_t> usedVerts;
-        for (uint32_t i = 0; i < totVerts; ++i)
+        else if (valence == 4) // regular
         {
-            usedVerts[v[i]] = i;
+            T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * p);
         }
-        for (size_t i = 0; i < ntris; ++i)
+        else
         {
-            for (uint32_t j = 0; j < 3; ++j)
+            float theta = float(M_PI) / float(valence - 1);
+            T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+            for (uint32_t k = 1; k < valence - 1; ++k)
             {
-                *vp = usedVerts[f[i]->v[j]];
-                ++vp;
+                float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                T += float3(wt * pRing[k]);
             }
+            T = -T;
         }
-
-        LoopSubdivideResult result;
-        result.positions = std::move(pLimit);
-        result.normals = std::move(Ns);
-        result.indices = std::move(verts);
-        return result;
     }
+    return cross(S, T);
 }
 
-static float3 weightOneRing(SDVertex* vert, float beta)
+} // namespace
+
+LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
 {
-    // Put vert one-ring in pRing.
-    uint32_t valence = vert->valence();
-    FALCOR_ASSERT(valence < 16);
-    float3 pRing[16];
-
-    vert->oneRing(pRing);
-    float3 p = (1 - valence * beta) * vert->p;
-    for (uint32_t i = 0; i < valence; ++i)
+    SDMesh mesh = createBaseMesh(positions, indices);
+
+    // Refine LoopSubdiv into triangles.
+    for (uint32_t i = 0; i < levels; ++i)
     {
-        p += beta * pRing[i];
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        mesh = subdivide(mesh);
+        logDebug(
+            "loopSubdivide: Level {} has {} vertices and {} faces ({:.2f} ms).",
+            i + 1,
+            mesh.getVertexCount(),
+            mesh.getFaceCount(),
+            CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint())
+        );
     }
-    return p;
-}
 
-void SDVertex::oneRing(float3* p_)
-{
-    if (!boundary)
+    // Push vertices to limit surface.
+    const uint32_t vertexCount = mesh.getVertexCount();
+    std::vector<float3> pLimit(vertexCount);
+    parallelFor(div_round_up(vertexCount, kVerticesPerTask), [&](uint32_t task)
     {
-        // Get one-ring vertices for interior vertex.
-        SDFace* face = startFace;
-        do
+        std::vector<float3> ring;
+        const uint32_t end = std::min(vertexCount, (task + 1) * kVerticesPerTask);
+        for (uint32_t v = task * kVerticesPerTask; v < end; ++v)
         {
-            *p_++ = face->nextVert(this)->p;
-            face = face->nextFace(this);
-        } while (face != startFace);
-    }
-    else
+            if (mesh.startFaces[v] == kInvalidIndex)
+                pLimit[v] = mesh.positions[v];
+            else if (mesh.boundary[v])
+                pLimit[v] = mesh.weightBoundary(v, 1.f / 5.f, ring);
+            else
+                pLimit[v] = mesh.weightOneRing(v, loopGamma(mesh.valence(v)), ring);
+        }
+    });
+    mesh.positions.swap(pLimit);
+
+    // Compute vertex tangents on limit surface.
+    std::vector<float3> Ns(vertexCount, float3(0.f));
+    parallelFor(div_round_up(vertexCount, kVerticesPerTask), [&](uint32_t task)
     {
-        // Get one-ring vertices for boundary vertex.
-        SDFace* face = startFace;
-        SDFace* f2;
-        while ((f2 = face->nextFace(this)) != nullptr)
+        std::vector<float3> ring;
+        const uint32_t end = std::min(vertexCount, (task + 1) * kVerticesPerTask);
+        for (uint32_t v = task * kVerticesPerTask; v < end; ++v)
         {
-            face = f2;
+            if (mesh.startFaces[v] != kInvalidIndex)
+                Ns[v] = computeLimitNormal(mesh, v, ring);
         }
-        *p_++ = face->nextVert(this)->p;
-        do
-        {
-            *p_++ = face->prevVert(this)->p;
-            face = face->prevFace(this);
-        } while (face != nullptr);
-    }
-}
-
-static float3 weightBoundary(SDVertex* vert, float beta)
-{
-    // Put vert one-ring in pRing.
-    uint32_t valence = vert->valence();
-    FALCOR_ASSERT(valence < 16);
-    float3 pRing[16];
-
-    vert->oneRing(pRing);
-    float3 p = (1 - 2 * beta) * vert->p;
-    p += beta * pRing[0];
-    p += beta * pRing[valence - 1];
-    return p;
+    });
+
+    // Create triangle mesh from subdivision mesh.
+    LoopSubdivideResult result;
+    result.positions = std::move(mesh.positions);
+    result.normals = std::move(Ns);
+    result.indices = std::move(mesh.faceVertices);
+    return result;
 }
 
 } // namespace Falcor::pbrt
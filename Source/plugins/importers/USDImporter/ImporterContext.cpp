@@ -41,6 +41,9 @@
 
 #include <tbb/parallel_for.h>
 
+#include <optional>
+#include <unordered_set>
+
 BEGIN_DISABLE_USD_WARNINGS
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usd/stage.h>
@@ -882,17 +885,27 @@ namespace Falcor
                 }
             }
 
-            for (size_t i = 0; i < geomData.geomSubsets.size(); ++i)
-            {
-                // Create separate mesh for each GeomSubset
-                SceneBuilder::Mesh sbMesh;
-                if (!createSceneBuilderMesh(mesh.prim, geomData, geomData.geomSubsets[i], ctx, sbMesh))
+            // Create separate mesh for each GeomSubset.
+            // Subsets are processed in parallel, as a single gprim may hold most of the geometry of the stage.
+            std::vector<std::optional<SceneBuilder::ProcessedMesh>> processedSubsets(geomData.geomSubsets.size());
+            tbb::parallel_for<size_t>(0, geomData.geomSubsets.size(),
+                [&](size_t i)
                 {
-                    continue;
+                    SceneBuilder::Mesh sbMesh;
+                    if (!createSceneBuilderMesh(mesh.prim, geomData, geomData.geomSubsets[i], ctx, sbMesh))
+                    {
+                        return;
+                    }
+
+                    auto pAttributeIndices = mesh.attributeIndices.empty() ? nullptr : &mesh.attributeIndices[i];
+                    processedSubsets[i] = ctx.builder.processMesh(sbMesh, pAttributeIndices);
                 }
+            );
 
-                auto pAttributeIndices = mesh.attributeIndices.empty() ? nullptr : &mesh.attributeIndices[i];
-                mesh.processedMeshes.push_back(ctx.builder.processMesh(sbMesh, pAttributeIndices));
+            // Keep the processed meshes in subset order.
+            for (auto& processedSubset : processedSubsets)
+            {
+                if (processedSubset) mesh.processedMeshes.push_back(std::move(*processedSubset));
             }
 
             return true;
@@ -1083,8 +1096,88 @@ namespace Falcor
             }
         }
 
+        void createMeshTasks(ImporterContext& ctx)
+        {
+            // Get time samples from the points attribute. This only reads from the stage and is done in parallel.
+            tbb::parallel_for<size_t>(0, ctx.meshes.size(),
+                [&](size_t i)
+                {
+                    UsdGeomPointBased geomPointBased(ctx.meshes[i].prim);
+                    geomPointBased.GetPointsAttr().GetTimeSamples(&ctx.meshes[i].timeSamples);
+                }
+            );
+
+            // Create the mesh processing tasks in mesh order.
+            for (size_t index = 0; index < ctx.meshes.size(); ++index)
+            {
+                auto& mesh = ctx.meshes[index];
+
+                if (!ctx.builder.getSettings().getAttribute(mesh.prim.GetPath().GetString(), "usdImporter:enableMotion", true))
+                    mesh.timeSamples.clear();
+
+                if (mesh.timeSamples.size() == 0)
+                {
+                    mesh.timeSamples.push_back(0.0);
+                    ctx.meshTasks.push_back(MeshProcessingTask{ (uint32_t)index, 0 });
+                }
+                else
+                {
+                    // Create mesh processing tasks, one for each time sample
+                    for (uint32_t i = 0; i < mesh.timeSamples.size(); ++i)
+                    {
+                        MeshProcessingTask task{ (uint32_t)index, i };
+
+                        // Add the default mesh (or first time-sample) to mesh tasks
+                        if (i == 0) ctx.meshTasks.push_back(task);
+
+                        // Add task for processing keyframe
+                        if (mesh.timeSamples.size() > 1) ctx.meshKeyframeTasks.push_back(task);
+                    }
+                }
+            }
+        }
+
+        void convertMeshMaterials(ImporterContext& ctx)
+        {
+            // Gather the materials bound to the meshes and their subsets.
+            std::vector<std::vector<UsdShadeMaterial>> meshMaterials(ctx.meshes.size());
+            tbb::parallel_for<size_t>(0, ctx.meshes.size(),
+                [&](size_t i)
+                {
+                    if (!ctx.meshes[i].prim.IsA<UsdGeomMesh>()) return;
+                    UsdGeomMesh usdMesh(ctx.meshes[i].prim);
+                    meshMaterials[i].push_back(ctx.getBoundMaterial(usdMesh));
+                    for (const auto& subset : UsdGeomSubset::GetAllGeomSubsets(usdMesh))
+                    {
+                        meshMaterials[i].push_back(ctx.getBoundMaterial(subset));
+                    }
+                }
+            );
+
+            std::vector<UsdShadeMaterial> materials;
+            std::unordered_set<SdfPath, SdfPath::Hash> materialPaths;
+            for (const auto& list : meshMaterials)
+            {
+                for (const auto& material : list)
+                {
+                    if (material && materialPaths.insert(material.GetPath()).second) materials.push_back(material);
+                }
+            }
+
+            // Convert each material once, in parallel. The converter caches the results, so the mesh conversion
+            // below doesn't block on the converter while another thread converts a shared material.
+            tbb::parallel_for<size_t>(0, materials.size(),
+                [&](size_t i) { ctx.mpPreviewSurfaceConverter->convert(materials[i], ctx.builder.getDevice()->getRenderContext()); }
+            );
+        }
+
         void addMeshesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
+            createMeshTasks(ctx);
+
+            convertMeshMaterials(ctx);
+            timeReport.measure("Convert mesh materials");
+
             // Process collected mesh tasks.
             tbb::parallel_for<size_t>(0, ctx.meshTasks.size(),
                 [&](size_t i)
@@ -1093,6 +1186,7 @@ namespace Falcor
                     processMesh(ctx.meshes[ctx.meshTasks[i].meshId], ctx);
                 }
             );
+            timeReport.measure("Convert meshes");
 
             // Add processed meshes to scene builder.
             // This is done sequentially after being processed in parallel to ensure a deterministic ordering.
@@ -1104,6 +1198,7 @@ namespace Falcor
                     mesh.meshIDs.push_back(ctx.builder.addProcessedMesh(m));
                 }
             }
+            timeReport.measure("Add meshes");
 
             if (ctx.builder.getSettings().getOption("usdImporter:loadMeshVertexAnimations", kLoadMeshVertexAnimations))
             {
@@ -1131,9 +1226,9 @@ namespace Falcor
 
                 for (auto& m : ctx.meshes)
                     ctx.builder.addCachedMeshes(std::move(m.cachedMeshes));
-            }
 
-            timeReport.measure("Process meshes");
+                timeReport.measure("Convert mesh keyframes");
+            }
         }
 
         void addInstancesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
@@ -1266,6 +1361,7 @@ namespace Falcor
             tbb::parallel_for<size_t>(0, ctx.curves.size(),
                 [&](size_t i) { processCurve(ctx.curves[i], ctx); }
             );
+            timeReport.measure("Convert curves");
 
             // Add processed curves or meshes (of the first keyframe) to scene builder.
             // This is done sequentially after being processed in parallel to ensure a deterministic ordering.
@@ -1286,7 +1382,7 @@ namespace Falcor
             for (auto& curve : ctx.curves) ctx.addCachedCurve(curve);
             ctx.builder.addCachedCurves(std::move(ctx.cachedCurves));
 
-            timeReport.measure("Process curves");
+            timeReport.measure("Add curves");
 
             // Add instances to scene builder.
             for (const auto& instance : ctx.curveInstances)
@@ -1901,39 +1997,11 @@ namespace Falcor
         // Make sure to only add it once to meshes and meshMap.
         if (geomMap.find(prim) == geomMap.end())
         {
-            Mesh mesh{ prim };
-
-            // Mesh will be added at the next index
+            // Mesh will be added at the next index.
+            // Time samples and processing tasks are created in finalize(), after the traversal.
             size_t index = meshes.size();
 
-            // Get time samples from the points attribute
-            UsdGeomPointBased geomPointBased(prim);
-            geomPointBased.GetPointsAttr().GetTimeSamples(&mesh.timeSamples);
-
-            if (!builder.getSettings().getAttribute(prim.GetPath().GetString(), "usdImporter:enableMotion", true))
-                mesh.timeSamples.clear();
-
-            if (mesh.timeSamples.size() == 0)
-            {
-                mesh.timeSamples.push_back(0.0);
-                meshTasks.push_back(MeshProcessingTask{ (uint32_t)index, 0 });
-            }
-            else
-            {
-                // Create mesh processing tasks, one for each time sample
-                for (uint32_t i = 0; i < mesh.timeSamples.size(); ++i)
-                {
-                    MeshProcessingTask task{ (uint32_t)index, i };
-
-                    // Add the default mesh (or first time-sample) to mesh tasks
-                    if (i == 0) meshTasks.push_back(task);
-
-                    // Add task for processing keyframe
-                    if(mesh.timeSamples.size() > 1) meshKeyframeTasks.push_back(task);
-                }
-            }
-
-            meshes.push_back(std::move(mesh));
+            meshes.push_back(Mesh{ prim });
             geomMap.emplace(prim, index);
         }
     }
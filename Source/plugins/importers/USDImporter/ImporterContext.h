@@ -335,6 +335,11 @@ namespace Falcor
 
             Some object types may require data from other associated objects in the
             scene and cannot be added directly to the SceneBuilder during traversal.
+
+            Geometry is converted in two phases: a parallel phase that converts materials, meshes and curves
+            (triangulation, primvar flattening, subset splitting and scene builder pre-processing), followed by a
+            serial phase that registers the results with the SceneBuilder in traversal order, so that the
+            resulting scene is deterministic. The time of each phase is recorded in the time report.
         */
         void finalize();
 
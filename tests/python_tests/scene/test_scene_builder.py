@@ -0,0 +1,70 @@
+import sys
+import os
+import unittest
+import falcor
+import numpy as np
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.relpath(__file__))))
+from helpers import for_each_device_type
+from scene.test_triangle_mesh import create_grid
+
+SCENE_TEMPLATE = """
+import numpy as np
+
+positions = np.array({positions}, dtype=np.float32)
+normals = np.array({normals}, dtype=np.float32)
+tex_coords = np.array({tex_coords}, dtype=np.float32)
+indices = np.array({indices}, dtype=np.uint32)
+
+material = StandardMaterial("Material")
+mesh_id = sceneBuilder.addMesh(positions, indices, material, normals=normals, texCoords=tex_coords, name="Grid")
+sceneBuilder.addMeshInstance(sceneBuilder.addNode("Grid"), mesh_id)
+"""
+
+
+def read_mesh(testbed, mesh_id):
+    """
+    Read back the triangle indices, positions and texture coordinates of a mesh from the scene buffers.
+    """
+    scene = testbed.scene
+    mesh = scene.get_mesh(mesh_id)
+    buffers = {
+        name: testbed.device.create_structured_buffer(
+            struct_size=12,
+            element_count=mesh.triangle_count if name == "triangleIndices" else mesh.vertex_count,
+            bind_flags=falcor.ResourceBindFlags.ShaderResource | falcor.ResourceBindFlags.UnorderedAccess,
+        )
+        for name in ["triangleIndices", "positions", "texcrds"]
+    }
+    scene.get_mesh_vertices_and_indices(mesh_id, buffers)
+    triangles = buffers["triangleIndices"].to_numpy().view(np.uint32).reshape(-1, 3)
+    positions = buffers["positions"].to_numpy().view(np.float32).reshape(-1, 3)
+    tex_coords = buffers["texcrds"].to_numpy().view(np.float32).reshape(-1, 3)[:, :2]
+    return triangles, positions, tex_coords
+
+
+class TestSceneBuilder(unittest.TestCase):
+    @for_each_device_type
+    def test_add_mesh_from_numpy(self, device: falcor.Device):
+        positions, normals, tex_coords, indices = create_grid(4)
+        script = SCENE_TEMPLATE.format(
+            positions=positions.tolist(),
+            normals=normals.tolist(),
+            tex_coords=tex_coords.tolist(),
+            indices=indices.tolist(),
+        )
+
+        testbed = falcor.Testbed(width=64, height=64, create_window=False, device=device)
+        testbed.load_scene_from_string(script)
+        self.assertEqual(testbed.scene.get_mesh(0).vertex_count, len(positions))
+        self.assertEqual(testbed.scene.get_mesh(0).triangle_count, len(indices) // 3)
+
+        # The vertices may be reordered, so compare the attributes of each triangle corner.
+        triangles, scene_positions, scene_tex_coords = read_mesh(testbed, 0)
+        corners = indices.reshape(-1, 3)
+        self.assertTrue(np.array_equal(scene_positions[triangles], positions[corners]))
+        self.assertTrue(np.array_equal(scene_tex_coords[triangles], tex_coords[corners]))
+
+
+if __name__ == "__main__":
+    unittest.main()
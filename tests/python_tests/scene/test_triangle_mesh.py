@@ -0,0 +1,83 @@
+import time
+import unittest
+import falcor
+import numpy as np
+
+
+def create_grid(resolution):
+    """
+    Create the attributes of a regular grid in the XZ plane with resolution x resolution quads.
+    """
+    u, v = np.meshgrid(np.linspace(0, 1, resolution + 1, dtype=np.float32), np.linspace(0, 1, resolution + 1, dtype=np.float32))
+    u = u.flatten()
+    v = v.flatten()
+    positions = np.stack([u, np.sin(u * 10) * np.cos(v * 10), v], axis=1)
+    normals = np.tile(np.array([0, 1, 0], dtype=np.float32), (len(u), 1))
+    tex_coords = np.stack([u, v], axis=1)
+
+    row = resolution + 1
+    i, j = np.meshgrid(np.arange(resolution), np.arange(resolution))
+    i0 = (j * row + i).flatten()
+    indices = np.stack([i0, i0 + row, i0 + 1, i0 + 1, i0 + row, i0 + row + 1], axis=1).flatten()
+
+    return positions, normals, tex_coords, indices
+
+
+class TestTriangleMesh(unittest.TestCase):
+    def test_create_from_numpy(self):
+        positions, normals, tex_coords, indices = create_grid(4)
+        mesh = falcor.TriangleMesh.createFromNumpy(positions, normals, indices.astype(np.uint32), tex_coords)
+        self.assertEqual(len(mesh.vertices), len(positions))
+        self.assertEqual(mesh.indices, indices.tolist())
+        for i, v in enumerate(mesh.vertices):
+            self.assertEqual([v.position.x, v.position.y, v.position.z], positions[i].tolist())
+            self.assertEqual([v.normal.x, v.normal.y, v.normal.z], normals[i].tolist())
+            self.assertEqual([v.texCoord.x, v.texCoord.y], tex_coords[i].tolist())
+
+        # Indices are converted to uint32 and texture coordinates are optional.
+        mesh = falcor.TriangleMesh.createFromNumpy(positions.flatten(), normals, indices)
+        self.assertEqual(mesh.indices, indices.tolist())
+        self.assertTrue(all(v.texCoord.x == 0 and v.texCoord.y == 0 for v in mesh.vertices))
+
+    def test_create_from_numpy_errors(self):
+        positions, normals, tex_coords, indices = create_grid(2)
+        with self.assertRaises(Exception):
+            falcor.TriangleMesh.createFromNumpy(positions[:-1], normals, indices)
+        with self.assertRaises(Exception):
+            falcor.TriangleMesh.createFromNumpy(positions, normals, indices[:-1])
+        with self.assertRaises(Exception):
+            falcor.TriangleMesh.createFromNumpy(positions, normals, indices + len(positions))
+        with self.assertRaises(Exception):
+            falcor.TriangleMesh.createFromNumpy(positions, normals, indices, tex_coords[:, :1])
+
+    def test_create_from_numpy_matches_per_element(self):
+        positions, normals, tex_coords, indices = create_grid(100)
+
+        start = time.perf_counter()
+        mesh = falcor.TriangleMesh()
+        for p, n, t in zip(positions, normals, tex_coords):
+            mesh.addVertex(falcor.float3(*p), falcor.float3(*n), falcor.float2(*t))
+        for t in indices.reshape(-1, 3):
+            mesh.addTriangle(*(int(i) for i in t))
+        per_element_time = time.perf_counter() - start
+
+        start = time.perf_counter()
+        bulk_mesh = falcor.TriangleMesh.createFromNumpy(positions, normals, indices, tex_coords)
+        bulk_time = time.perf_counter() - start
+
+        # Timings are only reported, wall-clock comparisons are unreliable on loaded machines.
+        print(
+            f"Created mesh with {len(positions)} vertices and {len(indices) // 3} triangles: "
+            f"per element {per_element_time * 1000:.1f} ms, bulk {bulk_time * 1000:.1f} ms "
+            f"({per_element_time / max(bulk_time, 1e-9):.0f}x speedup)"
+        )
+
+        self.assertEqual(mesh.indices, bulk_mesh.indices)
+        self.assertEqual(len(mesh.vertices), len(bulk_mesh.vertices))
+        for a, b in zip(mesh.vertices, bulk_mesh.vertices):
+            self.assertEqual([a.position.x, a.position.y, a.position.z], [b.position.x, b.position.y, b.position.z])
+            self.assertEqual([a.normal.x, a.normal.y, a.normal.z], [b.normal.x, b.normal.y, b.normal.z])
+            self.assertEqual([a.texCoord.x, a.texCoord.y], [b.texCoord.x, b.texCoord.y])
+
+if __name__ == "__main__":
+    unittest.main()
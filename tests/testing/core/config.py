@@ -29,6 +29,12 @@ ERROR_IMAGE_SUFFIX = '.error.png'
 
 PYTHON_TESTS_DIR = "tests/python_tests"
 
+# Directory containing the stored benchmark baselines (one per host and build configuration).
+BENCHMARK_BASELINES_DIR = "tests/benchmark_baselines"
+
+# Default allowed regression of benchmark median times in percent.
+DEFAULT_BENCHMARK_THRESHOLD = 10.0
+
 # Build configurations.
 BUILD_CONFIGS = {
     # Temporary build configurations combining a CMake preset and build type.
@@ -108,6 +108,7 @@ class Environment:
         self.image_tests_ref_dir: str = env['image_tests']['ref_dir']
         self.image_tests_remote_ref_dir: str = env['image_tests'].get('remote_ref_dir', None)
         self.python_tests_dir = self.project_dir / config.PYTHON_TESTS_DIR
+        self.benchmark_baselines_dir = self.project_dir / config.BENCHMARK_BASELINES_DIR
 
         self.vcs_root = helpers.get_vcs_root(self.project_dir)
         self.hostname = helpers.get_hostname()
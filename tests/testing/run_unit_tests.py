@@ -2,9 +2,11 @@
 Frontend for running unit tests.
 
 This script helps to run the falcor unit tests for different build configurations.
+With --benchmark, the benchmarks are run instead and compared against the stored baseline.
 '''
 
 import sys
+import shutil
 import argparse
 import subprocess
 
@@ -26,6 +28,32 @@ def run_unit_tests(env: Environment, args):
 
     return p.returncode == 0
 
+def run_benchmarks(env: Environment, args, threshold, update_baseline):
+    '''
+    Run benchmarks by running FalcorTest in benchmark mode.
+    Results are compared against the baseline of this host and build configuration if one exists.
+    '''
+    baseline_file = env.benchmark_baselines_dir / env.hostname / f'{env.build_config}.json'
+    report_file = env.temp_dir / 'benchmarks' / f'{env.build_config}.json'
+    report_file.parent.mkdir(parents=True, exist_ok=True)
+
+    args = ['--benchmark', '--benchmark-report', str(report_file), '--benchmark-threshold', str(threshold)] + args
+    if baseline_file.exists() and not update_baseline:
+        print(f'Comparing against baseline "{baseline_file}".')
+        args += ['--benchmark-baseline', str(baseline_file)]
+
+    success = run_unit_tests(env, args)
+
+    if update_baseline:
+        if not success:
+            print('Benchmarks failed, baseline not updated.')
+            return False
+        baseline_file.parent.mkdir(parents=True, exist_ok=True)
+        shutil.copyfile(report_file, baseline_file)
+        print(f'Updated baseline "{baseline_file}".')
+
+    return success
+
 def main():
     default_config = find_most_recent_build_config()
 
@@ -34,6 +62,9 @@ def main():
     parser.add_argument('--environment', type=str, action='store', help=f'Environment', default=None)
     parser.add_argument('--config', type=str, action='store', help=f'Build configuration (default: {default_config})', default=default_config)
     parser.add_argument('--list-configs', action='store_true', help='List available build configurations')
+    parser.add_argument('--benchmark', action='store_true', help='Run the benchmarks instead of the unit tests')
+    parser.add_argument('--benchmark-threshold', type=float, action='store', help=f'Allowed regression of benchmark median times in percent (default: {config.DEFAULT_BENCHMARK_THRESHOLD})', default=config.DEFAULT_BENCHMARK_THRESHOLD)
+    parser.add_argument('--update-baseline', action='store_true', help='Store the benchmark results as the new baseline')
     args, passthrough_args = parser.parse_known_args()
 
     # Try to load environment.
@@ -53,6 +84,10 @@ def main():
             print(f"\nFailed to load environment: {env_error}")
         sys.exit(0)
 
+    if args.update_baseline and not args.benchmark:
+        print('--update-baseline requires --benchmark.')
+        sys.exit(1)
+
     # List build configurations.
     if args.list_configs:
         print('Available build configurations:\n' + '\n'.join(config.BUILD_CONFIGS.keys()))
@@ -64,7 +99,10 @@ def main():
         sys.exit(1)
 
     # Run tests.
-    success = run_unit_tests(env, passthrough_args)
+    if args.benchmark:
+        success = run_benchmarks(env, passthrough_args, args.benchmark_threshold, args.update_baseline)
+    else:
+        success = run_unit_tests(env, passthrough_args)
 
     sys.exit(0 if success else 1)
 